@@ -434,6 +434,7 @@ TEST_F(CmdlineParserTest, TestJitOptions) {
   }
   {
     EXPECT_SINGLE_PARSE_VALUE(12345u, "-Xjitthreshold:12345", M::JITCompileThreshold);
+    EXPECT_SINGLE_PARSE_VALUE(0u, "-Xjitoptimizethreshold:0", M::JITOptimizeThreshold);
   }
 }  // TEST_F
 
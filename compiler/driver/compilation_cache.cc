@@ -0,0 +1,890 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compilation_cache.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+
+#include "arch/instruction_set_features.h"
+#include "art_method-inl.h"
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
+#include "base/unix_file/fd_file.h"
+#include "class_linker.h"
+#include "compiled_method.h"
+#include "dex/pass_manager.h"
+#include "dex_instruction-inl.h"
+#include "driver/compiler_driver.h"
+#include "driver/compiler_options.h"
+#include "gc/heap.h"
+#include "gc/space/image_space.h"
+#include "leb128.h"
+#include "mirror/class-inl.h"
+#include "mirror/dex_cache-inl.h"
+#include "mirror/iftable-inl.h"
+#include "oat.h"
+#include "os.h"
+#include "runtime.h"
+#include "scoped_thread_state_change.h"
+#include "utils.h"
+
+namespace art {
+
+// Bump whenever the key inputs or the entry layout change.
+static constexpr uint32_t kCompilationCacheVersion = 3u;
+
+// Entries are named by their key in hexadecimal.
+static constexpr size_t kEntryNameLength = 2u * sizeof(uint64_t);
+
+static constexpr uint8_t kEntryMagic[] = { 'a', 'c', 'c', '\n' };
+
+// Markers folded into the key for types without a class signature.
+static constexpr uint64_t kUnresolvedType = UINT64_C(0xffffffffffffffff);
+static constexpr uint64_t kPrimitiveType = UINT64_C(0xfffffffffffffffe);
+
+// 64-bit FNV-1a hash used to fold the key inputs.
+class KeyHasher {
+ public:
+  KeyHasher() : hash_(UINT64_C(0xcbf29ce484222325)) {}
+
+  void UpdateBytes(const void* data, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    for (size_t i = 0; i != size; ++i) {
+      hash_ = (hash_ ^ bytes[i]) * UINT64_C(0x100000001b3);
+    }
+  }
+
+  template <typename T>
+  void UpdateValue(T value) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value,
+                  "Only integral values can be hashed directly");
+    UpdateBytes(&value, sizeof(value));
+  }
+
+  void UpdateString(const std::string& str) {
+    UpdateValue<uint32_t>(str.size());
+    UpdateBytes(str.data(), str.size());
+  }
+
+  void UpdateSignature(const DexFile& dex_file) {
+    UpdateBytes(dex_file.GetHeader().signature_, DexFile::kSha1DigestSize);
+  }
+
+  uint64_t Get() const {
+    return hash_;
+  }
+
+ private:
+  uint64_t hash_;
+};
+
+// A string, type, field or method index used by a code item.
+struct DexIndex {
+  enum Kind {
+    kString,
+    kType,
+    kField,
+    kMethod,
+  };
+
+  DexIndex(Kind k, uint32_t i) : kind(k), index(i) {}
+
+  Kind kind;
+  uint32_t index;
+};
+
+// Collects the dex file indices used by the instructions and catch handlers of a code item.
+static void CollectIndices(const DexFile::CodeItem* code_item, std::vector<DexIndex>* indices) {
+  for (uint32_t dex_pc = 0u; dex_pc < code_item->insns_size_in_code_units_; ) {
+    const Instruction* inst = Instruction::At(&code_item->insns_[dex_pc]);
+    switch (inst->GetVerifyTypeArgumentB()) {
+      case Instruction::kVerifyRegBString:
+        indices->push_back(DexIndex(DexIndex::kString, inst->VRegB()));
+        break;
+      case Instruction::kVerifyRegBType:
+      case Instruction::kVerifyRegBNewInstance:
+        indices->push_back(DexIndex(DexIndex::kType, inst->VRegB()));
+        break;
+      case Instruction::kVerifyRegBField:
+        indices->push_back(DexIndex(DexIndex::kField, inst->VRegB()));
+        break;
+      case Instruction::kVerifyRegBMethod:
+        indices->push_back(DexIndex(DexIndex::kMethod, inst->VRegB()));
+        break;
+      default:
+        break;
+    }
+    switch (inst->GetVerifyTypeArgumentC()) {
+      case Instruction::kVerifyRegCType:
+      case Instruction::kVerifyRegCNewArray:
+        indices->push_back(DexIndex(DexIndex::kType, inst->VRegC()));
+        break;
+      case Instruction::kVerifyRegCField:
+        indices->push_back(DexIndex(DexIndex::kField, inst->VRegC()));
+        break;
+      default:
+        break;
+    }
+    dex_pc += inst->SizeInCodeUnits();
+  }
+  if (code_item->tries_size_ != 0u) {
+    const uint8_t* handlers = DexFile::GetCatchHandlerData(*code_item, 0u);
+    size_t num_handlers = DecodeUnsignedLeb128(&handlers);
+    for (size_t i = 0; i != num_handlers; ++i) {
+      CatchHandlerIterator it(handlers);
+      for (; it.HasNext(); it.Next()) {
+        if (it.GetHandlerTypeIndex() != DexFile::kDexNoIndex16) {
+          indices->push_back(DexIndex(DexIndex::kType, it.GetHandlerTypeIndex()));
+        }
+      }
+      handlers = it.EndDataPointer();
+    }
+  }
+}
+
+// Hashes an index together with what it denotes in the dex file.
+static void HashIndex(KeyHasher* hasher, const DexFile& dex_file, const DexIndex& index) {
+  hasher->UpdateValue(index.kind);
+  hasher->UpdateValue(index.index);
+  switch (index.kind) {
+    case DexIndex::kString:
+      hasher->UpdateString(dex_file.StringDataByIdx(index.index));
+      break;
+    case DexIndex::kType:
+      hasher->UpdateString(dex_file.StringByTypeIdx(index.index));
+      break;
+    case DexIndex::kField: {
+      const DexFile::FieldId& field_id = dex_file.GetFieldId(index.index);
+      hasher->UpdateString(dex_file.GetFieldDeclaringClassDescriptor(field_id));
+      hasher->UpdateString(dex_file.GetFieldName(field_id));
+      hasher->UpdateString(dex_file.GetFieldTypeDescriptor(field_id));
+      break;
+    }
+    case DexIndex::kMethod: {
+      const DexFile::MethodId& method_id = dex_file.GetMethodId(index.index);
+      hasher->UpdateString(dex_file.GetMethodDeclaringClassDescriptor(method_id));
+      hasher->UpdateString(dex_file.GetMethodName(method_id));
+      hasher->UpdateString(dex_file.GetMethodSignature(method_id).ToString());
+      break;
+    }
+  }
+}
+
+// Hashes the bytes of a code item and the meaning of every index it uses.
+static void HashCodeItem(KeyHasher* hasher, const DexFile& dex_file,
+                         const DexFile::CodeItem* code_item, std::vector<DexIndex>* indices) {
+  hasher->UpdateValue(code_item->registers_size_);
+  hasher->UpdateValue(code_item->ins_size_);
+  hasher->UpdateValue(code_item->outs_size_);
+  hasher->UpdateValue(code_item->tries_size_);
+  hasher->UpdateBytes(code_item->insns_,
+                      code_item->insns_size_in_code_units_ * sizeof(code_item->insns_[0]));
+  if (code_item->tries_size_ != 0u) {
+    const uint8_t* tries =
+        reinterpret_cast<const uint8_t*>(DexFile::GetTryItems(*code_item, 0u));
+    const uint8_t* handlers = DexFile::GetCatchHandlerData(*code_item, 0u);
+    hasher->UpdateBytes(tries, handlers - tries);
+    // The handler list encodes the catch types and addresses; hash up to its end.
+    const uint8_t* end = handlers;
+    size_t num_handlers = DecodeUnsignedLeb128(&end);
+    for (size_t i = 0; i != num_handlers; ++i) {
+      CatchHandlerIterator it(end);
+      for (; it.HasNext(); it.Next()) {
+      }
+      end = it.EndDataPointer();
+    }
+    hasher->UpdateBytes(handlers, end - handlers);
+  }
+  indices->clear();
+  CollectIndices(code_item, indices);
+  for (const DexIndex& index : *indices) {
+    HashIndex(hasher, dex_file, index);
+  }
+}
+
+// Finds the method a method index refers to by name and signature, as the compiler resolves
+// it. The dex cache is not used: methods get resolved into it while methods are compiled, and
+// the key must not depend on that.
+static ArtMethod* FindCallee(const DexFile& dex_file, mirror::DexCache* dex_cache,
+                             uint32_t method_idx) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  const DexFile::MethodId& method_id = dex_file.GetMethodId(method_idx);
+  mirror::Class* klass = dex_cache->GetResolvedType(method_id.class_idx_);
+  if (klass == nullptr) {
+    return nullptr;
+  }
+  const size_t pointer_size = Runtime::Current()->GetClassLinker()->GetImagePointerSize();
+  const char* name = dex_file.GetMethodName(method_id);
+  const Signature signature = dex_file.GetMethodSignature(method_id);
+  if (klass->IsInterface()) {
+    return klass->FindInterfaceMethod(name, signature, pointer_size);
+  }
+  ArtMethod* method = klass->FindDirectMethod(name, signature, pointer_size);
+  return (method != nullptr) ? method : klass->FindVirtualMethod(name, signature, pointer_size);
+}
+
+class EntryWriter {
+ public:
+  template <typename T>
+  void WriteValue(T value) {
+    WriteBytes(&value, sizeof(value));
+  }
+
+  void WriteBytes(const void* data, size_t size) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    data_.insert(data_.end(), bytes, bytes + size);
+  }
+
+  void WriteString(const std::string& str) {
+    WriteValue<uint32_t>(str.size());
+    WriteBytes(str.data(), str.size());
+  }
+
+  void WriteArray(const SwapVector<uint8_t>* array) {
+    if (array == nullptr) {
+      WriteValue<uint32_t>(0u);
+    } else {
+      WriteValue<uint32_t>(array->size());
+      WriteBytes(array->data(), array->size());
+    }
+  }
+
+  const std::vector<uint8_t>& GetData() const {
+    return data_;
+  }
+
+ private:
+  std::vector<uint8_t> data_;
+};
+
+// Reads back the data written by the EntryWriter. Any out of bounds access marks the entry
+// as corrupt, in which case it is treated as a miss.
+class EntryReader {
+ public:
+  explicit EntryReader(const std::vector<uint8_t>& data) : data_(data), pos_(0u), ok_(true) {}
+
+  template <typename T>
+  T ReadValue() {
+    T value = T();
+    ReadBytes(&value, sizeof(value));
+    return value;
+  }
+
+  void ReadBytes(void* out, size_t size) {
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return;
+    }
+    memcpy(out, data_.data() + pos_, size);
+    pos_ += size;
+  }
+
+  std::string ReadSignature() {
+    std::string signature(DexFile::kSha1DigestSize, '\0');
+    ReadBytes(&signature[0], signature.size());
+    return signature;
+  }
+
+  std::string ReadString() {
+    uint32_t size = ReadValue<uint32_t>();
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return std::string();
+    }
+    std::string str(reinterpret_cast<const char*>(data_.data()) + pos_, size);
+    pos_ += size;
+    return str;
+  }
+
+  std::vector<uint8_t> ReadArray() {
+    uint32_t size = ReadValue<uint32_t>();
+    if (!ok_ || size > data_.size() - pos_) {
+      ok_ = false;
+      return std::vector<uint8_t>();
+    }
+    std::vector<uint8_t> array(data_.begin() + pos_, data_.begin() + pos_ + size);
+    pos_ += size;
+    return array;
+  }
+
+  bool IsOk() const {
+    return ok_;
+  }
+
+  bool IsAtEnd() const {
+    return pos_ == data_.size();
+  }
+
+ private:
+  const std::vector<uint8_t>& data_;
+  size_t pos_;
+  bool ok_;
+};
+
+CompilationCache::CompilationCache(CompilerDriver* driver, Compiler::Kind compiler_kind,
+                                   const std::string& directory, size_t max_size)
+    : driver_(driver),
+      compiler_kind_(compiler_kind),
+      directory_(directory),
+      max_size_(max_size),
+      global_fingerprint_(0u),
+      class_signatures_lock_("compilation cache class signatures lock"),
+      hits_(0u),
+      misses_(0u),
+      stores_(0u),
+      store_failures_(0u),
+      evictions_(0u),
+      compile_time_saved_ns_(0u),
+      overhead_ns_(0u) {
+}
+
+CompilationCache::DexFileSignature CompilationCache::GetSignature(const DexFile& dex_file) {
+  const uint8_t* signature = dex_file.GetHeader().signature_;
+  return DexFileSignature(reinterpret_cast<const char*>(signature), DexFile::kSha1DigestSize);
+}
+
+void CompilationCache::Init(const std::vector<const DexFile*>& dex_files) {
+  ScopedObjectAccess soa(Thread::Current());
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  global_fingerprint_ = ComputeGlobalFingerprint();
+  for (const DexFile* dex_file : class_linker->GetBootClassPath()) {
+    known_dex_files_.Overwrite(GetSignature(*dex_file), dex_file);
+  }
+  for (const DexFile* dex_file : dex_files) {
+    known_dex_files_.Overwrite(GetSignature(*dex_file), dex_file);
+    compiled_dex_files_.insert(dex_file);
+  }
+}
+
+uint64_t CompilationCache::ComputeGlobalFingerprint() const {
+  KeyHasher hasher;
+  hasher.UpdateValue(kCompilationCacheVersion);
+  hasher.UpdateBytes(OatHeader::kOatVersion, sizeof(OatHeader::kOatVersion));
+  hasher.UpdateValue(kIsDebugBuild);
+  hasher.UpdateValue(kUseReadBarrier);
+  hasher.UpdateValue(kPoisonHeapReferences);
+  hasher.UpdateValue(compiler_kind_);
+  hasher.UpdateValue(driver_->GetInstructionSet());
+  hasher.UpdateString(driver_->GetInstructionSetFeatures()->GetFeatureString());
+  hasher.UpdateValue(driver_->GetSupportBootImageFixup());
+
+  const CompilerOptions& options = driver_->GetCompilerOptions();
+  hasher.UpdateValue(options.GetCompilerFilter());
+  hasher.UpdateValue<uint64_t>(options.GetHugeMethodThreshold());
+  hasher.UpdateValue<uint64_t>(options.GetLargeMethodThreshold());
+  hasher.UpdateValue<uint64_t>(options.GetSmallMethodThreshold());
+  hasher.UpdateValue<uint64_t>(options.GetTinyMethodThreshold());
+  hasher.UpdateValue<uint64_t>(options.GetNumDexMethodsThreshold());
+  hasher.UpdateValue<uint64_t>(options.GetInlineDepthLimit());
+  hasher.UpdateValue<uint64_t>(options.GetInlineMaxCodeUnits());
+  hasher.UpdateValue(options.GetIncludePatchInformation());
+  hasher.UpdateValue(options.GetDebuggable());
+  hasher.UpdateValue(options.GetGenerateDebugInfo());
+  hasher.UpdateValue(options.GetImplicitNullChecks());
+  hasher.UpdateValue(options.GetImplicitStackOverflowChecks());
+  hasher.UpdateValue(options.GetImplicitSuspendChecks());
+  hasher.UpdateValue(options.GetCompilePic());
+  hasher.UpdateValue(options.GetInlineAllocation());
+  hasher.UpdateValue(options.IsJitBaseline());
+  const PassManagerOptions* pass_manager_options = options.GetPassManagerOptions();
+  if (pass_manager_options != nullptr) {
+    hasher.UpdateString(pass_manager_options->GetDisablePassList());
+    hasher.UpdateString(pass_manager_options->GetOverriddenPassOptions());
+  }
+
+  // Non-PIC code may embed pointers into the boot image, so tie the entries to the image
+  // the code was compiled against. A system update also replaces the boot image, which
+  // retires entries created by an older compiler.
+  gc::space::ImageSpace* image_space = Runtime::Current()->GetHeap()->GetImageSpace();
+  if (image_space != nullptr) {
+    const ImageHeader& image_header = image_space->GetImageHeader();
+    hasher.UpdateValue(image_header.GetOatChecksum());
+    hasher.UpdateValue(reinterpret_cast<uintptr_t>(image_header.GetOatDataBegin()));
+    hasher.UpdateValue(image_header.GetPatchDelta());
+  }
+  return hasher.Get();
+}
+
+uint64_t CompilationCache::GetTypeSignature(mirror::DexCache* dex_cache, uint32_t type_idx) {
+  // All types that can be resolved have been resolved before the compilation started, so an
+  // unresolved type stays unresolved while the method is compiled.
+  mirror::Class* klass = dex_cache->GetResolvedType(type_idx);
+  return (klass != nullptr) ? GetClassSignature(klass) : kUnresolvedType;
+}
+
+uint64_t CompilationCache::GetClassSignature(mirror::Class* klass) {
+  while (klass->IsArrayClass()) {
+    klass = klass->GetComponentType();
+  }
+  if (klass->IsPrimitive()) {
+    return kPrimitiveType;
+  }
+  const DexFile& dex_file = klass->GetDexFile();
+  std::pair<const DexFile*, uint16_t> signature_key(&dex_file, klass->GetDexClassDefIndex());
+  Thread* self = Thread::Current();
+  {
+    MutexLock mu(self, class_signatures_lock_);
+    auto it = class_signatures_.find(signature_key);
+    if (it != class_signatures_.end()) {
+      return it->second;
+    }
+  }
+
+  KeyHasher hasher;
+  std::string temp;
+  hasher.UpdateString(klass->GetDescriptor(&temp));
+  if (klass->GetClassLoader() == nullptr) {
+    // Boot classes only change together with the boot image, which the global fingerprint
+    // covers.
+    hasher.UpdateSignature(dex_file);
+  } else {
+    hasher.UpdateValue(klass->GetStatus());
+    hasher.UpdateValue(klass->GetAccessFlags());
+    // The class layout and the verifier's view of the type depend on the whole hierarchy.
+    mirror::Class* super_class = klass->GetSuperClass();
+    hasher.UpdateValue((super_class != nullptr) ? GetClassSignature(super_class) : 0u);
+    for (int32_t i = 0, count = klass->GetIfTableCount(); i != count; ++i) {
+      mirror::Class* interface = klass->GetIfTable()->GetInterface(i);
+      if (interface != klass) {
+        hasher.UpdateValue(GetClassSignature(interface));
+      }
+    }
+    // Field offsets, vtable indices and inlined callees depend on the declared members.
+    const uint8_t* class_data = dex_file.GetClassData(*klass->GetClassDef());
+    if (class_data != nullptr) {
+      std::vector<DexIndex> indices;
+      ClassDataItemIterator it(dex_file, class_data);
+      for (; it.HasNextStaticField() || it.HasNextInstanceField(); it.Next()) {
+        hasher.UpdateValue(it.GetFieldAccessFlags());
+        HashIndex(&hasher, dex_file, DexIndex(DexIndex::kField, it.GetMemberIndex()));
+      }
+      for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+        hasher.UpdateValue(it.GetMethodAccessFlags());
+        HashIndex(&hasher, dex_file, DexIndex(DexIndex::kMethod, it.GetMemberIndex()));
+        const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+        if (code_item != nullptr) {
+          HashCodeItem(&hasher, dex_file, code_item, &indices);
+        }
+      }
+    }
+  }
+  uint64_t signature = hasher.Get();
+  MutexLock mu(self, class_signatures_lock_);
+  class_signatures_.Overwrite(signature_key, signature);
+  return signature;
+}
+
+bool CompilationCache::ComputeKey(const DexFile& dex_file, const DexFile::CodeItem* code_item,
+                                  uint32_t method_idx, uint32_t access_flags,
+                                  InvokeType invoke_type, uint64_t* key) {
+  if (compiled_dex_files_.find(&dex_file) == compiled_dex_files_.end()) {
+    return false;
+  }
+  KeyHasher hasher;
+  hasher.UpdateValue(global_fingerprint_);
+  HashIndex(&hasher, dex_file, DexIndex(DexIndex::kMethod, method_idx));
+  hasher.UpdateValue(access_flags);
+  hasher.UpdateValue(invoke_type);
+
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::DexCache* dex_cache = Runtime::Current()->GetClassLinker()->FindDexCache(dex_file);
+  const DexFile::MethodId& method_id = dex_file.GetMethodId(method_idx);
+  hasher.UpdateValue(GetTypeSignature(dex_cache, method_id.class_idx_));
+  if (code_item != nullptr) {
+    std::vector<DexIndex> indices;
+    HashCodeItem(&hasher, dex_file, code_item, &indices);
+    HashReferencedClasses(&hasher, dex_file, dex_cache, indices);
+    std::map<ArtMethod*, size_t> visited;
+    HashInlineCandidates(&hasher, dex_file, dex_cache, indices,
+                         driver_->GetCompilerOptions().GetInlineDepthLimit(), &visited);
+  }
+  *key = hasher.Get();
+  return true;
+}
+
+void CompilationCache::HashReferencedClasses(KeyHasher* hasher, const DexFile& dex_file,
+                                             mirror::DexCache* dex_cache,
+                                             const std::vector<DexIndex>& indices) {
+  // Add the signatures of the classes the compiler may make assumptions about.
+  for (const DexIndex& index : indices) {
+    switch (index.kind) {
+      case DexIndex::kString:
+        break;
+      case DexIndex::kType:
+        hasher->UpdateValue(GetTypeSignature(dex_cache, index.index));
+        break;
+      case DexIndex::kField: {
+        const DexFile::FieldId& field_id = dex_file.GetFieldId(index.index);
+        hasher->UpdateValue(GetTypeSignature(dex_cache, field_id.class_idx_));
+        hasher->UpdateValue(GetTypeSignature(dex_cache, field_id.type_idx_));
+        break;
+      }
+      case DexIndex::kMethod: {
+        const DexFile::MethodId& callee_id = dex_file.GetMethodId(index.index);
+        hasher->UpdateValue(GetTypeSignature(dex_cache, callee_id.class_idx_));
+        const DexFile::ProtoId& proto_id = dex_file.GetProtoId(callee_id.proto_idx_);
+        hasher->UpdateValue(GetTypeSignature(dex_cache, proto_id.return_type_idx_));
+        const DexFile::TypeList* parameters = dex_file.GetProtoParameters(proto_id);
+        for (uint32_t i = 0, size = (parameters != nullptr) ? parameters->Size() : 0u;
+             i != size; ++i) {
+          hasher->UpdateValue(GetTypeSignature(dex_cache, parameters->GetTypeItem(i).type_idx_));
+        }
+        break;
+      }
+    }
+  }
+}
+
+void CompilationCache::HashInlineCandidates(KeyHasher* hasher, const DexFile& dex_file,
+                                            mirror::DexCache* dex_cache,
+                                            const std::vector<DexIndex>& indices, size_t depth,
+                                            std::map<ArtMethod*, size_t>* visited) {
+  if (depth == 0u) {
+    return;
+  }
+  for (const DexIndex& index : indices) {
+    if (index.kind != DexIndex::kMethod) {
+      continue;
+    }
+    ArtMethod* callee = FindCallee(dex_file, dex_cache, index.index);
+    // Boot methods only change together with the boot image, which the global fingerprint
+    // covers.
+    if (callee == nullptr || callee->GetDeclaringClass()->GetClassLoader() == nullptr) {
+      continue;
+    }
+    const DexFile::CodeItem* callee_code_item = callee->GetCodeItem();
+    if (callee_code_item == nullptr) {
+      continue;
+    }
+    // A method reached again with at most the depth it was hashed with is already covered.
+    auto it = visited->find(callee);
+    if (it != visited->end() && it->second >= depth) {
+      continue;
+    }
+    (*visited)[callee] = depth;
+    const DexFile& callee_dex_file = *callee->GetDexFile();
+    mirror::DexCache* callee_dex_cache = callee->GetDexCache();
+    HashIndex(hasher, callee_dex_file,
+              DexIndex(DexIndex::kMethod, callee->GetDexMethodIndex()));
+    std::vector<DexIndex> callee_indices;
+    HashCodeItem(hasher, callee_dex_file, callee_code_item, &callee_indices);
+    HashReferencedClasses(hasher, callee_dex_file, callee_dex_cache, callee_indices);
+    HashInlineCandidates(hasher, callee_dex_file, callee_dex_cache, callee_indices, depth - 1u,
+                         visited);
+  }
+}
+
+std::string CompilationCache::GetEntryPath(uint64_t key) const {
+  static_assert(kEntryNameLength == 16u, "Entry name length does not match the format");
+  return StringPrintf("%s/%016" PRIx64, directory_.c_str(), key);
+}
+
+CompiledMethod* CompilationCache::Lookup(uint64_t key, const DexFile& dex_file,
+                                         uint32_t method_idx) {
+  uint64_t start_ns = NanoTime();
+  CompiledMethod* compiled_method = nullptr;
+  uint64_t compile_time_ns = 0u;
+  std::string path = GetEntryPath(key);
+  std::unique_ptr<File> file(OS::OpenFileForReading(path.c_str()));
+  if (file.get() != nullptr) {
+    int64_t length = file->GetLength();
+    if (length > 0) {
+      std::vector<uint8_t> data(static_cast<size_t>(length));
+      if (file->ReadFully(data.data(), data.size())) {
+        compiled_method = ReadEntry(data, dex_file, method_idx, &compile_time_ns);
+      }
+    }
+  }
+  if (compiled_method != nullptr) {
+    // Mark the entry as recently used for Trim(). The entry may have been evicted in the
+    // meantime by a concurrent dex2oat, in which case there is nothing to mark.
+    utimes(path.c_str(), nullptr);
+  }
+  uint64_t lookup_time_ns = NanoTime() - start_ns;
+  overhead_ns_.FetchAndAddSequentiallyConsistent(lookup_time_ns);
+  if (compiled_method == nullptr) {
+    misses_.FetchAndAddSequentiallyConsistent(1u);
+    return nullptr;
+  }
+  hits_.FetchAndAddSequentiallyConsistent(1u);
+  compile_time_saved_ns_.FetchAndAddSequentiallyConsistent(compile_time_ns);
+  return compiled_method;
+}
+
+CompiledMethod* CompilationCache::ReadEntry(const std::vector<uint8_t>& data,
+                                            const DexFile& dex_file,
+                                            uint32_t method_idx,
+                                            uint64_t* compile_time_ns) const {
+  EntryReader reader(data);
+  uint8_t magic[sizeof(kEntryMagic)];
+  reader.ReadBytes(magic, sizeof(magic));
+  if (!reader.IsOk() || memcmp(magic, kEntryMagic, sizeof(kEntryMagic)) != 0 ||
+      reader.ReadValue<uint32_t>() != kCompilationCacheVersion) {
+    return nullptr;
+  }
+  // Guard against key collisions with a different method. The dex file itself may have
+  // changed since the entry was written.
+  if (reader.ReadString() != PrettyMethod(method_idx, dex_file) ||
+      reader.ReadValue<uint32_t>() != method_idx) {
+    return nullptr;
+  }
+  *compile_time_ns = reader.ReadValue<uint64_t>();
+  InstructionSet instruction_set = static_cast<InstructionSet>(reader.ReadValue<uint32_t>());
+  uint32_t frame_size_in_bytes = reader.ReadValue<uint32_t>();
+  uint32_t core_spill_mask = reader.ReadValue<uint32_t>();
+  uint32_t fp_spill_mask = reader.ReadValue<uint32_t>();
+  std::vector<uint8_t> quick_code = reader.ReadArray();
+  DefaultSrcMap src_mapping_table;
+  for (uint32_t i = 0, size = reader.ReadValue<uint32_t>(); reader.IsOk() && i != size; ++i) {
+    uint32_t from = reader.ReadValue<uint32_t>();
+    int32_t to = reader.ReadValue<int32_t>();
+    src_mapping_table.push_back(SrcMapElem {from, to});  // NOLINT
+  }
+  std::vector<uint8_t> mapping_table = reader.ReadArray();
+  std::vector<uint8_t> vmap_table = reader.ReadArray();
+  std::vector<uint8_t> gc_map = reader.ReadArray();
+  std::vector<uint8_t> cfi_info = reader.ReadArray();
+  std::vector<LinkerPatch> patches;
+  for (uint32_t i = 0, size = reader.ReadValue<uint32_t>(); reader.IsOk() && i != size; ++i) {
+    uint32_t literal_offset = reader.ReadValue<uint32_t>();
+    uint32_t type = reader.ReadValue<uint32_t>();
+    const DexFile* target_dex_file = &dex_file;
+    if (reader.ReadValue<uint8_t>() == 0u) {
+      auto it = known_dex_files_.find(reader.ReadSignature());
+      if (!reader.IsOk() || it == known_dex_files_.end()) {
+        // The patch refers to a dex file that is not part of this compilation.
+        return nullptr;
+      }
+      target_dex_file = it->second;
+    }
+    uint32_t target = reader.ReadValue<uint32_t>();
+    uint32_t pc_insn_offset = reader.ReadValue<uint32_t>();
+    if (!reader.IsOk()) {
+      return nullptr;
+    }
+    switch (static_cast<LinkerPatchType>(type)) {
+      case kLinkerPatchMethod:
+        patches.push_back(LinkerPatch::MethodPatch(literal_offset, target_dex_file, target));
+        break;
+      case kLinkerPatchCall:
+        patches.push_back(LinkerPatch::CodePatch(literal_offset, target_dex_file, target));
+        break;
+      case kLinkerPatchCallRelative:
+        patches.push_back(
+            LinkerPatch::RelativeCodePatch(literal_offset, target_dex_file, target));
+        break;
+      case kLinkerPatchType:
+        patches.push_back(LinkerPatch::TypePatch(literal_offset, target_dex_file, target));
+        break;
+      case kLinkerPatchDexCacheArray:
+        // The element offset depends on the layout of the target's dex cache arrays.
+        if (reader.ReadValue<uint32_t>() != target_dex_file->NumTypeIds() ||
+            reader.ReadValue<uint32_t>() != target_dex_file->NumMethodIds() ||
+            reader.ReadValue<uint32_t>() != target_dex_file->NumStringIds() ||
+            reader.ReadValue<uint32_t>() != target_dex_file->NumFieldIds()) {
+          return nullptr;
+        }
+        patches.push_back(LinkerPatch::DexCacheArrayPatch(literal_offset, target_dex_file,
+                                                          pc_insn_offset, target));
+        break;
+      default:
+        return nullptr;
+    }
+  }
+  if (!reader.IsOk() || !reader.IsAtEnd() || instruction_set != driver_->GetInstructionSet() ||
+      quick_code.empty()) {
+    return nullptr;
+  }
+  return CompiledMethod::SwapAllocCompiledMethod(driver_,
+                                                 instruction_set,
+                                                 ArrayRef<const uint8_t>(quick_code),
+                                                 frame_size_in_bytes,
+                                                 core_spill_mask,
+                                                 fp_spill_mask,
+                                                 &src_mapping_table,
+                                                 ArrayRef<const uint8_t>(mapping_table),
+                                                 ArrayRef<const uint8_t>(vmap_table),
+                                                 ArrayRef<const uint8_t>(gc_map),
+                                                 ArrayRef<const uint8_t>(cfi_info),
+                                                 ArrayRef<const LinkerPatch>(patches));
+}
+
+void CompilationCache::Store(uint64_t key, const DexFile& dex_file, uint32_t method_idx,
+                             const CompiledMethod& compiled_method, uint64_t compile_time_ns) {
+  uint64_t start_ns = NanoTime();
+  EntryWriter writer;
+  writer.WriteBytes(kEntryMagic, sizeof(kEntryMagic));
+  writer.WriteValue(kCompilationCacheVersion);
+  writer.WriteString(PrettyMethod(method_idx, dex_file));
+  writer.WriteValue(method_idx);
+  writer.WriteValue(compile_time_ns);
+  writer.WriteValue<uint32_t>(compiled_method.GetInstructionSet());
+  writer.WriteValue<uint32_t>(compiled_method.GetFrameSizeInBytes());
+  writer.WriteValue(compiled_method.GetCoreSpillMask());
+  writer.WriteValue(compiled_method.GetFpSpillMask());
+  writer.WriteArray(compiled_method.GetQuickCode());
+  const SwapSrcMap& src_mapping_table = compiled_method.GetSrcMappingTable();
+  writer.WriteValue<uint32_t>(src_mapping_table.size());
+  for (const SrcMapElem& elem : src_mapping_table) {
+    writer.WriteValue(elem.from_);
+    writer.WriteValue(elem.to_);
+  }
+  writer.WriteArray(compiled_method.GetMappingTable());
+  writer.WriteArray(compiled_method.GetVmapTable());
+  writer.WriteArray(compiled_method.GetGcMap());
+  writer.WriteArray(compiled_method.GetCFIInfo());
+  ArrayRef<const LinkerPatch> patches = compiled_method.GetPatches();
+  writer.WriteValue<uint32_t>(patches.size());
+  for (const LinkerPatch& patch : patches) {
+    const DexFile* target_dex_file;
+    uint32_t target;
+    uint32_t pc_insn_offset = 0u;
+    switch (patch.Type()) {
+      case kLinkerPatchMethod:
+      case kLinkerPatchCall:
+      case kLinkerPatchCallRelative:
+        target_dex_file = patch.TargetMethod().dex_file;
+        target = patch.TargetMethod().dex_method_index;
+        break;
+      case kLinkerPatchType:
+        target_dex_file = patch.TargetTypeDexFile();
+        target = patch.TargetTypeIndex();
+        break;
+      case kLinkerPatchDexCacheArray:
+        target_dex_file = patch.TargetDexCacheDexFile();
+        target = patch.TargetDexCacheElementOffset();
+        pc_insn_offset = patch.PcInsnOffset();
+        break;
+      default:
+        LOG(FATAL) << "Unexpected linker patch type " << patch.Type();
+        UNREACHABLE();
+    }
+    writer.WriteValue<uint32_t>(patch.LiteralOffset());
+    writer.WriteValue<uint32_t>(patch.Type());
+    // Targets in the method's own dex file are only valid as long as the key matches, which
+    // pins the meaning of the indices the method uses. Other dex files are identified by
+    // their SHA-1 signature.
+    writer.WriteValue<uint8_t>(target_dex_file == &dex_file ? 1u : 0u);
+    if (target_dex_file != &dex_file) {
+      writer.WriteBytes(target_dex_file->GetHeader().signature_, DexFile::kSha1DigestSize);
+    }
+    writer.WriteValue(target);
+    writer.WriteValue(pc_insn_offset);
+    if (patch.Type() == kLinkerPatchDexCacheArray) {
+      writer.WriteValue<uint32_t>(target_dex_file->NumTypeIds());
+      writer.WriteValue<uint32_t>(target_dex_file->NumMethodIds());
+      writer.WriteValue<uint32_t>(target_dex_file->NumStringIds());
+      writer.WriteValue<uint32_t>(target_dex_file->NumFieldIds());
+    }
+  }
+
+  // Write to a private file first so that concurrent dex2oat invocations sharing the cache
+  // never observe partially written entries.
+  std::string path = GetEntryPath(key);
+  std::string temp_path = StringPrintf("%s.%d", path.c_str(), GetTid());
+  const std::vector<uint8_t>& data = writer.GetData();
+  std::unique_ptr<File> file(OS::CreateEmptyFile(temp_path.c_str()));
+  bool success = file.get() != nullptr;
+  if (success) {
+    success = file->WriteFully(data.data(), data.size());
+    if (!success) {
+      file->Erase();
+    } else {
+      success = file->FlushCloseOrErase() == 0;
+    }
+    success = success && rename(temp_path.c_str(), path.c_str()) == 0;
+    if (!success) {
+      unlink(temp_path.c_str());
+    }
+  }
+  if (success) {
+    stores_.FetchAndAddSequentiallyConsistent(1u);
+  } else if (store_failures_.FetchAndAddSequentiallyConsistent(1u) == 0u) {
+    // Only report the first failure, the others are most likely caused by the same problem.
+    PLOG(WARNING) << "Failed to write compilation cache entry " << path;
+  }
+  overhead_ns_.FetchAndAddSequentiallyConsistent(NanoTime() - start_ns);
+}
+
+void CompilationCache::Trim() {
+  uint64_t start_ns = NanoTime();
+  DIR* dir = opendir(directory_.c_str());
+  if (dir == nullptr) {
+    PLOG(WARNING) << "Failed to open compilation cache directory " << directory_;
+    return;
+  }
+  struct Entry {
+    time_t last_use;
+    off_t size;
+    std::string path;
+  };
+  std::vector<Entry> entries;
+  uint64_t total_size = 0u;
+  for (dirent* dir_entry = readdir(dir); dir_entry != nullptr; dir_entry = readdir(dir)) {
+    // Skip anything but entries, including the temporary files of stores in progress.
+    const char* name = dir_entry->d_name;
+    if (strlen(name) != kEntryNameLength || strspn(name, "0123456789abcdef") != kEntryNameLength) {
+      continue;
+    }
+    std::string path = directory_ + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+      continue;
+    }
+    entries.push_back(Entry { st.st_mtime, st.st_size, path });  // NOLINT
+    total_size += st.st_size;
+  }
+  closedir(dir);
+  if (total_size > max_size_) {
+    std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+      return lhs.last_use < rhs.last_use;
+    });
+    for (const Entry& entry : entries) {
+      if (total_size <= max_size_) {
+        break;
+      }
+      // A concurrent dex2oat may have evicted the entry already.
+      if (unlink(entry.path.c_str()) == 0 || errno == ENOENT) {
+        total_size -= entry.size;
+        evictions_.FetchAndAddSequentiallyConsistent(1u);
+      }
+    }
+  }
+  overhead_ns_.FetchAndAddSequentiallyConsistent(NanoTime() - start_ns);
+}
+
+std::string CompilationCache::DumpStats() const {
+  size_t hits = GetHits();
+  size_t lookups = hits + GetMisses();
+  double hit_rate = (lookups != 0u) ? (100.0 * hits) / lookups : 0.0;
+  return StringPrintf("%zu hits, %zu misses (%.1f%% hit rate), %zu stores, %zu failed stores, "
+                      "%zu evictions, compile time saved %s, cache overhead %s",
+                      hits, GetMisses(), hit_rate, GetStores(), store_failures_.LoadRelaxed(),
+                      GetEvictions(),
+                      PrettyDuration(compile_time_saved_ns_.LoadRelaxed()).c_str(),
+                      PrettyDuration(overhead_ns_.LoadRelaxed()).c_str());
+}
+
+}  // namespace art
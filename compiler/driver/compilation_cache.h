@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
+#define ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "globals.h"
+#include "base/mutex.h"
+#include "compiler.h"
+#include "dex_file.h"
+#include "invoke_type.h"
+#include "safe_map.h"
+
+namespace art {
+
+class ArtMethod;
+class CompiledMethod;
+class CompilerDriver;
+class KeyHasher;
+struct DexIndex;
+namespace mirror {
+class Class;
+class DexCache;
+}  // namespace mirror
+
+// A persistent, on-disk cache of compiled methods shared between dex2oat invocations.
+//
+// Each entry is keyed by a hash of everything the compiled code of a method may depend on:
+// the compiler version and options, the target instruction set, the boot image, the method's
+// own code item and the classes the method refers to. Every string, type, field and method
+// index used by the code item is hashed together with what it denotes, so the key survives
+// edits elsewhere in the dex file as long as the indices the method uses keep their meaning.
+// For each class the method resolves (referenced types, the declaring classes and types of
+// referenced fields and methods, catch types and the method's own class) the key includes a
+// class signature covering the class status, access flags, superclass and interfaces, and
+// the declared fields and methods including their code. This captures field offsets, vtable
+// layouts and verification results. The compiler may also inline callees, and their callees
+// in turn up to the inline depth limit, so the code items of the methods the method calls are
+// hashed recursively to that depth, together with the classes those code items refer to.
+//
+// The cache directory is kept below a maximum size. Entries are touched when they are hit, and
+// Trim() evicts the least recently used ones.
+class CompilationCache {
+ public:
+  static constexpr size_t kDefaultMaxSize = 256 * MB;
+
+  CompilationCache(CompilerDriver* driver, Compiler::Kind compiler_kind,
+                   const std::string& directory, size_t max_size = kDefaultMaxSize);
+
+  // Computes the global fingerprint and records the dex files covered by the cache. Must be
+  // called after the classes have been resolved and verified, and before any method is looked
+  // up or stored.
+  void Init(const std::vector<const DexFile*>& dex_files)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+
+  // Computes the cache key for a method. The code item is null for native and abstract
+  // methods. Returns false if the method's dex file is not covered by the cache.
+  bool ComputeKey(const DexFile& dex_file, const DexFile::CodeItem* code_item,
+                  uint32_t method_idx, uint32_t access_flags, InvokeType invoke_type,
+                  uint64_t* key)
+      LOCKS_EXCLUDED(Locks::mutator_lock_, class_signatures_lock_);
+
+  // Returns a swap allocated copy of the cached compiled method, or null on a miss.
+  CompiledMethod* Lookup(uint64_t key, const DexFile& dex_file, uint32_t method_idx);
+
+  // Stores a compiled method under the given key. The compile time is recorded so that hits
+  // in later runs can report the time saved.
+  void Store(uint64_t key, const DexFile& dex_file, uint32_t method_idx,
+             const CompiledMethod& compiled_method, uint64_t compile_time_ns);
+
+  // Evicts the least recently used entries until the cache directory holds no more than the
+  // maximum size.
+  void Trim();
+
+  size_t GetHits() const {
+    return hits_.LoadRelaxed();
+  }
+
+  size_t GetMisses() const {
+    return misses_.LoadRelaxed();
+  }
+
+  size_t GetStores() const {
+    return stores_.LoadRelaxed();
+  }
+
+  size_t GetEvictions() const {
+    return evictions_.LoadRelaxed();
+  }
+
+  std::string DumpStats() const;
+
+ private:
+  typedef std::string DexFileSignature;
+
+  static DexFileSignature GetSignature(const DexFile& dex_file);
+
+  uint64_t ComputeGlobalFingerprint() const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Returns the signature of a resolved class, or a marker for unresolved types.
+  uint64_t GetTypeSignature(mirror::DexCache* dex_cache, uint32_t type_idx)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(class_signatures_lock_);
+  uint64_t GetClassSignature(mirror::Class* klass)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(class_signatures_lock_);
+
+  // Hashes the signatures of the classes the indices used by a code item refer to.
+  void HashReferencedClasses(KeyHasher* hasher, const DexFile& dex_file,
+                             mirror::DexCache* dex_cache, const std::vector<DexIndex>& indices)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(class_signatures_lock_);
+
+  // Hashes the code items of the methods called through the indices, and what they refer to,
+  // recursively up to the given depth. Visited maps the methods already hashed to the depth
+  // they were hashed with.
+  void HashInlineCandidates(KeyHasher* hasher, const DexFile& dex_file,
+                            mirror::DexCache* dex_cache, const std::vector<DexIndex>& indices,
+                            size_t depth, std::map<ArtMethod*, size_t>* visited)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(class_signatures_lock_);
+
+  std::string GetEntryPath(uint64_t key) const;
+
+  CompiledMethod* ReadEntry(const std::vector<uint8_t>& data, const DexFile& dex_file,
+                            uint32_t method_idx, uint64_t* compile_time_ns) const;
+
+  CompilerDriver* const driver_;
+  const Compiler::Kind compiler_kind_;
+  const std::string directory_;
+  const size_t max_size_;
+
+  // Folded compiler version, options and boot image state. Set by Init().
+  uint64_t global_fingerprint_;
+
+  // Dex files being compiled. Set by Init().
+  std::set<const DexFile*> compiled_dex_files_;
+
+  // Class signatures computed so far, by defining dex file and class def index.
+  Mutex class_signatures_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  SafeMap<std::pair<const DexFile*, uint16_t>, uint64_t> class_signatures_
+      GUARDED_BY(class_signatures_lock_);
+
+  // Dex files that linker patches of a cached method may refer to, by SHA-1 signature.
+  SafeMap<DexFileSignature, const DexFile*> known_dex_files_;
+
+  Atomic<size_t> hits_;
+  Atomic<size_t> misses_;
+  Atomic<size_t> stores_;
+  Atomic<size_t> store_failures_;
+  Atomic<size_t> evictions_;
+  // Compile time recorded in the entries that were hit.
+  Atomic<uint64_t> compile_time_saved_ns_;
+  // Time spent reading and writing entries.
+  Atomic<uint64_t> overhead_ns_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompilationCache);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
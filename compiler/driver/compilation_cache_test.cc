@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "driver/compilation_cache.h"
+
+#include <inttypes.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+#include "base/stringprintf.h"
+#include "common_compiler_test.h"
+#include "compiled_method.h"
+#include "driver/compiler_driver.h"
+#include "modifiers.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+
+class CompilationCacheTest : public CommonCompilerTest {
+ protected:
+  void SetUp() OVERRIDE {
+    CommonCompilerTest::SetUp();
+    // Keep the cache in the dalvik-cache so that it is cleaned up with it.
+    cache_dir_ = dalvik_cache_ + "/compilation-cache";
+    ASSERT_EQ(0, mkdir(cache_dir_.c_str(), 0700));
+  }
+
+  static const DexFile::CodeItem* FindCodeItem(const DexFile& dex_file, uint32_t method_idx) {
+    for (size_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+      const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(i));
+      if (class_data == nullptr) {
+        continue;
+      }
+      ClassDataItemIterator it(dex_file, class_data);
+      while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+        it.Next();
+      }
+      for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+        if (it.GetMemberIndex() == method_idx) {
+          return it.GetMethodCodeItem();
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  std::string GetEntryPath(uint64_t key) const {
+    return StringPrintf("%s/%016" PRIx64, cache_dir_.c_str(), key);
+  }
+
+  void SetLastUse(uint64_t key, time_t seconds) const {
+    struct timeval times[2] = { { seconds, 0 }, { seconds, 0 } };  // NOLINT
+    ASSERT_EQ(0, utimes(GetEntryPath(key).c_str(), times));
+  }
+
+  std::string cache_dir_;
+};
+
+TEST_F(CompilationCacheTest, StoreAndLookup) {
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("StaticLeafMethods");
+  }
+  ASSERT_NE(class_loader, nullptr);
+  std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+  ASSERT_EQ(1u, dex_files.size());
+  const DexFile& dex_file = *dex_files[0];
+
+  CompilationCache cache(compiler_driver_.get(), Compiler::kQuick, cache_dir_);
+  cache.Init(dex_files);
+  const DexFile::CodeItem* code_item = FindCodeItem(dex_file, 1u);
+  const DexFile::CodeItem* other_code_item = FindCodeItem(dex_file, 2u);
+  ASSERT_NE(nullptr, code_item);
+  ASSERT_NE(nullptr, other_code_item);
+  uint64_t key;
+  ASSERT_TRUE(cache.ComputeKey(dex_file, code_item, 1u, kAccStatic, kStatic, &key));
+  uint64_t other_key;
+  ASSERT_TRUE(cache.ComputeKey(dex_file, other_code_item, 2u, kAccStatic, kStatic, &other_key));
+  EXPECT_NE(key, other_key);
+  // The key follows the method's code rather than the dex file it is in.
+  uint64_t changed_code_key;
+  ASSERT_TRUE(cache.ComputeKey(dex_file, other_code_item, 1u, kAccStatic, kStatic,
+                               &changed_code_key));
+  EXPECT_NE(key, changed_code_key);
+  // Only the dex files passed to Init() are covered.
+  uint64_t boot_key;
+  EXPECT_FALSE(cache.ComputeKey(*java_lang_dex_file_, code_item, 1u, kAccStatic, kStatic,
+                                &boot_key));
+
+  EXPECT_EQ(nullptr, cache.Lookup(key, dex_file, 1u));
+  EXPECT_EQ(1u, cache.GetMisses());
+
+  const uint8_t raw_code[] = { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u, 9u, 10u, 11u, 12u };
+  const uint8_t raw_vmap_table[] = { 2u, 0u, 1u };
+  DefaultSrcMap src_mapping_table;
+  src_mapping_table.push_back(SrcMapElem {0u, 1});  // NOLINT
+  src_mapping_table.push_back(SrcMapElem {4u, 3});  // NOLINT
+  const LinkerPatch raw_patches[] = {
+      LinkerPatch::RelativeCodePatch(0u, &dex_file, 2u),
+      LinkerPatch::DexCacheArrayPatch(4u, &dex_file, 0u, 16u),
+      LinkerPatch::TypePatch(8u, java_lang_dex_file_, 3u),
+  };
+  ArrayRef<const LinkerPatch> patches(raw_patches);
+  CompiledMethod* compiled_method = CompiledMethod::SwapAllocCompiledMethod(
+      compiler_driver_.get(),
+      kRuntimeISA,
+      ArrayRef<const uint8_t>(raw_code),
+      64u,
+      0x1u,
+      0x2u,
+      &src_mapping_table,
+      ArrayRef<const uint8_t>(),
+      ArrayRef<const uint8_t>(raw_vmap_table),
+      ArrayRef<const uint8_t>(),
+      ArrayRef<const uint8_t>(),
+      patches);
+  cache.Store(key, dex_file, 1u, *compiled_method, 1000u);
+  EXPECT_EQ(1u, cache.GetStores());
+
+  // A later run computes the same key and gets the method back.
+  CompilationCache later_cache(compiler_driver_.get(), Compiler::kQuick, cache_dir_);
+  later_cache.Init(dex_files);
+  uint64_t later_key;
+  ASSERT_TRUE(later_cache.ComputeKey(dex_file, code_item, 1u, kAccStatic, kStatic,
+                                     &later_key));
+  EXPECT_EQ(key, later_key);
+  CompiledMethod* cached_method = later_cache.Lookup(later_key, dex_file, 1u);
+  ASSERT_NE(nullptr, cached_method);
+  EXPECT_EQ(1u, later_cache.GetHits());
+  EXPECT_EQ(kRuntimeISA, cached_method->GetInstructionSet());
+  EXPECT_TRUE(*compiled_method->GetQuickCode() == *cached_method->GetQuickCode());
+  EXPECT_EQ(64u, cached_method->GetFrameSizeInBytes());
+  EXPECT_EQ(0x1u, cached_method->GetCoreSpillMask());
+  EXPECT_EQ(0x2u, cached_method->GetFpSpillMask());
+  ASSERT_EQ(src_mapping_table.size(), cached_method->GetSrcMappingTable().size());
+  for (size_t i = 0; i != src_mapping_table.size(); ++i) {
+    EXPECT_EQ(src_mapping_table[i].from_, cached_method->GetSrcMappingTable()[i].from_);
+    EXPECT_EQ(src_mapping_table[i].to_, cached_method->GetSrcMappingTable()[i].to_);
+  }
+  EXPECT_EQ(nullptr, cached_method->GetMappingTable());
+  EXPECT_TRUE(*compiled_method->GetVmapTable() == *cached_method->GetVmapTable());
+  EXPECT_EQ(nullptr, cached_method->GetGcMap());
+  ASSERT_EQ(patches.size(), cached_method->GetPatches().size());
+  for (size_t i = 0; i != patches.size(); ++i) {
+    EXPECT_TRUE(patches[i] == cached_method->GetPatches()[i]);
+  }
+
+  // An entry is never handed out for a different method.
+  EXPECT_EQ(nullptr, later_cache.Lookup(later_key, dex_file, 2u));
+  EXPECT_EQ(1u, later_cache.GetMisses());
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), cached_method);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), compiled_method);
+}
+
+TEST_F(CompilationCacheTest, TrimEvictsLeastRecentlyUsed) {
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("StaticLeafMethods");
+  }
+  ASSERT_NE(class_loader, nullptr);
+  std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+  ASSERT_EQ(1u, dex_files.size());
+  const DexFile& dex_file = *dex_files[0];
+
+  CompilationCache cache(compiler_driver_.get(), Compiler::kQuick, cache_dir_);
+  cache.Init(dex_files);
+  const DexFile::CodeItem* code_item = FindCodeItem(dex_file, 1u);
+  const DexFile::CodeItem* other_code_item = FindCodeItem(dex_file, 2u);
+  ASSERT_NE(nullptr, code_item);
+  ASSERT_NE(nullptr, other_code_item);
+  uint64_t key;
+  ASSERT_TRUE(cache.ComputeKey(dex_file, code_item, 1u, kAccStatic, kStatic, &key));
+  uint64_t other_key;
+  ASSERT_TRUE(cache.ComputeKey(dex_file, other_code_item, 2u, kAccStatic, kStatic, &other_key));
+
+  const uint8_t raw_code[] = { 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u };
+  CompiledMethod* compiled_method = CompiledMethod::SwapAllocCompiledMethod(
+      compiler_driver_.get(),
+      kRuntimeISA,
+      ArrayRef<const uint8_t>(raw_code),
+      32u,
+      0x1u,
+      0x0u,
+      nullptr,
+      ArrayRef<const uint8_t>(),
+      ArrayRef<const uint8_t>(),
+      ArrayRef<const uint8_t>(),
+      ArrayRef<const uint8_t>(),
+      ArrayRef<const LinkerPatch>());
+  cache.Store(key, dex_file, 1u, *compiled_method, 1000u);
+  cache.Store(other_key, dex_file, 2u, *compiled_method, 1000u);
+  ASSERT_EQ(2u, cache.GetStores());
+  struct stat st;
+  ASSERT_EQ(0, stat(GetEntryPath(key).c_str(), &st));
+  size_t entry_size = st.st_size;
+
+  // Make the first entry the older one, then use it so that the other one is evicted.
+  SetLastUse(key, 1000);
+  SetLastUse(other_key, 2000);
+  CompilationCache trimming_cache(compiler_driver_.get(), Compiler::kQuick, cache_dir_,
+                                  entry_size);
+  trimming_cache.Init(dex_files);
+  CompiledMethod* cached_method = trimming_cache.Lookup(key, dex_file, 1u);
+  ASSERT_NE(nullptr, cached_method);
+  trimming_cache.Trim();
+  EXPECT_EQ(1u, trimming_cache.GetEvictions());
+  EXPECT_TRUE(OS::FileExists(GetEntryPath(key).c_str()));
+  EXPECT_FALSE(OS::FileExists(GetEntryPath(other_key).c_str()));
+
+  // Nothing is evicted while the cache is within its size.
+  trimming_cache.Trim();
+  EXPECT_EQ(1u, trimming_cache.GetEvictions());
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), cached_method);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), compiled_method);
+}
+
+}  // namespace art
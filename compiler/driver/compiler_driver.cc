@@ -22,6 +22,7 @@
 #include <unordered_set>
 #include <vector>
 #include <unistd.h>
+#include <sys/stat.h>
 
 #ifndef __APPLE__
 #include <malloc.h>  // For mallinfo
@@ -43,6 +44,7 @@
 #include "dex/verified_method.h"
 #include "dex/quick/dex_file_method_inliner.h"
 #include "dex/quick/dex_file_to_method_inliner_map.h"
+#include "driver/compilation_cache.h"
 #include "driver/compiler_options.h"
 #include "elf_writer_quick.h"
 #include "jni_internal.h"
@@ -2127,12 +2129,38 @@ void CompilerDriver::InitializeClasses(jobject class_loader,
 
 void CompilerDriver::Compile(jobject class_loader, const std::vector<const DexFile*>& dex_files,
                              ThreadPool* thread_pool, TimingLogger* timings) {
+  if (compilation_cache_ != nullptr) {
+    TimingLogger::ScopedTiming t("Init compilation cache", timings);
+    compilation_cache_->Init(dex_files);
+  }
   for (size_t i = 0; i != dex_files.size(); ++i) {
     const DexFile* dex_file = dex_files[i];
     CHECK(dex_file != nullptr);
     CompileDexFile(class_loader, *dex_file, dex_files, thread_pool, timings);
   }
   VLOG(compiler) << "Compile: " << GetMemoryUsageString(false);
+  if (compilation_cache_ != nullptr) {
+    TimingLogger::ScopedTiming t("Trim compilation cache", timings);
+    compilation_cache_->Trim();
+    LOG(INFO) << "Compilation cache: " << compilation_cache_->DumpStats();
+  }
+}
+
+void CompilerDriver::EnableCompilationCache(const std::string& directory, size_t max_size) {
+  if (image_) {
+    LOG(WARNING) << "Compilation cache is not supported when compiling an image";
+    return;
+  }
+  if (profile_present_) {
+    // The profile decides which methods are compiled at all, which the cache key does not cover.
+    LOG(WARNING) << "Compilation cache is not supported with profile guided compilation";
+    return;
+  }
+  if (!OS::DirectoryExists(directory.c_str()) && mkdir(directory.c_str(), 0700) != 0) {
+    PLOG(WARNING) << "Failed to create compilation cache directory " << directory;
+    return;
+  }
+  compilation_cache_.reset(new CompilationCache(this, compiler_kind_, directory, max_size));
 }
 
 void CompilerDriver::CompileClass(const ParallelCompilationManager* manager,
@@ -2278,6 +2306,10 @@ void CompilerDriver::CompileMethod(Thread* self, const DexFile::CodeItem* code_i
         InstructionSetHasGenericJniStub(instruction_set_)) {
       // Leaving this empty will trigger the generic JNI version
     } else {
+      if (ClassLinker::IsCriticalNativeMethod(dex_file, dex_file.GetClassDef(class_def_idx),
+                                              method_idx, access_flags)) {
+        access_flags |= kAccCriticalNative;
+      }
       compiled_method = compiler_->JniCompile(access_flags, method_idx, dex_file);
       CHECK(compiled_method != nullptr);
     }
@@ -2293,10 +2325,24 @@ void CompilerDriver::CompileMethod(Thread* self, const DexFile::CodeItem* code_i
                    // Is eligable for compilation by methods-to-compile filter.
                    IsMethodToCompile(method_ref);
     if (compile) {
-      // NOTE: if compiler declines to compile this method, it will return null.
-      check_bail_out = false;
-      compiled_method = compiler_->Compile(code_item, access_flags, invoke_type, class_def_idx,
-                                           method_idx, class_loader, dex_file);
+      uint64_t cache_key = 0u;
+      bool use_cache = compilation_cache_ != nullptr &&
+          compilation_cache_->ComputeKey(dex_file, code_item, method_idx, access_flags,
+                                         invoke_type, &cache_key);
+      if (use_cache) {
+        compiled_method = compilation_cache_->Lookup(cache_key, dex_file, method_idx);
+      }
+      if (compiled_method == nullptr) {
+        uint64_t compile_start_ns = use_cache ? NanoTime() : 0u;
+        // NOTE: if compiler declines to compile this method, it will return null.
+        check_bail_out = false;
+        compiled_method = compiler_->Compile(code_item, access_flags, invoke_type, class_def_idx,
+                                             method_idx, class_loader, dex_file);
+        if (use_cache && compiled_method != nullptr) {
+          compilation_cache_->Store(cache_key, dex_file, method_idx, *compiled_method,
+                                    NanoTime() - compile_start_ns);
+        }
+      }
     }
     if (compiled_method == nullptr && dex_to_dex_compilation_level != kDontDexToDexCompile) {
       // TODO: add a command-line option to disable DEX-to-DEX compilation ?
@@ -2466,13 +2512,26 @@ bool CompilerDriver::WriteElf(const std::string& android_root,
   }
 }
 
+bool CompilerDriver::GetProfileData(const std::string& method_name,
+                                    ProfileFile::ProfileData* data) const {
+  return profile_present_ && profile_file_.GetProfileData(data, method_name);
+}
+
+bool CompilerDriver::IsProfileTopK(const ProfileFile::ProfileData& data) const {
+  // Methods that comprise top_k_threshold % of the total samples are in the top K.
+  // Compare against the start of the topK percentage bucket just in case the threshold
+  // falls inside a bucket.
+  return data.GetTopKUsedPercentage() - data.GetUsedPercent()
+         <= compiler_options_->GetTopKProfileThreshold();
+}
+
 bool CompilerDriver::SkipCompilation(const std::string& method_name) {
   if (!profile_present_) {
     return false;
   }
   // First find the method in the profile file.
   ProfileFile::ProfileData data;
-  if (!profile_file_.GetProfileData(&data, method_name)) {
+  if (!GetProfileData(method_name, &data)) {
     // Not in profile, no information can be determined.
     if (kIsDebugBuild) {
       VLOG(compiler) << "not compiling " << method_name << " because it's not in the profile";
@@ -2481,10 +2540,7 @@ bool CompilerDriver::SkipCompilation(const std::string& method_name) {
   }
 
   // Methods that comprise top_k_threshold % of the total samples will be compiled.
-  // Compare against the start of the topK percentage bucket just in case the threshold
-  // falls inside a bucket.
-  bool compile = data.GetTopKUsedPercentage() - data.GetUsedPercent()
-                 <= compiler_options_->GetTopKProfileThreshold();
+  bool compile = IsProfileTopK(data);
   if (kIsDebugBuild) {
     if (compile) {
       LOG(INFO) << "compiling method " << method_name << " because its usage is part of top "
@@ -59,6 +59,7 @@ namespace verifier {
 class MethodVerifier;
 }  // namespace verifier
 
+class CompilationCache;
 class CompiledClass;
 class CompiledMethod;
 class CompilerOptions;
@@ -157,6 +158,15 @@ class CompilerDriver {
     return profile_present_;
   }
 
+  // Reuse compiled methods from, and add newly compiled methods to, the persistent cache in
+  // the given directory, trimmed to `max_size` bytes after compiling. Not supported for boot
+  // images and profile guided compilation.
+  void EnableCompilationCache(const std::string& directory, size_t max_size);
+
+  const CompilationCache* GetCompilationCache() const {
+    return compilation_cache_.get();
+  }
+
   // Are we compiling and creating an image file?
   bool IsImage() const {
     return image_;
@@ -469,6 +479,13 @@ class CompilerDriver {
   // Should the compiler run on this method given profile information?
   bool SkipCompilation(const std::string& method_name);
 
+  // Look up the profile information for a method. Returns false if there is no profile or the
+  // method has not been sampled.
+  bool GetProfileData(const std::string& method_name, ProfileFile::ProfileData* data) const;
+
+  // Do the samples of the method fall within the top K% of the profile?
+  bool IsProfileTopK(const ProfileFile::ProfileData& data) const;
+
   // Get memory usage during compilation.
   std::string GetMemoryUsageString(bool extended) const;
 
@@ -623,6 +640,9 @@ class CompilerDriver {
   ProfileFile profile_file_;
   bool profile_present_;
 
+  // Optional persistent cache of compiled methods, see EnableCompilationCache().
+  std::unique_ptr<CompilationCache> compilation_cache_;
+
   const CompilerOptions* const compiler_options_;
   VerificationResults* const verification_results_;
   DexFileToMethodInlinerMap* const method_inliner_map_;
@@ -773,17 +793,17 @@ class CompilerDriver {
   };
 
   DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_code_;
+            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 16> dedupe_code_;
   DedupeSet<ArrayRef<SrcMapElem>,
-            SwapSrcMap, size_t, DedupeHashFunc<SrcMapElem>, 4> dedupe_src_mapping_table_;
+            SwapSrcMap, size_t, DedupeHashFunc<SrcMapElem>, 16> dedupe_src_mapping_table_;
   DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_mapping_table_;
+            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 16> dedupe_mapping_table_;
   DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_vmap_table_;
+            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 16> dedupe_vmap_table_;
   DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_gc_map_;
+            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 16> dedupe_gc_map_;
   DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_cfi_info_;
+            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 16> dedupe_cfi_info_;
 
   DISALLOW_COPY_AND_ASSIGN(CompilerDriver);
 };
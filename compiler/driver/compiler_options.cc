@@ -40,7 +40,9 @@ CompilerOptions::CompilerOptions()
       verbose_methods_(nullptr),
       pass_manager_options_(new PassManagerOptions),
       abort_on_hard_verifier_failure_(false),
-      init_failure_output_(nullptr) {
+      init_failure_output_(nullptr),
+      inline_allocation_(false),
+      jit_baseline_(false) {
 }
 
 CompilerOptions::~CompilerOptions() {
@@ -88,7 +90,9 @@ CompilerOptions::CompilerOptions(CompilerFilter compiler_filter,
     verbose_methods_(verbose_methods),
     pass_manager_options_(pass_manager_options),
     abort_on_hard_verifier_failure_(abort_on_hard_verifier_failure),
-    init_failure_output_(init_failure_output) {
+    init_failure_output_(init_failure_output),
+    inline_allocation_(false),
+    jit_baseline_(false) {
 }
 
 }  // namespace art
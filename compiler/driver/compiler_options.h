@@ -211,6 +211,28 @@ class CompilerOptions FINAL {
     return abort_on_hard_verifier_failure_;
   }
 
+  // Should object and array allocations be inlined as TLAB bump pointer allocations? This only
+  // pays off when the runtime allocates with a TLAB or region TLAB allocator. With any other
+  // allocator, the inlined code always falls back to calling the allocation entrypoint.
+  bool GetInlineAllocation() const {
+    return inline_allocation_;
+  }
+
+  void SetInlineAllocation(bool inline_allocation) {
+    inline_allocation_ = inline_allocation;
+  }
+
+  // Is the code compiled for the baseline tier of the JIT? The optimizing compiler then skips
+  // the inliner and the more expensive optimizations, and the code counts down the hotness
+  // counter of the method, with which the JIT finds the methods to recompile optimized.
+  bool IsJitBaseline() const {
+    return jit_baseline_;
+  }
+
+  void SetJitBaseline(bool jit_baseline) {
+    jit_baseline_ = jit_baseline;
+  }
+
  private:
   CompilerFilter compiler_filter_;
   const size_t huge_method_threshold_;
@@ -242,6 +264,9 @@ class CompilerOptions FINAL {
   // Log initialization of initialization failures to this stream if not null.
   std::ostream* const init_failure_output_;
 
+  bool inline_allocation_;
+  bool jit_baseline_;
+
   DISALLOW_COPY_AND_ASSIGN(CompilerOptions);
 };
 std::ostream& operator<<(std::ostream& os, const CompilerOptions::CompilerFilter& rhs);
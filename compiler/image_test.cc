@@ -95,6 +95,9 @@ TEST_F(ImageTest, WriteRead) {
   ASSERT_TRUE(dup_oat.get() != nullptr);
 
   {
+    // The compiler driver uses two threads, check that copying in parallel is deterministic.
+    ASSERT_GT(compiler_driver_->GetThreadCount(), 1u);
+    writer->SetVerifyParallelCopy(true);
     bool success_image =
         writer->Write(image_file.GetFilename(), dup_oat->GetPath(), dup_oat->GetPath());
     ASSERT_TRUE(success_image);
@@ -18,6 +18,7 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <vector>
@@ -58,6 +59,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change.h"
 #include "handle_scope-inl.h"
+#include "thread_pool.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 
 using ::art::mirror::Class;
@@ -71,6 +73,8 @@ namespace art {
 // Separate objects into multiple bins to optimize dirty memory use.
 static constexpr bool kBinObjects = true;
 static constexpr bool kComputeEagerResolvedStrings = false;
+// Number of objects handed to a thread pool worker at a time by the parallel passes.
+static constexpr size_t kParallelChunkSize = 1024;
 
 static void CheckNoDexObjectsCallback(Object* obj, void* arg ATTRIBUTE_UNUSED)
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
@@ -173,11 +177,21 @@ bool ImageWriter::Write(const std::string& image_filename,
   Thread::Current()->TransitionFromSuspendedToRunnable();
 
   CreateHeader(oat_loaded_size, oat_data_offset);
-  CopyAndFixupNativeData();
   // TODO: heap validation can't handle these fix up passes.
   Runtime::Current()->GetHeap()->DisableObjectValidation();
-  CopyAndFixupObjects();
   Thread::Current()->TransitionFromRunnableToSuspended(kNative);
+  {
+    ThreadPool thread_pool("Image writer thread pool", compiler_driver_.GetThreadCount() - 1);
+    CopyAndFixupNativeData(&thread_pool);
+    CopyAndFixupObjects(&thread_pool);
+  }
+  if (verify_parallel_copy_) {
+    VerifyParallelCopy();
+  }
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    RestoreHashCodes();
+  }
 
   SetOatChecksumFromElfFile(oat_file.get());
 
@@ -881,10 +895,11 @@ void ImageWriter::WalkFieldsCallback(mirror::Object* obj, void* arg) {
   writer->WalkFieldsInOrder(obj);
 }
 
-void ImageWriter::UnbinObjectsIntoOffsetCallback(mirror::Object* obj, void* arg) {
-  ImageWriter* writer = reinterpret_cast<ImageWriter*>(arg);
+void ImageWriter::UnbinObjectsIntoOffsetChunk(ImageWriter* writer, size_t begin, size_t end) {
   DCHECK(writer != nullptr);
-  writer->UnbinObjectsIntoOffset(obj);
+  for (size_t i = begin; i != end; ++i) {
+    writer->UnbinObjectsIntoOffset(writer->image_objects_[i]);
+  }
 }
 
 void ImageWriter::UnbinObjectsIntoOffset(mirror::Object* obj) {
@@ -942,7 +957,15 @@ void ImageWriter::CalculateNewObjectOffsets() {
   DCHECK_EQ(image_end_, GetBinSizeSum(kBinMirrorCount) + image_objects_offset_begin_);
 
   // Transform each object's bin slot into an offset which will be used to do the final copy.
-  heap->VisitObjects(UnbinObjectsIntoOffsetCallback, this);
+  // The bin slots were assigned above in heap order, this only adds the bin offsets.
+  CollectImageObjects();
+  self->TransitionFromRunnableToSuspended(kNative);
+  {
+    ThreadPool thread_pool("Image writer thread pool", compiler_driver_.GetThreadCount() - 1);
+    ForAllChunks(&thread_pool, image_objects_.size(), UnbinObjectsIntoOffsetChunk);
+  }
+  self->TransitionFromSuspendedToRunnable();
+  image_objects_.clear();
 
   DCHECK_EQ(image_end_, GetBinSizeSum(kBinMirrorCount) + image_objects_offset_begin_);
 
@@ -1056,24 +1079,84 @@ class FixupRootVisitor : public RootVisitor {
   }
 };
 
-void ImageWriter::CopyAndFixupNativeData() {
-  // Copy ArtFields and methods to their locations and update the array for convenience.
-  for (auto& pair : native_object_reloc_) {
+class ImageWriter::ChunkTask FINAL : public Task {
+ public:
+  ChunkTask(ImageWriter* writer, ChunkCallback* callback, size_t begin, size_t end)
+      : writer_(writer), callback_(callback), begin_(begin), end_(end) {
+  }
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    callback_(writer_, begin_, end_);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ImageWriter* const writer_;
+  ChunkCallback* const callback_;
+  const size_t begin_;
+  const size_t end_;
+};
+
+void ImageWriter::ForAllChunks(ThreadPool* thread_pool, size_t count, ChunkCallback* callback) {
+  Thread* self = Thread::Current();
+  // Ensure we're suspended while we're blocked waiting for the other threads to finish.
+  CHECK_NE(self->GetState(), kRunnable);
+  if (thread_pool == nullptr) {
+    ScopedObjectAccess soa(self);
+    callback(this, 0u, count);
+    return;
+  }
+  for (size_t begin = 0; begin < count; begin += kParallelChunkSize) {
+    size_t end = std::min(begin + kParallelChunkSize, count);
+    thread_pool->AddTask(self, new ChunkTask(this, callback, begin, end));
+  }
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, false);
+  thread_pool->StopWorkers(self);
+}
+
+void ImageWriter::CollectImageObjectsCallback(Object* obj, void* arg) {
+  reinterpret_cast<std::vector<Object*>*>(arg)->push_back(obj);
+}
+
+void ImageWriter::CollectImageObjects() {
+  image_objects_.clear();
+  Runtime::Current()->GetHeap()->VisitObjects(CollectImageObjectsCallback, &image_objects_);
+}
+
+void ImageWriter::CopyAndFixupNativeDataChunk(ImageWriter* writer, size_t begin, size_t end) {
+  for (size_t i = begin; i != end; ++i) {
+    const auto& pair = *writer->image_native_objects_[i];
     auto& native_reloc = pair.second;
+    auto* dest = writer->image_->Begin() + native_reloc.offset;
+    DCHECK_GE(dest, writer->image_->Begin() + writer->image_end_);
     if (native_reloc.bin_type == kBinArtField) {
-      auto* dest = image_->Begin() + native_reloc.offset;
-      DCHECK_GE(dest, image_->Begin() + image_end_);
       memcpy(dest, pair.first, sizeof(ArtField));
       reinterpret_cast<ArtField*>(dest)->SetDeclaringClass(
-          GetImageAddress(reinterpret_cast<ArtField*>(pair.first)->GetDeclaringClass()));
+          writer->GetImageAddress(reinterpret_cast<ArtField*>(pair.first)->GetDeclaringClass()));
     } else {
       CHECK(IsArtMethodBin(native_reloc.bin_type)) << native_reloc.bin_type;
-      auto* dest = image_->Begin() + native_reloc.offset;
-      DCHECK_GE(dest, image_->Begin() + image_end_);
-      CopyAndFixupMethod(reinterpret_cast<ArtMethod*>(pair.first),
-                         reinterpret_cast<ArtMethod*>(dest));
+      writer->CopyAndFixupMethod(reinterpret_cast<ArtMethod*>(pair.first),
+                                 reinterpret_cast<ArtMethod*>(dest));
     }
   }
+}
+
+void ImageWriter::CopyAndFixupNativeData(ThreadPool* thread_pool) {
+  // Copy ArtFields and methods to their locations and update the array for convenience.
+  image_native_objects_.clear();
+  image_native_objects_.reserve(native_object_reloc_.size());
+  for (const auto& pair : native_object_reloc_) {
+    image_native_objects_.push_back(&pair);
+  }
+  ForAllChunks(thread_pool, image_native_objects_.size(), CopyAndFixupNativeDataChunk);
+  image_native_objects_.clear();
+
+  ScopedObjectAccess soa(Thread::Current());
   // Fixup the image method roots.
   auto* image_header = reinterpret_cast<ImageHeader*>(image_->Begin());
   const ImageSection& methods_section = image_header->GetMethodsSection();
@@ -1108,9 +1191,23 @@ void ImageWriter::CopyAndFixupNativeData() {
   CHECK_EQ(intern_table_bytes, intern_table_bytes_);
 }
 
-void ImageWriter::CopyAndFixupObjects() {
-  gc::Heap* heap = Runtime::Current()->GetHeap();
-  heap->VisitObjects(CopyAndFixupObjectsCallback, this);
+void ImageWriter::CopyAndFixupObjects(ThreadPool* thread_pool) {
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    CollectImageObjects();
+  }
+  ForAllChunks(thread_pool, image_objects_.size(), CopyAndFixupObjectsChunk);
+  image_objects_.clear();
+}
+
+void ImageWriter::CopyAndFixupObjectsChunk(ImageWriter* writer, size_t begin, size_t end) {
+  DCHECK(writer != nullptr);
+  for (size_t i = begin; i != end; ++i) {
+    writer->CopyAndFixupObject(writer->image_objects_[i]);
+  }
+}
+
+void ImageWriter::RestoreHashCodes() {
   // Fix up the object previously had hash codes.
   for (const auto& hash_pair : saved_hashcode_map_) {
     Object* const obj = hash_pair.first;
@@ -1120,10 +1217,22 @@ void ImageWriter::CopyAndFixupObjects() {
   saved_hashcode_map_.clear();
 }
 
-void ImageWriter::CopyAndFixupObjectsCallback(Object* obj, void* arg) {
-  DCHECK(obj != nullptr);
-  DCHECK(arg != nullptr);
-  reinterpret_cast<ImageWriter*>(arg)->CopyAndFixupObject(obj);
+void ImageWriter::VerifyParallelCopy() {
+  auto* image_header = reinterpret_cast<ImageHeader*>(image_->Begin());
+  const size_t image_size = image_header->GetImageSize();
+  std::vector<uint8_t> image_copy(image_->Begin(), image_->Begin() + image_size);
+  const uint8_t* bitmap_begin = reinterpret_cast<const uint8_t*>(image_bitmap_->Begin());
+  std::vector<uint8_t> bitmap_copy(bitmap_begin, bitmap_begin + image_bitmap_->Size());
+  // The header is already final, everything after it is written by the copy.
+  const size_t header_size = RoundUp(sizeof(ImageHeader), kObjectAlignment);
+  memset(image_->Begin() + header_size, 0, image_size - header_size);
+  image_bitmap_->Clear();
+  CopyAndFixupNativeData(nullptr);
+  CopyAndFixupObjects(nullptr);
+  CHECK_EQ(memcmp(image_copy.data(), image_->Begin(), image_size), 0)
+      << "Parallel image copy differs from the serial one";
+  CHECK_EQ(memcmp(bitmap_copy.data(), image_bitmap_->Begin(), image_bitmap_->Size()), 0)
+      << "Parallel image bitmap differs from the serial one";
 }
 
 void ImageWriter::FixupPointerArray(mirror::Object* dst, mirror::PointerArray* arr,
@@ -1165,7 +1274,7 @@ void ImageWriter::CopyAndFixupObject(Object* obj) {
   DCHECK_LT(offset, image_end_);
   const auto* src = reinterpret_cast<const uint8_t*>(obj);
 
-  image_bitmap_->Set(dst);  // Mark the obj as live.
+  image_bitmap_->AtomicTestAndSet(dst);  // Mark the obj as live.
 
   const size_t n = obj->SizeOf();
   DCHECK_LE(offset + n, image_->Size());
@@ -1295,9 +1404,8 @@ void ImageWriter::FixupObject(Object* orig, Object* copy) {
     // Is this a native dex cache array?
     auto it = pointer_arrays_.find(down_cast<mirror::PointerArray*>(orig));
     if (it != pointer_arrays_.end()) {
-      // Should only need to fixup every pointer array exactly once.
+      // Objects are copied concurrently, so pointer_arrays_ must not be modified here.
       FixupPointerArray(copy, down_cast<mirror::PointerArray*>(orig), klass, it->second);
-      pointer_arrays_.erase(it);
       return;
     }
     CHECK(dex_cache_array_indexes_.find(orig) == dex_cache_array_indexes_.end())
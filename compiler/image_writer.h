@@ -25,6 +25,7 @@
 #include <set>
 #include <string>
 #include <ostream>
+#include <vector>
 
 #include "base/bit_utils.h"
 #include "base/macros.h"
@@ -40,6 +41,8 @@
 
 namespace art {
 
+class ThreadPool;
+
 // Write a Space built during compilation for use during execution.
 class ImageWriter FINAL {
  public:
@@ -54,7 +57,8 @@ class ImageWriter FINAL {
         quick_to_interpreter_bridge_offset_(0), compile_pic_(compile_pic),
         target_ptr_size_(InstructionSetPointerSize(compiler_driver_.GetInstructionSet())),
         bin_slot_sizes_(), bin_slot_previous_sizes_(), bin_slot_count_(),
-        intern_table_bytes_(0u), dirty_methods_(0u), clean_methods_(0u) {
+        intern_table_bytes_(0u), verify_parallel_copy_(false), dirty_methods_(0u),
+        clean_methods_(0u) {
     CHECK_NE(image_begin, 0U);
     std::fill(image_methods_, image_methods_ + arraysize(image_methods_), nullptr);
   }
@@ -94,6 +98,12 @@ class ImageWriter FINAL {
     return reinterpret_cast<uintptr_t>(oat_data_begin_);
   }
 
+  // Makes Write() copy the image a second time on the calling thread only and check that the
+  // result is identical to the parallel copy. For testing.
+  void SetVerifyParallelCopy(bool verify_parallel_copy) {
+    verify_parallel_copy_ = verify_parallel_copy;
+  }
+
  private:
   bool AllocMemory();
 
@@ -253,15 +263,36 @@ class ImageWriter FINAL {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   static void WalkFieldsCallback(mirror::Object* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  static void UnbinObjectsIntoOffsetCallback(mirror::Object* obj, void* arg)
+  static void UnbinObjectsIntoOffsetChunk(ImageWriter* writer, size_t begin, size_t end)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Work is split into chunks of the image_objects_ or image_native_objects_ lists. Chunks
+  // never write to the same memory, so the result does not depend on the thread count.
+  typedef void ChunkCallback(ImageWriter* writer, size_t begin, size_t end);
+  class ChunkTask;
+
+  // Collects the heap objects into image_objects_, in the order Heap::VisitObjects visits them.
+  void CollectImageObjects() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static void CollectImageObjectsCallback(mirror::Object* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Runs the callback over [0, count) in chunks. Uses the thread pool if there is one, the
+  // calling thread helps out. Must be called with the calling thread suspended.
+  void ForAllChunks(ThreadPool* thread_pool, size_t count, ChunkCallback* callback)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
+
   // Creates the contiguous image in memory and adjusts pointers.
-  void CopyAndFixupNativeData() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  void CopyAndFixupObjects() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  static void CopyAndFixupObjectsCallback(mirror::Object* obj, void* arg)
+  void CopyAndFixupNativeData(ThreadPool* thread_pool) LOCKS_EXCLUDED(Locks::mutator_lock_);
+  static void CopyAndFixupNativeDataChunk(ImageWriter* writer, size_t begin, size_t end)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void CopyAndFixupObjects(ThreadPool* thread_pool) LOCKS_EXCLUDED(Locks::mutator_lock_);
+  static void CopyAndFixupObjectsChunk(ImageWriter* writer, size_t begin, size_t end)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void CopyAndFixupObject(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Puts back the hash codes that the forwarding addresses replaced in the original objects.
+  void RestoreHashCodes() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Redoes the copy without the thread pool and checks that the image is unchanged.
+  void VerifyParallelCopy() LOCKS_EXCLUDED(Locks::mutator_lock_);
   void CopyAndFixupMethod(ArtMethod* orig, ArtMethod* copy)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void FixupClass(mirror::Class* orig, mirror::Class* copy)
@@ -366,6 +397,13 @@ class ImageWriter FINAL {
   };
   std::unordered_map<void*, NativeObjectReloc> native_object_reloc_;
 
+  // Work lists for the parallel passes over the heap objects and the native objects.
+  std::vector<mirror::Object*> image_objects_;
+  std::vector<const std::pair<void* const, NativeObjectReloc>*> image_native_objects_;
+
+  // Whether Write() checks the parallel copy against a copy on a single thread.
+  bool verify_parallel_copy_;
+
   // Runtime ArtMethods which aren't reachable from any Class but need to be copied into the image.
   ArtMethod* image_methods_[ImageHeader::kImageMethodsCount];
 
@@ -27,8 +27,10 @@
 #include "dex/quick_compiler_callbacks.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
+#include "gc/heap.h"
 #include "jit/jit.h"
 #include "jit/jit_code_cache.h"
+#include "runtime.h"
 #include "oat_file-inl.h"
 #include "object_lock.h"
 #include "thread_list.h"
@@ -55,17 +57,17 @@ extern "C" void jit_unload(void* handle) {
   delete reinterpret_cast<JitCompiler*>(handle);
 }
 
-extern "C" bool jit_compile_method(void* handle, ArtMethod* method, Thread* self)
+extern "C" bool jit_compile_method(void* handle, ArtMethod* method, Thread* self, bool baseline)
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
   auto* jit_compiler = reinterpret_cast<JitCompiler*>(handle);
   DCHECK(jit_compiler != nullptr);
-  return jit_compiler->CompileMethod(self, method);
+  return jit_compiler->CompileMethod(self, method, baseline);
 }
 
-JitCompiler::JitCompiler() : total_time_(0) {
+static CompilerOptions* CreateCompilerOptions(bool baseline) {
   auto* pass_manager_options = new PassManagerOptions;
   pass_manager_options->SetDisablePassList("GVN,DCE,GVNCleanup");
-  compiler_options_.reset(new CompilerOptions(
+  auto* compiler_options = new CompilerOptions(
       CompilerOptions::kDefaultCompilerFilter,
       CompilerOptions::kDefaultHugeMethodThreshold,
       CompilerOptions::kDefaultLargeMethodThreshold,
@@ -85,7 +87,18 @@ JitCompiler::JitCompiler() : total_time_(0) {
       nullptr,
       pass_manager_options,
       nullptr,
-      false));
+      false);
+  // Inlined allocations only succeed in the thread-local allocation buffers.
+  gc::AllocatorType allocator = Runtime::Current()->GetHeap()->GetCurrentAllocator();
+  compiler_options->SetInlineAllocation(
+      allocator == gc::kAllocatorTypeTLAB || allocator == gc::kAllocatorTypeRegionTLAB);
+  compiler_options->SetJitBaseline(baseline);
+  return compiler_options;
+}
+
+JitCompiler::JitCompiler() : total_time_(0) {
+  baseline_compiler_options_.reset(CreateCompilerOptions(true));
+  compiler_options_.reset(CreateCompilerOptions(false));
   const InstructionSet instruction_set = kRuntimeISA;
   for (const StringPiece option : Runtime::Current()->GetCompilerOptions()) {
     VLOG(compiler) << "JIT compiler option " << option;
@@ -124,26 +137,42 @@ JitCompiler::JitCompiler() : total_time_(0) {
   callbacks_.reset(new QuickCompilerCallbacks(verification_results_.get(),
                                               method_inliner_map_.get(),
                                               CompilerCallbacks::CallbackMode::kCompileApp));
+  // With tiering, both tiers use the optimizing compiler and the baseline tier only runs its
+  // cheap passes. Without it, methods are compiled once with Quick as before.
+  const bool tiering = Runtime::Current()->GetJITOptions()->GetOptimizeThreshold() != 0;
+  if (tiering) {
+    baseline_compiler_driver_.reset(new CompilerDriver(
+        baseline_compiler_options_.get(), verification_results_.get(), method_inliner_map_.get(),
+        Compiler::kOptimizing, instruction_set, instruction_set_features_.get(), false,
+        nullptr, nullptr, nullptr, 1, false, true,
+        std::string(), cumulative_logger_.get(), -1, std::string()));
+  }
   compiler_driver_.reset(new CompilerDriver(
       compiler_options_.get(), verification_results_.get(), method_inliner_map_.get(),
-      Compiler::kQuick, instruction_set, instruction_set_features_.get(), false,
+      tiering ? Compiler::kOptimizing : Compiler::kQuick, instruction_set,
+      instruction_set_features_.get(), false,
       nullptr, nullptr, nullptr, 1, false, true,
       std::string(), cumulative_logger_.get(), -1, std::string()));
-  // Disable dedupe so we can remove compiled methods.
-  compiler_driver_->SetDedupeEnabled(false);
-  compiler_driver_->SetSupportBootImageFixup(false);
+  for (CompilerDriver* driver : { baseline_compiler_driver_.get(), compiler_driver_.get() }) {
+    if (driver != nullptr) {
+      // Disable dedupe so we can remove compiled methods.
+      driver->SetDedupeEnabled(false);
+      driver->SetSupportBootImageFixup(false);
+    }
+  }
 }
 
 JitCompiler::~JitCompiler() {
 }
 
-bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method) {
+bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method, bool baseline) {
   TimingLogger logger("JIT compiler timing logger", true, VLOG_IS_ON(jit));
   const uint64_t start_time = NanoTime();
   StackHandleScope<2> hs(self);
   self->AssertNoPendingException();
   Runtime* runtime = Runtime::Current();
-  if (runtime->GetJit()->GetCodeCache()->ContainsMethod(method)) {
+  // Optimized code replaces the baseline code in the code cache.
+  if (baseline && runtime->GetJit()->GetCodeCache()->ContainsMethod(method)) {
     VLOG(jit) << "Already compiled " << PrettyMethod(method);
     return true;  // Already compiled
   }
@@ -168,10 +197,12 @@ bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method) {
       return false;
     }
   }
+  CompilerDriver* const driver = baseline ? baseline_compiler_driver_.get() : compiler_driver_.get();
+  DCHECK(driver != nullptr) << "Baseline compilation requires tiering";
   CompiledMethod* compiled_method = nullptr;
   {
     TimingLogger::ScopedTiming t2("Compiling", &logger);
-    compiled_method = compiler_driver_->CompileMethod(self, method);
+    compiled_method = driver->CompileMethod(self, method);
   }
   {
     TimingLogger::ScopedTiming t2("TrimMaps", &logger);
@@ -193,11 +224,11 @@ bool JitCompiler::CompileMethod(Thread* self, ArtMethod* method) {
       result = true;
     } else {
       TimingLogger::ScopedTiming t2("MakeExecutable", &logger);
-      result = MakeExecutable(compiled_method, method);
+      result = MakeExecutable(compiled_method, method, baseline);
     }
   }
   // Remove the compiled method to save memory.
-  compiler_driver_->RemoveCompiledMethod(method_ref);
+  driver->RemoveCompiledMethod(method_ref);
   runtime->GetJit()->AddTimingLogger(logger);
   return result;
 }
@@ -228,15 +259,18 @@ uint8_t* JitCompiler::WriteMethodHeaderAndCode(const CompiledMethod* compiled_me
   std::copy(quick_code->data(), quick_code->data() + code_size, code_ptr);
   // After we are done writing we need to update the method header.
   // Write out the method header last.
+  // An offset of 0 means that the table is absent.
   method_header = new(method_header)OatQuickMethodHeader(
-      code_ptr - mapping_table, code_ptr - vmap_table, code_ptr - gc_map, frame_size_in_bytes,
-      core_spill_mask, fp_spill_mask, code_size);
+      mapping_table == nullptr ? 0u : code_ptr - mapping_table,
+      code_ptr - vmap_table,
+      gc_map == nullptr ? 0u : code_ptr - gc_map,
+      frame_size_in_bytes, core_spill_mask, fp_spill_mask, code_size);
   // Return the code ptr.
   return code_ptr;
 }
 
 bool JitCompiler::AddToCodeCache(ArtMethod* method, const CompiledMethod* compiled_method,
-                                 OatFile::OatMethod* out_method) {
+                                 bool baseline, OatFile::OatMethod* out_method) {
   Runtime* runtime = Runtime::Current();
   JitCodeCache* const code_cache = runtime->GetJit()->GetCodeCache();
   const auto* quick_code = compiled_method->GetQuickCode();
@@ -248,27 +282,32 @@ bool JitCompiler::AddToCodeCache(ArtMethod* method, const CompiledMethod* compil
   const uint8_t* base = code_cache->CodeCachePtr();
   auto* const mapping_table = compiled_method->GetMappingTable();
   auto* const vmap_table = compiled_method->GetVmapTable();
+  // Optimizing does not emit a mapping table nor a GC map, its stack maps are in the vmap table.
   auto* const gc_map = compiled_method->GetGcMap();
-  CHECK(gc_map != nullptr) << PrettyMethod(method);
   // Write out pre-header stuff.
-  uint8_t* const mapping_table_ptr = code_cache->AddDataArray(
-      self, mapping_table->data(), mapping_table->data() + mapping_table->size());
-  if (mapping_table_ptr == nullptr) {
-    return false;  // Out of data cache.
+  uint8_t* mapping_table_ptr = nullptr;
+  if (mapping_table != nullptr) {
+    mapping_table_ptr = code_cache->AddDataArray(
+        self, mapping_table->data(), mapping_table->data() + mapping_table->size());
+    if (mapping_table_ptr == nullptr) {
+      return false;  // Out of data cache.
+    }
   }
   uint8_t* const vmap_table_ptr = code_cache->AddDataArray(
       self, vmap_table->data(), vmap_table->data() + vmap_table->size());
   if (vmap_table_ptr == nullptr) {
     return false;  // Out of data cache.
   }
-  uint8_t* const gc_map_ptr = code_cache->AddDataArray(
-      self, gc_map->data(), gc_map->data() + gc_map->size());
-  if (gc_map_ptr == nullptr) {
-    return false;  // Out of data cache.
+  uint8_t* gc_map_ptr = nullptr;
+  if (gc_map != nullptr) {
+    gc_map_ptr = code_cache->AddDataArray(self, gc_map->data(), gc_map->data() + gc_map->size());
+    if (gc_map_ptr == nullptr) {
+      return false;  // Out of data cache.
+    }
   }
   // Don't touch this until you protect / unprotect the code.
   const size_t reserve_size = sizeof(OatQuickMethodHeader) + quick_code->size() + 32;
-  uint8_t* const code_reserve = code_cache->ReserveCode(self, reserve_size);
+  uint8_t* const code_reserve = code_cache->ReserveCode(self, reserve_size, method, baseline);
   if (code_reserve == nullptr) {
     return false;
   }
@@ -294,11 +333,12 @@ bool JitCompiler::AddToCodeCache(ArtMethod* method, const CompiledMethod* compil
   return true;
 }
 
-bool JitCompiler::MakeExecutable(CompiledMethod* compiled_method, ArtMethod* method) {
+bool JitCompiler::MakeExecutable(CompiledMethod* compiled_method, ArtMethod* method,
+                                 bool baseline) {
   CHECK(method != nullptr);
   CHECK(compiled_method != nullptr);
   OatFile::OatMethod oat_method(nullptr, 0);
-  if (!AddToCodeCache(method, compiled_method, &oat_method)) {
+  if (!AddToCodeCache(method, compiled_method, baseline, &oat_method)) {
     return false;
   }
   // TODO: Flush instruction cache.
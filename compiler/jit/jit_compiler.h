@@ -37,11 +37,12 @@ class JitCompiler {
  public:
   static JitCompiler* Create();
   virtual ~JitCompiler();
-  bool CompileMethod(Thread* self, ArtMethod* method)
+  // Compiles with the baseline tier if baseline is true, and fully optimized otherwise.
+  bool CompileMethod(Thread* self, ArtMethod* method, bool baseline)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   // This is in the compiler since the runtime doesn't have access to the compiled method
-  // structures.
-  bool AddToCodeCache(ArtMethod* method, const CompiledMethod* compiled_method,
+  // structures. Baseline code also sets aside room in the code cache for its tier-up.
+  bool AddToCodeCache(ArtMethod* method, const CompiledMethod* compiled_method, bool baseline,
                       OatFile::OatMethod* out_method) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   CompilerCallbacks* GetCompilerCallbacks() const;
   size_t GetTotalCompileTime() const {
@@ -50,11 +51,14 @@ class JitCompiler {
 
  private:
   uint64_t total_time_;
+  std::unique_ptr<CompilerOptions> baseline_compiler_options_;
   std::unique_ptr<CompilerOptions> compiler_options_;
   std::unique_ptr<CumulativeLogger> cumulative_logger_;
   std::unique_ptr<VerificationResults> verification_results_;
   std::unique_ptr<DexFileToMethodInlinerMap> method_inliner_map_;
   std::unique_ptr<CompilerCallbacks> callbacks_;
+  // Null when tiering is disabled by an optimize threshold of 0.
+  std::unique_ptr<CompilerDriver> baseline_compiler_driver_;
   std::unique_ptr<CompilerDriver> compiler_driver_;
   std::unique_ptr<const InstructionSetFeatures> instruction_set_features_;
 
@@ -62,7 +66,7 @@ class JitCompiler {
   uint8_t* WriteMethodHeaderAndCode(
       const CompiledMethod* compiled_method, uint8_t* reserve_begin, uint8_t* reserve_end,
       const uint8_t* mapping_table, const uint8_t* vmap_table, const uint8_t* gc_map);
-  bool MakeExecutable(CompiledMethod* compiled_method, ArtMethod* method)
+  bool MakeExecutable(CompiledMethod* compiled_method, ArtMethod* method, bool baseline)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   DISALLOW_COPY_AND_ASSIGN(JitCompiler);
@@ -166,6 +166,9 @@ class JniCompilerTest : public CommonCompilerTest {
   void StackArgsFloatsFirstImpl();
   void StackArgsMixedImpl();
   void StackArgsSignExtendedMips64Impl();
+  void CriticalNativeIntIntMethodImpl();
+  void CriticalNativeMixedArgsMethodImpl();
+  void CriticalNativeStackArgsImpl();
 
   JNIEnv* env_;
   jmethodID jmethod_;
@@ -1761,4 +1764,78 @@ void JniCompilerTest::StackArgsSignExtendedMips64Impl() {
 
 JNI_TEST(StackArgsSignExtendedMips64)
 
+// @CriticalNative methods get neither a JNIEnv* nor a jclass and stay Runnable.
+int gJava_MyClassNatives_criticalSII_calls = 0;
+jint Java_MyClassNatives_criticalSII(jint x, jint y) {
+  EXPECT_EQ(kRunnable, Thread::Current()->GetState());
+  Locks::mutator_lock_->AssertSharedHeld(Thread::Current());
+  gJava_MyClassNatives_criticalSII_calls++;
+  return x - y;  // non-commutative operator
+}
+
+void JniCompilerTest::CriticalNativeIntIntMethodImpl() {
+  SetUpForTest(true, "criticalSII", "(II)I",
+               reinterpret_cast<void*>(&Java_MyClassNatives_criticalSII));
+
+  EXPECT_EQ(0, gJava_MyClassNatives_criticalSII_calls);
+  jint result = env_->CallStaticIntMethod(jklass_, jmethod_, 50, 20);
+  EXPECT_EQ(30, result);
+  EXPECT_EQ(1, gJava_MyClassNatives_criticalSII_calls);
+  result = env_->CallStaticIntMethod(jklass_, jmethod_, -1, 0x7fffffff);
+  EXPECT_EQ(static_cast<jint>(0x80000000), result);
+  EXPECT_EQ(2, gJava_MyClassNatives_criticalSII_calls);
+
+  gJava_MyClassNatives_criticalSII_calls = 0;
+}
+
+JNI_TEST(CriticalNativeIntIntMethod)
+
+jdouble Java_MyClassNatives_criticalSJIDF(jlong x, jint y, jdouble z, jfloat w) {
+  EXPECT_EQ(kRunnable, Thread::Current()->GetState());
+  return static_cast<jdouble>(x) - static_cast<jdouble>(y) + z * static_cast<jdouble>(w);
+}
+
+void JniCompilerTest::CriticalNativeMixedArgsMethodImpl() {
+  SetUpForTest(true, "criticalSJIDF", "(JIDF)D",
+               reinterpret_cast<void*>(&Java_MyClassNatives_criticalSJIDF));
+
+  jlong x = INT64_C(0x100000000);
+  jint y = 7;
+  jdouble z = 0.5;
+  jfloat w = 3.0f;
+  jdouble result = env_->CallStaticDoubleMethod(jklass_, jmethod_, x, y, z, w);
+  EXPECT_DOUBLE_EQ(static_cast<jdouble>(x) - 7.0 + 1.5, result);
+}
+
+JNI_TEST(CriticalNativeMixedArgsMethod)
+
+void Java_MyClassNatives_criticalStackArgs(jint i1, jlong l1, jint i2, jlong l2, jint i3,
+                                           jlong l3, jdouble d1, jfloat f1, jdouble d2,
+                                           jfloat f2, jint i4, jlong l4) {
+  EXPECT_EQ(kRunnable, Thread::Current()->GetState());
+  EXPECT_EQ(i1, 1);
+  EXPECT_EQ(l1, INT64_C(0x100000002));
+  EXPECT_EQ(i2, -3);
+  EXPECT_EQ(l2, INT64_C(-0x400000005));
+  EXPECT_EQ(i3, 6);
+  EXPECT_EQ(l3, INT64_C(0x700000008));
+  EXPECT_DOUBLE_EQ(d1, 9.5);
+  EXPECT_FLOAT_EQ(f1, 10.25f);
+  EXPECT_DOUBLE_EQ(d2, -11.75);
+  EXPECT_FLOAT_EQ(f2, 12.0f);
+  EXPECT_EQ(i4, 13);
+  EXPECT_EQ(l4, INT64_C(0xe0000000f));
+}
+
+void JniCompilerTest::CriticalNativeStackArgsImpl() {
+  SetUpForTest(true, "criticalStackArgs", "(IJIJIJDFDFIJ)V",
+               reinterpret_cast<void*>(&Java_MyClassNatives_criticalStackArgs));
+
+  env_->CallStaticVoidMethod(jklass_, jmethod_, 1, INT64_C(0x100000002), -3,
+                             INT64_C(-0x400000005), 6, INT64_C(0x700000008), 9.5, 10.25f,
+                             -11.75, 12.0f, 13, INT64_C(0xe0000000f));
+}
+
+JNI_TEST(CriticalNativeStackArgs)
+
 }  // namespace art
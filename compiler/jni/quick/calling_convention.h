@@ -270,7 +270,8 @@ class ManagedRuntimeCallingConvention : public CallingConvention {
 // callee saves for frames above this one.
 class JniCallingConvention : public CallingConvention {
  public:
-  static JniCallingConvention* Create(bool is_static, bool is_synchronized, const char* shorty,
+  static JniCallingConvention* Create(bool is_static, bool is_synchronized,
+                                      bool is_critical_native, const char* shorty,
                                       InstructionSet instruction_set);
 
   // Size of frame excluding space for outgoing args (its assumed Method* is
@@ -318,6 +319,12 @@ class JniCallingConvention : public CallingConvention {
   // Iterator interface extension for JNI
   FrameOffset CurrentParamHandleScopeEntryOffset();
 
+  // @CriticalNative methods receive neither a JNIEnv* nor a jclass, so the
+  // native arguments are exactly the managed ones.
+  bool IsCriticalNative() const {
+    return is_critical_native_;
+  }
+
   // Position of handle scope and interior fields
   FrameOffset HandleScopeOffset() const {
     return FrameOffset(this->displacement_.Int32Value() + frame_pointer_size_);
@@ -348,9 +355,10 @@ class JniCallingConvention : public CallingConvention {
     kObjectOrClass = 1
   };
 
-  explicit JniCallingConvention(bool is_static, bool is_synchronized, const char* shorty,
-                                size_t frame_pointer_size)
-      : CallingConvention(is_static, is_synchronized, shorty, frame_pointer_size) {}
+  explicit JniCallingConvention(bool is_static, bool is_synchronized, bool is_critical_native,
+                                const char* shorty, size_t frame_pointer_size)
+      : CallingConvention(is_static, is_synchronized, shorty, frame_pointer_size),
+        is_critical_native_(is_critical_native) {}
 
   // Number of stack slots for outgoing arguments, above which the handle scope is
   // located
@@ -358,6 +366,9 @@ class JniCallingConvention : public CallingConvention {
 
  protected:
   size_t NumberOfExtraArgumentsForJni();
+
+ private:
+  const bool is_critical_native_;
 };
 
 }  // namespace art
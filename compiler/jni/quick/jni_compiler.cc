@@ -52,6 +52,8 @@ static void CopyParameter(Assembler* jni_asm,
 static void SetNativeParameter(Assembler* jni_asm,
                                JniCallingConvention* jni_conv,
                                ManagedRegister in_reg);
+static CompiledMethod* ArtJniCompileCriticalNativeMethod(CompilerDriver* driver,
+                                                         const char* shorty);
 
 // Generate the JNI bridge for the given method, general contract:
 // - Arguments are in the managed runtime format, either on stack or in
@@ -66,11 +68,16 @@ CompiledMethod* ArtJniCompileMethodInternal(CompilerDriver* driver,
   const bool is_static = (access_flags & kAccStatic) != 0;
   const bool is_synchronized = (access_flags & kAccSynchronized) != 0;
   const char* shorty = dex_file.GetMethodShorty(dex_file.GetMethodId(method_idx));
+  if ((access_flags & kAccCriticalNative) != 0) {
+    CHECK(is_static);
+    CHECK(!is_synchronized);
+    return ArtJniCompileCriticalNativeMethod(driver, shorty);
+  }
   InstructionSet instruction_set = driver->GetInstructionSet();
   const bool is_64_bit_target = Is64BitInstructionSet(instruction_set);
   // Calling conventions used to iterate over parameters to method
   std::unique_ptr<JniCallingConvention> main_jni_conv(
-      JniCallingConvention::Create(is_static, is_synchronized, shorty, instruction_set));
+      JniCallingConvention::Create(is_static, is_synchronized, false, shorty, instruction_set));
   bool reference_return = main_jni_conv->IsReturnAReference();
 
   std::unique_ptr<ManagedRuntimeCallingConvention> mr_conv(
@@ -90,7 +97,8 @@ CompiledMethod* ArtJniCompileMethodInternal(CompilerDriver* driver,
   }
 
   std::unique_ptr<JniCallingConvention> end_jni_conv(
-      JniCallingConvention::Create(is_static, is_synchronized, jni_end_shorty, instruction_set));
+      JniCallingConvention::Create(is_static, is_synchronized, false, jni_end_shorty,
+                                   instruction_set));
 
   // Assembler that holds generated instructions
   std::unique_ptr<Assembler> jni_asm(Assembler::Create(instruction_set));
@@ -494,6 +502,121 @@ CompiledMethod* ArtJniCompileMethodInternal(CompilerDriver* driver,
                                                  ArrayRef<const LinkerPatch>());
 }
 
+// Generate the bridge for a @CriticalNative method. Such methods are static, unsynchronized and
+// take and return only primitives, so the native code is called directly from Runnable without
+// a JNIEnv*, a jclass, a handle scope or a local reference frame:
+// - Build the frame and publish it to the thread so that the dlsym lookup stub can find the
+//   method on the first call.
+// - Shuffle the arguments into the native convention and call.
+// - Move the result into the managed return register and poll for an exception from the lookup.
+static CompiledMethod* ArtJniCompileCriticalNativeMethod(CompilerDriver* driver,
+                                                         const char* shorty) {
+  InstructionSet instruction_set = driver->GetInstructionSet();
+  const bool is_64_bit_target = Is64BitInstructionSet(instruction_set);
+  std::unique_ptr<JniCallingConvention> main_jni_conv(
+      JniCallingConvention::Create(true, false, true, shorty, instruction_set));
+  std::unique_ptr<ManagedRuntimeCallingConvention> mr_conv(
+      ManagedRuntimeCallingConvention::Create(true, false, shorty, instruction_set));
+  CHECK(!main_jni_conv->IsReturnAReference());
+
+  std::unique_ptr<Assembler> jni_asm(Assembler::Create(instruction_set));
+  jni_asm->cfi().SetEnabled(driver->GetCompilerOptions().GetGenerateDebugInfo());
+
+  // 1. Build the frame saving all callee saves.
+  const size_t frame_size(main_jni_conv->FrameSize());
+  const std::vector<ManagedRegister>& callee_save_regs = main_jni_conv->CalleeSaveRegisters();
+  __ BuildFrame(frame_size, mr_conv->MethodRegister(), callee_save_regs, mr_conv->EntrySpills());
+  DCHECK_EQ(jni_asm->cfi().GetCurrentCFAOffset(), static_cast<int>(frame_size));
+
+  // 2. Write out the end of the quick frames.
+  if (is_64_bit_target) {
+    __ StoreStackPointerToThread64(Thread::TopOfManagedStackOffset<8>());
+  } else {
+    __ StoreStackPointerToThread32(Thread::TopOfManagedStackOffset<4>());
+  }
+
+  // 3. Move frame down to allow space for out going args.
+  const size_t out_arg_size = main_jni_conv->OutArgSize();
+  __ IncreaseFrameSize(out_arg_size);
+
+  // 4. Shuffle the arguments. Without the JNIEnv* and jclass every argument moves to the same or
+  //    a lower native position, so a forward pass never clobbers a value still to be read.
+  mr_conv->ResetIterator(FrameOffset(frame_size + out_arg_size));
+  main_jni_conv->ResetIterator(FrameOffset(out_arg_size));
+  while (mr_conv->HasNext()) {
+    CHECK(main_jni_conv->HasNext());
+    CopyParameter(jni_asm.get(), mr_conv.get(), main_jni_conv.get(), frame_size, out_arg_size);
+    mr_conv->Next();
+    main_jni_conv->Next();
+  }
+
+  // 5. Plant call to native code associated with method.
+  MemberOffset jni_entrypoint_offset = ArtMethod::EntryPointFromJniOffset(
+      InstructionSetPointerSize(instruction_set));
+  __ Call(main_jni_conv->MethodStackOffset(), jni_entrypoint_offset,
+          mr_conv->InterproceduralScratchRegister());
+
+  // 6. Fix differences in result widths.
+  if (main_jni_conv->RequiresSmallResultTypeExtension()) {
+    if (main_jni_conv->GetReturnType() == Primitive::kPrimByte ||
+        main_jni_conv->GetReturnType() == Primitive::kPrimShort) {
+      __ SignExtend(main_jni_conv->ReturnRegister(),
+                    Primitive::ComponentSize(main_jni_conv->GetReturnType()));
+    } else if (main_jni_conv->GetReturnType() == Primitive::kPrimBoolean ||
+               main_jni_conv->GetReturnType() == Primitive::kPrimChar) {
+      __ ZeroExtend(main_jni_conv->ReturnRegister(),
+                    Primitive::ComponentSize(main_jni_conv->GetReturnType()));
+    }
+  }
+
+  // 7. Move the result to the managed return register through the spill slot, the native and
+  //    managed conventions disagree on floating point results for some instruction sets.
+  if (main_jni_conv->SizeOfReturnValue() != 0) {
+    FrameOffset return_save_location = main_jni_conv->ReturnValueSaveLocation();
+    if ((instruction_set == kMips || instruction_set == kMips64) &&
+        main_jni_conv->GetReturnType() == Primitive::kPrimDouble &&
+        return_save_location.Uint32Value() % 8 != 0) {
+      // Ensure doubles are 8-byte aligned for MIPS
+      return_save_location = FrameOffset(return_save_location.Uint32Value() + kMipsPointerSize);
+    }
+    CHECK_LT(return_save_location.Uint32Value(), frame_size + out_arg_size);
+    __ Store(return_save_location, main_jni_conv->ReturnRegister(),
+             main_jni_conv->SizeOfReturnValue());
+    __ Load(mr_conv->ReturnRegister(), return_save_location, mr_conv->SizeOfReturnValue());
+  }
+
+  // 8. Move frame up now we're done with the out arg space.
+  __ DecreaseFrameSize(out_arg_size);
+
+  // 9. Process a pending exception from a failed native method lookup.
+  __ ExceptionPoll(main_jni_conv->InterproceduralScratchRegister(), 0);
+
+  // 10. Remove activation.
+  DCHECK_EQ(jni_asm->cfi().GetCurrentCFAOffset(), static_cast<int>(frame_size));
+  __ RemoveFrame(frame_size, callee_save_regs);
+  DCHECK_EQ(jni_asm->cfi().GetCurrentCFAOffset(), static_cast<int>(frame_size));
+
+  // 11. Finalize code generation
+  __ EmitSlowPaths();
+  size_t cs = __ CodeSize();
+  std::vector<uint8_t> managed_code(cs);
+  MemoryRegion code(&managed_code[0], managed_code.size());
+  __ FinalizeInstructions(code);
+
+  return CompiledMethod::SwapAllocCompiledMethod(driver,
+                                                 instruction_set,
+                                                 ArrayRef<const uint8_t>(managed_code),
+                                                 frame_size,
+                                                 main_jni_conv->CoreSpillMask(),
+                                                 main_jni_conv->FpSpillMask(),
+                                                 nullptr,  // src_mapping_table.
+                                                 ArrayRef<const uint8_t>(),  // mapping_table.
+                                                 ArrayRef<const uint8_t>(),  // vmap_table.
+                                                 ArrayRef<const uint8_t>(),  // native_gc_map.
+                                                 ArrayRef<const uint8_t>(*jni_asm->cfi().data()),
+                                                 ArrayRef<const LinkerPatch>());
+}
+
 // Copy a single parameter from the managed to the JNI calling convention.
 static void CopyParameter(Assembler* jni_asm,
                           ManagedRuntimeCallingConvention* mr_conv,
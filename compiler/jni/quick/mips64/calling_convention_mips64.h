@@ -48,7 +48,8 @@ class Mips64ManagedRuntimeCallingConvention FINAL : public ManagedRuntimeCalling
 
 class Mips64JniCallingConvention FINAL : public JniCallingConvention {
  public:
-  explicit Mips64JniCallingConvention(bool is_static, bool is_synchronized, const char* shorty);
+  explicit Mips64JniCallingConvention(bool is_static, bool is_synchronized,
+                                      bool is_critical_native, const char* shorty);
   ~Mips64JniCallingConvention() OVERRIDE {}
   // Calling convention
   ManagedRegister ReturnRegister() OVERRIDE;
@@ -14,8 +14,13 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <set>
+
 #include "arch/instruction_set_features.h"
 #include "art_method-inl.h"
+#include "base/stringprintf.h"
+#include "base/unix_file/fd_file.h"
 #include "class_linker.h"
 #include "common_compiler_test.h"
 #include "compiled_method.h"
@@ -177,6 +182,125 @@ TEST_F(OatTest, WriteRead) {
   }
 }
 
+TEST_F(OatTest, CodeTiersFollowProfile) {
+  TimingLogger timings("OatTest::CodeTiersFollowProfile", false, false);
+  jobject class_loader;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    class_loader = LoadDex("StaticLeafMethods");
+  }
+  ASSERT_NE(class_loader, nullptr);
+  std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+  ASSERT_EQ(1u, dex_files.size());
+  const DexFile& dex_file = *dex_files[0];
+
+  // The methods in definition order, with their class def and index in the class.
+  struct MethodInfo {
+    uint32_t method_idx;
+    size_t class_def_index;
+    size_t class_def_method_index;
+    size_t tier;
+  };
+  std::vector<MethodInfo> methods;
+  for (size_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+    const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(i));
+    if (class_data == nullptr) {
+      continue;
+    }
+    ClassDataItemIterator it(dex_file, class_data);
+    while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      it.Next();
+    }
+    for (size_t class_def_method_index = 0;
+         it.HasNextDirectMethod() || it.HasNextVirtualMethod();
+         it.Next(), ++class_def_method_index) {
+      methods.push_back(MethodInfo { it.GetMemberIndex(), i, class_def_method_index, 0u });
+    }
+  }
+  ASSERT_GE(methods.size(), 9u);
+
+  // Pick the tiers against definition order: hot methods dominate the samples, warm methods are
+  // sampled but outside the top K% and cold methods are not in the profile.
+  static constexpr size_t kHot = 0u;
+  static constexpr size_t kWarm = 1u;
+  static constexpr size_t kCold = 2u;
+  static constexpr uint32_t kHotCount = 1000u;
+  static constexpr uint32_t kWarmCount = 1u;
+  std::vector<std::pair<std::string, uint32_t>> profiled_methods;
+  uint32_t total_count = 0u;
+  for (size_t i = 0; i != methods.size(); ++i) {
+    MethodInfo& method = methods[i];
+    method.tier = (i % 3u == 0u) ? kCold : (i % 3u == 1u) ? kWarm : kHot;
+    if (method.tier != kCold) {
+      uint32_t count = (method.tier == kHot) ? kHotCount : kWarmCount;
+      profiled_methods.push_back(std::make_pair(PrettyMethod(method.method_idx, dex_file), count));
+      total_count += count;
+    }
+  }
+  ScratchFile profile;
+  std::string profile_data = StringPrintf("%u/0/0\n", total_count);
+  for (const auto& entry : profiled_methods) {
+    profile_data += StringPrintf("%s/%u/10\n", entry.first.c_str(), entry.second);
+  }
+  ASSERT_TRUE(profile.GetFile()->WriteFully(profile_data.data(), profile_data.size()));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  compiler_driver_.reset(new CompilerDriver(compiler_options_.get(),
+                                            verification_results_.get(),
+                                            method_inliner_map_.get(),
+                                            Compiler::kQuick, kRuntimeISA,
+                                            instruction_set_features_.get(), false, nullptr,
+                                            nullptr, nullptr, 2, true, true, "", timer_.get(), -1,
+                                            profile.GetFilename()));
+  ASSERT_TRUE(compiler_driver_->ProfilePresent());
+  compiler_driver_->CompileAll(class_loader, dex_files, &timings);
+
+  ScratchFile tmp;
+  SafeMap<std::string, std::string> key_value_store;
+  key_value_store.Put(OatHeader::kImageLocationKey, "lue.art");
+  OatWriter oat_writer(dex_files, 42U, 4096U, 0, compiler_driver_.get(), nullptr, &timings,
+                       &key_value_store);
+  ASSERT_TRUE(compiler_driver_->WriteElf(GetTestAndroidRoot(), !kIsTargetBuild, dex_files,
+                                         &oat_writer, tmp.GetFile()));
+  // Patch locations are recorded while the code is laid out, they must stay sorted.
+  const std::vector<uintptr_t>& patch_locations = oat_writer.GetAbsolutePatchLocations();
+  EXPECT_TRUE(std::is_sorted(patch_locations.begin(), patch_locations.end()));
+
+  std::string error_msg;
+  std::unique_ptr<OatFile> oat_file(OatFile::Open(tmp.GetFilename(), tmp.GetFilename(), nullptr,
+                                                  nullptr, false, nullptr, &error_msg));
+  ASSERT_TRUE(oat_file.get() != nullptr) << error_msg;
+  uint32_t dex_file_checksum = dex_file.GetLocationChecksum();
+  const OatFile::OatDexFile* oat_dex_file = oat_file->GetOatDexFile(dex_file.GetLocation().c_str(),
+                                                                    &dex_file_checksum);
+  ASSERT_TRUE(oat_dex_file != nullptr);
+
+  // Deduplicated code is laid out with the hottest of the methods that share it, so the tier of
+  // a code offset is the hottest tier among its methods.
+  SafeMap<uint32_t, size_t> code_offset_tiers;
+  for (const MethodInfo& method : methods) {
+    const OatFile::OatClass oat_class = oat_dex_file->GetOatClass(method.class_def_index);
+    uint32_t code_offset = oat_class.GetOatMethod(method.class_def_method_index).GetCodeOffset();
+    ASSERT_NE(0u, code_offset) << PrettyMethod(method.method_idx, dex_file);
+    code_offset &= ~1u;  // Clear the Thumb bit.
+    auto lb = code_offset_tiers.lower_bound(code_offset);
+    if (lb != code_offset_tiers.end() && lb->first == code_offset) {
+      lb->second = std::min(lb->second, method.tier);
+    } else {
+      code_offset_tiers.PutBefore(lb, code_offset, method.tier);
+    }
+  }
+  // Hot code precedes warm code, which precedes cold code.
+  std::set<size_t> tiers_seen;
+  size_t last_tier = kHot;
+  for (const auto& entry : code_offset_tiers) {
+    EXPECT_LE(last_tier, entry.second) << "at code offset " << entry.first;
+    last_tier = entry.second;
+    tiers_seen.insert(entry.second);
+  }
+  EXPECT_EQ(3u, tiers_seen.size());
+}
+
 TEST_F(OatTest, OatHeaderSizeCheck) {
   // If this test is failing and you have to update these constants,
   // it is time to update OatHeader::kOatVersion
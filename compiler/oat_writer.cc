@@ -16,6 +16,7 @@
 
 #include "oat_writer.h"
 
+#include <algorithm>
 #include <zlib.h>
 
 #include "arch/arm64/instruction_set_features_arm64.h"
@@ -43,6 +44,7 @@
 #include "safe_map.h"
 #include "scoped_thread_state_change.h"
 #include "handle_scope-inl.h"
+#include "thread_pool.h"
 #include "verifier/method_verifier.h"
 
 namespace art {
@@ -69,6 +71,7 @@ OatWriter::OatWriter(const std::vector<const DexFile*>& dex_files,
     size_(0u),
     bss_size_(0u),
     oat_data_offset_(0u),
+    first_code_tier_(kCodeTierCold),
     image_file_location_oat_checksum_(image_file_location_oat_checksum),
     image_file_location_oat_begin_(image_file_location_oat_begin),
     image_patch_delta_(image_patch_delta),
@@ -99,7 +102,10 @@ OatWriter::OatWriter(const std::vector<const DexFile*>& dex_files,
     size_oat_dex_file_location_data_(0),
     size_oat_dex_file_location_checksum_(0),
     size_oat_dex_file_offset_(0),
+    size_oat_dex_file_lookup_table_offset_(0),
     size_oat_dex_file_methods_offsets_(0),
+    size_oat_lookup_table_alignment_(0),
+    size_oat_lookup_table_(0),
     size_oat_class_type_(0),
     size_oat_class_status_(0),
     size_oat_class_method_bitmaps_(0),
@@ -125,10 +131,18 @@ OatWriter::OatWriter(const std::vector<const DexFile*>& dex_files,
     TimingLogger::ScopedTiming split("InitDexFiles", timings);
     offset = InitDexFiles(offset);
   }
+  {
+    TimingLogger::ScopedTiming split("InitLookupTables", timings);
+    offset = InitLookupTables(offset);
+  }
   {
     TimingLogger::ScopedTiming split("InitOatClasses", timings);
     offset = InitOatClasses(offset);
   }
+  if (compiler_driver_->ProfilePresent()) {
+    TimingLogger::ScopedTiming split("InitCodeTiers", timings);
+    InitCodeTiers();
+  }
   {
     TimingLogger::ScopedTiming split("InitOatMaps", timings);
     offset = InitOatMaps(offset);
@@ -271,7 +285,14 @@ class OatWriter::OatDexMethodVisitor : public DexMethodVisitor {
   OatDexMethodVisitor(OatWriter* writer, size_t offset)
     : DexMethodVisitor(writer, offset),
       oat_class_index_(0u),
-      method_offsets_index_(0u) {
+      method_offsets_index_(0u),
+      code_tier_(kCodeTierCold) {
+  }
+
+  // Start another pass over all classes which lays out or writes the code of one CodeTier.
+  void StartCodeTier(CodeTier code_tier) {
+    oat_class_index_ = 0u;
+    code_tier_ = code_tier;
   }
 
   bool StartClass(const DexFile* dex_file, size_t class_def_index) {
@@ -287,8 +308,17 @@ class OatWriter::OatDexMethodVisitor : public DexMethodVisitor {
   }
 
  protected:
+  bool IsInCodeTier(const OatClass* oat_class) const {
+    return oat_class->GetCodeTier(method_offsets_index_) == code_tier_;
+  }
+
+  bool IsLastCodeTier() const {
+    return code_tier_ == kCodeTierCold;
+  }
+
   size_t oat_class_index_;
   size_t method_offsets_index_;
+  CodeTier code_tier_;
 };
 
 class OatWriter::InitOatClassesMethodVisitor : public DexMethodVisitor {
@@ -347,6 +377,66 @@ class OatWriter::InitOatClassesMethodVisitor : public DexMethodVisitor {
   size_t num_non_null_compiled_methods_;
 };
 
+// Classify the compiled methods of a range of classes of one dex file into CodeTiers.
+class OatWriter::InitCodeTiersTask FINAL : public SelfDeletingTask {
+ public:
+  InitCodeTiersTask(OatWriter* writer, const DexFile* dex_file, size_t first_oat_class_index,
+                    size_t class_def_begin, size_t class_def_end)
+    : writer_(writer),
+      dex_file_(dex_file),
+      first_oat_class_index_(first_oat_class_index),
+      class_def_begin_(class_def_begin),
+      class_def_end_(class_def_end) {
+  }
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE {
+    for (size_t class_def_index = class_def_begin_;
+         class_def_index != class_def_end_;
+         ++class_def_index) {
+      OatClass* oat_class = writer_->oat_classes_[first_oat_class_index_ + class_def_index];
+      DCHECK(oat_class->method_code_tiers_.empty());
+      oat_class->method_code_tiers_.reserve(oat_class->method_offsets_.size());
+      const uint8_t* class_data = dex_file_->GetClassData(dex_file_->GetClassDef(class_def_index));
+      if (class_data == nullptr) {
+        continue;
+      }
+      ClassDataItemIterator it(*dex_file_, class_data);
+      while (it.HasNextStaticField()) {
+        it.Next();
+      }
+      while (it.HasNextInstanceField()) {
+        it.Next();
+      }
+      size_t class_def_method_index = 0u;
+      while (it.HasNextDirectMethod() || it.HasNextVirtualMethod()) {
+        if (oat_class->GetCompiledMethod(class_def_method_index) != nullptr) {
+          oat_class->method_code_tiers_.push_back(GetCodeTier(it.GetMemberIndex()));
+        }
+        ++class_def_method_index;
+        it.Next();
+      }
+      DCHECK_EQ(oat_class->method_code_tiers_.size(), oat_class->method_offsets_.size());
+    }
+  }
+
+ private:
+  CodeTier GetCodeTier(uint32_t method_idx) const {
+    // The profile is keyed by the pretty method name, building it dominates this task.
+    const CompilerDriver* compiler_driver = writer_->compiler_driver_;
+    ProfileFile::ProfileData data;
+    if (!compiler_driver->GetProfileData(PrettyMethod(method_idx, *dex_file_), &data)) {
+      return kCodeTierCold;
+    }
+    return compiler_driver->IsProfileTopK(data) ? kCodeTierHot : kCodeTierWarm;
+  }
+
+  OatWriter* const writer_;
+  const DexFile* const dex_file_;
+  const size_t first_oat_class_index_;
+  const size_t class_def_begin_;
+  const size_t class_def_end_;
+};
+
 class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
  public:
   InitCodeMethodVisitor(OatWriter* writer, size_t offset)
@@ -358,7 +448,7 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
 
   bool EndClass() {
     OatDexMethodVisitor::EndClass();
-    if (oat_class_index_ == writer_->oat_classes_.size()) {
+    if (oat_class_index_ == writer_->oat_classes_.size() && IsLastCodeTier()) {
       offset_ = writer_->relative_patcher_->ReserveSpaceEnd(offset_);
     }
     return true;
@@ -369,7 +459,10 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
     OatClass* oat_class = writer_->oat_classes_[oat_class_index_];
     CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
 
-    if (compiled_method != nullptr) {
+    if (compiled_method != nullptr && !IsInCodeTier(oat_class)) {
+      // Laid out in another pass.
+      ++method_offsets_index_;
+    } else if (compiled_method != nullptr) {
       // Derived from CompiledMethod.
       uint32_t quick_code_offset = 0;
 
@@ -668,7 +761,7 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
 
   bool EndClass() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     bool result = OatDexMethodVisitor::EndClass();
-    if (oat_class_index_ == writer_->oat_classes_.size()) {
+    if (oat_class_index_ == writer_->oat_classes_.size() && IsLastCodeTier()) {
       DCHECK(result);  // OatDexMethodVisitor::EndClass() never fails.
       offset_ = writer_->relative_patcher_->WriteThunks(out_, offset_);
       if (UNLIKELY(offset_ == 0u)) {
@@ -684,7 +777,10 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
     OatClass* oat_class = writer_->oat_classes_[oat_class_index_];
     const CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
 
-    if (compiled_method != nullptr) {  // ie. not an abstract method
+    if (compiled_method != nullptr && !IsInCodeTier(oat_class)) {
+      // Written in another pass.
+      ++method_offsets_index_;
+    } else if (compiled_method != nullptr) {  // ie. not an abstract method
       size_t file_offset = file_offset_;
       OutputStream* out = out_;
 
@@ -1024,6 +1120,24 @@ size_t OatWriter::InitDexFiles(size_t offset) {
   return offset;
 }
 
+size_t OatWriter::InitLookupTables(size_t offset) {
+  for (size_t i = 0; i != dex_files_->size(); ++i) {
+    OatDexFile* oat_dex_file = oat_dex_files_[i];
+    oat_dex_file->lookup_table_.reset(TypeLookupTable::Create(*(*dex_files_)[i]));
+    if (oat_dex_file->lookup_table_ == nullptr) {
+      continue;
+    }
+    // lookup tables are required to be 4 byte aligned
+    size_t original_offset = offset;
+    offset = RoundUp(offset, 4);
+    size_oat_lookup_table_alignment_ += offset - original_offset;
+
+    oat_dex_file->lookup_table_offset_ = offset;
+    offset += oat_dex_file->lookup_table_->RawDataLength();
+  }
+  return offset;
+}
+
 size_t OatWriter::InitOatClasses(size_t offset) {
   // calculate the offsets within OatDexFiles to OatClasses
   InitOatClassesMethodVisitor visitor(this, offset);
@@ -1046,6 +1160,29 @@ size_t OatWriter::InitOatClasses(size_t offset) {
   return offset;
 }
 
+void OatWriter::InitCodeTiers() {
+  // Split each dex file into chunks of classes so that single dex apps are classified in
+  // parallel as well. Each task only touches the OatClasses of its own chunk.
+  static constexpr size_t kClassDefsPerTask = 512u;
+  Thread* self = Thread::Current();
+  ScopedThreadStateChange tsc(self, kNative);
+  ThreadPool thread_pool("OatWriter code tiers thread pool",
+                         compiler_driver_->GetThreadCount() - 1);
+  size_t oat_class_index = 0u;
+  for (const DexFile* dex_file : *dex_files_) {
+    const size_t class_def_count = dex_file->NumClassDefs();
+    for (size_t begin = 0u; begin < class_def_count; begin += kClassDefsPerTask) {
+      size_t end = std::min(begin + kClassDefsPerTask, class_def_count);
+      thread_pool.AddTask(self, new InitCodeTiersTask(this, dex_file, oat_class_index, begin, end));
+    }
+    oat_class_index += class_def_count;
+  }
+  CHECK_EQ(oat_class_index, oat_classes_.size());
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+  first_code_tier_ = kCodeTierHot;
+}
+
 size_t OatWriter::InitOatMaps(size_t offset) {
   #define VISIT(VisitorType)                          \
     do {                                              \
@@ -1114,7 +1251,27 @@ size_t OatWriter::InitOatCodeDexFiles(size_t offset) {
       offset = visitor.GetOffset();                   \
     } while (false)
 
-  VISIT(InitCodeMethodVisitor);
+  {
+    // One pass per CodeTier, the dedupe map is shared so that identical code in a cold method
+    // reuses the copy laid out for a hot one.
+    InitCodeMethodVisitor visitor(this, offset);
+    for (uint8_t tier = first_code_tier_; tier != kCodeTierCount; ++tier) {
+      size_t tier_start = visitor.GetOffset();
+      visitor.StartCodeTier(static_cast<CodeTier>(tier));
+      bool success = VisitDexMethods(&visitor);
+      DCHECK(success);
+      VLOG(compiler) << "Code tier " << static_cast<int>(tier) << ": "
+                     << PrettySize(visitor.GetOffset() - tier_start);
+    }
+    offset = visitor.GetOffset();
+  }
+  if (first_code_tier_ != kCodeTierCold) {
+    // Debug info consumers expect methods in address order.
+    std::stable_sort(method_info_.begin(), method_info_.end(),
+                     [](const DebugInfo& lhs, const DebugInfo& rhs) {
+                       return lhs.low_pc_ < rhs.low_pc_;
+                     });
+  }
   if (compiler_driver_->IsImage()) {
     VISIT(InitImageMethodVisitor);
   }
@@ -1229,7 +1386,10 @@ bool OatWriter::WriteCode(OutputStream* out) {
     DO_STAT(size_oat_dex_file_location_data_);
     DO_STAT(size_oat_dex_file_location_checksum_);
     DO_STAT(size_oat_dex_file_offset_);
+    DO_STAT(size_oat_dex_file_lookup_table_offset_);
     DO_STAT(size_oat_dex_file_methods_offsets_);
+    DO_STAT(size_oat_lookup_table_alignment_);
+    DO_STAT(size_oat_lookup_table_);
     DO_STAT(size_oat_class_type_);
     DO_STAT(size_oat_class_status_);
     DO_STAT(size_oat_class_method_bitmaps_);
@@ -1287,6 +1447,27 @@ bool OatWriter::WriteTables(OutputStream* out, const size_t file_offset) {
     }
     size_dex_file_ += dex_file->GetHeader().file_size_;
   }
+  for (size_t i = 0; i != oat_dex_files_.size(); ++i) {
+    const TypeLookupTable* lookup_table = oat_dex_files_[i]->lookup_table_.get();
+    if (lookup_table == nullptr) {
+      continue;
+    }
+    uint32_t expected_offset = file_offset + oat_dex_files_[i]->lookup_table_offset_;
+    off_t actual_offset = out->Seek(expected_offset, kSeekSet);
+    if (static_cast<uint32_t>(actual_offset) != expected_offset) {
+      const DexFile* dex_file = (*dex_files_)[i];
+      PLOG(ERROR) << "Failed to seek to lookup table section. Actual: " << actual_offset
+                  << " Expected: " << expected_offset << " File: " << dex_file->GetLocation();
+      return false;
+    }
+    if (!out->WriteFully(lookup_table->RawData(), lookup_table->RawDataLength())) {
+      const DexFile* dex_file = (*dex_files_)[i];
+      PLOG(ERROR) << "Failed to write lookup table for " << dex_file->GetLocation()
+                  << " to " << out->GetLocation();
+      return false;
+    }
+    size_oat_lookup_table_ += lookup_table->RawDataLength();
+  }
   for (size_t i = 0; i != oat_classes_.size(); ++i) {
     if (!oat_classes_[i]->Write(this, out, file_offset)) {
       PLOG(ERROR) << "Failed to write oat methods information to " << out->GetLocation();
@@ -1357,18 +1538,16 @@ size_t OatWriter::WriteCode(OutputStream* out, const size_t file_offset, size_t
 size_t OatWriter::WriteCodeDexFiles(OutputStream* out,
                                     const size_t file_offset,
                                     size_t relative_offset) {
-  #define VISIT(VisitorType)                                              \
-    do {                                                                  \
-      VisitorType visitor(this, out, file_offset, relative_offset);       \
-      if (UNLIKELY(!VisitDexMethods(&visitor))) {                         \
-        return 0;                                                         \
-      }                                                                   \
-      relative_offset = visitor.GetOffset();                              \
-    } while (false)
-
-  VISIT(WriteCodeMethodVisitor);
-
-  #undef VISIT
+  {
+    WriteCodeMethodVisitor visitor(this, out, file_offset, relative_offset);
+    for (uint8_t tier = first_code_tier_; tier != kCodeTierCount; ++tier) {
+      visitor.StartCodeTier(static_cast<CodeTier>(tier));
+      if (UNLIKELY(!VisitDexMethods(&visitor))) {
+        return 0;
+      }
+    }
+    relative_offset = visitor.GetOffset();
+  }
 
   size_code_alignment_ += relative_patcher_->CodeAlignmentSize();
   size_relative_call_thunks_ += relative_patcher_->RelativeCallThunksSize();
@@ -1405,6 +1584,7 @@ OatWriter::OatDexFile::OatDexFile(size_t offset, const DexFile& dex_file) {
   dex_file_location_data_ = reinterpret_cast<const uint8_t*>(location.data());
   dex_file_location_checksum_ = dex_file.GetLocationChecksum();
   dex_file_offset_ = 0;
+  lookup_table_offset_ = 0;
   methods_offsets_.resize(dex_file.NumClassDefs());
 }
 
@@ -1413,6 +1593,7 @@ size_t OatWriter::OatDexFile::SizeOf() const {
           + dex_file_location_size_
           + sizeof(dex_file_location_checksum_)
           + sizeof(dex_file_offset_)
+          + sizeof(lookup_table_offset_)
           + (sizeof(methods_offsets_[0]) * methods_offsets_.size());
 }
 
@@ -1421,6 +1602,10 @@ void OatWriter::OatDexFile::UpdateChecksum(OatHeader* oat_header) const {
   oat_header->UpdateChecksum(dex_file_location_data_, dex_file_location_size_);
   oat_header->UpdateChecksum(&dex_file_location_checksum_, sizeof(dex_file_location_checksum_));
   oat_header->UpdateChecksum(&dex_file_offset_, sizeof(dex_file_offset_));
+  oat_header->UpdateChecksum(&lookup_table_offset_, sizeof(lookup_table_offset_));
+  if (lookup_table_ != nullptr) {
+    oat_header->UpdateChecksum(lookup_table_->RawData(), lookup_table_->RawDataLength());
+  }
   oat_header->UpdateChecksum(&methods_offsets_[0],
                             sizeof(methods_offsets_[0]) * methods_offsets_.size());
 }
@@ -1449,6 +1634,11 @@ bool OatWriter::OatDexFile::Write(OatWriter* oat_writer,
     return false;
   }
   oat_writer->size_oat_dex_file_offset_ += sizeof(dex_file_offset_);
+  if (!out->WriteFully(&lookup_table_offset_, sizeof(lookup_table_offset_))) {
+    PLOG(ERROR) << "Failed to write lookup table offset to " << out->GetLocation();
+    return false;
+  }
+  oat_writer->size_oat_dex_file_lookup_table_offset_ += sizeof(lookup_table_offset_);
   if (!out->WriteFully(&methods_offsets_[0],
                       sizeof(methods_offsets_[0]) * methods_offsets_.size())) {
     PLOG(ERROR) << "Failed to write methods offsets to " << out->GetLocation();
@@ -27,6 +27,7 @@
 #include "oat.h"
 #include "mirror/class.h"
 #include "safe_map.h"
+#include "type_lookup_table.h"
 
 namespace art {
 
@@ -74,8 +75,8 @@ class TimingLogger;
 // OatMethodHeader   fixed size header for a CompiledMethod including the size of the MethodCode.
 // MethodCode        one variable sized blob with the code of a CompiledMethod.
 // OatMethodHeader   (OatMethodHeader, MethodCode) pairs are deduplicated.
-// MethodCode
-// ...
+// MethodCode        With a profile, the code of hot methods comes first, then warm and
+// ...               then cold methods, each group in definition order.
 // OatMethodHeader
 // MethodCode
 //
@@ -139,6 +140,17 @@ class OatWriter {
   struct MappingTableDataAccess;
   struct VmapTableDataAccess;
 
+  // Code is grouped by profile hotness so that the code run at startup is contiguous.
+  // Hot methods are in the top K% of the profile samples, warm methods have been sampled
+  // at least once and cold methods have not been sampled. Without a profile all methods
+  // are cold, i.e. the code is laid out in definition order.
+  enum CodeTier : uint8_t {
+    kCodeTierHot,
+    kCodeTierWarm,
+    kCodeTierCold,
+    kCodeTierCount
+  };
+
   // The function VisitDexMethods() below iterates through all the methods in all
   // the compiled dex files in order of their definitions. The method visitor
   // classes provide individual bits of processing for each of the passes we need to
@@ -147,6 +159,7 @@ class OatWriter {
   class DexMethodVisitor;
   class OatDexMethodVisitor;
   class InitOatClassesMethodVisitor;
+  class InitCodeTiersTask;
   class InitCodeMethodVisitor;
   template <typename DataAccess>
   class InitMapMethodVisitor;
@@ -162,7 +175,9 @@ class OatWriter {
   size_t InitOatHeader();
   size_t InitOatDexFiles(size_t offset);
   size_t InitDexFiles(size_t offset);
+  size_t InitLookupTables(size_t offset);
   size_t InitOatClasses(size_t offset);
+  void InitCodeTiers();
   size_t InitOatMaps(size_t offset);
   size_t InitOatCode(size_t offset)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -192,8 +207,12 @@ class OatWriter {
     const uint8_t* dex_file_location_data_;
     uint32_t dex_file_location_checksum_;
     uint32_t dex_file_offset_;
+    uint32_t lookup_table_offset_;
     std::vector<uint32_t> methods_offsets_;
 
+    // Class lookup table written after the dex files, null if the dex file has no classes.
+    std::unique_ptr<TypeLookupTable> lookup_table_;
+
    private:
     DISALLOW_COPY_AND_ASSIGN(OatDexFile);
   };
@@ -216,6 +235,14 @@ class OatWriter {
       return compiled_methods_[class_def_method_index];
     }
 
+    CodeTier GetCodeTier(size_t method_offsets_index) const {
+      if (method_code_tiers_.empty()) {
+        return kCodeTierCold;
+      }
+      DCHECK_LT(method_offsets_index, method_code_tiers_.size());
+      return static_cast<CodeTier>(method_code_tiers_[method_offsets_index]);
+    }
+
     // Offset of start of OatClass from beginning of OatHeader. It is
     // used to validate file position when writing.
     size_t offset_;
@@ -254,6 +281,10 @@ class OatWriter {
     std::vector<OatMethodOffsets> method_offsets_;
     std::vector<OatQuickMethodHeader> method_headers_;
 
+    // CodeTier for each CompiledMethod present in the OatClass, indexed like method_offsets_.
+    // Empty if there is no profile.
+    std::vector<uint8_t> method_code_tiers_;
+
    private:
     DISALLOW_COPY_AND_ASSIGN(OatClass);
   };
@@ -275,6 +306,9 @@ class OatWriter {
   // Offset of the oat data from the start of the mmapped region of the elf file.
   size_t oat_data_offset_;
 
+  // The first CodeTier that has any methods, kCodeTierCold if there is no profile.
+  CodeTier first_code_tier_;
+
   // dependencies on the image.
   uint32_t image_file_location_oat_checksum_;
   uintptr_t image_file_location_oat_begin_;
@@ -319,7 +353,10 @@ class OatWriter {
   uint32_t size_oat_dex_file_location_data_;
   uint32_t size_oat_dex_file_location_checksum_;
   uint32_t size_oat_dex_file_offset_;
+  uint32_t size_oat_dex_file_lookup_table_offset_;
   uint32_t size_oat_dex_file_methods_offsets_;
+  uint32_t size_oat_lookup_table_alignment_;
+  uint32_t size_oat_lookup_table_;
   uint32_t size_oat_class_type_;
   uint32_t size_oat_class_status_;
   uint32_t size_oat_class_method_bitmaps_;
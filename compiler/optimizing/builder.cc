@@ -22,6 +22,7 @@
 #include "dex/verified_method.h"
 #include "dex_file-inl.h"
 #include "dex_instruction-inl.h"
+#include "dex_instruction_utils.h"
 #include "dex/verified_method.h"
 #include "driver/compiler_driver-inl.h"
 #include "driver/compiler_options.h"
@@ -29,6 +30,7 @@
 #include "mirror/dex_cache.h"
 #include "nodes.h"
 #include "primitive.h"
+#include "runtime.h"
 #include "scoped_thread_state_change.h"
 #include "thread.h"
 
@@ -230,6 +232,29 @@ void HGraphBuilder::MaybeRecordStat(MethodCompilationStat compilation_stat) {
   }
 }
 
+const DexFileReference* HGraphBuilder::GetDequickenedReference(uint32_t dex_pc) {
+  // The verifier only records the accessed fields and methods for the JIT, which compiles
+  // methods that have been quickened by the dex-to-dex compiler.
+  if (dex_compilation_unit_ == nullptr) {
+    return nullptr;
+  }
+  const DexFileReference* reference = nullptr;
+  if (Runtime::Current()->UseJit()) {
+    const VerifiedMethod* verified_method =
+        compiler_driver_->GetVerifiedMethod(dex_file_, dex_compilation_unit_->GetDexMethodIndex());
+    if (verified_method != nullptr) {
+      reference = verified_method->GetDequickenIndex(dex_pc);
+    }
+  }
+  if (reference == nullptr) {
+    VLOG(compiler) << "Did not compile "
+                   << PrettyMethod(dex_compilation_unit_->GetDexMethodIndex(), *dex_file_)
+                   << " because of a quickened instruction without dequickening info";
+    MaybeRecordStat(MethodCompilationStat::kNotCompiledNoDequickenInfo);
+  }
+  return reference;
+}
+
 bool HGraphBuilder::SkipCompilation(const DexFile::CodeItem& code_item,
                                     size_t number_of_branches) {
   const CompilerOptions& compiler_options = compiler_driver_->GetCompilerOptions();
@@ -330,6 +355,9 @@ bool HGraphBuilder::BuildGraph(const DexFile::CodeItem& code_item) {
   exit_block_->AddInstruction(new (arena_) HExit());
   // Add the suspend check to the entry block.
   entry_block_->AddInstruction(new (arena_) HSuspendCheck(0));
+  if (IsJitBaseline()) {
+    entry_block_->AddInstruction(new (arena_) HCountHotness());
+  }
   entry_block_->AddInstruction(new (arena_) HGoto());
 
   return true;
@@ -586,6 +614,8 @@ bool HGraphBuilder::BuildInvoke(const Instruction& instruction,
       break;
     case Instruction::INVOKE_VIRTUAL:
     case Instruction::INVOKE_VIRTUAL_RANGE:
+    case Instruction::INVOKE_VIRTUAL_QUICK:
+    case Instruction::INVOKE_VIRTUAL_RANGE_QUICK:
       invoke_type = kVirtual;
       break;
     case Instruction::INVOKE_INTERFACE:
@@ -601,9 +631,25 @@ bool HGraphBuilder::BuildInvoke(const Instruction& instruction,
       return false;
   }
 
-  const DexFile::MethodId& method_id = dex_file_->GetMethodId(method_idx);
-  const DexFile::ProtoId& proto_id = dex_file_->GetProtoId(method_id.proto_idx_);
-  const char* descriptor = dex_file_->StringDataByIdx(proto_id.shorty_idx_);
+  // A quickened invoke holds the vtable index of the called method instead of its index.
+  const DexFile* method_dex_file = dex_file_;
+  int vtable_index = -1;
+  if (IsInstructionQuickInvoke(opcode)) {
+    const DexFileReference* method_reference = GetDequickenedReference(dex_pc);
+    if (method_reference == nullptr) {
+      return false;
+    }
+    vtable_index = method_idx;
+    method_dex_file = method_reference->dex_file;
+    method_idx = method_reference->index;
+  }
+  // A method of another dex file has no index in the dex file of the compiled method, so the
+  // call is kept virtual and is not considered for intrinsics.
+  const bool is_other_dex_file = (method_dex_file != dex_file_);
+
+  const DexFile::MethodId& method_id = method_dex_file->GetMethodId(method_idx);
+  const DexFile::ProtoId& proto_id = method_dex_file->GetProtoId(method_id.proto_idx_);
+  const char* descriptor = method_dex_file->StringDataByIdx(proto_id.shorty_idx_);
   Primitive::Type return_type = Primitive::GetType(descriptor[0]);
   bool is_instance_call = invoke_type != kStatic;
   // Remove the return type from the 'proto'.
@@ -619,9 +665,13 @@ bool HGraphBuilder::BuildInvoke(const Instruction& instruction,
   int table_index;
   InvokeType optimized_invoke_type = invoke_type;
 
-  if (!compiler_driver_->ComputeInvokeInfo(dex_compilation_unit_, dex_pc, true, true,
-                                           &optimized_invoke_type, &target_method, &table_index,
-                                           &direct_code, &direct_method)) {
+  if (is_other_dex_file) {
+    DCHECK_NE(vtable_index, -1);
+    table_index = vtable_index;
+    method_idx = DexFile::kDexNoIndex;
+  } else if (!compiler_driver_->ComputeInvokeInfo(dex_compilation_unit_, dex_pc, true, true,
+                                                  &optimized_invoke_type, &target_method,
+                                                  &table_index, &direct_code, &direct_method)) {
     VLOG(compiler) << "Did not compile "
                    << PrettyMethod(dex_compilation_unit_->GetDexMethodIndex(), *dex_file_)
                    << " because a method call could not be resolved";
@@ -638,7 +688,8 @@ bool HGraphBuilder::BuildInvoke(const Instruction& instruction,
   HClinitCheck* clinit_check = nullptr;
   // Replace calls to String.<init> with StringFactory.
   int32_t string_init_offset = 0;
-  bool is_string_init = compiler_driver_->IsStringInit(method_idx, dex_file_, &string_init_offset);
+  bool is_string_init = !is_other_dex_file &&
+      compiler_driver_->IsStringInit(method_idx, dex_file_, &string_init_offset);
   if (is_string_init) {
     return_type = Primitive::kPrimNot;
     is_instance_call = false;
@@ -828,11 +879,32 @@ bool HGraphBuilder::BuildInstanceFieldAccess(const Instruction& instruction,
                                              bool is_put) {
   uint32_t source_or_dest_reg = instruction.VRegA_22c();
   uint32_t obj_reg = instruction.VRegB_22c();
-  uint16_t field_index = instruction.VRegC_22c();
+  uint32_t field_index = instruction.VRegC_22c();
 
   ScopedObjectAccess soa(Thread::Current());
-  ArtField* resolved_field =
-      compiler_driver_->ComputeInstanceFieldInfo(field_index, dex_compilation_unit_, is_put, soa);
+  ArtField* resolved_field;
+  if (IsInstructionIGetQuickOrIPutQuick(instruction.Opcode())) {
+    // A quickened access holds the offset of the field instead of its index. The verifier has
+    // already checked the access, and the dex-to-dex compiler only quickens non-volatile fields.
+    const DexFileReference* field_reference = GetDequickenedReference(dex_pc);
+    if (field_reference == nullptr) {
+      return false;
+    }
+    StackHandleScope<2> hs(soa.Self());
+    Handle<mirror::DexCache> dex_cache(hs.NewHandle(
+        compiler_driver_->FindDexCache(field_reference->dex_file)));
+    Handle<mirror::ClassLoader> class_loader(hs.NewHandle(
+        soa.Decode<mirror::ClassLoader*>(dex_compilation_unit_->GetClassLoader())));
+    resolved_field = compiler_driver_->ResolveFieldWithDexFile(
+        soa, dex_cache, class_loader, field_reference->dex_file, field_reference->index, false);
+    DCHECK(resolved_field == nullptr || resolved_field->GetOffset().Uint32Value() == field_index);
+    field_index = (field_reference->dex_file == dex_file_)
+        ? field_reference->index
+        : DexFile::kDexNoIndex;
+  } else {
+    resolved_field =
+        compiler_driver_->ComputeInstanceFieldInfo(field_index, dex_compilation_unit_, is_put, soa);
+  }
 
   if (resolved_field == nullptr) {
     MaybeRecordStat(MethodCompilationStat::kNotCompiledUnresolvedField);
@@ -1312,9 +1384,17 @@ void HGraphBuilder::PotentiallyAddSuspendCheck(HBasicBlock* target, uint32_t dex
     // Add a suspend check to backward branches which may potentially loop. We
     // can remove them after we recognize loops in the graph.
     current_block_->AddInstruction(new (arena_) HSuspendCheck(dex_pc));
+    if (IsJitBaseline()) {
+      // Like the interpreter, count loop iterations as well as invocations.
+      current_block_->AddInstruction(new (arena_) HCountHotness());
+    }
   }
 }
 
+bool HGraphBuilder::IsJitBaseline() const {
+  return compiler_driver_ != nullptr && compiler_driver_->GetCompilerOptions().IsJitBaseline();
+}
+
 bool HGraphBuilder::AnalyzeDexInstruction(const Instruction& instruction, uint32_t dex_pc) {
   if (current_block_ == nullptr) {
     return true;  // Dead code
@@ -1412,7 +1492,9 @@ bool HGraphBuilder::AnalyzeDexInstruction(const Instruction& instruction, uint32
       break;
     }
 
-    case Instruction::RETURN_VOID: {
+    case Instruction::RETURN_VOID:
+    case Instruction::RETURN_VOID_NO_BARRIER: {
+      // The dex-to-dex compiler only removes the barrier where none is required.
       BuildReturn(instruction, Primitive::kPrimVoid);
       break;
     }
@@ -1460,7 +1542,8 @@ bool HGraphBuilder::AnalyzeDexInstruction(const Instruction& instruction, uint32
     case Instruction::INVOKE_INTERFACE:
     case Instruction::INVOKE_STATIC:
     case Instruction::INVOKE_SUPER:
-    case Instruction::INVOKE_VIRTUAL: {
+    case Instruction::INVOKE_VIRTUAL:
+    case Instruction::INVOKE_VIRTUAL_QUICK: {
       uint32_t method_idx = instruction.VRegB_35c();
       uint32_t number_of_vreg_arguments = instruction.VRegA_35c();
       uint32_t args[5];
@@ -1476,7 +1559,8 @@ bool HGraphBuilder::AnalyzeDexInstruction(const Instruction& instruction, uint32
     case Instruction::INVOKE_INTERFACE_RANGE:
     case Instruction::INVOKE_STATIC_RANGE:
     case Instruction::INVOKE_SUPER_RANGE:
-    case Instruction::INVOKE_VIRTUAL_RANGE: {
+    case Instruction::INVOKE_VIRTUAL_RANGE:
+    case Instruction::INVOKE_VIRTUAL_RANGE_QUICK: {
       uint32_t method_idx = instruction.VRegB_3rc();
       uint32_t number_of_vreg_arguments = instruction.VRegA_3rc();
       uint32_t register_index = instruction.VRegC();
@@ -2108,7 +2192,14 @@ bool HGraphBuilder::AnalyzeDexInstruction(const Instruction& instruction, uint32
     case Instruction::IGET_BOOLEAN:
     case Instruction::IGET_BYTE:
     case Instruction::IGET_CHAR:
-    case Instruction::IGET_SHORT: {
+    case Instruction::IGET_SHORT:
+    case Instruction::IGET_QUICK:
+    case Instruction::IGET_WIDE_QUICK:
+    case Instruction::IGET_OBJECT_QUICK:
+    case Instruction::IGET_BOOLEAN_QUICK:
+    case Instruction::IGET_BYTE_QUICK:
+    case Instruction::IGET_CHAR_QUICK:
+    case Instruction::IGET_SHORT_QUICK: {
       if (!BuildInstanceFieldAccess(instruction, dex_pc, false)) {
         return false;
       }
@@ -2121,7 +2212,14 @@ bool HGraphBuilder::AnalyzeDexInstruction(const Instruction& instruction, uint32
     case Instruction::IPUT_BOOLEAN:
     case Instruction::IPUT_BYTE:
     case Instruction::IPUT_CHAR:
-    case Instruction::IPUT_SHORT: {
+    case Instruction::IPUT_SHORT:
+    case Instruction::IPUT_QUICK:
+    case Instruction::IPUT_WIDE_QUICK:
+    case Instruction::IPUT_OBJECT_QUICK:
+    case Instruction::IPUT_BOOLEAN_QUICK:
+    case Instruction::IPUT_BYTE_QUICK:
+    case Instruction::IPUT_CHAR_QUICK:
+    case Instruction::IPUT_SHORT_QUICK: {
       if (!BuildInstanceFieldAccess(instruction, dex_pc, true)) {
         return false;
       }
@@ -102,6 +102,8 @@ class HGraphBuilder : public ValueObject {
   void UpdateLocal(int register_index, HInstruction* instruction) const;
   HInstruction* LoadLocal(int register_index, Primitive::Type type) const;
   void PotentiallyAddSuspendCheck(HBasicBlock* target, uint32_t dex_pc);
+  // Whether the code counts the hotness of the method for the JIT, see HCountHotness.
+  bool IsJitBaseline() const;
   void InitializeParameters(uint16_t number_of_parameters);
   bool NeedsAccessCheck(uint32_t type_index) const;
 
@@ -225,6 +227,10 @@ class HGraphBuilder : public ValueObject {
 
   void MaybeRecordStat(MethodCompilationStat compilation_stat);
 
+  // Returns the field or method accessed by the quickened instruction at `dex_pc`, as recorded
+  // by the verifier, or null if the verifier did not record it.
+  const DexFileReference* GetDequickenedReference(uint32_t dex_pc);
+
   // Returns the outer-most compiling method's class.
   mirror::Class* GetOutermostCompilingClass() const;
 
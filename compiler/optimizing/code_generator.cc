@@ -25,6 +25,7 @@
 #include "dex/verified_method.h"
 #include "driver/dex_compilation_unit.h"
 #include "gc_map_builder.h"
+#include "graph_visualizer.h"
 #include "leb128.h"
 #include "mapping_table.h"
 #include "mirror/array-inl.h"
@@ -120,6 +121,36 @@ size_t CodeGenerator::GetCachePointerOffset(uint32_t index) {
   return mirror::Array::DataOffset(pointer_size).Uint32Value() + pointer_size * index;
 }
 
+// Arrays allocated inline are kept well below the large object threshold, so that the
+// fast path never has to consider the large object space.
+static constexpr size_t kMaxInlineArrayAllocationSize = 1 * KB;
+
+bool CodeGenerator::CanInlineAllocation(HNewInstance* new_instance) const {
+  // The inline sequence does not install the Brooks forwarding pointer. Allocations that
+  // need an access check always go through the entrypoint.
+  return compiler_options_.GetInlineAllocation() &&
+      !kUseBrooksReadBarrier &&
+      new_instance->GetEntrypoint() == kQuickAllocObject;
+}
+
+bool CodeGenerator::CanInlineAllocation(HNewArray* new_array) const {
+  return compiler_options_.GetInlineAllocation() &&
+      !kUseBrooksReadBarrier &&
+      new_array->GetEntrypoint() == kQuickAllocArray;
+}
+
+size_t CodeGenerator::GetArrayComponentSizeShift(HNewArray* new_array) const {
+  const char* descriptor = graph_->GetDexFile().StringByTypeIdx(new_array->GetTypeIndex());
+  DCHECK_EQ(descriptor[0], '[') << descriptor;
+  return Primitive::ComponentSizeShift(Primitive::GetType(descriptor[1]));
+}
+
+uint32_t CodeGenerator::GetMaxInlineArrayLength(HNewArray* new_array) const {
+  size_t component_size_shift = GetArrayComponentSizeShift(new_array);
+  size_t data_offset = mirror::Array::DataOffset(1u << component_size_shift).Uint32Value();
+  return (kMaxInlineArrayAllocationSize - data_offset) >> component_size_shift;
+}
+
 void CodeGenerator::CompileBaseline(CodeAllocator* allocator, bool is_leaf) {
   Initialize();
   if (!is_leaf) {
@@ -163,8 +194,12 @@ void CodeGenerator::CompileInternal(CodeAllocator* allocator, bool is_baseline)
   is_baseline_ = is_baseline;
   HGraphVisitor* instruction_visitor = GetInstructionVisitor();
   DCHECK_EQ(current_block_index_, 0u);
+  size_t frame_start = GetAssembler()->CodeSize();
   GenerateFrameEntry();
   DCHECK_EQ(GetAssembler()->cfi().GetCurrentCFAOffset(), static_cast<int>(frame_size_));
+  if (disasm_info_ != nullptr) {
+    disasm_info_->SetFrameEntryInterval(frame_start, GetAssembler()->CodeSize());
+  }
   for (size_t e = block_order_->Size(); current_block_index_ < e; ++current_block_index_) {
     HBasicBlock* block = block_order_->Get(current_block_index_);
     // Don't generate code for an empty block. Its predecessors will branch to its successor
@@ -178,13 +213,26 @@ void CodeGenerator::CompileInternal(CodeAllocator* allocator, bool is_baseline)
         InitLocationsBaseline(current);
       }
       DCHECK(CheckTypeConsistency(current));
+      size_t start = GetAssembler()->CodeSize();
+      size_t number_of_slow_paths = slow_paths_.Size();
       current->Accept(instruction_visitor);
+      if (disasm_info_ != nullptr) {
+        disasm_info_->AddInstructionInterval(current, start, GetAssembler()->CodeSize());
+        for (size_t i = number_of_slow_paths, e = slow_paths_.Size(); i < e; ++i) {
+          disasm_info_->AddSlowPath(slow_paths_.Get(i), current);
+        }
+      }
     }
   }
 
   // Generate the slow paths.
   for (size_t i = 0, e = slow_paths_.Size(); i < e; ++i) {
-    slow_paths_.Get(i)->EmitNativeCode(this);
+    SlowPathCode* slow_path = slow_paths_.Get(i);
+    size_t start = GetAssembler()->CodeSize();
+    slow_path->EmitNativeCode(this);
+    if (disasm_info_ != nullptr) {
+      disasm_info_->SetSlowPathInterval(slow_path, start, GetAssembler()->CodeSize());
+    }
   }
 
   // Finalize instructions in assember;
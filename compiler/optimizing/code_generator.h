@@ -42,6 +42,7 @@ static int64_t constexpr kPrimLongMax = 0x7fffffffffffffff;
 class Assembler;
 class CodeGenerator;
 class DexCompilationUnit;
+class DisassemblyInformation;
 class ParallelMoveResolver;
 class SrcMapElem;
 template <class Alloc>
@@ -224,6 +225,10 @@ class CodeGenerator {
     slow_paths_.Add(slow_path);
   }
 
+  // Makes the code generation record where the code of each instruction and slow path goes.
+  void SetDisassemblyInformation(DisassemblyInformation* info) { disasm_info_ = info; }
+  const DisassemblyInformation* GetDisassemblyInformation() const { return disasm_info_; }
+
   void BuildSourceMap(DefaultSrcMap* src_map) const;
   void BuildMappingTable(std::vector<uint8_t>* vector) const;
   void BuildVMapTable(std::vector<uint8_t>* vector) const;
@@ -269,6 +274,18 @@ class CodeGenerator {
   // Pointer variant for ArtMethod and ArtField arrays.
   size_t GetCachePointerOffset(uint32_t index);
 
+  // Returns whether the allocation can be emitted as an inline bump pointer allocation in
+  // the thread-local allocation buffer, calling the entrypoint only on the slow path.
+  bool CanInlineAllocation(HNewInstance* new_instance) const;
+  bool CanInlineAllocation(HNewArray* new_array) const;
+
+  // Returns the component size shift of the array allocated by `new_array`.
+  size_t GetArrayComponentSizeShift(HNewArray* new_array) const;
+
+  // Returns the largest length of an array allocated inline by `new_array`. Longer arrays,
+  // and negative lengths once compared unsigned, take the slow path.
+  uint32_t GetMaxInlineArrayLength(HNewArray* new_array) const;
+
   void EmitParallelMoves(Location from1,
                          Location to1,
                          Primitive::Type type1,
@@ -356,6 +373,7 @@ class CodeGenerator {
         compiler_options_(compiler_options),
         pc_infos_(graph->GetArena(), 32),
         slow_paths_(graph->GetArena(), 8),
+        disasm_info_(nullptr),
         block_order_(nullptr),
         current_block_index_(0),
         is_leaf_(true),
@@ -445,6 +463,9 @@ class CodeGenerator {
   GrowableArray<PcInfo> pc_infos_;
   GrowableArray<SlowPathCode*> slow_paths_;
 
+  // Filled in during code generation when the graph visualizer dumps the disassembly.
+  DisassemblyInformation* disasm_info_;
+
   // The order to use for code generation.
   const GrowableArray<HBasicBlock*>* block_order_;
 
@@ -240,6 +240,73 @@ class LoadStringSlowPathARM : public SlowPathCodeARM {
   DISALLOW_COPY_AND_ASSIGN(LoadStringSlowPathARM);
 };
 
+class NewInstanceSlowPathARM : public SlowPathCodeARM {
+ public:
+  explicit NewInstanceSlowPathARM(HNewInstance* instruction) : instruction_(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+
+    CodeGeneratorARM* arm_codegen = down_cast<CodeGeneratorARM*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    arm_codegen->LoadCurrentMethod(calling_convention.GetRegisterAt(1));
+    __ LoadImmediate(calling_convention.GetRegisterAt(0), instruction_->GetTypeIndex());
+    arm_codegen->InvokeRuntime(
+        GetThreadOffset<kArmWordSize>(instruction_->GetEntrypoint()).Int32Value(),
+        instruction_,
+        instruction_->GetDexPc(),
+        this);
+    arm_codegen->Move32(locations->Out(), Location::RegisterLocation(R0));
+
+    RestoreLiveRegisters(codegen, locations);
+    __ b(GetExitLabel());
+  }
+
+ private:
+  HNewInstance* const instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewInstanceSlowPathARM);
+};
+
+class NewArraySlowPathARM : public SlowPathCodeARM {
+ public:
+  explicit NewArraySlowPathARM(HNewArray* instruction) : instruction_(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+
+    CodeGeneratorARM* arm_codegen = down_cast<CodeGeneratorARM*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    // Move the length first, as it may live in one of the other argument registers.
+    InvokeRuntimeCallingConvention calling_convention;
+    arm_codegen->Move32(Location::RegisterLocation(calling_convention.GetRegisterAt(1)),
+                        locations->InAt(0));
+    arm_codegen->LoadCurrentMethod(calling_convention.GetRegisterAt(2));
+    __ LoadImmediate(calling_convention.GetRegisterAt(0), instruction_->GetTypeIndex());
+    arm_codegen->InvokeRuntime(
+        GetThreadOffset<kArmWordSize>(instruction_->GetEntrypoint()).Int32Value(),
+        instruction_,
+        instruction_->GetDexPc(),
+        this);
+    arm_codegen->Move32(locations->Out(), Location::RegisterLocation(R0));
+
+    RestoreLiveRegisters(codegen, locations);
+    __ b(GetExitLabel());
+  }
+
+ private:
+  HNewArray* const instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewArraySlowPathARM);
+};
+
 class TypeCheckSlowPathARM : public SlowPathCodeARM {
  public:
   TypeCheckSlowPathARM(HInstruction* instruction,
@@ -1219,6 +1286,26 @@ void InstructionCodeGeneratorARM::VisitMemoryBarrier(HMemoryBarrier* memory_barr
   GenerateMemoryBarrier(memory_barrier->GetBarrierKind());
 }
 
+void LocationsBuilderARM::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorARM::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register method = locations->GetTemp(0).AsRegister<Register>();
+  Register count = locations->GetTemp(1).AsRegister<Register>();
+  const int32_t offset = ArtMethod::HotnessCountOffset().Int32Value();
+  codegen_->LoadCurrentMethod(method);
+  Label done;
+  __ LoadFromOffset(kLoadUnsignedHalfword, count, method, offset);
+  __ CompareAndBranchIfZero(count, &done);
+  __ AddConstant(count, -1);
+  __ StoreToOffset(kStoreHalfword, count, method, offset);
+  __ Bind(&done);
+}
+
 void LocationsBuilderARM::VisitReturnVoid(HReturnVoid* ret) {
   ret->SetLocations(nullptr);
 }
@@ -2563,6 +2650,14 @@ void InstructionCodeGeneratorARM::VisitUShr(HUShr* ushr) {
 }
 
 void LocationsBuilderARM::VisitNewInstance(HNewInstance* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations =
+        new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister());
+    return;
+  }
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
@@ -2572,6 +2667,39 @@ void LocationsBuilderARM::VisitNewInstance(HNewInstance* instruction) {
 }
 
 void InstructionCodeGeneratorARM::VisitNewInstance(HNewInstance* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations = instruction->GetLocations();
+    Register out = locations->Out().AsRegister<Register>();
+    Register cls = locations->GetTemp(0).AsRegister<Register>();
+    Register temp = locations->GetTemp(1).AsRegister<Register>();
+    SlowPathCodeARM* slow_path = new (GetGraph()->GetArena()) NewInstanceSlowPathARM(instruction);
+    codegen_->AddSlowPath(slow_path);
+
+    // Classes that are unresolved, not yet initialized or finalizable go to the entrypoint.
+    codegen_->LoadCurrentMethod(cls);
+    __ LoadFromOffset(
+        kLoadWord, cls, cls, ArtMethod::DexCacheResolvedTypesOffset().Int32Value());
+    __ LoadFromOffset(
+        kLoadWord, cls, cls, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex()));
+    __ CompareAndBranchIfZero(cls, slow_path->GetEntryLabel());
+    __ LoadFromOffset(kLoadWord, IP, cls, mirror::Class::StatusOffset().Int32Value());
+    __ cmp(IP, ShifterOperand(mirror::Class::kStatusInitialized));
+    __ b(slow_path->GetEntryLabel(), LT);
+    // Pairs with the release of the initialized status, as for a class initialization check.
+    __ dmb(ISH);
+    __ LoadFromOffset(kLoadWord, temp, cls, mirror::Class::AccessFlagsOffset().Int32Value());
+    __ tst(temp, ShifterOperand(kAccClassIsFinalizable));
+    __ b(slow_path->GetEntryLabel(), NE);
+    __ LoadFromOffset(kLoadWord, temp, cls, mirror::Class::ObjectSizeOffset().Int32Value());
+    __ AddConstant(temp, temp, kObjectAlignment - 1);
+    __ bic(temp, temp, ShifterOperand(kObjectAlignment - 1));
+    GenerateTlabAllocation(out, temp, slow_path);
+    __ StoreToOffset(kStoreWord, cls, out, mirror::Object::ClassOffset().Int32Value());
+    // Publish the class before the reference to the new object.
+    GenerateMemoryBarrier(MemBarrierKind::kStoreStore);
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   InvokeRuntimeCallingConvention calling_convention;
   codegen_->LoadCurrentMethod(calling_convention.GetRegisterAt(1));
   __ LoadImmediate(calling_convention.GetRegisterAt(0), instruction->GetTypeIndex());
@@ -2582,6 +2710,15 @@ void InstructionCodeGeneratorARM::VisitNewInstance(HNewInstance* instruction) {
 }
 
 void LocationsBuilderARM::VisitNewArray(HNewArray* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations =
+        new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister());
+    locations->SetInAt(0, Location::RequiresRegister());
+    return;
+  }
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
@@ -2592,6 +2729,43 @@ void LocationsBuilderARM::VisitNewArray(HNewArray* instruction) {
 }
 
 void InstructionCodeGeneratorARM::VisitNewArray(HNewArray* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations = instruction->GetLocations();
+    Register length = locations->InAt(0).AsRegister<Register>();
+    Register out = locations->Out().AsRegister<Register>();
+    Register cls = locations->GetTemp(0).AsRegister<Register>();
+    Register temp = locations->GetTemp(1).AsRegister<Register>();
+    SlowPathCodeARM* slow_path = new (GetGraph()->GetArena()) NewArraySlowPathARM(instruction);
+    codegen_->AddSlowPath(slow_path);
+
+    // Array classes are initialized when they are created, so only an unresolved class or
+    // a negative or large length goes to the entrypoint.
+    size_t component_size_shift = codegen_->GetArrayComponentSizeShift(instruction);
+    uint32_t data_offset = mirror::Array::DataOffset(1u << component_size_shift).Uint32Value();
+    codegen_->LoadCurrentMethod(cls);
+    __ LoadFromOffset(
+        kLoadWord, cls, cls, ArtMethod::DexCacheResolvedTypesOffset().Int32Value());
+    __ LoadFromOffset(
+        kLoadWord, cls, cls, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex()));
+    __ CompareAndBranchIfZero(cls, slow_path->GetEntryLabel());
+    __ LoadImmediate(IP, codegen_->GetMaxInlineArrayLength(instruction));
+    __ cmp(length, ShifterOperand(IP));
+    __ b(slow_path->GetEntryLabel(), HI);
+    __ LoadImmediate(temp, data_offset + kObjectAlignment - 1);
+    if (component_size_shift == 0) {
+      __ add(temp, temp, ShifterOperand(length));
+    } else {
+      __ add(temp, temp, ShifterOperand(length, LSL, component_size_shift));
+    }
+    __ bic(temp, temp, ShifterOperand(kObjectAlignment - 1));
+    GenerateTlabAllocation(out, temp, slow_path);
+    __ StoreToOffset(kStoreWord, cls, out, mirror::Object::ClassOffset().Int32Value());
+    __ StoreToOffset(kStoreWord, length, out, mirror::Array::LengthOffset().Int32Value());
+    // Publish the class and length before the reference to the new array.
+    GenerateMemoryBarrier(MemBarrierKind::kStoreStore);
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   InvokeRuntimeCallingConvention calling_convention;
   codegen_->LoadCurrentMethod(calling_convention.GetRegisterAt(2));
   __ LoadImmediate(calling_convention.GetRegisterAt(0), instruction->GetTypeIndex());
@@ -3803,6 +3977,26 @@ void InstructionCodeGeneratorARM::VisitClinitCheck(HClinitCheck* check) {
                                    check->GetLocations()->InAt(0).AsRegister<Register>());
 }
 
+void InstructionCodeGeneratorARM::GenerateTlabAllocation(Register out,
+                                                         Register size,
+                                                         SlowPathCodeARM* slow_path) {
+  // The inline end is null while the thread has no TLAB or while the allocation entrypoints
+  // are instrumented, so that the bounds check then always fails.
+  __ LoadFromOffset(kLoadWord, out, TR, Thread::ThreadLocalPosOffset<kArmWordSize>().Int32Value());
+  __ LoadFromOffset(
+      kLoadWord, IP, TR, Thread::ThreadLocalInlineEndOffset<kArmWordSize>().Int32Value());
+  __ add(size, size, ShifterOperand(out));
+  __ cmp(size, ShifterOperand(IP));
+  __ b(slow_path->GetEntryLabel(), HI);
+  __ StoreToOffset(
+      kStoreWord, size, TR, Thread::ThreadLocalPosOffset<kArmWordSize>().Int32Value());
+  __ LoadFromOffset(
+      kLoadWord, size, TR, Thread::ThreadLocalObjectsOffset<kArmWordSize>().Int32Value());
+  __ AddConstant(size, size, 1);
+  __ StoreToOffset(
+      kStoreWord, size, TR, Thread::ThreadLocalObjectsOffset<kArmWordSize>().Int32Value());
+}
+
 void InstructionCodeGeneratorARM::GenerateClassInitializationCheck(
     SlowPathCodeARM* slow_path, Register class_reg) {
   __ LoadFromOffset(kLoadWord, IP, class_reg, mirror::Class::StatusOffset().Int32Value());
@@ -175,6 +175,9 @@ class InstructionCodeGeneratorARM : public HGraphVisitor {
   // the suspend call.
   void GenerateSuspendCheck(HSuspendCheck* check, HBasicBlock* successor);
   void GenerateClassInitializationCheck(SlowPathCodeARM* slow_path, Register class_reg);
+  // Bumps the thread-local allocation pointer by `size`, which must be object aligned, and
+  // puts the allocated address in `out`. Clobbers `size` and IP.
+  void GenerateTlabAllocation(Register out, Register size, SlowPathCodeARM* slow_path);
   void HandleBitwiseOperation(HBinaryOperation* operation);
   void HandleShift(HBinaryOperation* operation);
   void GenerateMemoryBarrier(MemBarrierKind kind);
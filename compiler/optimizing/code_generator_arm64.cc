@@ -240,6 +240,78 @@ class LoadStringSlowPathARM64 : public SlowPathCodeARM64 {
   DISALLOW_COPY_AND_ASSIGN(LoadStringSlowPathARM64);
 };
 
+class NewInstanceSlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  explicit NewInstanceSlowPathARM64(HNewInstance* instruction) : instruction_(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+    CodeGeneratorARM64* arm64_codegen = down_cast<CodeGeneratorARM64*>(codegen);
+
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    arm64_codegen->LoadCurrentMethod(calling_convention.GetRegisterAt(1).X());
+    __ Mov(calling_convention.GetRegisterAt(0).W(), instruction_->GetTypeIndex());
+    arm64_codegen->InvokeRuntime(
+        GetThreadOffset<kArm64WordSize>(instruction_->GetEntrypoint()).Int32Value(),
+        instruction_,
+        instruction_->GetDexPc(),
+        this);
+    CheckEntrypointTypes<kQuickAllocObject, void*, uint32_t, ArtMethod*>();
+    Primitive::Type type = instruction_->GetType();
+    arm64_codegen->MoveLocation(locations->Out(), calling_convention.GetReturnLocation(type), type);
+
+    RestoreLiveRegisters(codegen, locations);
+    __ B(GetExitLabel());
+  }
+
+ private:
+  HNewInstance* const instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewInstanceSlowPathARM64);
+};
+
+class NewArraySlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  explicit NewArraySlowPathARM64(HNewArray* instruction) : instruction_(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+    CodeGeneratorARM64* arm64_codegen = down_cast<CodeGeneratorARM64*>(codegen);
+
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    // Move the length first, as it may live in one of the other argument registers.
+    InvokeRuntimeCallingConvention calling_convention;
+    arm64_codegen->MoveLocation(LocationFrom(calling_convention.GetRegisterAt(1)),
+                                locations->InAt(0),
+                                Primitive::kPrimInt);
+    arm64_codegen->LoadCurrentMethod(calling_convention.GetRegisterAt(2).X());
+    __ Mov(calling_convention.GetRegisterAt(0).W(), instruction_->GetTypeIndex());
+    arm64_codegen->InvokeRuntime(
+        GetThreadOffset<kArm64WordSize>(instruction_->GetEntrypoint()).Int32Value(),
+        instruction_,
+        instruction_->GetDexPc(),
+        this);
+    CheckEntrypointTypes<kQuickAllocArray, void*, uint32_t, int32_t, ArtMethod*>();
+    Primitive::Type type = instruction_->GetType();
+    arm64_codegen->MoveLocation(locations->Out(), calling_convention.GetReturnLocation(type), type);
+
+    RestoreLiveRegisters(codegen, locations);
+    __ B(GetExitLabel());
+  }
+
+ private:
+  HNewArray* const instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewArraySlowPathARM64);
+};
+
 class NullCheckSlowPathARM64 : public SlowPathCodeARM64 {
  public:
   explicit NullCheckSlowPathARM64(HNullCheck* instr) : instruction_(instr) {}
@@ -1011,6 +1083,26 @@ void InstructionCodeGeneratorARM64::GenerateClassInitializationCheck(SlowPathCod
   __ Bind(slow_path->GetExitLabel());
 }
 
+void InstructionCodeGeneratorARM64::GenerateTlabAllocation(vixl::Register out,
+                                                           vixl::Register size,
+                                                           SlowPathCodeARM64* slow_path) {
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  Register end = temps.AcquireX();
+  // The inline end is null while the thread has no TLAB or while the allocation entrypoints
+  // are instrumented, so that the bounds check then always fails.
+  __ Ldr(out.X(), MemOperand(tr, Thread::ThreadLocalPosOffset<kArm64WordSize>().Int32Value()));
+  __ Ldr(end, MemOperand(tr, Thread::ThreadLocalInlineEndOffset<kArm64WordSize>().Int32Value()));
+  __ Add(size.X(), out.X(), size.X());
+  __ Cmp(size.X(), end);
+  __ B(hi, slow_path->GetEntryLabel());
+  __ Str(size.X(), MemOperand(tr, Thread::ThreadLocalPosOffset<kArm64WordSize>().Int32Value()));
+  __ Ldr(size.X(),
+         MemOperand(tr, Thread::ThreadLocalObjectsOffset<kArm64WordSize>().Int32Value()));
+  __ Add(size.X(), size.X(), 1);
+  __ Str(size.X(),
+         MemOperand(tr, Thread::ThreadLocalObjectsOffset<kArm64WordSize>().Int32Value()));
+}
+
 void InstructionCodeGeneratorARM64::GenerateMemoryBarrier(MemBarrierKind kind) {
   BarrierType type = BarrierAll;
 
@@ -2279,6 +2371,15 @@ void InstructionCodeGeneratorARM64::VisitNeg(HNeg* neg) {
 }
 
 void LocationsBuilderARM64::VisitNewArray(HNewArray* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations =
+        new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister());
+    locations->SetInAt(0, Location::RequiresRegister());
+    return;
+  }
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
@@ -2292,6 +2393,36 @@ void LocationsBuilderARM64::VisitNewArray(HNewArray* instruction) {
 
 void InstructionCodeGeneratorARM64::VisitNewArray(HNewArray* instruction) {
   LocationSummary* locations = instruction->GetLocations();
+  if (codegen_->CanInlineAllocation(instruction)) {
+    Register length = InputRegisterAt(instruction, 0);
+    Register out = OutputRegister(instruction);
+    Register cls = WRegisterFrom(locations->GetTemp(0));
+    Register temp = WRegisterFrom(locations->GetTemp(1));
+    SlowPathCodeARM64* slow_path =
+        new (GetGraph()->GetArena()) NewArraySlowPathARM64(instruction);
+    codegen_->AddSlowPath(slow_path);
+
+    // Array classes are initialized when they are created, so only an unresolved class or
+    // a negative or large length goes to the entrypoint.
+    size_t component_size_shift = codegen_->GetArrayComponentSizeShift(instruction);
+    uint32_t data_offset = mirror::Array::DataOffset(1u << component_size_shift).Uint32Value();
+    codegen_->LoadCurrentMethod(cls.X());
+    __ Ldr(cls, MemOperand(cls.X(), ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ Ldr(cls, HeapOperand(cls, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ Cbz(cls, slow_path->GetEntryLabel());
+    __ Cmp(length, codegen_->GetMaxInlineArrayLength(instruction));
+    __ B(hi, slow_path->GetEntryLabel());
+    __ Lsl(temp, length, component_size_shift);
+    __ Add(temp, temp, data_offset + kObjectAlignment - 1);
+    __ And(temp, temp, ~static_cast<int32_t>(kObjectAlignment - 1));
+    GenerateTlabAllocation(out, temp, slow_path);
+    __ Str(cls, HeapOperand(out, mirror::Object::ClassOffset()));
+    __ Str(length, HeapOperand(out, mirror::Array::LengthOffset()));
+    // Publish the class and length before the reference to the new array.
+    GenerateMemoryBarrier(MemBarrierKind::kStoreStore);
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   InvokeRuntimeCallingConvention calling_convention;
   Register type_index = RegisterFrom(locations->GetTemp(0), Primitive::kPrimInt);
   DCHECK(type_index.Is(w0));
@@ -2308,6 +2439,14 @@ void InstructionCodeGeneratorARM64::VisitNewArray(HNewArray* instruction) {
 }
 
 void LocationsBuilderARM64::VisitNewInstance(HNewInstance* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations =
+        new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister());
+    return;
+  }
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
@@ -2319,6 +2458,37 @@ void LocationsBuilderARM64::VisitNewInstance(HNewInstance* instruction) {
 
 void InstructionCodeGeneratorARM64::VisitNewInstance(HNewInstance* instruction) {
   LocationSummary* locations = instruction->GetLocations();
+  if (codegen_->CanInlineAllocation(instruction)) {
+    Register out = OutputRegister(instruction);
+    Register cls = WRegisterFrom(locations->GetTemp(0));
+    Register temp = WRegisterFrom(locations->GetTemp(1));
+    SlowPathCodeARM64* slow_path =
+        new (GetGraph()->GetArena()) NewInstanceSlowPathARM64(instruction);
+    codegen_->AddSlowPath(slow_path);
+
+    // Classes that are unresolved, not yet initialized or finalizable go to the entrypoint.
+    codegen_->LoadCurrentMethod(cls.X());
+    __ Ldr(cls, MemOperand(cls.X(), ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ Ldr(cls, HeapOperand(cls, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ Cbz(cls, slow_path->GetEntryLabel());
+    __ Ldr(temp, HeapOperand(cls, mirror::Class::StatusOffset()));
+    __ Cmp(temp, mirror::Class::kStatusInitialized);
+    __ B(lt, slow_path->GetEntryLabel());
+    // Pairs with the release of the initialized status, as for a class initialization check.
+    __ Dmb(InnerShareable, BarrierReads);
+    __ Ldr(temp, HeapOperand(cls, mirror::Class::AccessFlagsOffset()));
+    __ Tst(temp, kAccClassIsFinalizable);
+    __ B(ne, slow_path->GetEntryLabel());
+    __ Ldr(temp, HeapOperand(cls, mirror::Class::ObjectSizeOffset()));
+    __ Add(temp, temp, kObjectAlignment - 1);
+    __ And(temp, temp, ~static_cast<int32_t>(kObjectAlignment - 1));
+    GenerateTlabAllocation(out, temp, slow_path);
+    __ Str(cls, HeapOperand(out, mirror::Object::ClassOffset()));
+    // Publish the class before the reference to the new object.
+    GenerateMemoryBarrier(MemBarrierKind::kStoreStore);
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   Register type_index = RegisterFrom(locations->GetTemp(0), Primitive::kPrimInt);
   DCHECK(type_index.Is(w0));
   Register current_method = RegisterFrom(locations->GetTemp(1), Primitive::kPrimNot);
@@ -2511,6 +2681,26 @@ void InstructionCodeGeneratorARM64::VisitMemoryBarrier(HMemoryBarrier* memory_ba
   GenerateMemoryBarrier(memory_barrier->GetBarrierKind());
 }
 
+void LocationsBuilderARM64::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorARM64::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register method = XRegisterFrom(locations->GetTemp(0));
+  Register count = WRegisterFrom(locations->GetTemp(1));
+  const MemOperand address(method, ArtMethod::HotnessCountOffset().Int32Value());
+  codegen_->LoadCurrentMethod(method);
+  vixl::Label done;
+  __ Ldrh(count, address);
+  __ Cbz(count, &done);
+  __ Sub(count, count, 1);
+  __ Strh(count, address);
+  __ Bind(&done);
+}
+
 void LocationsBuilderARM64::VisitReturn(HReturn* instruction) {
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
   Primitive::Type return_type = instruction->InputAt(0)->GetType();
@@ -153,6 +153,11 @@ class InstructionCodeGeneratorARM64 : public HGraphVisitor {
 
  private:
   void GenerateClassInitializationCheck(SlowPathCodeARM64* slow_path, vixl::Register class_reg);
+  // Bumps the thread-local allocation pointer by `size`, which must be object aligned, and
+  // puts the allocated address in `out`. Clobbers `size`.
+  void GenerateTlabAllocation(vixl::Register out,
+                              vixl::Register size,
+                              SlowPathCodeARM64* slow_path);
   void GenerateMemoryBarrier(MemBarrierKind kind);
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
   void HandleBinaryOp(HBinaryOperation* instr);
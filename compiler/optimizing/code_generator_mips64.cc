@@ -2916,6 +2916,26 @@ void InstructionCodeGeneratorMIPS64::VisitMemoryBarrier(HMemoryBarrier* memory_b
   GenerateMemoryBarrier(memory_barrier->GetBarrierKind());
 }
 
+void LocationsBuilderMIPS64::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorMIPS64::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  GpuRegister method = locations->GetTemp(0).AsRegister<GpuRegister>();
+  GpuRegister count = locations->GetTemp(1).AsRegister<GpuRegister>();
+  const int32_t offset = ArtMethod::HotnessCountOffset().Int32Value();
+  codegen_->LoadCurrentMethod(method);
+  Label done;
+  __ LoadFromOffset(kLoadUnsignedHalfword, count, method, offset);
+  __ Beqzc(count, &done);
+  __ Addiu(count, count, -1);
+  __ StoreToOffset(kStoreHalfword, count, method, offset);
+  __ Bind(&done);
+}
+
 void LocationsBuilderMIPS64::VisitReturn(HReturn* ret) {
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(ret);
   Primitive::Type return_type = ret->InputAt(0)->GetType();
@@ -193,6 +193,69 @@ class LoadStringSlowPathX86 : public SlowPathCodeX86 {
   DISALLOW_COPY_AND_ASSIGN(LoadStringSlowPathX86);
 };
 
+class NewInstanceSlowPathX86 : public SlowPathCodeX86 {
+ public:
+  explicit NewInstanceSlowPathX86(HNewInstance* instruction) : instruction_(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+
+    CodeGeneratorX86* x86_codegen = down_cast<CodeGeneratorX86*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    x86_codegen->LoadCurrentMethod(calling_convention.GetRegisterAt(1));
+    __ movl(calling_convention.GetRegisterAt(0), Immediate(instruction_->GetTypeIndex()));
+    __ fs()->call(
+        Address::Absolute(GetThreadOffset<kX86WordSize>(instruction_->GetEntrypoint())));
+    RecordPcInfo(codegen, instruction_, instruction_->GetDexPc());
+    x86_codegen->Move32(locations->Out(), Location::RegisterLocation(EAX));
+    RestoreLiveRegisters(codegen, locations);
+
+    __ jmp(GetExitLabel());
+  }
+
+ private:
+  HNewInstance* const instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewInstanceSlowPathX86);
+};
+
+class NewArraySlowPathX86 : public SlowPathCodeX86 {
+ public:
+  explicit NewArraySlowPathX86(HNewArray* instruction) : instruction_(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+
+    CodeGeneratorX86* x86_codegen = down_cast<CodeGeneratorX86*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    // Move the length first, as it may live in one of the other argument registers.
+    InvokeRuntimeCallingConvention calling_convention;
+    x86_codegen->Move32(Location::RegisterLocation(calling_convention.GetRegisterAt(1)),
+                        locations->InAt(0));
+    x86_codegen->LoadCurrentMethod(calling_convention.GetRegisterAt(2));
+    __ movl(calling_convention.GetRegisterAt(0), Immediate(instruction_->GetTypeIndex()));
+    __ fs()->call(
+        Address::Absolute(GetThreadOffset<kX86WordSize>(instruction_->GetEntrypoint())));
+    RecordPcInfo(codegen, instruction_, instruction_->GetDexPc());
+    x86_codegen->Move32(locations->Out(), Location::RegisterLocation(EAX));
+    RestoreLiveRegisters(codegen, locations);
+
+    __ jmp(GetExitLabel());
+  }
+
+ private:
+  HNewArray* const instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewArraySlowPathX86);
+};
+
 class LoadClassSlowPathX86 : public SlowPathCodeX86 {
  public:
   LoadClassSlowPathX86(HLoadClass* cls,
@@ -1129,6 +1192,27 @@ void InstructionCodeGeneratorX86::VisitMemoryBarrier(HMemoryBarrier* memory_barr
   GenerateMemoryBarrier(memory_barrier->GetBarrierKind());
 }
 
+void LocationsBuilderX86::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorX86::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register method = locations->GetTemp(0).AsRegister<Register>();
+  Register count = locations->GetTemp(1).AsRegister<Register>();
+  codegen_->LoadCurrentMethod(method);
+  const Address address(method, ArtMethod::HotnessCountOffset().Int32Value());
+  Label done;
+  __ movzxw(count, address);
+  __ testl(count, count);
+  __ j(kEqual, &done);
+  __ subl(count, Immediate(1));
+  __ movw(address, count);
+  __ Bind(&done);
+}
+
 void LocationsBuilderX86::VisitReturnVoid(HReturnVoid* ret) {
   ret->SetLocations(nullptr);
 }
@@ -2958,6 +3042,14 @@ void InstructionCodeGeneratorX86::VisitUShr(HUShr* ushr) {
 }
 
 void LocationsBuilderX86::VisitNewInstance(HNewInstance* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations =
+        new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+    locations->SetOut(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    return;
+  }
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   locations->SetOut(Location::RegisterLocation(EAX));
@@ -2967,6 +3059,34 @@ void LocationsBuilderX86::VisitNewInstance(HNewInstance* instruction) {
 }
 
 void InstructionCodeGeneratorX86::VisitNewInstance(HNewInstance* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations = instruction->GetLocations();
+    Register out = locations->Out().AsRegister<Register>();
+    Register cls = locations->GetTemp(0).AsRegister<Register>();
+    Register temp = locations->GetTemp(1).AsRegister<Register>();
+    SlowPathCodeX86* slow_path = new (GetGraph()->GetArena()) NewInstanceSlowPathX86(instruction);
+    codegen_->AddSlowPath(slow_path);
+
+    // Classes that are unresolved, not yet initialized or finalizable go to the entrypoint.
+    codegen_->LoadCurrentMethod(cls);
+    __ movl(cls, Address(cls, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ movl(cls, Address(cls, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ testl(cls, cls);
+    __ j(kEqual, slow_path->GetEntryLabel());
+    __ cmpl(Address(cls, mirror::Class::StatusOffset().Int32Value()),
+            Immediate(mirror::Class::kStatusInitialized));
+    __ j(kLess, slow_path->GetEntryLabel());
+    __ movl(temp, Address(cls, mirror::Class::AccessFlagsOffset().Int32Value()));
+    __ testl(temp, Immediate(kAccClassIsFinalizable));
+    __ j(kNotZero, slow_path->GetEntryLabel());
+    __ movl(temp, Address(cls, mirror::Class::ObjectSizeOffset().Int32Value()));
+    __ addl(temp, Immediate(kObjectAlignment - 1));
+    __ andl(temp, Immediate(~static_cast<int32_t>(kObjectAlignment - 1)));
+    GenerateTlabAllocation(out, temp, slow_path);
+    __ movl(Address(out, mirror::Object::ClassOffset().Int32Value()), cls);
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   InvokeRuntimeCallingConvention calling_convention;
   codegen_->LoadCurrentMethod(calling_convention.GetRegisterAt(1));
   __ movl(calling_convention.GetRegisterAt(0), Immediate(instruction->GetTypeIndex()));
@@ -2978,6 +3098,15 @@ void InstructionCodeGeneratorX86::VisitNewInstance(HNewInstance* instruction) {
 }
 
 void LocationsBuilderX86::VisitNewArray(HNewArray* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations =
+        new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+    locations->SetOut(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetInAt(0, Location::RequiresRegister());
+    return;
+  }
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   locations->SetOut(Location::RegisterLocation(EAX));
@@ -2988,6 +3117,36 @@ void LocationsBuilderX86::VisitNewArray(HNewArray* instruction) {
 }
 
 void InstructionCodeGeneratorX86::VisitNewArray(HNewArray* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations = instruction->GetLocations();
+    Register length = locations->InAt(0).AsRegister<Register>();
+    Register out = locations->Out().AsRegister<Register>();
+    Register cls = locations->GetTemp(0).AsRegister<Register>();
+    Register temp = locations->GetTemp(1).AsRegister<Register>();
+    SlowPathCodeX86* slow_path = new (GetGraph()->GetArena()) NewArraySlowPathX86(instruction);
+    codegen_->AddSlowPath(slow_path);
+
+    // Array classes are initialized when they are created, so only an unresolved class or
+    // a negative or large length goes to the entrypoint.
+    size_t component_size_shift = codegen_->GetArrayComponentSizeShift(instruction);
+    uint32_t data_offset = mirror::Array::DataOffset(1u << component_size_shift).Uint32Value();
+    codegen_->LoadCurrentMethod(cls);
+    __ movl(cls, Address(cls, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ movl(cls, Address(cls, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ testl(cls, cls);
+    __ j(kEqual, slow_path->GetEntryLabel());
+    __ cmpl(length, Immediate(codegen_->GetMaxInlineArrayLength(instruction)));
+    __ j(kAbove, slow_path->GetEntryLabel());
+    __ leal(temp, Address(length,
+                          static_cast<ScaleFactor>(component_size_shift),
+                          data_offset + kObjectAlignment - 1));
+    __ andl(temp, Immediate(~static_cast<int32_t>(kObjectAlignment - 1)));
+    GenerateTlabAllocation(out, temp, slow_path);
+    __ movl(Address(out, mirror::Object::ClassOffset().Int32Value()), cls);
+    __ movl(Address(out, mirror::Array::LengthOffset().Int32Value()), length);
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   InvokeRuntimeCallingConvention calling_convention;
   codegen_->LoadCurrentMethod(calling_convention.GetRegisterAt(2));
   __ movl(calling_convention.GetRegisterAt(0), Immediate(instruction->GetTypeIndex()));
@@ -4317,6 +4476,22 @@ void InstructionCodeGeneratorX86::VisitClinitCheck(HClinitCheck* check) {
                                    check->GetLocations()->InAt(0).AsRegister<Register>());
 }
 
+void InstructionCodeGeneratorX86::GenerateTlabAllocation(Register out,
+                                                        Register size,
+                                                        SlowPathCodeX86* slow_path) {
+  // The inline end is null while the thread has no TLAB or while the allocation entrypoints
+  // are instrumented, so that the bounds check then always fails.
+  __ fs()->movl(out, Address::Absolute(Thread::ThreadLocalPosOffset<kX86WordSize>()));
+  __ addl(size, out);
+  __ fs()->cmpl(size, Address::Absolute(Thread::ThreadLocalInlineEndOffset<kX86WordSize>()));
+  __ j(kAbove, slow_path->GetEntryLabel());
+  __ fs()->movl(Address::Absolute(Thread::ThreadLocalPosOffset<kX86WordSize>()), size);
+  __ fs()->addl(Address::Absolute(Thread::ThreadLocalObjectsOffset<kX86WordSize>()),
+                Immediate(1));
+  // The TLAB is already zeroed and, thanks to the X86 memory model, the class is visible
+  // to other threads no later than the reference to the new object.
+}
+
 void InstructionCodeGeneratorX86::GenerateClassInitializationCheck(
     SlowPathCodeX86* slow_path, Register class_reg) {
   __ cmpl(Address(class_reg,  mirror::Class::StatusOffset().Int32Value()),
@@ -158,6 +158,9 @@ class InstructionCodeGeneratorX86 : public HGraphVisitor {
   // the suspend call.
   void GenerateSuspendCheck(HSuspendCheck* check, HBasicBlock* successor);
   void GenerateClassInitializationCheck(SlowPathCodeX86* slow_path, Register class_reg);
+  // Bumps the thread-local allocation pointer by `size`, which must be object aligned, and
+  // puts the allocated address in `out`. Clobbers `size`.
+  void GenerateTlabAllocation(Register out, Register size, SlowPathCodeX86* slow_path);
   void HandleBitwiseOperation(HBinaryOperation* instruction);
   void GenerateDivRemIntegral(HBinaryOperation* instruction);
   void DivRemOneOrMinusOne(HBinaryOperation* instruction);
@@ -263,6 +263,69 @@ class LoadStringSlowPathX86_64 : public SlowPathCodeX86_64 {
   DISALLOW_COPY_AND_ASSIGN(LoadStringSlowPathX86_64);
 };
 
+class NewInstanceSlowPathX86_64 : public SlowPathCodeX86_64 {
+ public:
+  explicit NewInstanceSlowPathX86_64(HNewInstance* instruction) : instruction_(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+
+    CodeGeneratorX86_64* x64_codegen = down_cast<CodeGeneratorX86_64*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    x64_codegen->LoadCurrentMethod(CpuRegister(calling_convention.GetRegisterAt(1)));
+    __ movl(CpuRegister(calling_convention.GetRegisterAt(0)),
+            Immediate(instruction_->GetTypeIndex()));
+    __ gs()->call(Address::Absolute(
+        GetThreadOffset<kX86_64WordSize>(instruction_->GetEntrypoint()), true));
+    RecordPcInfo(codegen, instruction_, instruction_->GetDexPc());
+    x64_codegen->Move(locations->Out(), Location::RegisterLocation(RAX));
+    RestoreLiveRegisters(codegen, locations);
+    __ jmp(GetExitLabel());
+  }
+
+ private:
+  HNewInstance* const instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewInstanceSlowPathX86_64);
+};
+
+class NewArraySlowPathX86_64 : public SlowPathCodeX86_64 {
+ public:
+  explicit NewArraySlowPathX86_64(HNewArray* instruction) : instruction_(instruction) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(locations->Out().reg()));
+
+    CodeGeneratorX86_64* x64_codegen = down_cast<CodeGeneratorX86_64*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    // Move the length first, as it may live in one of the other argument registers.
+    InvokeRuntimeCallingConvention calling_convention;
+    x64_codegen->Move(Location::RegisterLocation(calling_convention.GetRegisterAt(1)),
+                      locations->InAt(0));
+    x64_codegen->LoadCurrentMethod(CpuRegister(calling_convention.GetRegisterAt(2)));
+    __ movl(CpuRegister(calling_convention.GetRegisterAt(0)),
+            Immediate(instruction_->GetTypeIndex()));
+    __ gs()->call(Address::Absolute(
+        GetThreadOffset<kX86_64WordSize>(instruction_->GetEntrypoint()), true));
+    RecordPcInfo(codegen, instruction_, instruction_->GetDexPc());
+    x64_codegen->Move(locations->Out(), Location::RegisterLocation(RAX));
+    RestoreLiveRegisters(codegen, locations);
+    __ jmp(GetExitLabel());
+  }
+
+ private:
+  HNewArray* const instruction_;
+
+  DISALLOW_COPY_AND_ASSIGN(NewArraySlowPathX86_64);
+};
+
 class TypeCheckSlowPathX86_64 : public SlowPathCodeX86_64 {
  public:
   TypeCheckSlowPathX86_64(HInstruction* instruction,
@@ -1185,6 +1248,27 @@ void InstructionCodeGeneratorX86_64::VisitMemoryBarrier(HMemoryBarrier* memory_b
   GenerateMemoryBarrier(memory_barrier->GetBarrierKind());
 }
 
+void LocationsBuilderX86_64::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction);
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+}
+
+void InstructionCodeGeneratorX86_64::VisitCountHotness(HCountHotness* instruction) {
+  LocationSummary* locations = instruction->GetLocations();
+  CpuRegister method = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister count = locations->GetTemp(1).AsRegister<CpuRegister>();
+  codegen_->LoadCurrentMethod(method);
+  const Address address(method, ArtMethod::HotnessCountOffset().Int32Value());
+  Label done;
+  __ movzxw(count, address);
+  __ testl(count, count);
+  __ j(kEqual, &done);
+  __ subl(count, Immediate(1));
+  __ movw(address, count);
+  __ Bind(&done);
+}
+
 void LocationsBuilderX86_64::VisitReturnVoid(HReturnVoid* ret) {
   ret->SetLocations(nullptr);
 }
@@ -3012,6 +3096,14 @@ void InstructionCodeGeneratorX86_64::VisitUShr(HUShr* ushr) {
 }
 
 void LocationsBuilderX86_64::VisitNewInstance(HNewInstance* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations =
+        new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister());
+    return;
+  }
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
@@ -3021,6 +3113,35 @@ void LocationsBuilderX86_64::VisitNewInstance(HNewInstance* instruction) {
 }
 
 void InstructionCodeGeneratorX86_64::VisitNewInstance(HNewInstance* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations = instruction->GetLocations();
+    CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+    CpuRegister cls = locations->GetTemp(0).AsRegister<CpuRegister>();
+    CpuRegister temp = locations->GetTemp(1).AsRegister<CpuRegister>();
+    SlowPathCodeX86_64* slow_path =
+        new (GetGraph()->GetArena()) NewInstanceSlowPathX86_64(instruction);
+    codegen_->AddSlowPath(slow_path);
+
+    // Classes that are unresolved, not yet initialized or finalizable go to the entrypoint.
+    codegen_->LoadCurrentMethod(cls);
+    __ movl(cls, Address(cls, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ movl(cls, Address(cls, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ testl(cls, cls);
+    __ j(kEqual, slow_path->GetEntryLabel());
+    __ cmpl(Address(cls, mirror::Class::StatusOffset().Int32Value()),
+            Immediate(mirror::Class::kStatusInitialized));
+    __ j(kLess, slow_path->GetEntryLabel());
+    __ movl(temp, Address(cls, mirror::Class::AccessFlagsOffset().Int32Value()));
+    __ testl(temp, Immediate(kAccClassIsFinalizable));
+    __ j(kNotZero, slow_path->GetEntryLabel());
+    __ movl(temp, Address(cls, mirror::Class::ObjectSizeOffset().Int32Value()));
+    __ addl(temp, Immediate(kObjectAlignment - 1));
+    __ andl(temp, Immediate(~static_cast<int32_t>(kObjectAlignment - 1)));
+    GenerateTlabAllocation(out, temp, slow_path);
+    __ movl(Address(out, mirror::Object::ClassOffset().Int32Value()), cls);
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   InvokeRuntimeCallingConvention calling_convention;
   codegen_->LoadCurrentMethod(CpuRegister(calling_convention.GetRegisterAt(1)));
   codegen_->Load64BitValue(CpuRegister(calling_convention.GetRegisterAt(0)),
@@ -3033,6 +3154,15 @@ void InstructionCodeGeneratorX86_64::VisitNewInstance(HNewInstance* instruction)
 }
 
 void LocationsBuilderX86_64::VisitNewArray(HNewArray* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations =
+        new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCallOnSlowPath);
+    locations->AddTemp(Location::RequiresRegister());
+    locations->AddTemp(Location::RequiresRegister());
+    locations->SetInAt(0, Location::RequiresRegister());
+    locations->SetOut(Location::RequiresRegister());
+    return;
+  }
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
@@ -3043,6 +3173,37 @@ void LocationsBuilderX86_64::VisitNewArray(HNewArray* instruction) {
 }
 
 void InstructionCodeGeneratorX86_64::VisitNewArray(HNewArray* instruction) {
+  if (codegen_->CanInlineAllocation(instruction)) {
+    LocationSummary* locations = instruction->GetLocations();
+    CpuRegister length = locations->InAt(0).AsRegister<CpuRegister>();
+    CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+    CpuRegister cls = locations->GetTemp(0).AsRegister<CpuRegister>();
+    CpuRegister temp = locations->GetTemp(1).AsRegister<CpuRegister>();
+    SlowPathCodeX86_64* slow_path =
+        new (GetGraph()->GetArena()) NewArraySlowPathX86_64(instruction);
+    codegen_->AddSlowPath(slow_path);
+
+    // Array classes are initialized when they are created, so only an unresolved class or
+    // a negative or large length goes to the entrypoint.
+    size_t component_size_shift = codegen_->GetArrayComponentSizeShift(instruction);
+    uint32_t data_offset = mirror::Array::DataOffset(1u << component_size_shift).Uint32Value();
+    codegen_->LoadCurrentMethod(cls);
+    __ movl(cls, Address(cls, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ movl(cls, Address(cls, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ testl(cls, cls);
+    __ j(kEqual, slow_path->GetEntryLabel());
+    __ cmpl(length, Immediate(codegen_->GetMaxInlineArrayLength(instruction)));
+    __ j(kAbove, slow_path->GetEntryLabel());
+    __ leal(temp, Address(length,
+                          static_cast<ScaleFactor>(component_size_shift),
+                          data_offset + kObjectAlignment - 1));
+    __ andl(temp, Immediate(~static_cast<int32_t>(kObjectAlignment - 1)));
+    GenerateTlabAllocation(out, temp, slow_path);
+    __ movl(Address(out, mirror::Object::ClassOffset().Int32Value()), cls);
+    __ movl(Address(out, mirror::Array::LengthOffset().Int32Value()), length);
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   InvokeRuntimeCallingConvention calling_convention;
   codegen_->LoadCurrentMethod(CpuRegister(calling_convention.GetRegisterAt(2)));
   codegen_->Load64BitValue(CpuRegister(calling_convention.GetRegisterAt(0)),
@@ -4102,6 +4263,26 @@ void ParallelMoveResolverX86_64::RestoreScratch(int reg) {
   __ popq(CpuRegister(reg));
 }
 
+void InstructionCodeGeneratorX86_64::GenerateTlabAllocation(CpuRegister out,
+                                                            CpuRegister size,
+                                                            SlowPathCodeX86_64* slow_path) {
+  // The inline end is null while the thread has no TLAB or while the allocation entrypoints
+  // are instrumented, so that the bounds check then always fails.
+  __ gs()->movq(out, Address::Absolute(Thread::ThreadLocalPosOffset<kX86_64WordSize>(), true));
+  __ addq(size, out);
+  __ gs()->cmpq(size,
+                Address::Absolute(Thread::ThreadLocalInlineEndOffset<kX86_64WordSize>(), true));
+  __ j(kAbove, slow_path->GetEntryLabel());
+  __ gs()->movq(Address::Absolute(Thread::ThreadLocalPosOffset<kX86_64WordSize>(), true), size);
+  __ gs()->movq(size,
+                Address::Absolute(Thread::ThreadLocalObjectsOffset<kX86_64WordSize>(), true));
+  __ addq(size, Immediate(1));
+  __ gs()->movq(Address::Absolute(Thread::ThreadLocalObjectsOffset<kX86_64WordSize>(), true),
+                size);
+  // The TLAB is already zeroed and, thanks to the X86_64 memory model, the class is visible
+  // to other threads no later than the reference to the new object.
+}
+
 void InstructionCodeGeneratorX86_64::GenerateClassInitializationCheck(
     SlowPathCodeX86_64* slow_path, CpuRegister class_reg) {
   __ cmpl(Address(class_reg,  mirror::Class::StatusOffset().Int32Value()),
@@ -168,6 +168,9 @@ class InstructionCodeGeneratorX86_64 : public HGraphVisitor {
   // the suspend call.
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
   void GenerateClassInitializationCheck(SlowPathCodeX86_64* slow_path, CpuRegister class_reg);
+  // Bumps the thread-local allocation pointer by `size`, which must be object aligned, and
+  // puts the allocated address in `out`. Clobbers `size`.
+  void GenerateTlabAllocation(CpuRegister out, CpuRegister size, SlowPathCodeX86_64* slow_path);
   void HandleBitwiseOperation(HBinaryOperation* operation);
   void GenerateRemFP(HRem *rem);
   void DivRemOneOrMinusOne(HBinaryOperation* instruction);
@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "escape_analysis.h"
+
+#include "base/arena_containers.h"
+#include "dex_file-inl.h"
+#include "mirror/class-inl.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+
+// Returns the object whose field `instruction` accesses, looking through a null check.
+static HInstruction* GetAccessedObject(HInstruction* instruction) {
+  HInstruction* object = instruction->InputAt(0);
+  return object->IsNullCheck() ? object->InputAt(0) : object;
+}
+
+static MemberOffset GetFieldOffset(HInstruction* instruction) {
+  return instruction->IsInstanceFieldGet()
+      ? instruction->AsInstanceFieldGet()->GetFieldOffset()
+      : instruction->AsInstanceFieldSet()->GetFieldOffset();
+}
+
+static Primitive::Type GetFieldType(HInstruction* instruction) {
+  return instruction->IsInstanceFieldGet()
+      ? instruction->AsInstanceFieldGet()->GetFieldType()
+      : instruction->AsInstanceFieldSet()->GetFieldType();
+}
+
+// Returns whether reading `value` back from a field of type `field_type` gives `value`.
+// Stores to sub-word fields truncate the value, which the replaced get would not do.
+static bool IsStoredUnchanged(HInstruction* value, Primitive::Type field_type) {
+  switch (field_type) {
+    case Primitive::kPrimBoolean:
+    case Primitive::kPrimByte:
+    case Primitive::kPrimChar:
+    case Primitive::kPrimShort:
+      if (value->IsIntConstant()) {
+        int32_t constant = value->AsIntConstant()->GetValue();
+        switch (field_type) {
+          case Primitive::kPrimBoolean: return constant == 0 || constant == 1;
+          case Primitive::kPrimByte: return constant == static_cast<int8_t>(constant);
+          case Primitive::kPrimChar: return constant == static_cast<uint16_t>(constant);
+          default: return constant == static_cast<int16_t>(constant);
+        }
+      }
+      return value->GetType() == field_type;
+    default:
+      return true;
+  }
+}
+
+// Returns whether `user` is a call of the constructor of java.lang.Object on its input
+// `index`. The constructor is empty, finalizers are registered by the allocation.
+static bool IsObjectConstructorCall(HInstruction* user, size_t index) {
+  if (!user->IsInvokeStaticOrDirect() || index != 0 || !user->HasEnvironment()) {
+    return false;
+  }
+  uint32_t method_index = user->AsInvokeStaticOrDirect()->GetDexMethodIndex();
+  if (method_index == DexFile::kDexNoIndex) {
+    return false;
+  }
+  const DexFile& dex_file = user->GetEnvironment()->GetDexFile();
+  const DexFile::MethodId& method_id = dex_file.GetMethodId(method_index);
+  return strcmp(dex_file.GetMethodName(method_id), "<init>") == 0 &&
+      strcmp(dex_file.GetMethodDeclaringClassDescriptor(method_id), "Ljava/lang/Object;") == 0;
+}
+
+// Returns whether all the non-environment uses of `object` are field accesses of the
+// allocation `new_instance` that can be replaced, or calls of the empty constructor.
+static bool HasOnlyReplaceableUses(HInstruction* object, HNewInstance* new_instance) {
+  for (HUseIterator<HInstruction*> it(object->GetUses()); !it.Done(); it.Advance()) {
+    HInstruction* user = it.Current()->GetUser();
+    size_t index = it.Current()->GetIndex();
+    if (user->IsNullCheck() && object == new_instance) {
+      if (!HasOnlyReplaceableUses(user, new_instance)) {
+        return false;
+      }
+    } else if (IsObjectConstructorCall(user, index)) {
+      continue;
+    } else if (user->IsInstanceFieldGet()) {
+      if (user->AsInstanceFieldGet()->IsVolatile()) {
+        return false;
+      }
+    } else if (user->IsInstanceFieldSet() && index == 0) {
+      HInstanceFieldSet* set = user->AsInstanceFieldSet();
+      if (set->IsVolatile() || !IsStoredUnchanged(set->GetValue(), set->GetFieldType())) {
+        return false;
+      }
+    } else {
+      // Stored somewhere, passed to a call, returned, compared, merged in a phi, ...
+      return false;
+    }
+  }
+  return true;
+}
+
+bool EscapeAnalysis::DoesNotEscape(HNewInstance* new_instance) const {
+  // Allocations that need an access check can throw, and must stay.
+  if (new_instance->GetEntrypoint() != kQuickAllocObject) {
+    return false;
+  }
+  ReferenceTypeInfo type_info = new_instance->GetReferenceTypeInfo();
+  if (type_info.IsTop() || !type_info.IsExact()) {
+    return false;
+  }
+  {
+    // Removing the allocation must not skip the initialization of the class, nor the
+    // registration of a finalizer.
+    ScopedObjectAccess soa(Thread::Current());
+    mirror::Class* klass = type_info.GetTypeHandle().Get();
+    if (!klass->IsInitialized() || !klass->IsInstantiable() || klass->IsFinalizable()) {
+      return false;
+    }
+  }
+  if (!HasOnlyReplaceableUses(new_instance, new_instance)) {
+    return false;
+  }
+  // Deoptimization and the debugger rebuild interpreter frames from the environments, and
+  // would see the removed object.
+  if (new_instance->HasEnvironmentUses()) {
+    return false;
+  }
+  for (HUseIterator<HInstruction*> it(new_instance->GetUses()); !it.Done(); it.Advance()) {
+    if (it.Current()->GetUser()->HasEnvironmentUses()) {
+      // A null check of the allocation is live in an environment.
+      return false;
+    }
+  }
+  return true;
+}
+
+static HInstruction* GetDefaultValue(HGraph* graph, Primitive::Type type) {
+  switch (type) {
+    case Primitive::kPrimNot:
+      return graph->GetNullConstant();
+    case Primitive::kPrimLong:
+      return graph->GetLongConstant(0);
+    case Primitive::kPrimFloat:
+      return graph->GetFloatConstant(0.0f);
+    case Primitive::kPrimDouble:
+      return graph->GetDoubleConstant(0.0);
+    default:
+      return graph->GetIntConstant(0);
+  }
+}
+
+void EscapeAnalysis::ScalarReplace(HNewInstance* new_instance) {
+  ArenaAllocator* arena = graph_->GetArena();
+
+  // Number the fields accessed through the allocation.
+  ArenaVector<HInstruction*> accesses(arena->Adapter(kArenaAllocMisc));
+  ArenaVector<uint32_t> field_offsets(arena->Adapter(kArenaAllocMisc));
+  ArenaVector<Primitive::Type> field_types(arena->Adapter(kArenaAllocMisc));
+  for (HUseIterator<HInstruction*> it(new_instance->GetUses()); !it.Done(); it.Advance()) {
+    HInstruction* user = it.Current()->GetUser();
+    if (user->IsNullCheck()) {
+      for (HUseIterator<HInstruction*> it2(user->GetUses()); !it2.Done(); it2.Advance()) {
+        accesses.push_back(it2.Current()->GetUser());
+      }
+    } else {
+      accesses.push_back(user);
+    }
+  }
+  for (HInstruction* access : accesses) {
+    if (access->IsInvokeStaticOrDirect()) {
+      continue;
+    }
+    uint32_t offset = GetFieldOffset(access).Uint32Value();
+    if (std::find(field_offsets.begin(), field_offsets.end(), offset) == field_offsets.end()) {
+      field_offsets.push_back(offset);
+      field_types.push_back(GetFieldType(access));
+    }
+  }
+  const size_t number_of_fields = field_offsets.size();
+
+  // Propagate the values of the fields through the blocks dominated by the allocation, in
+  // reverse post order so that all forward predecessors of a block are visited before it.
+  // Loop phis get the values of their back edges once the whole loop has been visited.
+  struct LoopPhi {
+    HPhi* phi;
+    size_t field;
+  };
+  ArenaVector<LoopPhi> loop_phis(arena->Adapter(kArenaAllocMisc));
+  ArenaVector<HPhi*> phis(arena->Adapter(kArenaAllocMisc));
+  ArenaVector<HInstruction*> values(graph_->GetBlocks().Size() * number_of_fields,
+                                    nullptr,
+                                    arena->Adapter(kArenaAllocMisc));
+  HBasicBlock* allocation_block = new_instance->GetBlock();
+  for (HReversePostOrderIterator block_it(*graph_); !block_it.Done(); block_it.Advance()) {
+    HBasicBlock* block = block_it.Current();
+    if (!allocation_block->Dominates(block)) {
+      continue;
+    }
+    HInstruction** block_values = &values[block->GetBlockId() * number_of_fields];
+    const GrowableArray<HBasicBlock*>& predecessors = block->GetPredecessors();
+    if (block == allocation_block) {
+      // The fields only exist after the allocation.
+    } else if (predecessors.Size() == 1) {
+      std::copy_n(&values[predecessors.Get(0)->GetBlockId() * number_of_fields],
+                  number_of_fields,
+                  block_values);
+    } else {
+      for (size_t field = 0; field != number_of_fields; ++field) {
+        HInstruction* first_value =
+            values[predecessors.Get(0)->GetBlockId() * number_of_fields + field];
+        bool needs_phi = block->IsLoopHeader();
+        for (size_t i = 1; !needs_phi && i != predecessors.Size(); ++i) {
+          needs_phi =
+              values[predecessors.Get(i)->GetBlockId() * number_of_fields + field] != first_value;
+        }
+        if (!needs_phi) {
+          block_values[field] = first_value;
+          continue;
+        }
+        HPhi* phi = new (arena) HPhi(
+            arena, kNoRegNumber, 0, HPhi::ToPhiType(field_types[field]));
+        block->AddPhi(phi);
+        phi->AddInput(first_value);
+        if (block->IsLoopHeader()) {
+          // The first predecessor is the pre-header, the others are back edges.
+          loop_phis.push_back(LoopPhi { phi, field });
+        } else {
+          for (size_t i = 1; i != predecessors.Size(); ++i) {
+            phi->AddInput(values[predecessors.Get(i)->GetBlockId() * number_of_fields + field]);
+          }
+        }
+        phis.push_back(phi);
+        block_values[field] = phi;
+      }
+    }
+
+    for (HInstructionIterator it(block->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      if (instruction == new_instance) {
+        for (size_t field = 0; field != number_of_fields; ++field) {
+          block_values[field] = GetDefaultValue(graph_, field_types[field]);
+        }
+      } else if ((instruction->IsInstanceFieldGet() || instruction->IsInstanceFieldSet()) &&
+                 GetAccessedObject(instruction) == new_instance) {
+        size_t field = std::find(field_offsets.begin(),
+                                 field_offsets.end(),
+                                 GetFieldOffset(instruction).Uint32Value()) - field_offsets.begin();
+        if (instruction->IsInstanceFieldGet()) {
+          instruction->ReplaceWith(block_values[field]);
+        } else {
+          block_values[field] = instruction->AsInstanceFieldSet()->GetValue();
+        }
+        block->RemoveInstruction(instruction);
+      } else if (instruction->IsInvokeStaticOrDirect() &&
+                 instruction->InputCount() != 0 &&
+                 GetAccessedObject(instruction) == new_instance) {
+        // The constructor of java.lang.Object, see IsObjectConstructorCall.
+        block->RemoveInstruction(instruction);
+      }
+    }
+  }
+
+  for (const LoopPhi& loop_phi : loop_phis) {
+    const GrowableArray<HBasicBlock*>& predecessors = loop_phi.phi->GetBlock()->GetPredecessors();
+    for (size_t i = 1; i != predecessors.Size(); ++i) {
+      loop_phi.phi->AddInput(
+          values[predecessors.Get(i)->GetBlockId() * number_of_fields + loop_phi.field]);
+    }
+  }
+
+  // Remove the null checks and the allocation, which are no longer used.
+  for (HUseIterator<HInstruction*> it(new_instance->GetUses()); !it.Done(); it.Advance()) {
+    HInstruction* null_check = it.Current()->GetUser();
+    DCHECK(null_check->IsNullCheck());
+    DCHECK(!null_check->HasUses());
+    null_check->GetBlock()->RemoveInstruction(null_check);
+  }
+  DCHECK(!new_instance->HasUses());
+  allocation_block->RemoveInstruction(new_instance);
+
+  // Remove the phis that merge a single value, or are not used. Removing one may make
+  // others redundant or unused.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (HPhi* phi : phis) {
+      if (!phi->IsInBlock()) {
+        continue;
+      }
+      HInstruction* candidate = nullptr;
+      for (size_t i = 0; i != phi->InputCount(); ++i) {
+        HInstruction* input = phi->InputAt(i);
+        if (input != phi && input != candidate) {
+          candidate = (candidate == nullptr) ? input : phi;
+        }
+      }
+      bool only_used_by_itself = !phi->HasEnvironmentUses();
+      for (HUseIterator<HInstruction*> it(phi->GetUses()); !it.Done(); it.Advance()) {
+        only_used_by_itself = only_used_by_itself && it.Current()->GetUser() == phi;
+      }
+      if (only_used_by_itself) {
+        for (size_t i = 0; i != phi->InputCount(); ++i) {
+          phi->RemoveAsUserOfInput(i);
+        }
+        phi->GetBlock()->RemovePhi(phi, /* ensure_safety */ false);
+        changed = true;
+      } else if (candidate != phi) {
+        DCHECK(candidate != nullptr);
+        phi->ReplaceWith(candidate);
+        phi->GetBlock()->RemovePhi(phi);
+        changed = true;
+      }
+    }
+  }
+}
+
+void EscapeAnalysis::Run() {
+  ArenaVector<HNewInstance*> candidates(graph_->GetArena()->Adapter(kArenaAllocMisc));
+  for (HReversePostOrderIterator block_it(*graph_); !block_it.Done(); block_it.Advance()) {
+    for (HInstructionIterator it(block_it.Current()->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      if (instruction->IsNewInstance()) {
+        candidates.push_back(instruction->AsNewInstance());
+      }
+    }
+  }
+
+  // Replacing an allocation that holds another one turns the accesses through the holder
+  // into accesses of the other allocation, which may then not escape either.
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (HNewInstance*& new_instance : candidates) {
+      if (new_instance != nullptr && DoesNotEscape(new_instance)) {
+        ScalarReplace(new_instance);
+        MaybeRecordStat(MethodCompilationStat::kScalarReplacedAllocation);
+        new_instance = nullptr;
+        changed = true;
+      }
+    }
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_ESCAPE_ANALYSIS_H_
+#define ART_COMPILER_OPTIMIZING_ESCAPE_ANALYSIS_H_
+
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+/**
+ * Finds HNewInstance allocations that do not escape the compiled method, and replaces
+ * them with SSA values for their fields (scalar replacement).
+ *
+ * An allocation does not escape when it is only used as the object of instance field
+ * gets and sets and of the call to the constructor of java.lang.Object, possibly through
+ * a null check. Its field gets are replaced by the values last stored, or by the default
+ * value of the field, with phis where the stored values differ between predecessors.
+ *
+ * Allocations that appear in an environment, directly or through a null check, are
+ * rejected. Rematerializing a removed object when an interpreter frame is rebuilt from an
+ * environment, e.g. on deoptimization, is not implemented.
+ *
+ * Must run after reference type propagation, which provides the allocated class.
+ */
+class EscapeAnalysis : public HOptimization {
+ public:
+  EscapeAnalysis(HGraph* graph, OptimizingCompilerStats* stats)
+      : HOptimization(graph, true, kEscapeAnalysisPassName, stats) {}
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kEscapeAnalysisPassName = "escape_analysis";
+
+ private:
+  // Returns whether `new_instance` can be replaced by the values of its fields.
+  bool DoesNotEscape(HNewInstance* new_instance) const;
+
+  // Replaces the field accesses of `new_instance`, and removes it.
+  void ScalarReplace(HNewInstance* new_instance);
+
+  DISALLOW_COPY_AND_ASSIGN(EscapeAnalysis);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_ESCAPE_ANALYSIS_H_
@@ -16,8 +16,13 @@
 
 #include "graph_visualizer.h"
 
+#include <dlfcn.h>
+
+#include <sstream>
+
 #include "code_generator.h"
 #include "dead_code_elimination.h"
+#include "disassembler.h"
 #include "licm.h"
 #include "nodes.h"
 #include "optimization.h"
@@ -26,6 +31,77 @@
 
 namespace art {
 
+typedef Disassembler* create_disasm_prototype(InstructionSet instruction_set,
+                                              DisassemblerOptions* options);
+
+/**
+ * Disassembles the code of a method for the graph visualizer. The disassembler library is
+ * loaded at runtime so that the compiler does not depend on it.
+ */
+class HGraphVisualizerDisassembler {
+ public:
+  HGraphVisualizerDisassembler(InstructionSet instruction_set, const uint8_t* base_address)
+      : instruction_set_(instruction_set),
+        base_address_(base_address),
+        disassembler_(nullptr),
+        disassembler_lib_handle_(nullptr) {
+    disassembler_lib_handle_ = dlopen(
+        kIsDebugBuild ? "libartd-disassembler.so" : "libart-disassembler.so", RTLD_NOW);
+    if (disassembler_lib_handle_ == nullptr) {
+      LOG(WARNING) << "Failed to dlopen libart-disassembler: " << dlerror();
+      return;
+    }
+    create_disasm_prototype* create_disassembler = reinterpret_cast<create_disasm_prototype*>(
+        dlsym(disassembler_lib_handle_, "create_disassembler"));
+    if (create_disassembler == nullptr) {
+      LOG(WARNING) << "Could not find create_disassembler entry: " << dlerror();
+      return;
+    }
+    // Reading the literal pools is only safe for code that has been finalized, which is
+    // the case here.
+    disassembler_.reset(create_disassembler(
+        instruction_set,
+        new DisassemblerOptions(/* absolute_addresses */ false,
+                                base_address,
+                                /* can_read_literals */ true)));
+  }
+
+  ~HGraphVisualizerDisassembler() {
+    // The disassembler must be deleted before the library that defines it is closed.
+    disassembler_.reset();
+    if (disassembler_lib_handle_ != nullptr) {
+      dlclose(disassembler_lib_handle_);
+    }
+  }
+
+  void Disassemble(std::ostream& output, size_t start, size_t end) const {
+    if (disassembler_ == nullptr) {
+      return;
+    }
+    const uint8_t* base = base_address_;
+    if (instruction_set_ == kThumb2) {
+      // ARM and Thumb-2 use the same disassembler. The bottom bit selects Thumb-2.
+      base = reinterpret_cast<const uint8_t*>(reinterpret_cast<uintptr_t>(base) | 1);
+    }
+    // The disassembler writes a line per native instruction, which we indent so that
+    // they stand out from the instructions of the graph.
+    std::ostringstream disassembly;
+    disassembler_->Dump(disassembly, base + start, base + end);
+    std::istringstream lines(disassembly.str());
+    for (std::string line; std::getline(lines, line);) {
+      output << "    " << line << std::endl;
+    }
+  }
+
+ private:
+  const InstructionSet instruction_set_;
+  const uint8_t* const base_address_;
+  std::unique_ptr<Disassembler> disassembler_;
+  void* disassembler_lib_handle_;
+
+  DISALLOW_COPY_AND_ASSIGN(HGraphVisualizerDisassembler);
+};
+
 /**
  * HGraph visitor to generate a file suitable for the c1visualizer tool and IRHydra.
  */
@@ -35,12 +111,16 @@ class HGraphVisualizerPrinter : public HGraphVisitor {
                           std::ostream& output,
                           const char* pass_name,
                           bool is_after_pass,
-                          const CodeGenerator& codegen)
+                          const CodeGenerator& codegen,
+                          const DisassemblyInformation* disasm_info = nullptr,
+                          const HGraphVisualizerDisassembler* disassembler = nullptr)
       : HGraphVisitor(graph),
         output_(output),
         pass_name_(pass_name),
         is_after_pass_(is_after_pass),
         codegen_(codegen),
+        disasm_info_(disasm_info),
+        disassembler_(disassembler),
         indent_(0) {}
 
   void StartTag(const char* name) {
@@ -281,15 +361,69 @@ class HGraphVisualizerPrinter : public HGraphVisitor {
       output_ << bci << " " << num_uses << " "
               << GetTypeId(instruction->GetType()) << instruction->GetId() << " ";
       PrintInstruction(instruction);
+      if (disasm_info_ != nullptr) {
+        // Print the code generated for the instruction, if any, before the end marker.
+        auto it = disasm_info_->GetInstructionIntervals().find(instruction);
+        if (it != disasm_info_->GetInstructionIntervals().end()
+            && it->second.start != it->second.end) {
+          output_ << std::endl;
+          disassembler_->Disassemble(output_, it->second.start, it->second.end);
+        }
+      }
       output_ << kEndInstructionMarker << std::endl;
     }
   }
 
+  // Prints the frame entry and the slow paths, which do not belong to a block of the graph,
+  // as the instructions of a pseudo block.
+  void PrintGeneratedCodeOutsideBlocks(const char* block_name, bool print_frame_entry) {
+    StartTag("block");
+    PrintProperty("name", block_name);
+    PrintInt("from_bci", -1);
+    PrintInt("to_bci", -1);
+    PrintEmptyProperty("predecessors");
+    PrintEmptyProperty("successors");
+    PrintEmptyProperty("xhandlers");
+    PrintEmptyProperty("flags");
+    StartTag("states");
+    StartTag("locals");
+    PrintInt("size", 0);
+    PrintProperty("method", "None");
+    EndTag("locals");
+    EndTag("states");
+    StartTag("HIR");
+    const char* kEndInstructionMarker = "<|@";
+    if (print_frame_entry) {
+      GeneratedCodeInterval frame_entry = disasm_info_->GetFrameEntryInterval();
+      AddIndent();
+      output_ << "0 0 FrameEntry" << std::endl;
+      disassembler_->Disassemble(output_, frame_entry.start, frame_entry.end);
+      output_ << kEndInstructionMarker << std::endl;
+    }
+    for (const SlowPathCodeInfo& info : disasm_info_->GetSlowPathIntervals()) {
+      AddIndent();
+      output_ << "0 0 SlowPath for " << info.instruction->DebugName()
+              << " " << GetTypeId(info.instruction->GetType()) << info.instruction->GetId()
+              << std::endl;
+      disassembler_->Disassemble(output_, info.code_interval.start, info.code_interval.end);
+      output_ << kEndInstructionMarker << std::endl;
+    }
+    EndTag("HIR");
+    EndTag("block");
+  }
+
   void Run() {
     StartTag("cfg");
     std::string pass_desc = std::string(pass_name_) + (is_after_pass_ ? " (after)" : " (before)");
     PrintProperty("name", pass_desc.c_str());
+    if (disasm_info_ != nullptr) {
+      // The frame entry goes first, and the slow paths after all the blocks.
+      PrintGeneratedCodeOutsideBlocks("FrameEntry", /* print_frame_entry */ true);
+    }
     VisitInsertionOrder();
+    if (disasm_info_ != nullptr) {
+      PrintGeneratedCodeOutsideBlocks("SlowPaths", /* print_frame_entry */ false);
+    }
     EndTag("cfg");
   }
 
@@ -341,6 +475,8 @@ class HGraphVisualizerPrinter : public HGraphVisitor {
   const char* pass_name_;
   const bool is_after_pass_;
   const CodeGenerator& codegen_;
+  const DisassemblyInformation* const disasm_info_;
+  const HGraphVisualizerDisassembler* const disassembler_;
   size_t indent_;
 
   DISALLOW_COPY_AND_ASSIGN(HGraphVisualizerPrinter);
@@ -369,4 +505,19 @@ void HGraphVisualizer::DumpGraph(const char* pass_name, bool is_after_pass) cons
   }
 }
 
+void HGraphVisualizer::DumpGraphWithDisassembly(const uint8_t* code) const {
+  DCHECK(output_ != nullptr);
+  if (!graph_->GetBlocks().IsEmpty()) {
+    HGraphVisualizerDisassembler disassembler(codegen_.GetInstructionSet(), code);
+    HGraphVisualizerPrinter printer(graph_,
+                                    *output_,
+                                    kDisassemblyPassName,
+                                    /* is_after_pass */ true,
+                                    codegen_,
+                                    codegen_.GetDisassemblyInformation(),
+                                    &disassembler);
+    printer.Run();
+  }
+}
+
 }  // namespace art
@@ -19,13 +19,83 @@
 
 #include <ostream>
 
+#include "arch/instruction_set.h"
+#include "base/arena_containers.h"
 #include "base/value_object.h"
 
 namespace art {
 
 class CodeGenerator;
+class Disassembler;
 class DexCompilationUnit;
 class HGraph;
+class HInstruction;
+class SlowPathCode;
+
+// Range of the native code generated for an instruction, a slow path or the frame entry,
+// as offsets in the method's code.
+struct GeneratedCodeInterval {
+  size_t start;
+  size_t end;
+};
+
+struct SlowPathCodeInfo {
+  const SlowPathCode* slow_path;
+  // The instruction the slow path was added for.
+  const HInstruction* instruction;
+  GeneratedCodeInterval code_interval;
+};
+
+// Where the code generator put the code of each instruction, filled in while compiling
+// when the graph visualizer is enabled, so that the final code can be dumped interleaved
+// with the graph.
+class DisassemblyInformation {
+ public:
+  explicit DisassemblyInformation(ArenaAllocator* allocator)
+      : frame_entry_interval_({0, 0}),
+        instruction_intervals_(std::less<const HInstruction*>(), allocator->Adapter()),
+        slow_path_intervals_(allocator->Adapter()) {}
+
+  void SetFrameEntryInterval(size_t start, size_t end) {
+    frame_entry_interval_ = {start, end};
+  }
+
+  void AddInstructionInterval(HInstruction* instr, size_t start, size_t end) {
+    instruction_intervals_.Put(instr, {start, end});
+  }
+
+  void AddSlowPath(const SlowPathCode* slow_path, const HInstruction* instruction) {
+    slow_path_intervals_.push_back({slow_path, instruction, {0, 0}});
+  }
+
+  void SetSlowPathInterval(const SlowPathCode* slow_path, size_t start, size_t end) {
+    for (SlowPathCodeInfo& info : slow_path_intervals_) {
+      if (info.slow_path == slow_path) {
+        info.code_interval = {start, end};
+        return;
+      }
+    }
+  }
+
+  GeneratedCodeInterval GetFrameEntryInterval() const {
+    return frame_entry_interval_;
+  }
+
+  const ArenaSafeMap<const HInstruction*, GeneratedCodeInterval>& GetInstructionIntervals() const {
+    return instruction_intervals_;
+  }
+
+  const ArenaVector<SlowPathCodeInfo>& GetSlowPathIntervals() const {
+    return slow_path_intervals_;
+  }
+
+ private:
+  GeneratedCodeInterval frame_entry_interval_;
+  ArenaSafeMap<const HInstruction*, GeneratedCodeInterval> instruction_intervals_;
+  ArenaVector<SlowPathCodeInfo> slow_path_intervals_;
+
+  DISALLOW_COPY_AND_ASSIGN(DisassemblyInformation);
+};
 
 /**
  * This class outputs the HGraph in the C1visualizer format.
@@ -39,6 +109,12 @@ class HGraphVisualizer : public ValueObject {
 
   void PrintHeader(const char* method_name) const;
   void DumpGraph(const char* pass_name, bool is_after_pass = true) const;
+  // Dumps the graph with the code generated for each instruction, followed by the slow paths.
+  // The code generator must have been given a DisassemblyInformation before compiling.
+  void DumpGraphWithDisassembly(const uint8_t* code) const;
+
+  // Name of the pass printed by DumpGraphWithDisassembly(), which checker tests can match.
+  static constexpr const char* kDisassemblyPassName = "disassembly";
 
  private:
   std::ostream* const output_;
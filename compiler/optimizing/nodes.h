@@ -827,6 +827,7 @@ class HLoopInformationOutwardIterator : public ValueObject {
   M(ClinitCheck, Instruction)                                           \
   M(Compare, BinaryOperation)                                           \
   M(Condition, BinaryOperation)                                         \
+  M(CountHotness, Instruction)                                          \
   M(Deoptimize, Instruction)                                            \
   M(Div, BinaryOperation)                                               \
   M(DivZeroCheck, Instruction)                                          \
@@ -1532,8 +1533,9 @@ class HInstruction : public ArenaObject<kArenaAllocMisc> {
   //      to walk the stack and have the current method stored at a specific stack address.
   // (2): Object literals like classes and strings, that are loaded from the dex cache
   //      fields of the current method.
+  // (3): The counting of the hotness of the current method.
   bool NeedsCurrentMethod() const {
-    return NeedsEnvironment() || IsLoadClass() || IsLoadString();
+    return NeedsEnvironment() || IsLoadClass() || IsLoadString() || IsCountHotness();
   }
 
   virtual bool NeedsDexCache() const { return false; }
@@ -3459,6 +3461,21 @@ class HSuspendCheck : public HTemplateInstruction<0> {
   DISALLOW_COPY_AND_ASSIGN(HSuspendCheck);
 };
 
+/**
+ * Counts down the hotness counter of the current method, stopping at zero. Added to
+ * method entries and back edges of code compiled for the baseline tier of the JIT,
+ * which recompiles the method with all optimizations once the counter reaches zero.
+ */
+class HCountHotness : public HTemplateInstruction<0> {
+ public:
+  HCountHotness() : HTemplateInstruction(SideEffects::ChangesSomething()) {}
+
+  DECLARE_INSTRUCTION(CountHotness);
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(HCountHotness);
+};
+
 /**
  * Instruction to load a Class object.
  */
@@ -38,6 +38,7 @@
 #include "driver/compiler_options.h"
 #include "driver/dex_compilation_unit.h"
 #include "elf_writer_quick.h"
+#include "escape_analysis.h"
 #include "graph_visualizer.h"
 #include "gvn.h"
 #include "inliner.h"
@@ -130,6 +131,16 @@ class PassInfoPrinter : public ValueObject {
     }
   }
 
+  bool IsVisualizerEnabled() const {
+    return visualizer_enabled_;
+  }
+
+  void DumpDisassembly(const uint8_t* code) const {
+    if (visualizer_enabled_) {
+      visualizer_.DumpGraphWithDisassembly(code);
+    }
+  }
+
  private:
   void StartPass(const char* pass_name) {
     // Dump graph first, then start timer.
@@ -372,6 +383,7 @@ static void RunOptimizations(HGraph* graph,
   BoundsCheckElimination* bce = new (arena) BoundsCheckElimination(graph);
   ReferenceTypePropagation* type_propagation =
       new (arena) ReferenceTypePropagation(graph, dex_file, dex_compilation_unit, handles);
+  EscapeAnalysis* escape_analysis = new (arena) EscapeAnalysis(graph, stats);
   InstructionSimplifier* simplify2 = new (arena) InstructionSimplifier(
       graph, stats, "instruction_simplifier_after_types");
 
@@ -380,6 +392,21 @@ static void RunOptimizations(HGraph* graph,
   IntrinsicsRecognizer* intrinsics = new (arena) IntrinsicsRecognizer(graph,
                                                     dex_compilation_unit.GetDexFile(), driver);
 
+  if (driver->GetCompilerOptions().IsJitBaseline()) {
+    // The baseline tier of the JIT only runs the cheap passes. Hot methods are compiled
+    // again with all of them.
+    HOptimization* baseline_optimizations[] = {
+      intrinsics,
+      fold1,
+      simplify1,
+      dce1,
+      simplify3,
+    };
+    RunOptimizations(
+        baseline_optimizations, arraysize(baseline_optimizations), pass_info_printer);
+    return;
+  }
+
   HOptimization* optimizations[] = {
     intrinsics,
     fold1,
@@ -396,6 +423,8 @@ static void RunOptimizations(HGraph* graph,
     licm,
     bce,
     type_propagation,
+    // Escape analysis needs the exact types of the allocations.
+    escape_analysis,
     simplify2,
     dce2,
     // The codegen has a few assumptions that only the instruction simplifier can
@@ -445,8 +474,14 @@ CompiledMethod* OptimizingCompiler::CompileOptimized(HGraph* graph,
 
   AllocateRegisters(graph, codegen, pass_info_printer);
 
+  DisassemblyInformation disasm_info(graph->GetArena());
+  if (pass_info_printer->IsVisualizerEnabled()) {
+    codegen->SetDisassemblyInformation(&disasm_info);
+  }
   CodeVectorAllocator allocator;
   codegen->CompileOptimized(&allocator);
+  pass_info_printer->DumpDisassembly(allocator.GetMemory().data());
+  codegen->SetDisassemblyInformation(nullptr);
 
   DefaultSrcMap src_mapping_table;
   if (compiler_driver->GetCompilerOptions().GetGenerateDebugInfo()) {
@@ -663,12 +698,15 @@ CompiledMethod* OptimizingCompiler::Compile(const DexFile::CodeItem* code_item,
                                             jobject jclass_loader,
                                             const DexFile& dex_file) const {
   CompilerDriver* compiler_driver = GetCompilerDriver();
+  const bool jit_baseline = compiler_driver->GetCompilerOptions().IsJitBaseline();
   CompiledMethod* method = nullptr;
   if (compiler_driver->IsMethodVerifiedWithoutFailures(method_idx, class_def_idx, dex_file) &&
       !compiler_driver->GetVerifiedMethod(&dex_file, method_idx)->HasRuntimeThrow()) {
      // try fast compile before going into optimizing compiler
-     method = TryFastCompile(compiler_driver, delegate_.get(), code_item, access_flags, invoke_type,
-                             class_def_idx, method_idx, jclass_loader, dex_file);
+     if (!jit_baseline) {
+       method = TryFastCompile(compiler_driver, delegate_.get(), code_item, access_flags,
+                               invoke_type, class_def_idx, method_idx, jclass_loader, dex_file);
+     }
 
       if (method != nullptr) {
         return method;
@@ -683,7 +721,9 @@ CompiledMethod* OptimizingCompiler::Compile(const DexFile::CodeItem* code_item,
     }
   }
 
-  if (method != nullptr) {
+  if (method != nullptr || jit_baseline) {
+    // Baseline code must count the hotness of the method, which Quick code does not do.
+    // The JIT compiles the method for the optimized tier instead.
     return method;
   }
   method = delegate_->Compile(code_item, access_flags, invoke_type, class_def_idx, method_idx,
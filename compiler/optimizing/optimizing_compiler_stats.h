@@ -39,6 +39,7 @@ enum MethodCompilationStat {
   kNotCompiledLargeMethodNoBranches,
   kNotCompiledMalformedOpcode,
   kNotCompiledNoCodegen,
+  kNotCompiledNoDequickenInfo,
   kNotCompiledNonSequentialRegPair,
   kNotCompiledPathological,
   kNotCompiledSpaceFilter,
@@ -53,6 +54,7 @@ enum MethodCompilationStat {
   kRemovedCheckedCast,
   kRemovedDeadInstruction,
   kRemovedNullCheck,
+  kScalarReplacedAllocation,
   kLastStat
 };
 
@@ -108,6 +110,7 @@ class OptimizingCompilerStats {
       case kNotCompiledLargeMethodNoBranches : return "kNotCompiledLargeMethodNoBranches";
       case kNotCompiledMalformedOpcode : return "kNotCompiledMalformedOpcode";
       case kNotCompiledNoCodegen : return "kNotCompiledNoCodegen";
+      case kNotCompiledNoDequickenInfo : return "kNotCompiledNoDequickenInfo";
       case kNotCompiledNonSequentialRegPair : return "kNotCompiledNonSequentialRegPair";
       case kNotCompiledPathological : return "kNotCompiledPathological";
       case kNotCompiledSpaceFilter : return "kNotCompiledSpaceFilter";
@@ -122,6 +125,7 @@ class OptimizingCompilerStats {
       case kRemovedCheckedCast: return "kRemovedCheckedCast";
       case kRemovedDeadInstruction: return "kRemovedDeadInstruction";
       case kRemovedNullCheck: return "kRemovedNullCheck";
+      case kScalarReplacedAllocation: return "kScalarReplacedAllocation";
       default: LOG(FATAL) << "invalid stat";
     }
     return "";
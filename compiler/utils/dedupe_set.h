@@ -19,10 +19,11 @@
 
 #include <algorithm>
 #include <inttypes.h>
+#include <string.h>
 #include <memory>
-#include <set>
 #include <string>
 
+#include "atomic.h"
 #include "base/mutex.h"
 #include "base/stl_util.h"
 #include "base/stringprintf.h"
@@ -34,40 +35,166 @@ namespace art {
 // A set of Keys that support a HashFunc returning HashType. Used to find duplicates of Key in the
 // Add method. The data-structure is thread-safe through the use of internal locks, it also
 // supports the lock being sharded.
+//
+// Each shard is an open addressing hash table with linear probing, allocated from the swap space.
+// The table stores the hash of each key so that probing only compares the contents of keys with
+// equal hashes, with memcmp(). Keys must therefore be arrays of trivially comparable elements.
+// The lock is only held to probe and insert, hashing and copying a new key are done outside it.
 template <typename InKey, typename StoreKey, typename HashType, typename HashFunc,
           HashType kShard = 1>
 class DedupeSet {
-  typedef std::pair<HashType, const InKey*> HashedInKey;
-  struct HashedKey {
-    StoreKey* store_ptr;
-    union {
-      HashType store_hash;        // Valid if store_ptr != null.
-      const HashedInKey* in_key;  // Valid if store_ptr == null.
+  class Shard {
+   public:
+    Shard(const SwapAllocator<void>& alloc, const std::string& lock_name)
+        : allocator_(alloc),
+          lock_name_(lock_name),
+          lock_(lock_name_.c_str()),
+          entries_(kMinBuckets, Entry(), SwapAllocator<Entry>(alloc)),
+          size_(0u),
+          contentions_(0u) {
+    }
+
+    ~Shard() {
+      // Have to manually free all pointers.
+      for (const Entry& entry : entries_) {
+        if (entry.store_ptr != nullptr) {
+          DeleteStoreKey(entry.store_ptr);
+        }
+      }
+    }
+
+    StoreKey* Add(Thread* self, HashType hash, const InKey& in_key) {
+      Lock(self);
+      StoreKey* store_key = Find(hash, in_key);
+      lock_.ExclusiveUnlock(self);
+      if (store_key != nullptr) {
+        return store_key;
+      }
+      // Copy the key outside the lock and check again, another thread may have added it.
+      StoreKey* new_key = CreateStoreKey(in_key);
+      Lock(self);
+      store_key = Find(hash, in_key);
+      if (store_key == nullptr) {
+        Insert(hash, new_key);
+        store_key = new_key;
+        new_key = nullptr;
+      }
+      lock_.ExclusiveUnlock(self);
+      if (new_key != nullptr) {
+        DeleteStoreKey(new_key);
+      }
+      return store_key;
+    }
+
+    // Must not be called while other threads are adding keys.
+    void UpdateStats(size_t* size, size_t* displaced, size_t* max_probe_length,
+                     size_t* contentions) const NO_THREAD_SAFETY_ANALYSIS {
+      const size_t mask = entries_.size() - 1u;
+      for (size_t index = 0; index != entries_.size(); ++index) {
+        const Entry& entry = entries_[index];
+        if (entry.store_ptr != nullptr) {
+          size_t probe_length = (index - (entry.hash & mask)) & mask;
+          if (probe_length != 0u) {
+            ++*displaced;
+          }
+          *max_probe_length = std::max(*max_probe_length, probe_length + 1u);
+        }
+      }
+      *size += size_;
+      *contentions += contentions_;
+    }
+
+   private:
+    struct Entry {
+      Entry() : hash(0), store_ptr(nullptr) {}
+
+      HashType hash;
+      StoreKey* store_ptr;  // Null for an empty bucket.
     };
-  };
 
-  class Comparator {
-   public:
-    bool operator()(const HashedKey& a, const HashedKey& b) const {
-      HashType a_hash = (a.store_ptr != nullptr) ? a.store_hash : a.in_key->first;
-      HashType b_hash = (b.store_ptr != nullptr) ? b.store_hash : b.in_key->first;
-      if (a_hash != b_hash) {
-        return a_hash < b_hash;
+    // Keep the load factor at or below 3/4.
+    static constexpr size_t kMinBuckets = 64u;
+    static constexpr size_t kMaxLoadNumerator = 3u;
+    static constexpr size_t kMaxLoadDenominator = 4u;
+
+    // Counts the acquisitions that had to wait for another thread, for DumpStats().
+    void Lock(Thread* self) EXCLUSIVE_LOCK_FUNCTION(lock_) NO_THREAD_SAFETY_ANALYSIS {
+      if (!lock_.ExclusiveTryLock(self)) {
+        lock_.ExclusiveLock(self);
+        ++contentions_;
+      }
+    }
+
+    static bool Equals(const StoreKey& store_key, const InKey& in_key) {
+      static_assert(sizeof(*store_key.data()) == sizeof(*in_key.data()),
+                    "Stored and added keys must have the same element size");
+      return store_key.size() == in_key.size() &&
+          (in_key.size() == 0u ||
+           memcmp(store_key.data(), in_key.data(), in_key.size() * sizeof(*in_key.data())) == 0);
+    }
+
+    StoreKey* Find(HashType hash, const InKey& in_key) const EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+      const size_t mask = entries_.size() - 1u;
+      for (size_t index = hash & mask; ; index = (index + 1u) & mask) {
+        const Entry& entry = entries_[index];
+        if (entry.store_ptr == nullptr) {
+          return nullptr;
+        }
+        if (entry.hash == hash && Equals(*entry.store_ptr, in_key)) {
+          return entry.store_ptr;
+        }
+      }
+    }
+
+    void Insert(HashType hash, StoreKey* store_key) EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+      if ((size_ + 1u) * kMaxLoadDenominator > entries_.size() * kMaxLoadNumerator) {
+        Grow();
+      }
+      InsertEntry(&entries_, hash, store_key);
+      ++size_;
+    }
+
+    static void InsertEntry(SwapVector<Entry>* entries, HashType hash, StoreKey* store_key) {
+      const size_t mask = entries->size() - 1u;
+      size_t index = hash & mask;
+      while ((*entries)[index].store_ptr != nullptr) {
+        index = (index + 1u) & mask;
       }
-      if (a.store_ptr != nullptr && b.store_ptr != nullptr) {
-        return std::lexicographical_compare(a.store_ptr->begin(), a.store_ptr->end(),
-                                            b.store_ptr->begin(), b.store_ptr->end());
-      } else if (a.store_ptr != nullptr && b.store_ptr == nullptr) {
-        return std::lexicographical_compare(a.store_ptr->begin(), a.store_ptr->end(),
-                                            b.in_key->second->begin(), b.in_key->second->end());
-      } else if (a.store_ptr == nullptr && b.store_ptr != nullptr) {
-        return std::lexicographical_compare(a.in_key->second->begin(), a.in_key->second->end(),
-                                            b.store_ptr->begin(), b.store_ptr->end());
-      } else {
-        return std::lexicographical_compare(a.in_key->second->begin(), a.in_key->second->end(),
-                                            b.in_key->second->begin(), b.in_key->second->end());
+      (*entries)[index].hash = hash;
+      (*entries)[index].store_ptr = store_key;
+    }
+
+    void Grow() EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+      // The stored hashes avoid rehashing the keys.
+      SwapVector<Entry> new_entries(entries_.size() * 2u, Entry(), entries_.get_allocator());
+      for (const Entry& entry : entries_) {
+        if (entry.store_ptr != nullptr) {
+          InsertEntry(&new_entries, entry.hash, entry.store_ptr);
+        }
       }
+      entries_.swap(new_entries);
+    }
+
+    StoreKey* CreateStoreKey(const InKey& key) {
+      StoreKey* ret = allocator_.allocate(1);
+      allocator_.construct(ret, key.begin(), key.end(), allocator_);
+      return ret;
+    }
+
+    void DeleteStoreKey(StoreKey* key) {
+      SwapAllocator<StoreKey> alloc(allocator_);
+      alloc.destroy(key);
+      alloc.deallocate(key, 1);
     }
+
+    SwapAllocator<StoreKey> allocator_;
+    const std::string lock_name_;
+    mutable Mutex lock_;
+    SwapVector<Entry> entries_ GUARDED_BY(lock_);
+    size_t size_ GUARDED_BY(lock_);
+    size_t contentions_ GUARDED_BY(lock_);
+
+    DISALLOW_COPY_AND_ASSIGN(Shard);
   };
 
  public:
@@ -79,90 +206,39 @@ class DedupeSet {
     HashType raw_hash = HashFunc()(key);
     if (kIsDebugBuild) {
       uint64_t hash_end = NanoTime();
-      hash_time_ += hash_end - hash_start;
+      hash_time_.FetchAndAddSequentiallyConsistent(hash_end - hash_start);
     }
     HashType shard_hash = raw_hash / kShard;
     HashType shard_bin = raw_hash % kShard;
-    HashedInKey hashed_in_key(shard_hash, &key);
-    HashedKey hashed_key;
-    hashed_key.store_ptr = nullptr;
-    hashed_key.in_key = &hashed_in_key;
-    MutexLock lock(self, *lock_[shard_bin]);
-    auto it = keys_[shard_bin].find(hashed_key);
-    if (it != keys_[shard_bin].end()) {
-      DCHECK(it->store_ptr != nullptr);
-      return it->store_ptr;
-    }
-    hashed_key.store_ptr = CreateStoreKey(key);
-    hashed_key.store_hash = shard_hash;
-    keys_[shard_bin].insert(hashed_key);
-    return hashed_key.store_ptr;
+    return shards_[shard_bin]->Add(self, shard_hash, key);
   }
 
   explicit DedupeSet(const char* set_name, SwapAllocator<void>& alloc)
-      : allocator_(alloc), hash_time_(0) {
+      : hash_time_(0) {
     for (HashType i = 0; i < kShard; ++i) {
       std::ostringstream oss;
       oss << set_name << " lock " << i;
-      lock_name_[i] = oss.str();
-      lock_[i].reset(new Mutex(lock_name_[i].c_str()));
-    }
-  }
-
-  ~DedupeSet() {
-    // Have to manually free all pointers.
-    for (auto& shard : keys_) {
-      for (const auto& hashed_key : shard) {
-        DCHECK(hashed_key.store_ptr != nullptr);
-        DeleteStoreKey(hashed_key.store_ptr);
-      }
+      shards_[i].reset(new Shard(alloc, oss.str()));
     }
   }
 
   std::string DumpStats() const {
-    size_t collision_sum = 0;
-    size_t collision_max = 0;
+    size_t size = 0;
+    size_t displaced = 0;
+    size_t max_probe_length = 0;
+    size_t contentions = 0;
     for (HashType shard = 0; shard < kShard; ++shard) {
-      HashType last_hash = 0;
-      size_t collision_cur_max = 0;
-      for (const HashedKey& key : keys_[shard]) {
-        DCHECK(key.store_ptr != nullptr);
-        if (key.store_hash == last_hash) {
-          collision_cur_max++;
-          if (collision_cur_max > 1) {
-            collision_sum++;
-            if (collision_cur_max > collision_max) {
-              collision_max = collision_cur_max;
-            }
-          }
-        } else {
-          collision_cur_max = 1;
-          last_hash = key.store_hash;
-        }
-      }
+      shards_[shard]->UpdateStats(&size, &displaced, &max_probe_length, &contentions);
     }
-    return StringPrintf("%zu collisions, %zu max bucket size, %" PRIu64 " ns hash time",
-                        collision_sum, collision_max, hash_time_);
+    return StringPrintf("%zu entries, %zu displaced, %zu max probe length, %zu lock contentions, "
+                        "%" PRIu64 " ns hash time",
+                        size, displaced, max_probe_length, contentions,
+                        hash_time_.LoadRelaxed());
   }
 
  private:
-  StoreKey* CreateStoreKey(const InKey& key) {
-    StoreKey* ret = allocator_.allocate(1);
-    allocator_.construct(ret, key.begin(), key.end(), allocator_);
-    return ret;
-  }
-
-  void DeleteStoreKey(StoreKey* key) {
-    SwapAllocator<StoreKey> alloc(allocator_);
-    alloc.destroy(key);
-    alloc.deallocate(key, 1);
-  }
-
-  std::string lock_name_[kShard];
-  std::unique_ptr<Mutex> lock_[kShard];
-  std::set<HashedKey, Comparator> keys_[kShard];
-  SwapAllocator<StoreKey> allocator_;
-  uint64_t hash_time_;
+  std::unique_ptr<Shard> shards_[kShard];
+  Atomic<uint64_t> hash_time_;
 
   DISALLOW_COPY_AND_ASSIGN(DedupeSet);
 };
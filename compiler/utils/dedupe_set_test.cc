@@ -16,9 +16,13 @@
 
 #include "dedupe_set.h"
 
+#include <pthread.h>
+
 #include <algorithm>
 #include <cstdio>
+#include <vector>
 
+#include "base/time_utils.h"
 #include "gtest/gtest.h"
 #include "thread-inl.h"
 
@@ -79,4 +83,73 @@ TEST(DedupeSetTest, Test) {
   }
 }
 
+typedef DedupeSet<std::vector<uint8_t>, SwapVector<uint8_t>, size_t, DedupeHashFunc, 16>
+    ConcurrentDedupeSet;
+
+struct ConcurrentAddArgs {
+  ConcurrentDedupeSet* deduplicator;
+  const std::vector<std::vector<uint8_t>>* keys;
+  size_t first_key;
+  std::vector<SwapVector<uint8_t>*> results;
+};
+
+static void* ConcurrentAddCallback(void* arg) {
+  ConcurrentAddArgs* args = reinterpret_cast<ConcurrentAddArgs*>(arg);
+  const size_t num_keys = args->keys->size();
+  args->results.resize(num_keys);
+  // Start at a different key in each thread so that the threads race to add the same keys.
+  for (size_t i = 0; i != num_keys; ++i) {
+    size_t index = (args->first_key + i) % num_keys;
+    args->results[index] = args->deduplicator->Add(nullptr, (*args->keys)[index]);
+  }
+  return nullptr;
+}
+
+// Checks that concurrent adds of the same keys return the same copies, and logs the throughput
+// and lock contention at various thread counts.
+TEST(DedupeSetTest, ConcurrentAdd) {
+  static constexpr size_t kNumKeys = 20000;
+  std::vector<std::vector<uint8_t>> keys(kNumKeys);
+  for (size_t i = 0; i != kNumKeys; ++i) {
+    // Keys of different lengths, like compiled code and tables.
+    keys[i].resize(16u + i % 64u);
+    for (size_t j = 0; j != keys[i].size(); ++j) {
+      keys[i][j] = static_cast<uint8_t>((i >> (8 * (j % 4))) + j);
+    }
+  }
+  SwapAllocator<void> swap(nullptr);
+  for (size_t num_threads : { 1u, 2u, 4u, 8u, 16u }) {
+    ConcurrentDedupeSet deduplicator("test", swap);
+    std::vector<ConcurrentAddArgs> args(num_threads);
+    std::vector<pthread_t> pthreads(num_threads);
+    uint64_t start_time = NanoTime();
+    for (size_t t = 0; t != num_threads; ++t) {
+      args[t].deduplicator = &deduplicator;
+      args[t].keys = &keys;
+      args[t].first_key = t * kNumKeys / num_threads;
+      ASSERT_EQ(0, pthread_create(&pthreads[t], nullptr, ConcurrentAddCallback, &args[t]));
+    }
+    for (size_t t = 0; t != num_threads; ++t) {
+      ASSERT_EQ(0, pthread_join(pthreads[t], nullptr));
+    }
+    uint64_t duration_ns = std::max<uint64_t>(NanoTime() - start_time, 1u);
+    LOG(INFO) << num_threads << " threads: "
+              << (num_threads * kNumKeys * UINT64_C(1000000000) / duration_ns) << " adds/s, "
+              << deduplicator.DumpStats();
+
+    for (size_t i = 0; i != kNumKeys; ++i) {
+      SwapVector<uint8_t>* result = args[0].results[i];
+      ASSERT_NE(result, nullptr);
+      ASSERT_TRUE(std::equal(keys[i].begin(), keys[i].end(), result->begin()));
+      for (size_t t = 1; t != num_threads; ++t) {
+        ASSERT_EQ(result, args[t].results[i]);
+      }
+    }
+    // Distinct keys are never merged.
+    std::vector<SwapVector<uint8_t>*> unique_results(args[0].results);
+    std::sort(unique_results.begin(), unique_results.end());
+    ASSERT_EQ(unique_results.end(), std::unique(unique_results.begin(), unique_results.end()));
+  }
+}
+
 }  // namespace art
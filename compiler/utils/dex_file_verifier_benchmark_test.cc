@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
+#include "common_runtime_test.h"
+#include "dex_file_verifier.h"
+#include "leb128.h"
+#include "test_dex_file_builder.h"
+#include "utils.h"
+
+namespace art {
+
+// Verifies large synthetic dex files with different numbers of threads, and logs the time taken.
+class DexFileVerifierBenchmarkTest : public CommonRuntimeTest {
+ protected:
+  static constexpr size_t kNumClasses = 20000;
+  static constexpr size_t kMethodsPerClass = 8;
+  static constexpr const char* kLocation = "DexFileVerifierBenchmarkTest";
+
+  static std::unique_ptr<const DexFile> BuildLargeDexFile(TestDexFileBuilder* builder) {
+    static const char* const kSignatures[] = { "()V", "(I)I", "(J[I)V", "(Ljava/lang/Object;)Z" };
+    for (size_t i = 0; i != kNumClasses; ++i) {
+      std::string descriptor = StringPrintf("Lbenchmark/Class%zu;", i);
+      builder->AddField(descriptor, "I", "intField");
+      builder->AddField(descriptor, "Ljava/lang/Object;", "objectField");
+      for (size_t j = 0; j != kMethodsPerClass; ++j) {
+        builder->AddMethod(descriptor, kSignatures[j % arraysize(kSignatures)],
+                           StringPrintf("method%zu", j));
+      }
+    }
+    return builder->Build(kLocation);
+  }
+
+  static bool Verify(const DexFile* dex_file, size_t num_threads, std::string* error_msg,
+                     size_t* num_parallel_chunks = nullptr) {
+    uint64_t start_ns = NanoTime();
+    bool result = DexFileVerifier::Verify(dex_file, dex_file->Begin(), dex_file->Size(),
+                                          kLocation, num_threads, error_msg, num_parallel_chunks);
+    LOG(INFO) << "Verified " << PrettySize(dex_file->Size()) << " with " << num_threads
+              << " thread(s) in " << PrettyDuration(NanoTime() - start_ns);
+    return result;
+  }
+
+  // Returns a copy of the dex file modified by the corrupt function, with a valid checksum.
+  template <typename Corrupt>
+  static std::unique_ptr<const DexFile> CorruptDexFile(const DexFile* dex_file,
+                                                       std::vector<uint8_t>* data,
+                                                       Corrupt corrupt) {
+    data->assign(dex_file->Begin(), dex_file->Begin() + dex_file->Size());
+    DexFile::Header* header = reinterpret_cast<DexFile::Header*>(&(*data)[0]);
+    corrupt(header, &(*data)[0]);
+    const size_t non_sum = sizeof(header->magic_) + sizeof(header->checksum_);
+    header->checksum_ = adler32(adler32(0L, Z_NULL, 0), &(*data)[non_sum], data->size() - non_sum);
+    std::string error_msg;
+    std::unique_ptr<const DexFile> result(
+        DexFile::Open(&(*data)[0], data->size(), kLocation, 0u, nullptr, &error_msg));
+    EXPECT_TRUE(result != nullptr) << error_msg;
+    return result;
+  }
+
+  static void ExpectSameFailure(const DexFile* dex_file, const char* expected_error) {
+    std::string expected_error_msg;
+    ASSERT_FALSE(Verify(dex_file, 1u, &expected_error_msg));
+    EXPECT_NE(std::string::npos, expected_error_msg.find(expected_error)) << expected_error_msg;
+    for (size_t num_threads : { 2u, 4u }) {
+      std::string parallel_error_msg;
+      EXPECT_FALSE(Verify(dex_file, num_threads, &parallel_error_msg));
+      EXPECT_EQ(expected_error_msg, parallel_error_msg);
+    }
+  }
+};
+
+TEST_F(DexFileVerifierBenchmarkTest, LargeDexFile) {
+  TestDexFileBuilder builder;
+  std::unique_ptr<const DexFile> dex_file(BuildLargeDexFile(&builder));
+  ASSERT_EQ(kNumClasses * kMethodsPerClass, dex_file->NumMethodIds());
+
+  for (size_t num_threads : { 1u, 2u, 4u }) {
+    std::string error_msg;
+    size_t num_parallel_chunks;
+    EXPECT_TRUE(Verify(dex_file.get(), num_threads, &error_msg, &num_parallel_chunks))
+        << error_msg;
+    // The string data and the id sections are large enough to be split.
+    if (num_threads == 1u) {
+      EXPECT_EQ(0u, num_parallel_chunks);
+    } else {
+      EXPECT_LT(0u, num_parallel_chunks) << num_threads;
+    }
+  }
+}
+
+TEST_F(DexFileVerifierBenchmarkTest, FailureReasonDoesNotDependOnThreads) {
+  TestDexFileBuilder builder;
+  std::unique_ptr<const DexFile> dex_file(BuildLargeDexFile(&builder));
+
+  // Swap two method ids in the middle of the section, so that they are out of order.
+  std::vector<uint8_t> data;
+  std::unique_ptr<const DexFile> bad_dex_file(CorruptDexFile(
+      dex_file.get(), &data, [&](DexFile::Header* header, uint8_t* begin) {
+        uint8_t* first = begin + header->method_ids_off_ +
+            (dex_file->NumMethodIds() / 2u) * sizeof(DexFile::MethodId);
+        std::swap_ranges(first, first + sizeof(DexFile::MethodId),
+                         first + sizeof(DexFile::MethodId));
+      }));
+  ASSERT_TRUE(bad_dex_file != nullptr);
+  ExpectSameFailure(bad_dex_file.get(), "Out-of-order method_ids");
+}
+
+TEST_F(DexFileVerifierBenchmarkTest, StringDataFailureReasonDoesNotDependOnThreads) {
+  TestDexFileBuilder builder;
+  std::unique_ptr<const DexFile> dex_file(BuildLargeDexFile(&builder));
+
+  // Put an illegal byte at the start of a string in the middle of the string data.
+  std::vector<uint8_t> data;
+  std::unique_ptr<const DexFile> bad_dex_file(CorruptDexFile(
+      dex_file.get(), &data, [&](DexFile::Header* header, uint8_t* begin) {
+        const DexFile::StringId* string_ids =
+            reinterpret_cast<const DexFile::StringId*>(begin + header->string_ids_off_);
+        uint8_t* string_data = begin + string_ids[header->string_ids_size_ / 2u].string_data_off_;
+        const uint8_t* chars = string_data;
+        DecodeUnsignedLeb128(&chars);
+        string_data[chars - string_data] = 0x80u;
+      }));
+  ASSERT_TRUE(bad_dex_file != nullptr);
+  ExpectSameFailure(bad_dex_file.get(), "Illegal start byte");
+}
+
+}  // namespace art
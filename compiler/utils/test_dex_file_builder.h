@@ -17,6 +17,8 @@
 #ifndef ART_COMPILER_UTILS_TEST_DEX_FILE_BUILDER_H_
 #define ART_COMPILER_UTILS_TEST_DEX_FILE_BUILDER_H_
 
+#include <zlib.h>
+
 #include <cstring>
 #include <set>
 #include <map>
@@ -88,11 +90,10 @@ class TestDexFileBuilder {
     DexFile::Header* header = reinterpret_cast<DexFile::Header*>(&header_data.data);
     std::copy_n(DexFile::kDexMagic, 4u, header->magic_);
     std::copy_n(DexFile::kDexMagicVersion, 4u, header->magic_ + 4u);
-    header->header_size_ = sizeof(header);
+    header->header_size_ = sizeof(DexFile::Header);
     header->endian_tag_ = DexFile::kDexEndianConstant;
     header->link_size_ = 0u;  // Unused.
     header->link_off_ = 0u;  // Unused.
-    header->map_off_ = 0u;  // Unused.
 
     uint32_t data_section_size = 0u;
 
@@ -155,10 +156,37 @@ class TestDexFileBuilder {
     header->class_defs_off_ = 0u;
 
     uint32_t data_section_offset = method_ids_offset + methods_.size() * sizeof(DexFile::MethodId);
+
+    // The map list follows the other data items.
+    std::vector<MapItem> map_items;
+    AddMapItem(&map_items, DexFile::kDexTypeHeaderItem, 1u, 0u);
+    AddMapItem(&map_items, DexFile::kDexTypeStringIdItem, strings_.size(), string_ids_offset);
+    AddMapItem(&map_items, DexFile::kDexTypeTypeIdItem, types_.size(), type_ids_offset);
+    AddMapItem(&map_items, DexFile::kDexTypeProtoIdItem, protos_.size(), proto_ids_offset);
+    AddMapItem(&map_items, DexFile::kDexTypeFieldIdItem, fields_.size(), field_ids_offset);
+    AddMapItem(&map_items, DexFile::kDexTypeMethodIdItem, methods_.size(), method_ids_offset);
+    AddMapItem(&map_items, DexFile::kDexTypeStringDataItem, strings_.size(), data_section_offset);
+    uint32_t type_lists_size = 0u;
+    uint32_t type_lists_offset = 0u;
+    for (const auto& entry : protos_) {
+      if (entry.second.data_offset != 0u) {
+        type_lists_offset = (type_lists_size == 0u) ? entry.second.data_offset : type_lists_offset;
+        type_lists_size += 1u;
+      }
+    }
+    AddMapItem(&map_items, DexFile::kDexTypeTypeList, type_lists_size,
+               data_section_offset + type_lists_offset);
+    uint32_t map_offset = data_section_offset + RoundUp(data_section_size, 4u);
+    AddMapItem(&map_items, DexFile::kDexTypeMapList, 1u, map_offset);
+    data_section_size = map_offset - data_section_offset + sizeof(uint32_t) +
+        map_items.size() * sizeof(DexFile::MapItem);
+    header->map_off_ = map_offset;
+
     header->data_size_ = data_section_size;
-    header->data_off_ = (data_section_size != 0u) ? data_section_offset : 0u;
+    header->data_off_ = data_section_offset;
 
     uint32_t total_size = data_section_offset + data_section_size;
+    header->file_size_ = total_size;
 
     dex_file_data_.resize(total_size);
     std::memcpy(&dex_file_data_[0], header_data.data, sizeof(DexFile::Header));
@@ -210,7 +238,19 @@ class TestDexFileBuilder {
       Write32(raw_offset + 4u, GetStringIdx(entry.first.name));
     }
 
-    // Leave checksum and signature as zeros.
+    Write32(map_offset, map_items.size());
+    for (size_t i = 0; i != map_items.size(); ++i) {
+      uint32_t raw_offset = map_offset + sizeof(uint32_t) + i * sizeof(DexFile::MapItem);
+      Write16(raw_offset + 0u, map_items[i].type);
+      Write32(raw_offset + 4u, map_items[i].size);
+      Write32(raw_offset + 8u, map_items[i].offset);
+    }
+
+    // Leave the signature as zeros. The checksum makes the file acceptable to the verifier.
+    const size_t non_sum = sizeof(header->magic_) + sizeof(header->checksum_);
+    uint32_t checksum = adler32(adler32(0L, Z_NULL, 0), &dex_file_data_[non_sum],
+                                dex_file_data_.size() - non_sum);
+    Write32(sizeof(header->magic_), checksum);
 
     std::string error_msg;
     std::unique_ptr<const DexFile> dex_file(DexFile::Open(
@@ -249,6 +289,12 @@ class TestDexFileBuilder {
   }
 
  private:
+  struct MapItem {
+    uint16_t type;
+    uint32_t size;
+    uint32_t offset;
+  };
+
   struct IdxAndDataOffset {
     uint32_t idx;
     uint32_t data_offset;
@@ -338,6 +384,14 @@ class TestDexFileBuilder {
     return key;
   }
 
+  static void AddMapItem(std::vector<MapItem>* map_items, uint16_t type, uint32_t size,
+                         uint32_t offset) {
+    if (size != 0u) {
+      MapItem item = { type, size, offset };
+      map_items->push_back(item);
+    }
+  }
+
   void Write32(size_t offset, uint32_t value) {
     CHECK_LE(offset + 4u, dex_file_data_.size());
     CHECK_EQ(dex_file_data_[offset + 0], 0u);
@@ -17,6 +17,7 @@
 #include "test_dex_file_builder.h"
 
 #include "dex_file-inl.h"
+#include "dex_file_verifier.h"
 #include "gtest/gtest.h"
 #include "utils.h"
 
@@ -33,6 +34,9 @@ TEST(TestDexFileBuilderTest, SimpleTest) {
   std::unique_ptr<const DexFile> dex_file(builder.Build(dex_location));
   ASSERT_TRUE(dex_file != nullptr);
   EXPECT_STREQ(dex_location, dex_file->GetLocation().c_str());
+  std::string error_msg;
+  EXPECT_TRUE(DexFileVerifier::Verify(dex_file.get(), dex_file->Begin(), dex_file->Size(),
+                                      dex_location, &error_msg)) << error_msg;
 
   static const char* const expected_strings[] = {
       "Arbitrary string",
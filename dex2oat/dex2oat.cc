@@ -53,6 +53,7 @@
 #include "dex/verification_results.h"
 #include "dex/quick_compiler_callbacks.h"
 #include "dex/quick/dex_file_to_method_inliner_map.h"
+#include "driver/compilation_cache.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
 #include "elf_file.h"
@@ -235,6 +236,11 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --compile-pic: Force indirect use of code, methods, and classes");
   UsageError("      Default: disabled");
   UsageError("");
+  UsageError("  --inline-allocation: Allocate objects and arrays inline from the thread-local");
+  UsageError("      allocation buffer. Use when the target runtime uses a moving collector");
+  UsageError("      with a TLAB allocator.");
+  UsageError("      Default: disabled");
+  UsageError("");
   UsageError("  --compiler-backend=(Quick|Optimizing): select compiler backend");
   UsageError("      set.");
   UsageError("      Example: --compiler-backend=Optimizing");
@@ -341,6 +347,16 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --swap-fd=<file-descriptor>:  specifies a file to use for swap (by descriptor).");
   UsageError("      Example: --swap-fd=10");
   UsageError("");
+  UsageError("  --compilation-cache-dir=<directory>: reuse compiled methods from earlier runs");
+  UsageError("      stored in the given directory, and store newly compiled methods there.");
+  UsageError("      Not supported with --image or --profile-file.");
+  UsageError("      Example: --compilation-cache-dir=/data/local/tmp/dex2oat-cache");
+  UsageError("");
+  UsageError("  --compilation-cache-max-size-mb=<n>: evict the least recently used entries of the");
+  UsageError("      compilation cache when it grows beyond the given size.");
+  UsageError("      Example: --compilation-cache-max-size-mb=64");
+  UsageError("      Default: 256");
+  UsageError("");
   std::cerr << "See log for usage error information\n";
   exit(EXIT_FAILURE);
 }
@@ -529,6 +545,7 @@ class Dex2Oat FINAL {
       dump_timing_(false),
       dump_slow_timing_(kIsDebugBuild),
       swap_fd_(-1),
+      compilation_cache_max_size_mb_(CompilationCache::kDefaultMaxSize / MB),
       timings_(timings) {}
 
   ~Dex2Oat() {
@@ -569,6 +586,7 @@ class Dex2Oat FINAL {
     std::string boot_image_filename;
     const char* compiler_filter_string = nullptr;
     bool compile_pic = false;
+    bool inline_allocation = false;
     int huge_method_threshold = CompilerOptions::kDefaultHugeMethodThreshold;
     int large_method_threshold = CompilerOptions::kDefaultLargeMethodThreshold;
     int small_method_threshold = CompilerOptions::kDefaultSmallMethodThreshold;
@@ -708,6 +726,8 @@ class Dex2Oat FINAL {
         compiler_filter_string = option.substr(strlen("--compiler-filter=")).data();
       } else if (option == "--compile-pic") {
         compile_pic = true;
+      } else if (option == "--inline-allocation") {
+        inline_allocation = true;
       } else if (option.starts_with("--huge-method-max=")) {
         const char* threshold = option.substr(strlen("--huge-method-max=")).data();
         if (!ParseInt(threshold, &huge_method_threshold)) {
@@ -843,6 +863,14 @@ class Dex2Oat FINAL {
         if (swap_fd_ < 0) {
           Usage("--swap-fd passed a negative value %d", swap_fd_);
         }
+      } else if (option.starts_with("--compilation-cache-dir=")) {
+        compilation_cache_dir_ = option.substr(strlen("--compilation-cache-dir=")).data();
+      } else if (option.starts_with("--compilation-cache-max-size-mb=")) {
+        const char* max_size_str = option.substr(strlen("--compilation-cache-max-size-mb=")).data();
+        if (!ParseUint(max_size_str, &compilation_cache_max_size_mb_)) {
+          Usage("Failed to parse --compilation-cache-max-size-mb argument '%s' as an integer",
+                max_size_str);
+        }
       } else if (option == "--abort-on-hard-verifier-error") {
         abort_on_hard_verifier_error = true;
       } else {
@@ -1080,6 +1108,7 @@ class Dex2Oat FINAL {
                                                 new PassManagerOptions(pass_manager_options),
                                                 init_failure_output_.get(),
                                                 abort_on_hard_verifier_error));
+    compiler_options_->SetInlineAllocation(inline_allocation);
 
     // Done with usage checks, enable watchdog if requested
     if (watch_dog_enabled) {
@@ -1423,6 +1452,9 @@ class Dex2Oat FINAL {
                                  compiler_phases_timings_.get(),
                                  swap_fd_,
                                  profile_file_);
+    if (!compilation_cache_dir_.empty()) {
+      driver_->EnableCompilationCache(compilation_cache_dir_, compilation_cache_max_size_mb_ * MB);
+    }
 
     driver_->CompileAll(class_loader, dex_files_, timings_);
   }
@@ -1937,6 +1969,8 @@ class Dex2Oat FINAL {
   std::string swap_file_name_;
   int swap_fd_;
   std::string profile_file_;  // Profile file to use
+  std::string compilation_cache_dir_;
+  size_t compilation_cache_max_size_mb_;
   TimingLogger* timings_;
   std::unique_ptr<CumulativeLogger> compiler_phases_timings_;
   std::unique_ptr<std::ostream> init_failure_output_;
@@ -46,6 +46,13 @@ Disassembler* Disassembler::Create(InstructionSet instruction_set, DisassemblerO
   }
 }
 
+// Lets the compiler create a disassembler for the graph visualizer without linking against
+// this library, see HGraphVisualizerDisassembler.
+extern "C" Disassembler* create_disassembler(InstructionSet instruction_set,
+                                             DisassemblerOptions* options) {
+  return Disassembler::Create(instruction_set, options);
+}
+
 std::string Disassembler::FormatInstructionPointer(const uint8_t* begin) {
   if (disassembler_options_->absolute_addresses_) {
     return StringPrintf("%p", begin);
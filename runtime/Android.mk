@@ -62,6 +62,7 @@ LIBART_COMMON_SRC_FILES := \
   gc/collector/semi_space.cc \
   gc/collector/sticky_mark_sweep.cc \
   gc/gc_cause.cc \
+  gc/allocation_profiler.cc \
   gc/heap.cc \
   gc/reference_processor.cc \
   gc/reference_queue.cc \
@@ -102,6 +103,7 @@ LIBART_COMMON_SRC_FILES := \
   linear_alloc.cc \
   mem_map.cc \
   memory_region.cc \
+  metrics.cc \
   mirror/abstract_method.cc \
   mirror/array.cc \
   mirror/class.cc \
@@ -164,6 +166,7 @@ LIBART_COMMON_SRC_FILES := \
   thread_pool.cc \
   trace.cc \
   transaction.cc \
+  type_lookup_table.cc \
   profiler.cc \
   fault_handler.cc \
   utf.cc \
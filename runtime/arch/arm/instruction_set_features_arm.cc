@@ -99,14 +99,14 @@ const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromVariant(
           << ") using conservative defaults";
     }
   }
-  return new ArmInstructionSetFeatures(smp, has_div, has_lpae);
+  return new ArmInstructionSetFeatures(smp, has_div, has_lpae, false);
 }
 
 const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromBitmap(uint32_t bitmap) {
   bool smp = (bitmap & kSmpBitfield) != 0;
   bool has_div = (bitmap & kDivBitfield) != 0;
   bool has_atomic_ldrd_strd = (bitmap & kAtomicLdrdStrdBitfield) != 0;
-  return new ArmInstructionSetFeatures(smp, has_div, has_atomic_ldrd_strd);
+  return new ArmInstructionSetFeatures(smp, has_div, has_atomic_ldrd_strd, false);
 }
 
 const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromCppDefines() {
@@ -121,7 +121,12 @@ const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromCppDefines() {
 #else
   const bool has_lpae = false;
 #endif
-  return new ArmInstructionSetFeatures(smp, has_div, has_lpae);
+#if defined(__ARM_NEON__)
+  const bool has_neon = true;
+#else
+  const bool has_neon = false;
+#endif
+  return new ArmInstructionSetFeatures(smp, has_div, has_lpae, has_neon);
 }
 
 const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromCpuInfo() {
@@ -130,6 +135,7 @@ const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromCpuInfo() {
   bool smp = false;
   bool has_lpae = false;
   bool has_div = false;
+  bool has_neon = false;
 
   std::ifstream in("/proc/cpuinfo");
   if (!in.fail()) {
@@ -149,6 +155,9 @@ const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromCpuInfo() {
           if (line.find("lpae") != std::string::npos) {
             has_lpae = true;
           }
+          if (line.find("neon") != std::string::npos) {
+            has_neon = true;
+          }
         } else if (line.find("processor") != std::string::npos &&
             line.find(": 1") != std::string::npos) {
           smp = true;
@@ -159,7 +168,7 @@ const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromCpuInfo() {
   } else {
     LOG(ERROR) << "Failed to open /proc/cpuinfo";
   }
-  return new ArmInstructionSetFeatures(smp, has_div, has_lpae);
+  return new ArmInstructionSetFeatures(smp, has_div, has_lpae, has_neon);
 }
 
 const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromHwcap() {
@@ -167,6 +176,7 @@ const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromHwcap() {
 
   bool has_div = false;
   bool has_lpae = false;
+  bool has_neon = false;
 
 #if defined(HAVE_ANDROID_OS) && defined(__arm__)
   uint64_t hwcaps = getauxval(AT_HWCAP);
@@ -180,9 +190,12 @@ const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromHwcap() {
   if ((hwcaps & HWCAP_LPAE) != 0) {
     has_lpae = true;
   }
+  if ((hwcaps & HWCAP_NEON) != 0) {
+    has_neon = true;
+  }
 #endif
 
-  return new ArmInstructionSetFeatures(smp, has_div, has_lpae);
+  return new ArmInstructionSetFeatures(smp, has_div, has_lpae, has_neon);
 }
 
 // A signal handler called by a fault for an illegal instruction.  We record the fact in r0
@@ -227,7 +240,7 @@ const ArmInstructionSetFeatures* ArmInstructionSetFeatures::FromAssembly() {
 #else
   const bool has_lpae = false;
 #endif
-  return new ArmInstructionSetFeatures(smp, has_div, has_lpae);
+  return new ArmInstructionSetFeatures(smp, has_div, has_lpae, false);
 }
 
 bool ArmInstructionSetFeatures::Equals(const InstructionSetFeatures* other) const {
@@ -285,7 +298,7 @@ const InstructionSetFeatures* ArmInstructionSetFeatures::AddFeaturesFromSplitStr
       return nullptr;
     }
   }
-  return new ArmInstructionSetFeatures(smp, has_div, has_atomic_ldrd_strd);
+  return new ArmInstructionSetFeatures(smp, has_div, has_atomic_ldrd_strd, has_neon_);
 }
 
 }  // namespace art
@@ -67,6 +67,13 @@ class ArmInstructionSetFeatures FINAL : public InstructionSetFeatures {
     return has_atomic_ldrd_strd_;
   }
 
+  // Is the NEON (Advanced SIMD) extension available? Only detected from /proc/cpuinfo, AT_HWCAP
+  // and the C pre-processor #defines. It selects code paths of the runtime and the compiler
+  // never emits NEON, so it is not part of the bitmap, the feature string or Equals.
+  bool HasNeon() const {
+    return has_neon_;
+  }
+
   virtual ~ArmInstructionSetFeatures() {}
 
  protected:
@@ -76,9 +83,9 @@ class ArmInstructionSetFeatures FINAL : public InstructionSetFeatures {
                                  std::string* error_msg) const OVERRIDE;
 
  private:
-  ArmInstructionSetFeatures(bool smp, bool has_div, bool has_atomic_ldrd_strd)
+  ArmInstructionSetFeatures(bool smp, bool has_div, bool has_atomic_ldrd_strd, bool has_neon)
       : InstructionSetFeatures(smp),
-        has_div_(has_div), has_atomic_ldrd_strd_(has_atomic_ldrd_strd) {
+        has_div_(has_div), has_atomic_ldrd_strd_(has_atomic_ldrd_strd), has_neon_(has_neon) {
   }
 
   // Bitmap positions for encoding features as a bitmap.
@@ -90,6 +97,7 @@ class ArmInstructionSetFeatures FINAL : public InstructionSetFeatures {
 
   const bool has_div_;
   const bool has_atomic_ldrd_strd_;
+  const bool has_neon_;
 
   DISALLOW_COPY_AND_ASSIGN(ArmInstructionSetFeatures);
 };
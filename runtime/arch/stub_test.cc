@@ -2285,10 +2285,14 @@ TEST_F(StubTest, IMT) {
 
   // 1. imt_conflict
 
+  // The runtime's conflict method has no conflict table, the trampoline calls into the runtime.
+  ArtMethod* conflict_method = Runtime::Current()->GetImtConflictMethod();
+
   // Contains.
 
   size_t result =
-      Invoke3WithReferrerAndHidden(0U, reinterpret_cast<size_t>(array_list.Get()),
+      Invoke3WithReferrerAndHidden(reinterpret_cast<size_t>(conflict_method),
+                                   reinterpret_cast<size_t>(array_list.Get()),
                                    reinterpret_cast<size_t>(obj.Get()),
                                    StubTest::GetEntrypoint(self, kQuickQuickImtConflictTrampoline),
                                    self, contains_amethod,
@@ -2306,7 +2310,25 @@ TEST_F(StubTest, IMT) {
   // Contains.
 
   result = Invoke3WithReferrerAndHidden(
-      0U, reinterpret_cast<size_t>(array_list.Get()), reinterpret_cast<size_t>(obj.Get()),
+      reinterpret_cast<size_t>(conflict_method), reinterpret_cast<size_t>(array_list.Get()),
+      reinterpret_cast<size_t>(obj.Get()),
+      StubTest::GetEntrypoint(self, kQuickQuickImtConflictTrampoline), self, contains_amethod,
+      static_cast<size_t>(inf_contains->GetDexMethodIndex()));
+
+  ASSERT_FALSE(self->IsExceptionPending());
+  EXPECT_EQ(static_cast<size_t>(JNI_TRUE), result);
+
+  // A conflict method with a conflict table dispatches through the table.
+  std::unique_ptr<uint8_t[]> table_storage(new uint8_t[ImtConflictTable::ComputeSize(1)]);
+  ImtConflictTable* table = new (table_storage.get()) ImtConflictTable();
+  table->SetEntry(0, inf_contains, contains_amethod);
+  table->SetEntry(1, nullptr, nullptr);
+  ArtMethod* table_conflict_method = class_linker_->CreateRuntimeMethod();
+  table_conflict_method->SetImtConflictTable(table, sizeof(void*));
+
+  result = Invoke3WithReferrerAndHidden(
+      reinterpret_cast<size_t>(table_conflict_method), reinterpret_cast<size_t>(array_list.Get()),
+      reinterpret_cast<size_t>(obj.Get()),
       StubTest::GetEntrypoint(self, kQuickQuickImtConflictTrampoline), self, contains_amethod,
       static_cast<size_t>(inf_contains->GetDexMethodIndex()));
 
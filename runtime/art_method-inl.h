@@ -297,7 +297,9 @@ inline bool ArtMethod::IsImtConflictMethod() {
   bool result = this == Runtime::Current()->GetImtConflictMethod();
   // Check that if we do think it is phony it looks like the imt conflict method.
   DCHECK(!result || IsRuntimeMethod());
-  return result;
+  // The conflict methods created for the conflict tables of a class are the only runtime methods
+  // with a JNI entrypoint.
+  return result || (IsRuntimeMethod() && GetImtConflictTable(sizeof(void*)) != nullptr);
 }
 
 inline bool ArtMethod::IsImtUnimplementedMethod() {
@@ -361,7 +363,7 @@ inline const char* ArtMethod::GetName() {
   Runtime* const runtime = Runtime::Current();
   if (this == runtime->GetResolutionMethod()) {
     return "<runtime internal resolution method>";
-  } else if (this == runtime->GetImtConflictMethod()) {
+  } else if (IsImtConflictMethod()) {
     return "<runtime internal imt conflict method>";
   } else if (this == runtime->GetCalleeSaveMethod(Runtime::kSaveAll)) {
     return "<runtime internal callee-save all registers method>";
@@ -522,7 +522,8 @@ void ArtMethod::RegisterNative(const void* native_method, bool is_fast) {
   CHECK(IsNative()) << PrettyMethod(this);
   CHECK(!IsFastNative()) << PrettyMethod(this);
   CHECK(native_method != nullptr) << PrettyMethod(this);
-  if (is_fast) {
+  // Critical natives already skip everything the fast native marker would.
+  if (is_fast && !IsCriticalNative()) {
     SetAccessFlags(GetAccessFlags() | kAccFastNative);
   }
   SetEntryPointFromJni(native_method);
@@ -46,10 +46,47 @@ class PointerArray;
 typedef void (EntryPointFromInterpreter)(Thread* self, const DexFile::CodeItem* code_item,
                                          ShadowFrame* shadow_frame, JValue* result);
 
+class ArtMethod;
+
+// Maps the interface methods of a class which share an IMT slot to their implementations. The
+// entries are terminated by one with a null interface method. Conflict tables are only created at
+// runtime, so they always use the runtime pointer size. The layout is known to the IMT conflict
+// trampolines in the arch specific quick_entrypoints.
+class ImtConflictTable {
+ public:
+  struct Entry {
+    ArtMethod* interface_method;
+    ArtMethod* implementation_method;
+  };
+
+  // Returns the implementation of the interface method, or null if it is not in the table.
+  ArtMethod* Lookup(ArtMethod* interface_method) const {
+    for (const Entry* entry = entries_; entry->interface_method != nullptr; ++entry) {
+      if (entry->interface_method == interface_method) {
+        return entry->implementation_method;
+      }
+    }
+    return nullptr;
+  }
+
+  void SetEntry(size_t index, ArtMethod* interface_method, ArtMethod* implementation_method) {
+    entries_[index].interface_method = interface_method;
+    entries_[index].implementation_method = implementation_method;
+  }
+
+  // Size in bytes of a table with num_entries entries and the terminating entry.
+  static size_t ComputeSize(size_t num_entries) {
+    return (num_entries + 1) * sizeof(Entry);
+  }
+
+ private:
+  Entry entries_[0];
+};
+
 class ArtMethod FINAL {
  public:
   ArtMethod() : access_flags_(0), dex_code_item_offset_(0), dex_method_index_(0),
-      method_index_(0) { }
+      method_index_(0), hotness_count_(0) { }
 
   ArtMethod(const ArtMethod& src, size_t image_pointer_size) {
     CopyFrom(&src, image_pointer_size);
@@ -149,6 +186,13 @@ class ArtMethod FINAL {
     return (GetAccessFlags() & mask) == mask;
   }
 
+  // Critical natives take no JNIEnv* or jclass and are called without a thread state transition,
+  // see ClassLinker::IsCriticalNativeMethod.
+  bool IsCriticalNative() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    uint32_t mask = kAccCriticalNative | kAccNative;
+    return (GetAccessFlags() & mask) == mask;
+  }
+
   bool IsAbstract() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     return (GetAccessFlags() & kAccAbstract) != 0;
   }
@@ -202,6 +246,20 @@ class ArtMethod FINAL {
     return OFFSET_OF_OBJECT_MEMBER(ArtMethod, method_index_);
   }
 
+  // The hotness counter is counted down by the JIT baseline code of the method, see
+  // jit::JitInstrumentationCache.
+  uint16_t GetHotnessCount() const {
+    return hotness_count_;
+  }
+
+  void SetHotnessCount(uint16_t hotness_count) {
+    hotness_count_ = hotness_count;
+  }
+
+  static MemberOffset HotnessCountOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(ArtMethod, hotness_count_);
+  }
+
   uint32_t GetCodeItemOffset() {
     return dex_code_item_offset_;
   }
@@ -427,6 +485,18 @@ class ArtMethod FINAL {
     SetEntryPoint(EntryPointFromJniOffset(pointer_size), entrypoint, pointer_size);
   }
 
+  // IMT conflict methods of a class reuse the JNI entrypoint for their conflict table. Null for
+  // the runtime's shared IMT conflict method.
+  ImtConflictTable* GetImtConflictTable(size_t pointer_size) {
+    DCHECK(IsRuntimeMethod());
+    return reinterpret_cast<ImtConflictTable*>(GetEntryPointFromJniPtrSize(pointer_size));
+  }
+
+  void SetImtConflictTable(ImtConflictTable* table, size_t pointer_size) {
+    DCHECK(IsRuntimeMethod());
+    SetEntryPointFromJniPtrSize(table, pointer_size);
+  }
+
   // Is this a CalleSaveMethod or ResolutionMethod and therefore doesn't adhere to normal
   // conventions for a method of managed code. Returns false for Proxy methods.
   ALWAYS_INLINE bool IsRuntimeMethod();
@@ -565,7 +635,10 @@ class ArtMethod FINAL {
   // Entry within a dispatch table for this method. For static/direct methods the index is into
   // the declaringClass.directMethods, for virtual methods the vtable and for interface methods the
   // ifTable.
-  uint32_t method_index_;
+  uint16_t method_index_;
+
+  // Counted down to zero by JIT baseline code, which writes it without synchronization.
+  uint16_t hotness_count_;
 
   // Fake padding field gets inserted here.
 
@@ -207,6 +207,11 @@ class PACKED(sizeof(T)) Atomic : public std::atomic<T> {
     return this->load(std::memory_order_relaxed);
   }
 
+  // Load from memory with acquire ordering.
+  T LoadAcquire() const {
+    return this->load(std::memory_order_acquire);
+  }
+
   // Load from memory with a total ordering.
   // Corresponds exactly to a Java volatile load.
   T LoadSequentiallyConsistent() const {
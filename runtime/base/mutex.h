@@ -78,6 +78,7 @@ enum LockLevel {
   kDexFileMethodInlinerLock,
   kDexFileToMethodInlinerMapLock,
   kMarkSweepMarkStackLock,
+  kInternTableStripeLock,
   kInternTableLock,
   kOatFileSecondaryLookupLock,
   kTracingUniqueMethodsLock,
@@ -97,6 +98,7 @@ enum LockLevel {
   kJniLoadLibraryLock,
   kThreadListLock,
   kAllocTrackerLock,
+  kAllocationProfilerLock,
   kDeoptimizationLock,
   kProfilerLock,
   kJdwpShutdownLock,
@@ -72,6 +72,11 @@ static constexpr inline uint64_t MsToNs(uint64_t ms) {
   return ms * 1000 * 1000;
 }
 
+// Converts the given number of nanoseconds to microseconds.
+static constexpr inline uint64_t NsToUs(uint64_t ns) {
+  return ns / 1000;
+}
+
 #if defined(__APPLE__)
 // No clocks to specify on OS/X, fake value to pass to routines that require a clock.
 #define CLOCK_REALTIME 0xebadf00d
@@ -53,6 +53,7 @@
 #include "jit/jit_code_cache.h"
 #include "leb128.h"
 #include "linear_alloc.h"
+#include "metrics.h"
 #include "oat.h"
 #include "oat_file.h"
 #include "oat_file_assistant.h"
@@ -1809,6 +1810,8 @@ mirror::Class* ClassLinker::DefineClass(Thread* self, const char* descriptor, si
                                         Handle<mirror::ClassLoader> class_loader,
                                         const DexFile& dex_file,
                                         const DexFile::ClassDef& dex_class_def) {
+  // Includes the time spent defining the super class and interfaces, if not yet loaded.
+  ScopedMetricsTimer timer(MetricsHistogram::kClassDefineTime);
   StackHandleScope<3> hs(self);
   auto klass = hs.NewHandle<mirror::Class>(nullptr);
 
@@ -1927,6 +1930,7 @@ mirror::Class* ClassLinker::DefineClass(Thread* self, const char* descriptor, si
    */
   Dbg::PostClassPrepare(h_new_class.Get());
 
+  self->AddMetric(MetricsCounter::kClassesDefined, 1u);
   return h_new_class.Get();
 }
 
@@ -2438,9 +2442,33 @@ void ClassLinker::LoadMethod(Thread* self, const DexFile& dex_file, const ClassD
       }
     }
   }
+  if (UNLIKELY((access_flags & kAccNative) != 0) &&
+      IsCriticalNativeMethod(dex_file, dex_file.GetClassDef(klass->GetDexClassDefIndex()),
+                             dex_method_idx, access_flags)) {
+    access_flags |= kAccCriticalNative;
+  }
   dst->SetAccessFlags(access_flags);
 }
 
+bool ClassLinker::IsCriticalNativeMethod(const DexFile& dex_file,
+                                         const DexFile::ClassDef& class_def,
+                                         uint32_t method_idx, uint32_t access_flags) {
+  static constexpr const char* kCriticalNativeDescriptor =
+      "Ldalvik/annotation/optimization/CriticalNative;";
+  if ((access_flags & kAccNative) == 0 ||
+      !dex_file.IsMethodAnnotationPresent(class_def, method_idx, kCriticalNativeDescriptor)) {
+    return false;
+  }
+  const char* shorty = dex_file.GetMethodShorty(dex_file.GetMethodId(method_idx));
+  bool eligible = (access_flags & kAccStatic) != 0 && (access_flags & kAccSynchronized) == 0 &&
+      strchr(shorty, 'L') == nullptr;
+  if (!eligible) {
+    LOG(WARNING) << "Ignoring @CriticalNative on " << PrettyMethod(method_idx, dex_file)
+                 << ", it must be static, not synchronized and only use primitive types";
+  }
+  return eligible;
+}
+
 void ClassLinker::AppendToBootClassPath(Thread* self, const DexFile& dex_file) {
   StackHandleScope<1> hs(self);
   Handle<mirror::DexCache> dex_cache(hs.NewHandle(AllocDexCache(self, dex_file)));
@@ -3084,6 +3112,8 @@ void ClassLinker::VerifyClass(Thread* self, Handle<mirror::Class> klass) {
   verifier::MethodVerifier::FailureKind verifier_failure = verifier::MethodVerifier::kNoFailure;
   std::string error_msg;
   if (!preverified) {
+    ScopedMetricsTimer timer(MetricsHistogram::kClassVerifyTime);
+    self->AddMetric(MetricsCounter::kClassesVerified, 1u);
     verifier_failure = verifier::MethodVerifier::VerifyClass(self, klass.Get(),
                                                              Runtime::Current()->IsAotCompiler(),
                                                              &error_msg);
@@ -4802,6 +4832,10 @@ bool ClassLinker::LinkInterfaceMethods(Thread* self, Handle<mirror::Class> klass
     if (super_class->ShouldHaveEmbeddedImtAndVTable()) {
       for (size_t i = 0; i < mirror::Class::kImtSize; ++i) {
         out_imt[i] = super_class->GetEmbeddedImTableEntry(i, image_pointer_size_);
+        // The conflict table of the super class does not have our implementations.
+        if (out_imt[i]->IsImtConflictMethod()) {
+          out_imt[i] = conflict_method;
+        }
       }
     } else {
       // No imt in the super class, need to reconstruct from the iftable.
@@ -5904,6 +5938,52 @@ ArtMethod* ClassLinker::CreateRuntimeMethod() {
   return method;
 }
 
+void ClassLinker::CreateImtConflictTable(Thread* self, mirror::Class* klass, uint32_t imt_index) {
+  DCHECK(klass->ShouldHaveEmbeddedImtAndVTable()) << PrettyClass(klass);
+  DCHECK_LT(imt_index, mirror::Class::kImtSize);
+  Runtime* const runtime = Runtime::Current();
+  // Images only know about the shared conflict method.
+  if (runtime->IsAotCompiler() ||
+      klass->GetEmbeddedImTableEntry(imt_index, image_pointer_size_) !=
+          runtime->GetImtConflictMethod()) {
+    return;
+  }
+  ScopedAssertNoThreadSuspension nts(self, __FUNCTION__);
+  mirror::IfTable* iftable = klass->GetIfTable();
+  const size_t ifcount = klass->GetIfTableCount();
+  std::vector<std::pair<ArtMethod*, ArtMethod*>> entries;
+  for (size_t i = 0; i < ifcount; ++i) {
+    mirror::Class* interface = iftable->GetInterface(i);
+    const size_t num_methods = iftable->GetMethodArrayCount(i);
+    if (num_methods == 0) {
+      continue;
+    }
+    mirror::PointerArray* method_array = iftable->GetMethodArray(i);
+    for (size_t j = 0; j < num_methods; ++j) {
+      ArtMethod* interface_method = interface->GetVirtualMethod(j, image_pointer_size_);
+      if (interface_method->GetDexMethodIndex() % mirror::Class::kImtSize == imt_index) {
+        entries.emplace_back(interface_method,
+                             method_array->GetElementPtrSize<ArtMethod*>(j, image_pointer_size_));
+      }
+    }
+  }
+  void* data = runtime->GetLinearAlloc()->Alloc(self,
+                                                 ImtConflictTable::ComputeSize(entries.size()));
+  CHECK(data != nullptr);
+  ImtConflictTable* table = new (data) ImtConflictTable();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    table->SetEntry(i, entries[i].first, entries[i].second);
+  }
+  table->SetEntry(entries.size(), nullptr, nullptr);
+  ArtMethod* conflict_method = CreateRuntimeMethod();
+  conflict_method->SetEntryPointFromQuickCompiledCode(GetQuickImtConflictStub());
+  conflict_method->SetImtConflictTable(table, image_pointer_size_);
+  // Racing threads may both install a table for the same slot. Either one is complete, the
+  // other is leaked in the linear alloc.
+  QuasiAtomic::ThreadFenceForConstructor();
+  klass->SetEmbeddedImTableEntry(imt_index, conflict_method, image_pointer_size_);
+}
+
 void ClassLinker::DropFindArrayClassCache() {
   std::fill_n(find_array_class_cache_, kFindArrayCacheSize, GcRoot<mirror::Class>(nullptr));
   find_array_class_cache_next_victim_ = 0;
@@ -422,6 +422,12 @@ class ClassLinker {
   // Is the given entry point quick code to run the generic JNI stub?
   bool IsQuickGenericJniStub(const void* entry_point) const;
 
+  // Is the native method annotated with @CriticalNative and eligible for the critical native
+  // calling convention, that is static, not synchronized and with only primitive arguments and
+  // return type? Shared with the compiler so that the JNI stub and the runtime agree.
+  static bool IsCriticalNativeMethod(const DexFile& dex_file, const DexFile::ClassDef& class_def,
+                                     uint32_t method_idx, uint32_t access_flags);
+
   InternTable* GetInternTable() const {
     return intern_table_;
   }
@@ -479,6 +485,12 @@ class ClassLinker {
 
   ArtMethod* CreateRuntimeMethod();
 
+  // Replaces the shared IMT conflict method in the given IMT slot of klass by a conflict method
+  // with a table of all the interface methods of klass which share the slot, so that the IMT
+  // conflict trampoline can dispatch them without calling into the runtime.
+  void CreateImtConflictTable(Thread* self, mirror::Class* klass, uint32_t imt_index)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Clear the ArrayClass cache. This is necessary when cleaning up for the image, as the cache
   // entries are roots, but potentially not image classes.
   void DropFindArrayClassCache() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -37,10 +37,12 @@
 #include "globals.h"
 #include "leb128.h"
 #include "mirror/string.h"
+#include "oat_file.h"
 #include "os.h"
 #include "safe_map.h"
 #include "handle_scope-inl.h"
 #include "thread.h"
+#include "type_lookup_table.h"
 #include "utf-inl.h"
 #include "utils.h"
 #include "well_known_classes.h"
@@ -414,6 +416,9 @@ DexFile::DexFile(const uint8_t* base, size_t size,
       oat_dex_file_(oat_dex_file) {
   CHECK(begin_ != nullptr) << GetLocation();
   CHECK_GT(size_, 0U) << GetLocation();
+  if (oat_dex_file_ != nullptr && oat_dex_file_->GetLookupTableData() != nullptr) {
+    lookup_table_.reset(TypeLookupTable::Open(oat_dex_file_->GetLookupTableData(), *this));
+  }
 }
 
 DexFile::~DexFile() {
@@ -472,6 +477,11 @@ uint32_t DexFile::GetVersion() const {
 
 const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor, size_t hash) const {
   DCHECK_EQ(ComputeModifiedUtf8Hash(descriptor), hash);
+  // Prefer the table from the oat file, it needs neither searching nor building.
+  if (lookup_table_ != nullptr) {
+    uint32_t class_def_idx = lookup_table_->Lookup(descriptor, hash);
+    return (class_def_idx != DexFile::kDexNoIndex) ? &GetClassDef(class_def_idx) : nullptr;
+  }
   // If we have an index lookup the descriptor via that as its constant time to search.
   Index* index = class_def_index_.LoadSequentiallyConsistent();
   if (index != nullptr) {
@@ -531,6 +541,39 @@ const DexFile::ClassDef* DexFile::FindClassDef(uint16_t type_idx) const {
   return nullptr;
 }
 
+bool DexFile::IsMethodAnnotationPresent(const ClassDef& class_def, uint32_t method_idx,
+                                        const char* descriptor) const {
+  if (class_def.annotations_off_ == 0) {
+    return false;
+  }
+  const AnnotationsDirectoryItem* directory =
+      reinterpret_cast<const AnnotationsDirectoryItem*>(begin_ + class_def.annotations_off_);
+  // The method annotations follow the field annotations.
+  const FieldAnnotationsItem* field_annotations =
+      reinterpret_cast<const FieldAnnotationsItem*>(&directory[1]);
+  const MethodAnnotationsItem* method_annotations =
+      reinterpret_cast<const MethodAnnotationsItem*>(&field_annotations[directory->fields_size_]);
+  for (uint32_t i = 0; i < directory->methods_size_; ++i) {
+    if (method_annotations[i].method_idx_ != method_idx) {
+      continue;
+    }
+    const AnnotationSetItem* set = reinterpret_cast<const AnnotationSetItem*>(
+        begin_ + method_annotations[i].annotations_off_);
+    for (uint32_t j = 0; j < set->size_; ++j) {
+      const AnnotationItem* item =
+          reinterpret_cast<const AnnotationItem*>(begin_ + set->entries_[j]);
+      // An encoded_annotation starts with the uleb128 type index of the annotation.
+      const uint8_t* annotation = item->annotation_;
+      uint32_t type_idx = DecodeUnsignedLeb128(&annotation);
+      if (strcmp(StringByTypeIdx(type_idx), descriptor) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+  return false;
+}
+
 const DexFile::FieldId* DexFile::FindFieldId(const DexFile::TypeId& declaring_klass,
                                               const DexFile::StringId& name,
                                               const DexFile::TypeId& type) const {
@@ -48,6 +48,7 @@ class OatDexFile;
 class Signature;
 template<class T> class Handle;
 class StringPiece;
+class TypeLookupTable;
 class ZipArchive;
 
 // TODO: move all of the macro functionality into the DexCache class.
@@ -675,6 +676,11 @@ class DexFile {
   // Looks up a class definition by its type index.
   const ClassDef* FindClassDef(uint16_t type_idx) const;
 
+  // Returns true if the method declared by class_def has an annotation of the type described by
+  // descriptor, regardless of its visibility.
+  bool IsMethodAnnotationPresent(const ClassDef& class_def, uint32_t method_idx,
+                                 const char* descriptor) const;
+
   const TypeList* GetInterfacesList(const ClassDef& class_def) const {
     if (class_def.interfaces_off_ == 0) {
         return nullptr;
@@ -1050,6 +1056,10 @@ class DexFile {
   // pointer to the OatDexFile it was loaded from. Otherwise oat_dex_file_ is
   // null.
   const OatDexFile* oat_dex_file_;
+
+  // Class def lookup table precomputed by dex2oat, if the oat file provides one. Used instead
+  // of class_def_index_.
+  std::unique_ptr<TypeLookupTable> lookup_table_;
 };
 
 struct DexFileReference {
@@ -16,18 +16,31 @@
 
 #include "dex_file_verifier.h"
 
+#include <unistd.h>
 #include <zlib.h>
+
+#include <algorithm>
 #include <memory>
 
 #include "base/stringprintf.h"
 #include "dex_file-inl.h"
 #include "leb128.h"
+#include "runtime.h"
 #include "safe_map.h"
+#include "thread-inl.h"
+#include "thread_pool.h"
 #include "utf-inl.h"
 #include "utils.h"
 
 namespace art {
 
+// Smaller files are verified on the calling thread by default.
+static constexpr size_t kMinParallelVerifySize = 1 * MB;
+static constexpr size_t kMaxVerifyThreads = 4;
+// Sections are split into about this many chunks per thread, to balance the load.
+static constexpr size_t kChunksPerThread = 4;
+static constexpr uint32_t kMinItemsPerChunk = 1024;
+
 static uint32_t MapTypeToBitMask(uint32_t map_type) {
   switch (map_type) {
     case DexFile::kDexTypeHeaderItem:               return 1 << 0;
@@ -126,14 +139,48 @@ const DexFile::MethodId* DexFileVerifier::CheckLoadMethodId(uint32_t idx, const
 
 bool DexFileVerifier::Verify(const DexFile* dex_file, const uint8_t* begin, size_t size,
                              const char* location, std::string* error_msg) {
-  std::unique_ptr<DexFileVerifier> verifier(new DexFileVerifier(dex_file, begin, size, location));
-  if (!verifier->Verify()) {
+  return Verify(dex_file, begin, size, location, GetDefaultThreadCount(size), error_msg);
+}
+
+bool DexFileVerifier::Verify(const DexFile* dex_file, const uint8_t* begin, size_t size,
+                             const char* location, size_t num_threads, std::string* error_msg,
+                             size_t* num_parallel_chunks) {
+  std::unique_ptr<DexFileVerifier> verifier(
+      new DexFileVerifier(dex_file, begin, size, location, num_threads));
+  bool success = verifier->Verify();
+  if (num_parallel_chunks != nullptr) {
+    *num_parallel_chunks = verifier->num_parallel_chunks_;
+  }
+  if (!success) {
     *error_msg = verifier->FailureReason();
     return false;
   }
   return true;
 }
 
+size_t DexFileVerifier::GetDefaultThreadCount(size_t size) {
+  if (size < kMinParallelVerifySize) {
+    return 1u;
+  }
+  return std::min(kMaxVerifyThreads, static_cast<size_t>(sysconf(_SC_NPROCESSORS_CONF)));
+}
+
+DexFileVerifier::DexFileVerifier(const DexFile* dex_file, const uint8_t* begin, size_t size,
+                                 const char* location, size_t num_threads)
+    : dex_file_(dex_file), begin_(begin), size_(size), location_(location),
+      header_(&dex_file->GetHeader()), parent_(nullptr), num_threads_(num_threads),
+      num_parallel_chunks_(0u), ptr_(nullptr), previous_item_(nullptr) {
+}
+
+DexFileVerifier::DexFileVerifier(const DexFileVerifier* parent)
+    : dex_file_(parent->dex_file_), begin_(parent->begin_), size_(parent->size_),
+      location_(parent->location_), header_(parent->header_), parent_(parent),
+      num_threads_(1u), num_parallel_chunks_(0u), ptr_(nullptr), previous_item_(nullptr) {
+}
+
+DexFileVerifier::~DexFileVerifier() {
+}
+
 bool DexFileVerifier::CheckShortyDescriptorMatch(char shorty_char, const char* descriptor,
                                                 bool is_return_type) {
   switch (shorty_char) {
@@ -1330,7 +1377,7 @@ bool DexFileVerifier::CheckIntraDataSection(size_t offset, uint32_t count, uint1
     return false;
   }
 
-  if (!CheckIntraSectionIterate(offset, count, type)) {
+  if (!CheckIntraSectionParallel(offset, count, type)) {
     return false;
   }
 
@@ -1430,8 +1477,10 @@ bool DexFileVerifier::CheckIntraSection() {
 }
 
 bool DexFileVerifier::CheckOffsetToTypeMap(size_t offset, uint16_t type) {
-  auto it = offset_to_type_map_.find(offset);
-  if (UNLIKELY(it == offset_to_type_map_.end())) {
+  const auto& offset_to_type_map =
+      (parent_ != nullptr) ? parent_->offset_to_type_map_ : offset_to_type_map_;
+  auto it = offset_to_type_map.find(offset);
+  if (UNLIKELY(it == offset_to_type_map.end())) {
     ErrorStringPrintf("No data map entry found @ %zx; expected %x", offset, type);
     return false;
   }
@@ -1966,7 +2015,8 @@ bool DexFileVerifier::CheckInterAnnotationsDirectoryItem() {
   return true;
 }
 
-bool DexFileVerifier::CheckInterSectionIterate(size_t offset, uint32_t count, uint16_t type) {
+bool DexFileVerifier::CheckInterSectionIterate(size_t offset, uint32_t count,
+                                               const void* previous_item, uint16_t type) {
   // Get the right alignment mask for the type of section.
   size_t alignment_mask;
   switch (type) {
@@ -1979,7 +2029,7 @@ bool DexFileVerifier::CheckInterSectionIterate(size_t offset, uint32_t count, ui
   }
 
   // Iterate through the items in the section.
-  previous_item_ = nullptr;
+  previous_item_ = previous_item;
   for (uint32_t i = 0; i < count; i++) {
     uint32_t new_offset = (offset + alignment_mask) & ~alignment_mask;
     ptr_ = begin_ + new_offset;
@@ -2059,6 +2109,324 @@ bool DexFileVerifier::CheckInterSectionIterate(size_t offset, uint32_t count, ui
   return true;
 }
 
+static size_t GetIdItemSize(uint16_t type) {
+  switch (type) {
+    case DexFile::kDexTypeStringIdItem:
+      return sizeof(DexFile::StringId);
+    case DexFile::kDexTypeTypeIdItem:
+      return sizeof(DexFile::TypeId);
+    case DexFile::kDexTypeProtoIdItem:
+      return sizeof(DexFile::ProtoId);
+    case DexFile::kDexTypeFieldIdItem:
+      return sizeof(DexFile::FieldId);
+    case DexFile::kDexTypeMethodIdItem:
+      return sizeof(DexFile::MethodId);
+    default:
+      return 0u;
+  }
+}
+
+bool DexFileVerifier::GetChunkStarts(size_t offset, uint32_t count, uint16_t type,
+                                     uint32_t items_per_chunk,
+                                     std::vector<std::pair<size_t, const void*>>* starts) {
+  size_t id_item_size = GetIdItemSize(type);
+  if (id_item_size != 0u) {
+    // Id items have a fixed size and are 4-byte aligned.
+    size_t section_start = RoundUp(offset, sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; i += items_per_chunk) {
+      const uint8_t* previous_item =
+          (i != 0u) ? begin_ + section_start + (i - 1u) * id_item_size : nullptr;
+      starts->emplace_back(section_start + i * id_item_size, previous_item);
+    }
+    return true;
+  }
+
+  // The intra-section checks recorded the offset of every data item. The items of a section
+  // are consecutive in the map, unless the section overlaps another one, which is then
+  // reported by the sequential checks.
+  size_t alignment_mask =
+      (type == DexFile::kDexTypeClassDataItem) ? sizeof(uint8_t) - 1 : sizeof(uint32_t) - 1;
+  auto it = offset_to_type_map_.find((offset + alignment_mask) & ~alignment_mask);
+  const void* previous_item = nullptr;
+  for (uint32_t i = 0; i < count; ++i, ++it) {
+    if (it == offset_to_type_map_.end() || it->second != type) {
+      return false;
+    }
+    if (i % items_per_chunk == 0u) {
+      starts->emplace_back(it->first, previous_item);
+    }
+    previous_item = begin_ + it->first;
+  }
+  return true;
+}
+
+class DexFileVerifier::ChunkTask : public Task {
+ public:
+  // Checks the references of a chunk of items.
+  ChunkTask(const DexFileVerifier* parent, size_t offset, uint32_t count,
+            const void* previous_item, uint16_t type)
+      : parent_(parent), offset_(offset), count_(count), previous_item_(previous_item),
+        type_(type), intra_section_(false), success_(false), end_offset_(0u) {
+  }
+
+  // Checks the structure of a chunk of data items.
+  ChunkTask(const DexFileVerifier* parent, size_t offset, uint32_t count, uint16_t type)
+      : parent_(parent), offset_(offset), count_(count), previous_item_(nullptr),
+        type_(type), intra_section_(true), success_(false), end_offset_(0u) {
+  }
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE {
+    DexFileVerifier verifier(parent_);
+    if (intra_section_) {
+      verifier.ptr_ = verifier.begin_ + offset_;
+      success_ = verifier.CheckIntraSectionIterate(offset_, count_, type_);
+      for (const auto& entry : verifier.offset_to_type_map_) {
+        item_offsets_.push_back(entry.first);
+      }
+    } else {
+      success_ = verifier.CheckInterSectionIterate(offset_, count_, previous_item_, type_);
+    }
+    end_offset_ = verifier.ptr_ - verifier.begin_;
+  }
+
+  bool Succeeded() const {
+    return success_;
+  }
+
+  size_t GetEndOffset() const {
+    return end_offset_;
+  }
+
+  // The offsets of the data items checked by an intra-section chunk.
+  const std::vector<uint32_t>& GetItemOffsets() const {
+    return item_offsets_;
+  }
+
+ private:
+  const DexFileVerifier* const parent_;
+  const size_t offset_;
+  const uint32_t count_;
+  const void* const previous_item_;
+  const uint16_t type_;
+  const bool intra_section_;
+  bool success_;
+  size_t end_offset_;
+  std::vector<uint32_t> item_offsets_;
+};
+
+uint32_t DexFileVerifier::GetItemsPerChunk(uint32_t count) const {
+  const size_t num_chunks = num_threads_ * kChunksPerThread;
+  return std::max(kMinItemsPerChunk, static_cast<uint32_t>((count + num_chunks - 1u) / num_chunks));
+}
+
+// Reads an unsigned LEB128 value without reading at or past end.
+static bool DecodeUnsignedLeb128InBounds(const uint8_t** ptr, const uint8_t* end,
+                                         uint32_t* value) {
+  uint32_t result = 0u;
+  for (size_t shift = 0u; shift < 35u; shift += 7u) {
+    if (*ptr >= end) {
+      return false;
+    }
+    uint8_t byte = *(*ptr)++;
+    result |= static_cast<uint32_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0u) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Adds the code item offsets of the methods of a class data item, as far as it can be parsed.
+static void AddCodeItemOffsets(const uint8_t* ptr, const uint8_t* end,
+                               std::vector<uint32_t>* offsets) {
+  uint32_t sizes[4];  // Static and instance fields, direct and virtual methods.
+  for (uint32_t& size : sizes) {
+    if (!DecodeUnsignedLeb128InBounds(&ptr, end, &size)) {
+      return;
+    }
+  }
+  uint32_t value;
+  for (uint64_t i = 0, num_fields = static_cast<uint64_t>(sizes[0]) + sizes[1];
+       i != num_fields; ++i) {
+    // The field index delta and the access flags.
+    if (!DecodeUnsignedLeb128InBounds(&ptr, end, &value) ||
+        !DecodeUnsignedLeb128InBounds(&ptr, end, &value)) {
+      return;
+    }
+  }
+  for (uint64_t i = 0, num_methods = static_cast<uint64_t>(sizes[2]) + sizes[3];
+       i != num_methods; ++i) {
+    // The method index delta, the access flags and the code offset.
+    uint32_t code_offset;
+    if (!DecodeUnsignedLeb128InBounds(&ptr, end, &value) ||
+        !DecodeUnsignedLeb128InBounds(&ptr, end, &value) ||
+        !DecodeUnsignedLeb128InBounds(&ptr, end, &code_offset)) {
+      return;
+    }
+    if (code_offset != 0u) {
+      offsets->push_back(code_offset);
+    }
+  }
+}
+
+void DexFileVerifier::FindReferencedDataItems(uint16_t type, std::vector<uint32_t>* offsets) {
+  auto ids_in_bounds = [this](uint32_t ids_offset, uint32_t ids_count, size_t id_size) {
+    return IsAligned<sizeof(uint32_t)>(ids_offset) && ids_offset <= size_ &&
+        ids_count <= (size_ - ids_offset) / id_size;
+  };
+  if (type == DexFile::kDexTypeStringDataItem) {
+    if (ids_in_bounds(header_->string_ids_off_, header_->string_ids_size_,
+                      sizeof(DexFile::StringId))) {
+      auto* string_ids = reinterpret_cast<const DexFile::StringId*>(
+          begin_ + header_->string_ids_off_);
+      for (uint32_t i = 0; i != header_->string_ids_size_; ++i) {
+        offsets->push_back(string_ids[i].string_data_off_);
+      }
+    }
+  } else if (ids_in_bounds(header_->class_defs_off_, header_->class_defs_size_,
+                           sizeof(DexFile::ClassDef))) {
+    auto* class_defs = reinterpret_cast<const DexFile::ClassDef*>(
+        begin_ + header_->class_defs_off_);
+    for (uint32_t i = 0; i != header_->class_defs_size_; ++i) {
+      uint32_t class_data_offset = class_defs[i].class_data_off_;
+      if (class_data_offset == 0u || class_data_offset >= size_) {
+        continue;
+      }
+      if (type == DexFile::kDexTypeClassDataItem) {
+        offsets->push_back(class_data_offset);
+      } else {
+        DCHECK_EQ(type, DexFile::kDexTypeCodeItem);
+        AddCodeItemOffsets(begin_ + class_data_offset, begin_ + size_, offsets);
+      }
+    }
+  }
+  // Code items may be shared between methods.
+  std::sort(offsets->begin(), offsets->end());
+  offsets->erase(std::unique(offsets->begin(), offsets->end()), offsets->end());
+}
+
+bool DexFileVerifier::GetIntraChunkStarts(size_t offset, uint32_t count, uint16_t type,
+                                          uint32_t items_per_chunk, std::vector<size_t>* starts) {
+  // The items are found through the references to them, which have not been checked yet. The
+  // section can only be split if every item is referenced, the first one at its start.
+  std::vector<uint32_t> items;
+  FindReferencedDataItems(type, &items);
+  size_t alignment_mask =
+      (type == DexFile::kDexTypeCodeItem) ? sizeof(uint32_t) - 1 : sizeof(uint8_t) - 1;
+  size_t data_end = header_->data_off_ + header_->data_size_;
+  if (items.size() != count || items.front() != ((offset + alignment_mask) & ~alignment_mask) ||
+      items.back() >= std::min(data_end, size_)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; i += items_per_chunk) {
+    starts->push_back(items[i]);
+  }
+  return true;
+}
+
+bool DexFileVerifier::IsZeroPadding(size_t offset, size_t end) const {
+  for (; offset < end; ++offset) {
+    if (begin_[offset] != 0u) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DexFileVerifier::CheckIntraSectionParallel(size_t offset, uint32_t count, uint16_t type) {
+  // Only these items take long enough to check to be worth splitting their sections.
+  if (thread_pool_ == nullptr ||
+      (type != DexFile::kDexTypeStringDataItem && type != DexFile::kDexTypeCodeItem &&
+       type != DexFile::kDexTypeClassDataItem)) {
+    return CheckIntraSectionIterate(offset, count, type);
+  }
+  const uint32_t items_per_chunk = GetItemsPerChunk(count);
+  std::vector<size_t> starts;
+  if (count <= items_per_chunk ||
+      !GetIntraChunkStarts(offset, count, type, items_per_chunk, &starts)) {
+    return CheckIntraSectionIterate(offset, count, type);
+  }
+
+  Thread* self = Thread::Current();
+  std::vector<std::unique_ptr<ChunkTask>> tasks;
+  for (size_t i = 0; i != starts.size(); ++i) {
+    uint32_t first_item = static_cast<uint32_t>(i) * items_per_chunk;
+    uint32_t chunk_count = std::min(items_per_chunk, count - first_item);
+    tasks.emplace_back(new ChunkTask(this, starts[i], chunk_count, type));
+    thread_pool_->AddTask(self, tasks.back().get());
+  }
+  thread_pool_->Wait(self, true, false);
+  num_parallel_chunks_ += tasks.size();
+
+  // Each chunk must end where the next one starts, up to zero padding for the alignment. If a
+  // chunk failed or the chunks disagree, check the section again on this thread, so that the
+  // failure reason is the one of the first bad item regardless of the number of threads.
+  const size_t alignment_mask =
+      (type == DexFile::kDexTypeCodeItem) ? sizeof(uint32_t) - 1 : sizeof(uint8_t) - 1;
+  bool success = IsZeroPadding(offset, starts[0]);
+  for (size_t i = 0; success && i != tasks.size(); ++i) {
+    size_t end = tasks[i]->GetEndOffset();
+    success = tasks[i]->Succeeded() &&
+        (i + 1u == tasks.size() ||
+         (((end + alignment_mask) & ~alignment_mask) == starts[i + 1u] &&
+          IsZeroPadding(end, starts[i + 1u])));
+  }
+  if (!success) {
+    return CheckIntraSectionIterate(offset, count, type);
+  }
+  for (const std::unique_ptr<ChunkTask>& task : tasks) {
+    for (uint32_t item_offset : task->GetItemOffsets()) {
+      offset_to_type_map_.Put(item_offset, type);
+    }
+  }
+  ptr_ = begin_ + tasks.back()->GetEndOffset();
+  return true;
+}
+
+bool DexFileVerifier::CheckInterSectionParallel(size_t offset, uint32_t count, uint16_t type) {
+  // Class defs are checked for duplicates, which needs to see all of them in order.
+  if (thread_pool_ == nullptr || type == DexFile::kDexTypeClassDefItem) {
+    return CheckInterSectionIterate(offset, count, nullptr, type);
+  }
+  const uint32_t items_per_chunk = GetItemsPerChunk(count);
+  std::vector<std::pair<size_t, const void*>> starts;
+  if (count <= items_per_chunk ||
+      !GetChunkStarts(offset, count, type, items_per_chunk, &starts)) {
+    return CheckInterSectionIterate(offset, count, nullptr, type);
+  }
+
+  Thread* self = Thread::Current();
+  std::vector<std::unique_ptr<ChunkTask>> tasks;
+  for (size_t i = 0; i != starts.size(); ++i) {
+    uint32_t first_item = static_cast<uint32_t>(i) * items_per_chunk;
+    uint32_t chunk_count = std::min(items_per_chunk, count - first_item);
+    tasks.emplace_back(new ChunkTask(this, starts[i].first, chunk_count, starts[i].second, type));
+    thread_pool_->AddTask(self, tasks.back().get());
+  }
+  thread_pool_->Wait(self, true, false);
+  num_parallel_chunks_ += tasks.size();
+
+  // Each chunk must end where the next one starts. If a chunk failed or the chunks disagree,
+  // check the section again on this thread, so that the failure reason is the one of the first
+  // bad item regardless of the number of threads.
+  size_t alignment_mask =
+      (type == DexFile::kDexTypeClassDataItem) ? sizeof(uint8_t) - 1 : sizeof(uint32_t) - 1;
+  bool success = true;
+  for (size_t i = 0; i != tasks.size(); ++i) {
+    if (!tasks[i]->Succeeded() ||
+        (i + 1u != tasks.size() &&
+         ((tasks[i]->GetEndOffset() + alignment_mask) & ~alignment_mask) != starts[i + 1u].first)) {
+      success = false;
+      break;
+    }
+  }
+  if (!success) {
+    return CheckInterSectionIterate(offset, count, nullptr, type);
+  }
+  return true;
+}
+
 bool DexFileVerifier::CheckInterSection() {
   const DexFile::MapList* map = reinterpret_cast<const DexFile::MapList*>(begin_ + header_->map_off_);
   const DexFile::MapItem* item = map->list_;
@@ -2090,7 +2458,7 @@ bool DexFileVerifier::CheckInterSection() {
       case DexFile::kDexTypeAnnotationSetItem:
       case DexFile::kDexTypeClassDataItem:
       case DexFile::kDexTypeAnnotationsDirectoryItem: {
-        if (!CheckInterSectionIterate(section_offset, section_count, type)) {
+        if (!CheckInterSectionParallel(section_offset, section_count, type)) {
           return false;
         }
         break;
@@ -2117,12 +2485,27 @@ bool DexFileVerifier::Verify() {
     return false;
   }
 
-  // Check structure within remaining sections.
+  // Large sections are checked in chunks of items on a thread pool. It is not used while starting
+  // up or shutting down, or with the mutator lock held, since its workers attach to the runtime.
+  if (num_threads_ > 1u) {
+    Runtime* runtime = Runtime::Current();
+    Thread* self = Thread::Current();
+    if (runtime != nullptr && self != nullptr && self->GetState() != kRunnable &&
+        !runtime->IsShuttingDown(self)) {
+      thread_pool_.reset(new ThreadPool("Dex file verifier thread pool", num_threads_ - 1u));
+      thread_pool_->StartWorkers(self);
+    }
+  }
+
+  // Check structure within remaining sections. The items of a data section have to be parsed to
+  // find the next one, so only the sections whose items are all referenced from elsewhere can be
+  // split into chunks.
   if (!CheckIntraSection()) {
     return false;
   }
 
-  // Check references from one section to another.
+  // Check references from one section to another. These can be split into chunks of the items
+  // known from the checks above.
   if (!CheckInterSection()) {
     return false;
   }
@@ -17,27 +17,47 @@
 #ifndef ART_RUNTIME_DEX_FILE_VERIFIER_H_
 #define ART_RUNTIME_DEX_FILE_VERIFIER_H_
 
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "dex_file.h"
 #include "safe_map.h"
 
 namespace art {
 
+class ThreadPool;
+
 class DexFileVerifier {
  public:
   static bool Verify(const DexFile* dex_file, const uint8_t* begin, size_t size,
                      const char* location, std::string* error_msg);
 
+  // Verifies with up to num_threads threads. Large sections are checked in chunks of items on a
+  // thread pool. The result and the failure reason do not depend on the number of threads. If
+  // num_parallel_chunks is not null, it receives the number of chunks checked on the pool.
+  static bool Verify(const DexFile* dex_file, const uint8_t* begin, size_t size,
+                     const char* location, size_t num_threads, std::string* error_msg,
+                     size_t* num_parallel_chunks = nullptr);
+
+  // Returns the number of threads used to verify a dex file of the given size by default.
+  static size_t GetDefaultThreadCount(size_t size);
+
+  ~DexFileVerifier();
+
   const std::string& FailureReason() const {
     return failure_reason_;
   }
 
  private:
-  DexFileVerifier(const DexFile* dex_file, const uint8_t* begin, size_t size, const char* location)
-      : dex_file_(dex_file), begin_(begin), size_(size), location_(location),
-        header_(&dex_file->GetHeader()), ptr_(nullptr), previous_item_(nullptr)  {
-  }
+  class ChunkTask;
+
+  DexFileVerifier(const DexFile* dex_file, const uint8_t* begin, size_t size, const char* location,
+                  size_t num_threads);
+
+  // Creates a verifier for a chunk of a section, which looks up data items in the offset map
+  // of the parent.
+  explicit DexFileVerifier(const DexFileVerifier* parent);
 
   bool Verify();
 
@@ -73,6 +93,15 @@ class DexFileVerifier {
   bool CheckIntraAnnotationsDirectoryItem();
 
   bool CheckIntraSectionIterate(size_t offset, uint32_t count, uint16_t type);
+  // Collects the sorted offsets of the string data, code or class data items referenced from the
+  // string ids or the class defs. The references are not checked.
+  void FindReferencedDataItems(uint16_t type, std::vector<uint32_t>* offsets);
+  // Computes the start offset of every chunk of items_per_chunk data items. Returns false if the
+  // items of the section cannot be located without checking them.
+  bool GetIntraChunkStarts(size_t offset, uint32_t count, uint16_t type, uint32_t items_per_chunk,
+                           std::vector<size_t>* starts);
+  bool IsZeroPadding(size_t offset, size_t end) const;
+  bool CheckIntraSectionParallel(size_t offset, uint32_t count, uint16_t type);
   bool CheckIntraIdSection(size_t offset, uint32_t count, uint16_t type);
   bool CheckIntraDataSection(size_t offset, uint32_t count, uint16_t type);
   bool CheckIntraSection();
@@ -95,7 +124,16 @@ class DexFileVerifier {
   bool CheckInterClassDataItem();
   bool CheckInterAnnotationsDirectoryItem();
 
-  bool CheckInterSectionIterate(size_t offset, uint32_t count, uint16_t type);
+  // Checks count items starting at offset. The ordering of the first item is checked against
+  // previous_item, if not null.
+  bool CheckInterSectionIterate(size_t offset, uint32_t count, const void* previous_item,
+                                uint16_t type);
+  // Computes the start offset and the previous item of every chunk of items_per_chunk items.
+  // Returns false if the items of the section cannot be located without checking them.
+  bool GetChunkStarts(size_t offset, uint32_t count, uint16_t type, uint32_t items_per_chunk,
+                      std::vector<std::pair<size_t, const void*>>* starts);
+  bool CheckInterSectionParallel(size_t offset, uint32_t count, uint16_t type);
+  uint32_t GetItemsPerChunk(uint32_t count) const;
   bool CheckInterSection();
 
   // Load a string by (type) index. Checks whether the index is in bounds, printing the error if
@@ -117,6 +155,12 @@ class DexFileVerifier {
   const char* const location_;
   const DexFile::Header* const header_;
 
+  // The verifier of the whole file, for the verifiers of chunks. Null otherwise.
+  const DexFileVerifier* const parent_;
+  const size_t num_threads_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+  size_t num_parallel_chunks_;
+
   AllocationTrackingSafeMap<uint32_t, uint16_t, kAllocatorTagDexFileVerifier> offset_to_type_map_;
   const uint8_t* ptr_;
   const void* previous_item_;
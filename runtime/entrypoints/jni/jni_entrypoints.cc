@@ -31,7 +31,12 @@ extern "C" void* artFindNativeMethod() {
 extern "C" void* artFindNativeMethod(Thread* self) {
   DCHECK_EQ(self, Thread::Current());
 #endif
-  Locks::mutator_lock_->AssertNotHeld(self);  // We come here as Native.
+  if (self->GetState() == kRunnable) {
+    // Critical natives are called without leaving runnable.
+    Locks::mutator_lock_->AssertSharedHeld(self);
+  } else {
+    Locks::mutator_lock_->AssertNotHeld(self);  // We come here as Native.
+  }
   ScopedObjectAccess soa(self);
 
   ArtMethod* method = self->GetCurrentMethod(nullptr);
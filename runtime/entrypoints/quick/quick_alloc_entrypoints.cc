@@ -268,6 +268,10 @@ void SetQuickAllocEntryPointsInstrumented(bool instrumented) {
   entry_points_instrumented = instrumented;
 }
 
+bool IsQuickAllocEntryPointsInstrumented() {
+  return entry_points_instrumented;
+}
+
 void ResetQuickAllocEntryPoints(QuickEntryPoints* qpoints) {
 #if !defined(__APPLE__) || !defined(__LP64__)
   switch (entry_points_allocator) {
@@ -36,6 +36,10 @@ void SetQuickAllocEntryPointsAllocator(gc::AllocatorType allocator)
 void SetQuickAllocEntryPointsInstrumented(bool instrumented)
     EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::runtime_shutdown_lock_);
 
+// Returns whether the instrumented allocation entrypoints are in use. Compiled code must not
+// allocate without calling them in that case.
+bool IsQuickAllocEntryPointsInstrumented();
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_ENTRYPOINTS_QUICK_QUICK_ALLOC_ENTRYPOINTS_H_
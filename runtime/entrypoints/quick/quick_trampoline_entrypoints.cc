@@ -1632,8 +1632,8 @@ class FillNativeCall {
 // of transitioning into native code.
 class BuildGenericJniFrameVisitor FINAL : public QuickArgumentVisitor {
  public:
-  BuildGenericJniFrameVisitor(Thread* self, bool is_static, const char* shorty, uint32_t shorty_len,
-                              ArtMethod*** sp)
+  BuildGenericJniFrameVisitor(Thread* self, bool is_static, bool is_critical_native,
+                              const char* shorty, uint32_t shorty_len, ArtMethod*** sp)
      : QuickArgumentVisitor(*sp, is_static, shorty, shorty_len),
        jni_call_(nullptr, nullptr, nullptr, nullptr), sm_(&jni_call_) {
     ComputeGenericJniFrameSize fsc;
@@ -1647,11 +1647,15 @@ class BuildGenericJniFrameVisitor FINAL : public QuickArgumentVisitor {
 
     jni_call_.Reset(start_gpr_reg, start_fpr_reg, start_stack_arg, handle_scope_);
 
-    // jni environment is always first argument
-    sm_.AdvancePointer(self->GetJniEnv());
+    // Critical natives only take the shorty arguments. The frame size computed above still
+    // accounts for the JNIEnv* and jclass, which just leaves some stack unused.
+    if (!is_critical_native) {
+      // jni environment is always first argument
+      sm_.AdvancePointer(self->GetJniEnv());
 
-    if (is_static) {
-      sm_.AdvanceHandleScope((**sp)->GetDeclaringClass());
+      if (is_static) {
+        sm_.AdvanceHandleScope((**sp)->GetDeclaringClass());
+      }
     }
   }
 
@@ -1815,7 +1819,8 @@ extern "C" TwoWordReturn artQuickGenericJniTrampoline(Thread* self, ArtMethod**
   const char* shorty = called->GetShorty(&shorty_len);
 
   // Run the visitor and update sp.
-  BuildGenericJniFrameVisitor visitor(self, called->IsStatic(), shorty, shorty_len, &sp);
+  BuildGenericJniFrameVisitor visitor(self, called->IsStatic(), called->IsCriticalNative(), shorty,
+                                      shorty_len, &sp);
   visitor.VisitArguments();
   visitor.FinalizeHandleScope(self);
 
@@ -2053,12 +2058,30 @@ extern "C" TwoWordReturn artInvokeInterfaceTrampoline(ArtMethod* interface_metho
   ScopedQuickEntrypointChecks sqec(self);
   ArtMethod* method;
   if (LIKELY(interface_method->GetDexMethodIndex() != DexFile::kDexNoIndex)) {
-    method = this_object->GetClass()->FindVirtualMethodForInterface(
-        interface_method, sizeof(void*));
-    if (UNLIKELY(method == nullptr)) {
-      ThrowIncompatibleClassChangeErrorClassForInterfaceDispatch(
-          interface_method, this_object, caller_method);
-      return GetTwoWordFailureValue();  // Failure.
+    mirror::Class* cls = this_object->GetClass();
+    const uint32_t imt_index = interface_method->GetDexMethodIndex() % mirror::Class::kImtSize;
+    ArtMethod* conflict_method = nullptr;
+    ImtConflictTable* table = nullptr;
+    if (cls->ShouldHaveEmbeddedImtAndVTable()) {
+      conflict_method = cls->GetEmbeddedImTableEntry(imt_index, sizeof(void*));
+      if (conflict_method->IsRuntimeMethod()) {
+        table = conflict_method->GetImtConflictTable(sizeof(void*));
+      }
+    }
+    // Architectures whose trampoline does not search the conflict table get here on every call.
+    method = (table != nullptr) ? table->Lookup(interface_method) : nullptr;
+    if (method == nullptr) {
+      method = cls->FindVirtualMethodForInterface(interface_method, sizeof(void*));
+      if (UNLIKELY(method == nullptr)) {
+        ThrowIncompatibleClassChangeErrorClassForInterfaceDispatch(
+            interface_method, this_object, caller_method);
+        return GetTwoWordFailureValue();  // Failure.
+      }
+      Runtime* runtime = Runtime::Current();
+      if (conflict_method == runtime->GetImtConflictMethod()) {
+        // First conflict in this slot, install a table for the next calls.
+        runtime->GetClassLinker()->CreateImtConflictTable(self, cls, imt_index);
+      }
     }
   } else {
     DCHECK_EQ(interface_method, Runtime::Current()->GetResolutionMethod());
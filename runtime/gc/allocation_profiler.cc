@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_profiler.h"
+
+#include <limits>
+
+#include "art_method-inl.h"
+#include "base/stringprintf.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "stack.h"
+#include "thread-inl.h"
+#include "thread_list.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+
+class AllocationProfiler::StackVisitor : public art::StackVisitor {
+ public:
+  StackVisitor(Thread* thread, std::vector<Frame>* frames)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      : art::StackVisitor(thread, nullptr, art::StackVisitor::StackWalkKind::kIncludeInlinedFrames),
+        frames_(frames) {}
+
+  bool VisitFrame() OVERRIDE SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    if (frames_->size() >= kMaxStackDepth) {
+      return false;
+    }
+    ArtMethod* m = GetMethod();
+    if (!m->IsRuntimeMethod()) {
+      frames_->push_back(Frame { m, GetDexPc() });
+    }
+    return true;
+  }
+
+ private:
+  std::vector<Frame>* const frames_;
+};
+
+AllocationProfiler::AllocationProfiler()
+    : sample_interval_(0),
+      lock_("allocation profiler lock", kAllocationProfilerLock),
+      allow_new_samples_(true),
+      sample_count_(0),
+      dropped_sample_count_(0) {
+}
+
+AllocationProfiler::~AllocationProfiler() {
+}
+
+size_t AllocationProfiler::NextSampleBytes() {
+  // Exponentially distributed intervals avoid aliasing with allocation patterns that repeat
+  // with the sample interval.
+  const size_t sample_interval = sample_interval_.LoadRelaxed();
+  if (sample_interval == 0) {
+    return std::numeric_limits<size_t>::max();
+  }
+  std::exponential_distribution<double> distribution(1.0 / sample_interval);
+  return static_cast<size_t>(distribution(random_)) + 1;
+}
+
+void AllocationProfiler::Start(size_t sample_interval) {
+  CHECK_NE(sample_interval, 0u);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, lock_);
+  sample_interval_.StoreRelaxed(sample_interval);
+  MutexLock mu2(self, *Locks::thread_list_lock_);
+  for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+    thread->SetAllocationSampleBytesRemaining(NextSampleBytes());
+  }
+}
+
+void AllocationProfiler::Stop() {
+  Thread* self = Thread::Current();
+  MutexLock mu(self, lock_);
+  sample_interval_.StoreRelaxed(0);
+  MutexLock mu2(self, *Locks::thread_list_lock_);
+  for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+    thread->SetAllocationSampleBytesRemaining(std::numeric_limits<size_t>::max());
+  }
+}
+
+void AllocationProfiler::SampleAllocation(Thread* self, mirror::Object* obj, size_t byte_count) {
+  if (!IsEnabled()) {
+    // Threads start with no bytes until their first sample, stop counting until the next Start.
+    self->SetAllocationSampleBytesRemaining(std::numeric_limits<size_t>::max());
+    return;
+  }
+  // Walk the stack before taking the lock. The walk does not suspend, so obj cannot move.
+  SiteKey key;
+  std::string temp;
+  key.descriptor = obj->GetClass()->GetDescriptor(&temp);
+  StackVisitor visitor(self, &key.frames);
+  visitor.WalkStack();
+
+  MutexLock mu(self, lock_);
+  self->SetAllocationSampleBytesRemaining(NextSampleBytes());
+  if (UNLIKELY(!allow_new_samples_)) {
+    // The GC is sweeping system weaks; dropping the sample is cheaper than waiting for it.
+    ++dropped_sample_count_;
+    return;
+  }
+  Site* site = &sites_[key];
+  ++site->alloc_count;
+  site->alloc_bytes += byte_count;
+  ++site->live_count;
+  site->live_bytes += byte_count;
+  sampled_objects_.push_back(SampledObject { obj, site, byte_count });
+  ++sample_count_;
+}
+
+void AllocationProfiler::SweepSampledObjects(IsMarkedCallback* callback, void* arg) {
+  MutexLock mu(Thread::Current(), lock_);
+  for (size_t i = 0; i < sampled_objects_.size(); ) {
+    SampledObject* sample = &sampled_objects_[i];
+    mirror::Object* new_obj = callback(sample->object, arg);
+    if (new_obj == nullptr) {
+      DCHECK_NE(sample->site->live_count, 0u);
+      --sample->site->live_count;
+      sample->site->live_bytes -= sample->byte_count;
+      *sample = sampled_objects_.back();
+      sampled_objects_.pop_back();
+    } else {
+      sample->object = new_obj;
+      ++i;
+    }
+  }
+}
+
+void AllocationProfiler::DisallowNewSamples() {
+  MutexLock mu(Thread::Current(), lock_);
+  allow_new_samples_ = false;
+}
+
+void AllocationProfiler::AllowNewSamples() {
+  MutexLock mu(Thread::Current(), lock_);
+  allow_new_samples_ = true;
+}
+
+void AllocationProfiler::EnsureNewSamplesDisallowed() {
+  // Lock and unlock once to ensure that no threads are still in the middle of adding samples.
+  MutexLock mu(Thread::Current(), lock_);
+  CHECK(!allow_new_samples_);
+}
+
+void AllocationProfiler::DumpProfile(std::ostream& os) {
+  MutexLock mu(Thread::Current(), lock_);
+  // pprof needs addresses for the frames, so give each distinct frame and allocated class a
+  // made up one, and describe them in the symbol section.
+  std::map<Frame, size_t> frame_ids;
+  std::map<std::string, size_t> class_ids;
+  for (const auto& entry : sites_) {
+    class_ids.emplace(entry.first.descriptor, 0u);
+    for (const Frame& frame : entry.first.frames) {
+      frame_ids.emplace(frame, 0u);
+    }
+  }
+  size_t next_id = 1;
+  os << "--- symbol\n"
+     << "binary=art\n";
+  for (auto& entry : class_ids) {
+    entry.second = next_id++;
+    os << StringPrintf("0x%016zx", entry.second) << " new "
+       << PrettyDescriptor(entry.first.c_str()) << "\n";
+  }
+  for (auto& entry : frame_ids) {
+    entry.second = next_id++;
+    ArtMethod* method = entry.first.method;
+    const char* source_file = method->GetDeclaringClassSourceFile();
+    os << StringPrintf("0x%016zx", entry.second) << " " << PrettyMethod(method, false) << " ("
+       << (source_file != nullptr ? source_file : "unknown") << ":"
+       << method->GetLineNumFromDexPC(entry.first.dex_pc) << ")\n";
+  }
+  os << "---\n"
+     << "--- heap\n";
+
+  uint64_t live_count = 0;
+  uint64_t live_bytes = 0;
+  uint64_t alloc_count = 0;
+  uint64_t alloc_bytes = 0;
+  for (const auto& entry : sites_) {
+    live_count += entry.second.live_count;
+    live_bytes += entry.second.live_bytes;
+    alloc_count += entry.second.alloc_count;
+    alloc_bytes += entry.second.alloc_bytes;
+  }
+  os << "heap profile: " << live_count << ": " << live_bytes << " [" << alloc_count << ": "
+     << alloc_bytes << "] @ heap_v2/" << sample_interval_.LoadRelaxed() << "\n";
+  for (const auto& entry : sites_) {
+    const Site& site = entry.second;
+    os << site.live_count << ": " << site.live_bytes << " [" << site.alloc_count << ": "
+       << site.alloc_bytes << "] @ " << StringPrintf("0x%016zx", class_ids[entry.first.descriptor]);
+    for (const Frame& frame : entry.first.frames) {
+      os << " " << StringPrintf("0x%016zx", frame_ids[frame]);
+    }
+    os << "\n";
+  }
+}
+
+void AllocationProfiler::DumpForSigQuit(std::ostream& os) {
+  MutexLock mu(Thread::Current(), lock_);
+  if (sample_count_ == 0 && !IsEnabled()) {
+    return;
+  }
+  os << "Allocation profiler: interval " << PrettySize(sample_interval_.LoadRelaxed()) << ", "
+     << sample_count_ << " samples (" << sampled_objects_.size() << " live, "
+     << dropped_sample_count_ << " dropped) at " << sites_.size() << " sites\n";
+}
+
+size_t AllocationProfiler::GetSampleCount() {
+  MutexLock mu(Thread::Current(), lock_);
+  return sample_count_;
+}
+
+size_t AllocationProfiler::GetLiveSampleCount() {
+  MutexLock mu(Thread::Current(), lock_);
+  return sampled_objects_.size();
+}
+
+}  // namespace gc
+}  // namespace art
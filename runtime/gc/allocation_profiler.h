@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_ALLOCATION_PROFILER_H_
+#define ART_RUNTIME_GC_ALLOCATION_PROFILER_H_
+
+#include <map>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "object_callbacks.h"
+
+namespace art {
+
+class ArtMethod;
+class Thread;
+
+namespace mirror {
+  class Object;
+}  // namespace mirror
+
+namespace gc {
+
+// Samples allocations about once every sample interval bytes allocated by each thread, and
+// aggregates the samples by allocation site, i.e. by allocated class and stack trace.
+//
+// Threads count the bytes the allocation slow path hands to them, which for TLABs and
+// thread-local RosAlloc runs is the whole buffer when it is refilled, so the fast paths are not
+// slowed down. The sampled objects are swept as system weaks, which keeps the count of sampled
+// objects and bytes that are still live per site. Unlike the DDMS allocation tracker, which
+// records every allocation into a fixed ring buffer, the profiler is cheap enough to leave on.
+class AllocationProfiler {
+ public:
+  // The maximum number of frames recorded per allocation site.
+  static constexpr size_t kMaxStackDepth = 64;
+
+  AllocationProfiler();
+  ~AllocationProfiler();
+
+  // Starts sampling about every sample_interval bytes allocated by a thread.
+  void Start(size_t sample_interval)
+      LOCKS_EXCLUDED(Locks::thread_list_lock_, lock_);
+  // Stops sampling. The samples taken so far are kept, and their objects are still swept.
+  void Stop() LOCKS_EXCLUDED(Locks::thread_list_lock_, lock_);
+
+  bool IsEnabled() const {
+    return sample_interval_.LoadRelaxed() != 0;
+  }
+
+  // Called by the allocation slow path once the thread has allocated its sample interval.
+  // Records the allocation of obj and picks the number of bytes until the next sample.
+  void SampleAllocation(Thread* self, mirror::Object* obj, size_t byte_count)
+      LOCKS_EXCLUDED(lock_) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Updates the sampled objects moved by the GC and accounts the unmarked ones as freed.
+  void SweepSampledObjects(IsMarkedCallback* callback, void* arg) LOCKS_EXCLUDED(lock_);
+
+  // While new samples are disallowed, SampleAllocation drops the samples it takes.
+  void DisallowNewSamples() LOCKS_EXCLUDED(lock_);
+  void AllowNewSamples() LOCKS_EXCLUDED(lock_);
+  void EnsureNewSamplesDisallowed() LOCKS_EXCLUDED(lock_);
+
+  // Writes the samples as a symbolized pprof heap profile. Each site reports its live and total
+  // sampled objects and bytes; pprof scales them by the sample interval.
+  void DumpProfile(std::ostream& os)
+      LOCKS_EXCLUDED(lock_) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void DumpForSigQuit(std::ostream& os) LOCKS_EXCLUDED(lock_);
+
+  size_t GetSampleCount() LOCKS_EXCLUDED(lock_);
+  size_t GetLiveSampleCount() LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct Frame {
+    ArtMethod* method;
+    uint32_t dex_pc;
+
+    bool operator<(const Frame& other) const {
+      return method != other.method ? method < other.method : dex_pc < other.dex_pc;
+    }
+  };
+
+  struct SiteKey {
+    std::string descriptor;
+    std::vector<Frame> frames;
+
+    bool operator<(const SiteKey& other) const {
+      return descriptor != other.descriptor ? descriptor < other.descriptor
+                                            : frames < other.frames;
+    }
+  };
+
+  struct Site {
+    uint64_t alloc_count = 0;
+    uint64_t alloc_bytes = 0;
+    uint64_t live_count = 0;
+    uint64_t live_bytes = 0;
+  };
+
+  struct SampledObject {
+    mirror::Object* object;
+    Site* site;
+    size_t byte_count;
+  };
+
+  class StackVisitor;
+
+  // Returns the number of bytes the thread allocates before its next sample.
+  size_t NextSampleBytes() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Set when sampling is enabled, 0 otherwise.
+  Atomic<size_t> sample_interval_;
+
+  Mutex lock_ ACQUIRED_AFTER(Locks::alloc_tracker_lock_);
+  bool allow_new_samples_ GUARDED_BY(lock_);
+  std::mt19937 random_ GUARDED_BY(lock_);
+  std::map<SiteKey, Site> sites_ GUARDED_BY(lock_);
+  std::vector<SampledObject> sampled_objects_ GUARDED_BY(lock_);
+  uint64_t sample_count_ GUARDED_BY(lock_);
+  uint64_t dropped_sample_count_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationProfiler);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_ALLOCATION_PROFILER_H_
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocation_profiler.h"
+
+#include <sstream>
+
+#include "base/stringprintf.h"
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "handle_scope-inl.h"
+#include "mirror/array-inl.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace gc {
+
+class AllocationProfilerTest : public CommonRuntimeTest {
+ protected:
+  // Large enough for the large object space, so that each allocation takes the slow path.
+  static constexpr size_t kArrayLength = 64 * KB;
+  static constexpr size_t kNumArrays = 8;
+};
+
+TEST_F(AllocationProfilerTest, SampleAndSweep) {
+  ScopedObjectAccess soa(Thread::Current());
+  AllocationProfiler* profiler = Runtime::Current()->GetHeap()->GetAllocationProfiler();
+  EXPECT_FALSE(profiler->IsEnabled());
+
+  // With a one byte interval, every allocation from the slow path is sampled.
+  profiler->Start(1u);
+  EXPECT_TRUE(profiler->IsEnabled());
+  const size_t samples_before = profiler->GetSampleCount();
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::IntArray> kept(hs.NewHandle(mirror::IntArray::Alloc(soa.Self(), kArrayLength)));
+  ASSERT_TRUE(kept.Get() != nullptr);
+  for (size_t i = 1; i != kNumArrays; ++i) {
+    ASSERT_TRUE(mirror::IntArray::Alloc(soa.Self(), kArrayLength) != nullptr);
+  }
+  profiler->Stop();
+  EXPECT_FALSE(profiler->IsEnabled());
+  EXPECT_GE(profiler->GetSampleCount(), samples_before + kNumArrays);
+
+  // Only the array in the handle survives, all of the samples are from the same site.
+  Runtime::Current()->GetHeap()->CollectGarbage(false);
+  std::ostringstream os;
+  profiler->DumpProfile(os);
+  const std::string profile = os.str();
+  EXPECT_EQ(0u, profile.find("--- symbol\n")) << profile;
+  EXPECT_NE(std::string::npos, profile.find("--- heap\nheap profile: ")) << profile;
+  const size_t symbol = profile.find(" new int[]\n");
+  ASSERT_NE(std::string::npos, symbol) << profile;
+  const std::string address = profile.substr(profile.rfind('\n', symbol) + 1,
+                                             symbol - profile.rfind('\n', symbol) - 1);
+  // The byte counts include the rounding of the allocator, so only check the object counts.
+  const size_t site_end = profile.find("] @ " + address + "\n");
+  ASSERT_NE(std::string::npos, site_end) << profile;
+  const std::string site = profile.substr(profile.rfind('\n', site_end) + 1);
+  EXPECT_EQ(0u, site.find("1: ")) << site;
+  EXPECT_NE(std::string::npos, site.find(StringPrintf(" [%zu: ", kNumArrays))) << site;
+
+  // Once stopped, allocations are no longer sampled.
+  const size_t samples_after = profiler->GetSampleCount();
+  ASSERT_TRUE(mirror::IntArray::Alloc(soa.Self(), kArrayLength) != nullptr);
+  EXPECT_EQ(samples_after, profiler->GetSampleCount());
+}
+
+}  // namespace gc
+}  // namespace art
@@ -1638,6 +1638,27 @@ size_t RosAlloc::Footprint() {
   return footprint_;
 }
 
+void RosAlloc::CountFreeBytes(size_t* free_slot_bytes, size_t* free_page_bytes) {
+  Thread* self = Thread::Current();
+  // The alloc bit maps of the runs that are not thread-local only change with the bracket locks.
+  size_t slot_bytes = 0;
+  for (size_t idx = 0; idx < kNumOfSizeBrackets; ++idx) {
+    MutexLock mu(self, *size_bracket_locks_[idx]);
+    for (Run* run : non_full_runs_[idx]) {
+      slot_bytes += run->NumberOfFreeSlots() * bracketSizes[idx];
+    }
+  }
+  size_t page_bytes = 0;
+  {
+    MutexLock mu(self, lock_);
+    for (FreePageRun* fpr : free_page_runs_) {
+      page_bytes += fpr->ByteSize(this);
+    }
+  }
+  *free_slot_bytes = slot_bytes;
+  *free_page_bytes = page_bytes;
+}
+
 size_t RosAlloc::FootprintLimit() {
   MutexLock mu(Thread::Current(), lock_);
   return capacity_;
@@ -1768,6 +1789,11 @@ void RosAlloc::AssertAllThreadLocalRunsAreRevoked() {
 }
 
 void RosAlloc::Initialize() {
+  // The allocation fast paths compute the bracket index and size of thread-local runs from the
+  // quantum. See IndexToBracketSize().
+  static_assert(kNumThreadLocalSizeBrackets <= kNumOfQuantumSizeBrackets,
+                "Thread-local size brackets must be quantum sized");
+  static_assert(kThreadLocalBracketQuantumSize == 16, "Unexpected bracket quantum");
   // bracketSizes.
   for (size_t i = 0; i < kNumOfSizeBrackets; i++) {
     if (i < kNumOfSizeBrackets - 2) {
@@ -428,6 +428,12 @@ class RosAlloc {
   // We use thread-local runs for the size Brackets whose indexes
   // are less than this index. We use shared (current) runs for the rest.
   static const size_t kNumThreadLocalSizeBrackets = 8;
+  // The thread-local size brackets are evenly spaced by this quantum, starting at one quantum.
+  static constexpr size_t kThreadLocalBracketQuantumSizeShift = 4;
+  static constexpr size_t kThreadLocalBracketQuantumSize = 1 << kThreadLocalBracketQuantumSizeShift;
+  // The largest allocation size served from a thread-local run.
+  static constexpr size_t kMaxThreadLocalBracketSize =
+      kNumThreadLocalSizeBrackets * kThreadLocalBracketQuantumSize;
 
  private:
   // The base address of the memory region that's managed by this allocator.
@@ -610,6 +616,10 @@ class RosAlloc {
   size_t ReleasePages() LOCKS_EXCLUDED(lock_);
   // Returns the current footprint.
   size_t Footprint() LOCKS_EXCLUDED(lock_);
+  // Returns the bytes of the free slots in the non-full runs that are neither current nor
+  // thread-local, which only compaction can reclaim, and the bytes of the free page runs.
+  void CountFreeBytes(size_t* free_slot_bytes, size_t* free_page_bytes)
+      LOCKS_EXCLUDED(lock_);
   // Returns the current capacity, maximum footprint.
   size_t FootprintLimit() LOCKS_EXCLUDED(lock_);
   // Update the current capacity.
@@ -631,6 +641,13 @@ class RosAlloc {
   static Run* GetDedicatedFullRun() {
     return dedicated_full_run_;
   }
+  // Offsets of the run fields read by the allocation fast paths in the quick entrypoints.
+  static size_t RunFirstSearchVecIdxOffset() {
+    return OFFSETOF_MEMBER(Run, first_search_vec_idx_);
+  }
+  static size_t RunAllocBitMapOffset() {
+    return OFFSETOF_MEMBER(Run, alloc_bit_map_);
+  }
   bool IsFreePage(size_t idx) const {
     DCHECK_LT(idx, capacity_ / kPageSize);
     uint8_t pm_type = page_map_[idx];
@@ -1679,7 +1679,7 @@ void ConcurrentCopying::ProcessReferences(Thread* self, bool concurrent) {
   WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
   GetHeap()->GetReferenceProcessor()->ProcessReferences(
       concurrent, GetTimings(), GetCurrentIteration()->GetClearSoftReferences(),
-      &IsHeapReferenceMarkedCallback, &MarkCallback, &ProcessMarkStackCallback, this);
+      &IsHeapReferenceMarkedCallback, &MarkCallback, &ProcessMarkStackCallback, this, 1);
 }
 
 void ConcurrentCopying::RevokeAllThreadLocalBuffers() {
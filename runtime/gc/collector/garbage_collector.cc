@@ -29,6 +29,7 @@
 #include "gc/accounting/heap_bitmap.h"
 #include "gc/space/large_object_space.h"
 #include "gc/space/space-inl.h"
+#include "metrics.h"
 #include "thread-inl.h"
 #include "thread_list.h"
 #include "utils.h"
@@ -216,6 +217,19 @@ void GarbageCollector::DumpPerformanceInfo(std::ostream& os) {
      << PrettySize(freed_bytes / seconds) << "/s\n";
 }
 
+void GarbageCollector::DumpMetrics(std::ostream& os) {
+  const std::string prefix = "gc." + MetricsRegistry::SanitizeName(GetName());
+  const CumulativeLogger& logger = GetCumulativeTimings();
+  os << prefix << ".iterations " << logger.GetIterations() << "\n"
+     << prefix << ".time_ns " << logger.GetTotalNs() << "\n"
+     << prefix << ".freed_objects " << GetTotalFreedObjects() << "\n"
+     << prefix << ".freed_bytes " << GetTotalFreedBytes() << "\n"
+     << prefix << ".throughput_bytes_per_s " << GetEstimatedMeanThroughput() << "\n";
+  MutexLock mu(Thread::Current(), pause_histogram_lock_);
+  // The pauses are recorded in nanoseconds.
+  MetricsRegistry::DumpHistogram(os, prefix + ".pause_us", pause_histogram_, 1000u);
+}
+
 }  // namespace collector
 }  // namespace gc
 }  // namespace art
@@ -171,6 +171,8 @@ class GarbageCollector : public RootVisitor {
   // Record a free of large objects.
   void RecordFreeLOS(const ObjectBytePair& freed);
   void DumpPerformanceInfo(std::ostream& os) LOCKS_EXCLUDED(pause_histogram_lock_);
+  // Writes the cumulative statistics in the format of MetricsRegistry::Dump.
+  void DumpMetrics(std::ostream& os) LOCKS_EXCLUDED(pause_histogram_lock_);
 
  protected:
   // Run all of the GC phases.
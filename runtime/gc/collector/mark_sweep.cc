@@ -68,6 +68,13 @@ static constexpr bool kParallelRecursiveMark = true;
 // ProcessMarkStack with very small mark stacks.
 static constexpr size_t kMinimumParallelMarkStackSize = 128;
 static constexpr bool kParallelProcessMarkStack = true;
+// If true, the thread roots are re-marked in the pause by the heap thread pool workers instead of
+// by the GC thread alone. The pause otherwise grows linearly with the number of threads.
+static constexpr bool kParallelReMarkThreadRoots = true;
+// If true, the continuous spaces are swept by splitting their bitmaps into ranges which are swept
+// by the heap thread pool workers. Ranges are at least kMinimumParallelSweepRange bytes.
+static constexpr bool kParallelSweep = true;
+static constexpr size_t kMinimumParallelSweepRange = 1 * MB;
 
 // Profiling and information flags.
 static constexpr bool kProfileLargeObjects = false;
@@ -176,7 +183,8 @@ void MarkSweep::ProcessReferences(Thread* self) {
   WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
   GetHeap()->GetReferenceProcessor()->ProcessReferences(
       true, GetTimings(), GetCurrentIteration()->GetClearSoftReferences(),
-      &HeapReferenceMarkedCallback, &MarkObjectCallback, &ProcessMarkStackCallback, this);
+      &HeapReferenceMarkedCallback, &MarkObjectCallback, &ProcessMarkStackCallback, this,
+      GetThreadCount(false));
 }
 
 void MarkSweep::PausePhase() {
@@ -1002,9 +1010,21 @@ void MarkSweep::RecursiveMarkDirtyObjects(bool paused, uint8_t minimum_age) {
 
 void MarkSweep::ReMarkRoots() {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
-  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
-  Runtime::Current()->VisitRoots(this, static_cast<VisitRootFlags>(
-      kVisitRootFlagNewRoots | kVisitRootFlagStopLoggingNewRoots | kVisitRootFlagClearRootLog));
+  Thread* const self = Thread::Current();
+  Locks::mutator_lock_->AssertExclusiveHeld(self);
+  Runtime* const runtime = Runtime::Current();
+  const VisitRootFlags flags = static_cast<VisitRootFlags>(
+      kVisitRootFlagNewRoots | kVisitRootFlagStopLoggingNewRoots | kVisitRootFlagClearRootLog);
+  const size_t thread_count = GetThreadCount(true);
+  if (kParallelReMarkThreadRoots && thread_count > 1) {
+    // The thread roots must be done first since the other visits push onto the mark stack
+    // without holding the mark stack lock.
+    ReMarkThreadRoots(self, thread_count);
+    runtime->VisitNonThreadRoots(this);
+    runtime->VisitConcurrentRoots(this, flags);
+  } else {
+    runtime->VisitRoots(this, flags);
+  }
   if (kVerifyRootsMarked) {
     TimingLogger::ScopedTiming t2("(Paused)VerifyRoots", GetTimings());
     VerifyRootMarkedVisitor visitor(this);
@@ -1089,6 +1109,50 @@ class CheckpointMarkThreadRoots : public Closure, public RootVisitor {
   const bool revoke_ros_alloc_thread_local_buffers_at_checkpoint_;
 };
 
+class ReMarkThreadRootsTask : public Task {
+ public:
+  ReMarkThreadRootsTask(MarkSweep* mark_sweep, Thread* const* threads, size_t count)
+      : mark_sweep_(mark_sweep), threads_(threads), count_(count) {
+  }
+
+  virtual void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    // All the mutators are suspended, only mark the roots and leave the barrier alone.
+    CheckpointMarkThreadRoots visitor(mark_sweep_, false);
+    for (size_t i = 0; i < count_; ++i) {
+      threads_[i]->VisitRoots(&visitor);
+    }
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  MarkSweep* const mark_sweep_;
+  Thread* const* const threads_;
+  const size_t count_;
+};
+
+void MarkSweep::ReMarkThreadRoots(Thread* self, size_t thread_count) {
+  TimingLogger::ScopedTiming t("(Paused)ReMarkThreadRoots", GetTimings());
+  Locks::mutator_lock_->AssertExclusiveHeld(self);
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  // Hold the thread list lock so that no thread can be registered or unregistered while the
+  // workers are visiting the stacks.
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  std::list<Thread*> thread_list = Runtime::Current()->GetThreadList()->GetList();
+  std::vector<Thread*> threads(thread_list.begin(), thread_list.end());
+  const size_t delta = threads.size() / thread_count + 1;
+  for (size_t begin = 0; begin < threads.size(); begin += delta) {
+    const size_t count = std::min(delta, threads.size() - begin);
+    thread_pool->AddTask(self, new ReMarkThreadRootsTask(this, &threads[begin], count));
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+}
+
 void MarkSweep::MarkRootsCheckpoint(Thread* self,
                                     bool revoke_ros_alloc_thread_local_buffers_at_checkpoint) {
   TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
@@ -1225,17 +1289,169 @@ void MarkSweep::Sweep(bool swap_bitmaps) {
     live_stack->Reset();
     DCHECK(mark_stack_->IsEmpty());
   }
+  const size_t thread_count = GetThreadCount(false);
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
     if (space->IsContinuousMemMapAllocSpace()) {
       space::ContinuousMemMapAllocSpace* alloc_space = space->AsContinuousMemMapAllocSpace();
       TimingLogger::ScopedTiming split(
           alloc_space->IsZygoteSpace() ? "SweepZygoteSpace" : "SweepMallocSpace", GetTimings());
-      RecordFree(alloc_space->Sweep(swap_bitmaps));
+      if (kParallelSweep && thread_count > 1) {
+        RecordFree(SweepParallel(alloc_space, swap_bitmaps, thread_count));
+      } else {
+        RecordFree(alloc_space->Sweep(swap_bitmaps));
+      }
     }
   }
   SweepLargeObjects(swap_bitmaps);
 }
 
+class SweepRangeTask : public Task {
+ public:
+  SweepRangeTask(space::ContinuousMemMapAllocSpace* space, bool swap_bitmaps, uintptr_t begin,
+                 uintptr_t end, ObjectBytePair* freed)
+      : space_(space), swap_bitmaps_(swap_bitmaps), begin_(begin), end_(end), freed_(freed) {
+  }
+
+  virtual void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    // The GC thread holds the heap bitmap lock on behalf of the workers.
+    *freed_ = space_->SweepRange(swap_bitmaps_, begin_, end_);
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  space::ContinuousMemMapAllocSpace* const space_;
+  const bool swap_bitmaps_;
+  const uintptr_t begin_;
+  const uintptr_t end_;
+  ObjectBytePair* const freed_;
+};
+
+// Sweeps a range of a malloc space. The unmarked objects are gathered in a chunk buffer, like
+// the one of SweepArray, so that the worker frees them with one FreeList call per
+// kSweepArrayChunkFreeSize objects rather than one per bitmap walk buffer. A RosAlloc space
+// serializes its bulk frees, and bounded chunks keep each hold of its lock short.
+class SweepMallocRangeTask : public Task {
+ public:
+  SweepMallocRangeTask(space::MallocSpace* space, bool swap_bitmaps, uintptr_t begin,
+                       uintptr_t end, ObjectBytePair* freed)
+      : space_(space), swap_bitmaps_(swap_bitmaps), begin_(begin), end_(end), freed_(freed),
+        self_(nullptr), chunk_free_buffer_(new mirror::Object*[kSweepArrayChunkFreeSize]),
+        chunk_free_pos_(0) {
+  }
+
+  virtual void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    // The GC thread holds the heap bitmap lock on behalf of the workers.
+    self_ = self;
+    accounting::ContinuousSpaceBitmap* live_bitmap = space_->GetLiveBitmap();
+    accounting::ContinuousSpaceBitmap* mark_bitmap = space_->GetMarkBitmap();
+    if (swap_bitmaps_) {
+      std::swap(live_bitmap, mark_bitmap);
+    }
+    accounting::ContinuousSpaceBitmap::SweepWalk(*live_bitmap, *mark_bitmap, begin_, end_,
+                                                 &SweepCallback, this);
+    FreeChunk();
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  static void SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg) {
+    SweepMallocRangeTask* task = reinterpret_cast<SweepMallocRangeTask*>(arg);
+    // Same as MallocSpace::SweepCallback: if the bitmaps aren't swapped the live bits must be
+    // cleared since the GC isn't going to re-swap the bitmaps.
+    if (!task->swap_bitmaps_) {
+      accounting::ContinuousSpaceBitmap* bitmap = task->space_->GetLiveBitmap();
+      for (size_t i = 0; i < num_ptrs; ++i) {
+        bitmap->Clear(ptrs[i]);
+      }
+    }
+    while (num_ptrs > 0) {
+      const size_t count =
+          std::min(num_ptrs, kSweepArrayChunkFreeSize - task->chunk_free_pos_);
+      std::copy(ptrs, ptrs + count, &task->chunk_free_buffer_[task->chunk_free_pos_]);
+      task->chunk_free_pos_ += count;
+      ptrs += count;
+      num_ptrs -= count;
+      if (task->chunk_free_pos_ == kSweepArrayChunkFreeSize) {
+        task->FreeChunk();
+      }
+    }
+  }
+
+  void FreeChunk() {
+    if (chunk_free_pos_ > 0) {
+      freed_->objects += chunk_free_pos_;
+      freed_->bytes += space_->FreeList(self_, chunk_free_pos_, chunk_free_buffer_.get());
+      chunk_free_pos_ = 0;
+    }
+  }
+
+  space::MallocSpace* const space_;
+  const bool swap_bitmaps_;
+  const uintptr_t begin_;
+  const uintptr_t end_;
+  ObjectBytePair* const freed_;
+  Thread* self_;
+  std::unique_ptr<mirror::Object*[]> chunk_free_buffer_;
+  size_t chunk_free_pos_;
+};
+
+ObjectBytePair MarkSweep::SweepParallel(space::ContinuousMemMapAllocSpace* space,
+                                        bool swap_bitmaps, size_t thread_count) {
+  Thread* self = Thread::Current();
+  Locks::heap_bitmap_lock_->AssertExclusiveHeld(self);
+  accounting::ContinuousSpaceBitmap* live_bitmap = space->GetLiveBitmap();
+  if (live_bitmap == space->GetMarkBitmap()) {
+    return ObjectBytePair(0, 0);
+  }
+  // Split the space on page boundaries relative to the start of the bitmap. A page is always a
+  // multiple of the heap covered by a bitmap word, so no two ranges share a word.
+  const uintptr_t heap_begin = live_bitmap->HeapBegin();
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(space->Begin());
+  const uintptr_t end = reinterpret_cast<uintptr_t>(space->End());
+  DCHECK_ALIGNED(begin - heap_begin, kPageSize);
+  if (begin >= end) {
+    return ObjectBytePair(0, 0);
+  }
+  const size_t delta = RoundUp(std::max((end - begin) / thread_count + 1,
+                                        kMinimumParallelSweepRange), kPageSize);
+  const size_t num_ranges = RoundUp(end - begin, delta) / delta;
+  // Zygote spaces do not free from their sweep callback, so only malloc spaces use the chunked
+  // frees of SweepMallocRangeTask.
+  space::MallocSpace* malloc_space = space->IsMallocSpace() ? space->AsMallocSpace() : nullptr;
+  std::vector<ObjectBytePair> freed(num_ranges);
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  {
+    TimingLogger::ScopedTiming t("SweepRanges", GetTimings());
+    size_t task_index = 0;
+    for (uintptr_t range_begin = begin; range_begin < end; range_begin += delta) {
+      DCHECK_LT(task_index, num_ranges);
+      const uintptr_t range_end = std::min(range_begin + delta, end);
+      if (malloc_space != nullptr) {
+        thread_pool->AddTask(self, new SweepMallocRangeTask(
+            malloc_space, swap_bitmaps, range_begin, range_end, &freed[task_index++]));
+      } else {
+        thread_pool->AddTask(self, new SweepRangeTask(space, swap_bitmaps, range_begin,
+                                                      range_end, &freed[task_index++]));
+      }
+    }
+    thread_pool->SetMaxActiveWorkers(thread_count - 1);
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, true, true);
+    thread_pool->StopWorkers(self);
+  }
+  ObjectBytePair total;
+  for (const ObjectBytePair& range_freed : freed) {
+    total.Add(range_freed);
+  }
+  return total;
+}
+
 void MarkSweep::SweepLargeObjects(bool swap_bitmaps) {
   space::LargeObjectSpace* los = heap_->GetLargeObjectsSpace();
   if (los != nullptr) {
@@ -50,6 +50,10 @@ namespace accounting {
   typedef AtomicStack<mirror::Object> ObjectStack;
 }  // namespace accounting
 
+namespace space {
+  class ContinuousMemMapAllocSpace;
+}  // namespace space
+
 namespace collector {
 
 class MarkSweep : public GarbageCollector {
@@ -122,6 +126,11 @@ class MarkSweep : public GarbageCollector {
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Remarks the roots of all the suspended threads using the heap thread pool.
+  void ReMarkThreadRoots(Thread* self, size_t thread_count)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_, Locks::mutator_lock_)
+      LOCKS_EXCLUDED(Locks::thread_list_lock_);
+
   void ProcessReferences(Thread* self)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
@@ -142,6 +151,13 @@ class MarkSweep : public GarbageCollector {
   // Sweeps unmarked objects to complete the garbage collection.
   void SweepLargeObjects(bool swap_bitmaps) EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
+  // Sweeps a continuous space by splitting it into ranges swept by the heap thread pool. For
+  // malloc spaces each worker frees the unmarked objects of its range in bounded chunks.
+  ObjectBytePair SweepParallel(space::ContinuousMemMapAllocSpace* space, bool swap_bitmaps,
+                               size_t thread_count)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Sweep only pointers within an array. WARNING: Trashes objects.
   void SweepArray(accounting::ObjectStack* allocation_stack_, bool swap_bitmaps)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
@@ -22,6 +22,7 @@
 #include "base/time_utils.h"
 #include "debugger.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/allocation_profiler.h"
 #include "gc/collector/semi_space.h"
 #include "gc/space/bump_pointer_space-inl.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -69,6 +70,7 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self, mirror::Clas
   size_t bytes_allocated;
   size_t usable_size;
   size_t new_num_bytes_allocated = 0;
+  bool sample_allocation = false;
   if (allocator == kAllocatorTypeTLAB || allocator == kAllocatorTypeRegionTLAB) {
     byte_count = RoundUp(byte_count, space::BumpPointerSpace::kAlignment);
   }
@@ -147,6 +149,11 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self, mirror::Clas
     new_num_bytes_allocated = static_cast<size_t>(
         num_bytes_allocated_.FetchAndAddSequentiallyConsistent(bytes_tl_bulk_allocated))
         + bytes_tl_bulk_allocated;
+    // Like num_bytes_allocated_, this counts thread-local buffers when they are handed out.
+    self->AddMetric(MetricsRegistry::AllocatedBytesCounter(allocator), bytes_tl_bulk_allocated);
+    // Only the slow path counts towards the next allocation sample, so TLABs and thread-local
+    // runs count when they are refilled.
+    sample_allocation = self->CountAllocationSampleBytes(bytes_tl_bulk_allocated);
   }
   if (kIsDebugBuild && Runtime::Current()->IsStarted()) {
     CHECK_LE(obj->SizeOf(), usable_size);
@@ -174,6 +181,9 @@ inline mirror::Object* Heap::AllocObjectWithAllocator(Thread* self, mirror::Clas
   } else {
     DCHECK(!Dbg::IsAllocTrackingEnabled());
   }
+  if (UNLIKELY(sample_allocation)) {
+    allocation_profiler_->SampleAllocation(self, obj, bytes_allocated);
+  }
   if (kInstrumented) {
     if (gc_stress_mode_) {
       CheckGcStressMode(self, &obj);
@@ -35,6 +35,7 @@
 #include "debugger.h"
 #include "dex_file-inl.h"
 #include "gc/accounting/atomic_stack.h"
+#include "gc/allocation_profiler.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/accounting/mod_union_table-inl.h"
@@ -112,6 +113,8 @@ static constexpr size_t kDefaultAllocationStackSize = 8 * MB /
 // System.runFinalization can deadlock with native allocations, to deal with this, we have a
 // timeout on how long we wait for finalizers to run. b/21544853
 static constexpr uint64_t kNativeAllocationFinalizeTimeout = MsToNs(250u);
+// How long a thread over the native growth limit waits for the GC it requested.
+static constexpr uint64_t kNativeAllocationGcWaitTimeout = MsToNs(250u);
 
 Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max_free,
            double target_utilization, double foreground_heap_growth_multiplier,
@@ -152,7 +155,8 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
       growth_limit_(growth_limit),
       max_allowed_footprint_(initial_size),
       native_footprint_gc_watermark_(initial_size),
-      native_need_to_run_finalization_(false),
+      native_allocation_gc_pending_(false),
+      native_bytes_allocated_at_last_gc_(0),
       // Initially assume we perceive jank in case the process state is never updated.
       process_state_(kProcessStateJankPerceptible),
       concurrent_start_bytes_(std::numeric_limits<size_t>::max()),
@@ -200,6 +204,7 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
       last_time_homogeneous_space_compaction_by_oom_(NanoTime()),
       pending_collector_transition_(nullptr),
       pending_heap_trim_(nullptr),
+      pending_fragmentation_check_(nullptr),
       use_homogeneous_space_compaction_for_oom_(use_homogeneous_space_compaction_for_oom),
       running_collection_is_blocking_(false),
       blocking_gc_count_(0U),
@@ -464,6 +469,7 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
   gc_complete_cond_.reset(new ConditionVariable("GC complete condition variable",
                                                 *gc_complete_lock_));
   task_processor_.reset(new TaskProcessor());
+  allocation_profiler_.reset(new AllocationProfiler());
   reference_processor_.reset(new ReferenceProcessor());
   pending_task_lock_ = new Mutex("Pending task lock");
   if (ignore_max_footprint_) {
@@ -748,6 +754,24 @@ void Heap::DecrementDisableMovingGC(Thread* self) {
   --disable_moving_gc_count_;
 }
 
+bool Heap::TryPinObject(mirror::Object* obj) {
+  // The region only gets evacuated during the flip pause, which can't happen while we are runnable,
+  // and obj was read through a read barrier so it is already in a to-space or unevacuated region.
+  if (region_space_ != nullptr && region_space_->HasAddress(obj)) {
+    region_space_->PinObject(obj);
+    return true;
+  }
+  return false;
+}
+
+bool Heap::TryUnpinObject(mirror::Object* obj) {
+  if (region_space_ != nullptr && region_space_->HasAddress(obj)) {
+    region_space_->UnpinObject(obj);
+    return true;
+  }
+  return false;
+}
+
 void Heap::UpdateProcessState(ProcessState process_state) {
   if (process_state_ != process_state) {
     process_state_ = process_state;
@@ -959,6 +983,7 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
     total_paused_time += collector->GetTotalPausedTimeNs();
     collector->DumpPerformanceInfo(os);
   }
+  reference_processor_->DumpPerformanceInfo(os);
   uint64_t allocation_time =
       static_cast<uint64_t>(total_allocation_time_.LoadRelaxed()) * kTimeAdjust;
   if (total_duration != 0) {
@@ -1011,10 +1036,30 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
   BaseMutex::DumpAll(os);
 }
 
+void Heap::DumpMetrics(std::ostream& os) {
+  os << "heap.allocated_bytes " << GetBytesAllocated() << "\n"
+     << "heap.total_memory " << GetTotalMemory() << "\n"
+     << "heap.max_memory " << GetMaxMemory() << "\n"
+     << "heap.allocated_bytes_ever " << GetBytesAllocatedEver() << "\n"
+     << "heap.freed_bytes_ever " << GetBytesFreedEver() << "\n"
+     << "heap.freed_objects_ever " << GetObjectsFreedEver() << "\n"
+     << "gc.count " << GetGcCount() << "\n"
+     << "gc.time_ns " << GetGcTime() << "\n"
+     << "gc.blocking_count " << GetBlockingGcCount() << "\n"
+     << "gc.blocking_time_ns " << GetBlockingGcTime() << "\n"
+     << "gc.wait_time_ns " << total_wait_time_ << "\n"
+     << "heap.main_space.free_slot_bytes " << main_space_free_slot_bytes_.LoadRelaxed() << "\n"
+     << "heap.main_space.used_page_bytes " << main_space_used_page_bytes_.LoadRelaxed() << "\n";
+  for (auto& collector : garbage_collectors_) {
+    collector->DumpMetrics(os);
+  }
+}
+
 void Heap::ResetGcPerformanceInfo() {
   for (auto& collector : garbage_collectors_) {
     collector->ResetMeasurements();
   }
+  reference_processor_->ResetMeasurements();
   total_allocation_time_.StoreRelaxed(0);
   total_bytes_freed_ever_ = 0;
   total_objects_freed_ever_ = 0;
@@ -2468,6 +2513,9 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type, GcCaus
   total_objects_freed_ever_ += GetCurrentGcIteration()->GetFreedObjects();
   total_bytes_freed_ever_ += GetCurrentGcIteration()->GetFreedBytes();
   RequestTrim(self);
+  if (!compacting_gc) {
+    RequestFragmentationCheck(self);
+  }
   // Enqueue cleared references.
   reference_processor_->EnqueueClearedReferences(self);
   // Grow the heap so that we know when to perform the next GC.
@@ -3211,6 +3259,7 @@ void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
   DumpGcPerformanceInfo(os);
+  allocation_profiler_->DumpForSigQuit(os);
 }
 
 size_t Heap::GetPercentFree() {
@@ -3285,7 +3334,9 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
     target_size = bytes_allocated + delta * multiplier;
     target_size = std::min(target_size, bytes_allocated + adjusted_max_free);
     target_size = std::max(target_size, bytes_allocated + adjusted_min_free);
-    native_need_to_run_finalization_ = true;
+    // The finalizers of the native allocation owners freed by this GC have not run yet, so this
+    // over-estimates the live native size. The watermark is bounded by max_free_ either way.
+    UpdateMaxNativeFootprint();
     next_gc_type_ = collector::kGcTypeSticky;
   } else {
     collector::GcType non_sticky_gc_type =
@@ -3345,6 +3396,8 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
                                          static_cast<size_t>(bytes_allocated));
     }
   }
+  // Restart the native allocation budget, see RegisterNativeAllocation.
+  native_bytes_allocated_at_last_gc_.StoreRelaxed(native_bytes_allocated_.LoadRelaxed());
 }
 
 void Heap::ClampGrowthLimit() {
@@ -3415,6 +3468,69 @@ static bool CanAddHeapTask(Thread* self) LOCKS_EXCLUDED(Locks::runtime_shutdown_
       !self->IsHandlingStackOverflow();
 }
 
+class Heap::NativeAllocationGCTask : public HeapTask {
+ public:
+  NativeAllocationGCTask() : HeapTask(NanoTime()) { }  // Start straight away.
+  virtual void Run(Thread* self) OVERRIDE {
+    Runtime::Current()->GetHeap()->NativeAllocationGC(self);
+  }
+};
+
+bool Heap::RequestNativeAllocationGC(Thread* self) {
+  if (!CanAddHeapTask(self)) {
+    return false;
+  }
+  {
+    MutexLock mu(self, *gc_complete_lock_);
+    if (native_allocation_gc_pending_) {
+      return true;
+    }
+    native_allocation_gc_pending_ = true;
+  }
+  task_processor_->AddTask(self, new NativeAllocationGCTask());
+  return true;
+}
+
+void Heap::WaitForNativeAllocationGC(Thread* self) {
+  ScopedThreadStateChange tsc(self, kWaitingForGcToComplete);
+  MutexLock mu(self, *gc_complete_lock_);
+  const uint64_t deadline = NanoTime() + kNativeAllocationGcWaitTimeout;
+  while (native_allocation_gc_pending_) {
+    const uint64_t now = NanoTime();
+    if (now >= deadline) {
+      break;
+    }
+    const uint64_t remaining = deadline - now;
+    gc_complete_cond_->TimedWait(self, static_cast<int64_t>(NsToMs(remaining)),
+                                 static_cast<int32_t>(remaining % MsToNs(1)));
+  }
+}
+
+void Heap::NativeAllocationGC(Thread* self) {
+  if (!Runtime::Current()->IsShuttingDown(self) &&
+      native_bytes_allocated_.LoadRelaxed() > native_footprint_gc_watermark_) {
+    collector::GcType gc_type = HasZygoteSpace() ? collector::kGcTypePartial :
+        collector::kGcTypeFull;
+    // A GC that finished while the task was queued may already have caught up.
+    if (WaitForGcToComplete(kGcCauseForNativeAlloc, self) == collector::kGcTypeNone ||
+        native_bytes_allocated_.LoadRelaxed() > native_footprint_gc_watermark_) {
+      CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
+    }
+  }
+  {
+    MutexLock mu(self, *gc_complete_lock_);
+    native_allocation_gc_pending_ = false;
+    gc_complete_cond_->Broadcast(self);
+  }
+  // Run the finalizers enqueued by the GC here rather than on the throttled threads, which
+  // only wait for the GC itself.
+  JNIEnv* env = self->GetJniEnv();
+  RunFinalization(env, kNativeAllocationFinalizeTimeout);
+  CHECK(!env->ExceptionCheck());
+  // Finalizers very likely released native allocations, update the native watermark.
+  UpdateMaxNativeFootprint();
+}
+
 void Heap::ClearConcurrentGCRequest() {
   concurrent_gc_pending_.StoreRelaxed(false);
 }
@@ -3533,6 +3649,57 @@ void Heap::RequestTrim(Thread* self) {
   task_processor_->AddTask(self, added_task);
 }
 
+class Heap::FragmentationCheckTask : public HeapTask {
+ public:
+  FragmentationCheckTask() : HeapTask(NanoTime()) { }
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    heap->CheckFragmentation(self);
+    heap->ClearPendingFragmentationCheck(self);
+  }
+};
+
+void Heap::ClearPendingFragmentationCheck(Thread* self) {
+  MutexLock mu(self, *pending_task_lock_);
+  pending_fragmentation_check_ = nullptr;
+}
+
+void Heap::RequestFragmentationCheck(Thread* self) {
+  if (!CanAddHeapTask(self)) {
+    return;
+  }
+  FragmentationCheckTask* added_task = nullptr;
+  {
+    MutexLock mu(self, *pending_task_lock_);
+    if (pending_fragmentation_check_ != nullptr) {
+      return;
+    }
+    added_task = new FragmentationCheckTask();
+    pending_fragmentation_check_ = added_task;
+  }
+  task_processor_->AddTask(self, added_task);
+}
+
+void Heap::CheckFragmentation(Thread* self) {
+  size_t free_slot_bytes;
+  size_t free_page_bytes;
+  size_t footprint;
+  {
+    // Compactions and collector transitions only replace the main space with the mutators
+    // suspended.
+    ScopedObjectAccess soa(self);
+    if (main_space_ == nullptr || !main_space_->IsRosAllocSpace()) {
+      return;
+    }
+    allocator::RosAlloc* rosalloc = main_space_->AsRosAllocSpace()->GetRosAlloc();
+    rosalloc->CountFreeBytes(&free_slot_bytes, &free_page_bytes);
+    footprint = rosalloc->Footprint();
+  }
+  const size_t used_page_bytes = footprint > free_page_bytes ? footprint - free_page_bytes : 0u;
+  main_space_free_slot_bytes_.StoreRelaxed(free_slot_bytes);
+  main_space_used_page_bytes_.StoreRelaxed(used_page_bytes);
+}
+
 void Heap::RevokeThreadLocalBuffers(Thread* thread) {
   if (rosalloc_space_ != nullptr) {
     size_t freed_bytes_revoke = rosalloc_space_->RevokeThreadLocalBuffers(thread);
@@ -3587,44 +3754,42 @@ void Heap::RunFinalization(JNIEnv* env, uint64_t timeout) {
 
 void Heap::RegisterNativeAllocation(JNIEnv* env, size_t bytes) {
   Thread* self = ThreadForEnv(env);
-  if (native_need_to_run_finalization_) {
-    RunFinalization(env, kNativeAllocationFinalizeTimeout);
-    UpdateMaxNativeFootprint();
-    native_need_to_run_finalization_ = false;
-  }
   // Total number of native bytes allocated.
   size_t new_native_bytes_allocated = native_bytes_allocated_.FetchAndAddSequentiallyConsistent(bytes);
   new_native_bytes_allocated += bytes;
-  if (new_native_bytes_allocated > native_footprint_gc_watermark_) {
-    collector::GcType gc_type = HasZygoteSpace() ? collector::kGcTypePartial :
-        collector::kGcTypeFull;
-
-    // The second watermark is higher than the gc watermark. If you hit this it means you are
-    // allocating native objects faster than the GC can keep up with.
-    if (new_native_bytes_allocated > growth_limit_) {
-      if (WaitForGcToComplete(kGcCauseForNativeAlloc, self) != collector::kGcTypeNone) {
-        // Just finished a GC, attempt to run finalizers.
-        RunFinalization(env, kNativeAllocationFinalizeTimeout);
-        CHECK(!env->ExceptionCheck());
-        // Native bytes allocated may be updated by finalization, refresh it.
-        new_native_bytes_allocated = native_bytes_allocated_.LoadRelaxed();
-      }
-      // If we still are over the watermark, attempt a GC for alloc and run finalizers.
-      if (new_native_bytes_allocated > growth_limit_) {
-        CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
-        RunFinalization(env, kNativeAllocationFinalizeTimeout);
-        native_need_to_run_finalization_ = false;
-        CHECK(!env->ExceptionCheck());
-      }
-      // We have just run finalizers, update the native watermark since it is very likely that
-      // finalizers released native managed allocations.
-      UpdateMaxNativeFootprint();
-    } else if (!IsGCRequestPending()) {
-      if (IsGcConcurrent()) {
-        RequestConcurrentGC(self, true);  // Request non-sticky type.
-      } else {
-        CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
-      }
+  collector::GcType gc_type = HasZygoteSpace() ? collector::kGcTypePartial :
+      collector::kGcTypeFull;
+  // The second watermark is higher than the gc watermark. If you hit this it means you are
+  // allocating native objects faster than the GC can keep up with. The heap task daemon then
+  // runs a blocking GC and the finalizers it enqueues, and the allocating thread is throttled
+  // until that GC completes, but never runs the GC or the finalizers itself.
+  if (UNLIKELY(new_native_bytes_allocated > growth_limit_)) {
+    if (RequestNativeAllocationGC(self)) {
+      WaitForNativeAllocationGC(self);
+    } else {
+      // No heap task daemon to hand the GC to, e.g. during startup. Leave the finalizers to the
+      // finalizer daemon.
+      CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
+    }
+    return;
+  }
+  // Below the second watermark the allocating thread never blocks. Native bytes allocated since
+  // the last GC use up the same headroom as managed allocations, so that a concurrent GC is
+  // requested early, well before the native footprint reaches the second watermark. Only native
+  // growth that crosses a trigger requests a GC here, managed allocations past the concurrent
+  // start bytes request their own.
+  const size_t native_bytes_at_last_gc = native_bytes_allocated_at_last_gc_.LoadRelaxed();
+  const size_t native_growth = new_native_bytes_allocated > native_bytes_at_last_gc ?
+      new_native_bytes_allocated - native_bytes_at_last_gc : 0u;
+  const size_t bytes_allocated = GetBytesAllocated();
+  const bool past_native_watermark = new_native_bytes_allocated > native_footprint_gc_watermark_;
+  const bool past_concurrent_start = bytes_allocated < concurrent_start_bytes_ &&
+      native_growth >= concurrent_start_bytes_ - bytes_allocated;
+  if ((past_native_watermark || past_concurrent_start) && !IsGCRequestPending()) {
+    if (IsGcConcurrent()) {
+      RequestConcurrentGC(self, true);  // Request non-sticky type.
+    } else if (past_native_watermark && !RequestNativeAllocationGC(self)) {
+      CollectGarbageInternal(gc_type, kGcCauseForNativeAlloc, false);
     }
   }
 }
@@ -55,6 +55,7 @@ namespace mirror {
 
 namespace gc {
 
+class AllocationProfiler;
 class ReferenceProcessor;
 class TaskProcessor;
 
@@ -227,6 +228,8 @@ class Heap {
   void CheckPreconditionsForAllocObject(mirror::Class* c, size_t byte_count)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Account for native bytes owned by managed objects. Requests a concurrent GC when the native
+  // allocations use up the GC headroom, only blocks the caller when it is far ahead of the GC.
   void RegisterNativeAllocation(JNIEnv* env, size_t bytes);
   void RegisterNativeFree(JNIEnv* env, size_t bytes);
 
@@ -279,6 +282,15 @@ class Heap {
   void IncrementDisableMovingGC(Thread* self);
   void DecrementDisableMovingGC(Thread* self);
 
+  // Keep a movable object in place without disabling moving GC for the whole heap. Only objects in
+  // the region space can be pinned; returns false if obj is elsewhere, in which case the caller
+  // must fall back to IncrementDisableMovingGC. That is always the case for objects in a bump
+  // pointer or semi space: their collectors evacuate the whole space and have no way to leave a
+  // single object or page behind, so a JNI critical section there still blocks every moving GC.
+  bool TryPinObject(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Undo a successful TryPinObject. Returns false if obj was not pinned by TryPinObject.
+  bool TryUnpinObject(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Clear all of the mark bits, doesn't clear bitmaps which have the same live bits as mark bits.
   void ClearMarkedObjects() EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
 
@@ -596,6 +608,8 @@ class Heap {
   // GC performance measuring
   void DumpGcPerformanceInfo(std::ostream& os);
   void ResetGcPerformanceInfo();
+  // Writes the heap and collector statistics in the format of MetricsRegistry::Dump.
+  void DumpMetrics(std::ostream& os);
 
   // Returns true if we currently care about pause times.
   bool CareAboutPauseTimes() const {
@@ -631,6 +645,9 @@ class Heap {
   TaskProcessor* GetTaskProcessor() {
     return task_processor_.get();
   }
+  AllocationProfiler* GetAllocationProfiler() {
+    return allocation_profiler_.get();
+  }
 
   bool HasZygoteSpace() const {
     return zygote_space_ != nullptr;
@@ -666,6 +683,10 @@ class Heap {
   // Request asynchronous GC.
   void RequestConcurrentGC(Thread* self, bool force_full) LOCKS_EXCLUDED(pending_task_lock_);
 
+  // Request an asynchronous measurement of the fragmentation of the main space, which is
+  // reported in the metrics dump.
+  void RequestFragmentationCheck(Thread* self) LOCKS_EXCLUDED(pending_task_lock_);
+
   // Whether or not we may use a garbage collector, used so that we only create collectors we need.
   bool MayUseCollector(CollectorType type) const;
 
@@ -684,8 +705,10 @@ class Heap {
 
  private:
   class ConcurrentGCTask;
+  class NativeAllocationGCTask;
   class CollectorTransitionTask;
   class HeapTrimTask;
+  class FragmentationCheckTask;
 
   // Compact source space to target space. Returns the collector used.
   collector::GarbageCollector* Compact(space::ContinuousMemMapAllocSpace* target_space,
@@ -861,7 +884,17 @@ class Heap {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   void ClearConcurrentGCRequest();
+  // Asks the heap task daemon for a blocking GC followed by finalization, on behalf of a thread
+  // registering native allocations. Returns false if heap tasks cannot be added.
+  bool RequestNativeAllocationGC(Thread* self) LOCKS_EXCLUDED(gc_complete_lock_);
+  // Waits, for a bounded time, for the GC requested by RequestNativeAllocationGC to complete.
+  void WaitForNativeAllocationGC(Thread* self) LOCKS_EXCLUDED(gc_complete_lock_);
+  // Run by the heap task daemon for RequestNativeAllocationGC.
+  void NativeAllocationGC(Thread* self) LOCKS_EXCLUDED(gc_complete_lock_);
   void ClearPendingTrim(Thread* self) LOCKS_EXCLUDED(pending_task_lock_);
+  void ClearPendingFragmentationCheck(Thread* self) LOCKS_EXCLUDED(pending_task_lock_);
+  // Measures the fragmentation of the RosAlloc main space.
+  void CheckFragmentation(Thread* self) LOCKS_EXCLUDED(Locks::mutator_lock_);
   void ClearPendingCollectorTransition(Thread* self) LOCKS_EXCLUDED(pending_task_lock_);
 
   // What kind of concurrency behavior is the runtime after? Currently true for concurrent mark
@@ -981,6 +1014,9 @@ class Heap {
   // Task processor, proxies heap trim requests to the daemon threads.
   std::unique_ptr<TaskProcessor> task_processor_;
 
+  // Samples allocations from the allocation slow path when enabled.
+  std::unique_ptr<AllocationProfiler> allocation_profiler_;
+
   // True while the garbage collector is running.
   volatile CollectorType collector_type_running_ GUARDED_BY(gc_complete_lock_);
 
@@ -1002,8 +1038,12 @@ class Heap {
   // The watermark at which a concurrent GC is requested by registerNativeAllocation.
   size_t native_footprint_gc_watermark_;
 
-  // Whether or not we need to run finalizers in the next native allocation.
-  bool native_need_to_run_finalization_;
+  // Whether a GC requested by RequestNativeAllocationGC has not completed yet.
+  bool native_allocation_gc_pending_ GUARDED_BY(gc_complete_lock_);
+
+  // Native bytes allocated when the last GC finished. Native allocations made since then count
+  // towards the concurrent GC trigger in the same way as managed allocations do.
+  Atomic<size_t> native_bytes_allocated_at_last_gc_;
 
   // Whether or not we currently care about pause times.
   ProcessState process_state_;
@@ -1163,12 +1203,18 @@ class Heap {
   // Count for performed homogeneous space compaction.
   Atomic<size_t> count_performed_homogeneous_space_compaction_;
 
+  // The fragmentation of the main space, as of the last fragmentation check: the bytes of the
+  // free slots in its partially used RosAlloc runs, and the bytes of its used pages.
+  Atomic<size_t> main_space_free_slot_bytes_;
+  Atomic<size_t> main_space_used_page_bytes_;
+
   // Whether or not a concurrent GC is pending.
   Atomic<bool> concurrent_gc_pending_;
 
   // Active tasks which we can modify (change target time, desired collector type, etc..).
   CollectorTransitionTask* pending_collector_transition_ GUARDED_BY(pending_task_lock_);
   HeapTrimTask* pending_heap_trim_ GUARDED_BY(pending_task_lock_);
+  FragmentationCheckTask* pending_fragmentation_check_ GUARDED_BY(pending_task_lock_);
 
   // Whether or not we use homogeneous space compaction to avoid OOM errors.
   bool use_homogeneous_space_compaction_for_oom_;
@@ -16,6 +16,7 @@
 
 #include "reference_processor.h"
 
+#include "base/histogram-inl.h"
 #include "base/time_utils.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
@@ -25,6 +26,7 @@
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
 #include "task_processor.h"
+#include "thread_pool.h"
 #include "utils.h"
 #include "well_known_classes.h"
 
@@ -32,6 +34,8 @@ namespace art {
 namespace gc {
 
 static constexpr bool kAsyncReferenceQueueAdd = false;
+// How many references a parallel reference clearing task processes.
+static constexpr size_t kClearWhiteReferencesChunkSize = 1024;
 
 ReferenceProcessor::ReferenceProcessor()
     : process_references_args_(nullptr, nullptr, nullptr),
@@ -41,7 +45,11 @@ ReferenceProcessor::ReferenceProcessor()
       weak_reference_queue_(Locks::reference_queue_weak_references_lock_),
       finalizer_reference_queue_(Locks::reference_queue_finalizer_references_lock_),
       phantom_reference_queue_(Locks::reference_queue_phantom_references_lock_),
-      cleared_references_(Locks::reference_queue_cleared_references_lock_) {
+      cleared_references_(Locks::reference_queue_cleared_references_lock_),
+      stats_lock_("reference processor stats lock", kDefaultMutexLevel),
+      process_time_histogram_("ProcessReferences", kProcessTimeBucketSize,
+                              kProcessTimeBucketCount),
+      total_references_processed_(0) {
 }
 
 void ReferenceProcessor::EnableSlowPath() {
@@ -120,9 +128,11 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
                                            IsHeapReferenceMarkedCallback* is_marked_callback,
                                            MarkObjectCallback* mark_object_callback,
                                            ProcessMarkStackCallback* process_mark_stack_callback,
-                                           void* arg) {
+                                           void* arg, size_t thread_count) {
   TimingLogger::ScopedTiming t(concurrent ? __FUNCTION__ : "(Paused)ProcessReferences", timings);
   Thread* self = Thread::Current();
+  const uint64_t start_time = NanoTime();
+  size_t references_processed = 0;
   {
     MutexLock mu(self, *Locks::reference_processor_lock_);
     process_references_args_.is_marked_callback_ = is_marked_callback;
@@ -144,9 +154,13 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
       StopPreservingReferences(self);
     }
   }
-  // Clear all remaining soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, is_marked_callback, arg);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, is_marked_callback, arg);
+  {
+    // Clear all remaining soft and weak references with white referents.
+    TimingLogger::ScopedTiming t2(concurrent ? "ClearWhiteReferences" :
+        "(Paused)ClearWhiteReferences", timings);
+    references_processed += ClearWhiteReferences(
+        { &soft_reference_queue_, &weak_reference_queue_ }, is_marked_callback, arg, thread_count);
+  }
   {
     TimingLogger::ScopedTiming t2(concurrent ? "EnqueueFinalizerReferences" :
         "(Paused)EnqueueFinalizerReferences", timings);
@@ -161,11 +175,15 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
       StopPreservingReferences(self);
     }
   }
-  // Clear all finalizer referent reachable soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, is_marked_callback, arg);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, is_marked_callback, arg);
-  // Clear all phantom references with white referents.
-  phantom_reference_queue_.ClearWhiteReferences(&cleared_references_, is_marked_callback, arg);
+  {
+    // Clear all finalizer referent reachable soft and weak references with white referents, and
+    // all phantom references with white referents.
+    TimingLogger::ScopedTiming t2(concurrent ? "ClearRemainingWhiteReferences" :
+        "(Paused)ClearRemainingWhiteReferences", timings);
+    references_processed += ClearWhiteReferences(
+        { &soft_reference_queue_, &weak_reference_queue_, &phantom_reference_queue_ },
+        is_marked_callback, arg, thread_count);
+  }
   // At this point all reference queues other than the cleared references should be empty.
   DCHECK(soft_reference_queue_.IsEmpty());
   DCHECK(weak_reference_queue_.IsEmpty());
@@ -183,6 +201,128 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
       DisableSlowPath(self);
     }
   }
+  MutexLock mu(self, stats_lock_);
+  process_time_histogram_.AdjustAndAddValue(NanoTime() - start_time);
+  total_references_processed_ += references_processed;
+}
+
+class ReferenceProcessor::ClearWhiteReferencesTask : public Task {
+ public:
+  ClearWhiteReferencesTask(IsHeapReferenceMarkedCallback* is_marked_callback, void* arg)
+      : is_marked_callback_(is_marked_callback), arg_(arg), cleared_references_(nullptr),
+        num_references_(0) {
+  }
+
+  bool IsFull() const {
+    return num_references_ == kClearWhiteReferencesChunkSize;
+  }
+
+  void Add(mirror::Reference* ref) {
+    DCHECK(!IsFull());
+    references_[num_references_++] = ref;
+  }
+
+  ReferenceQueue* GetClearedReferences() {
+    return &cleared_references_;
+  }
+
+  // Runs on the heap thread pool workers while the GC thread holds the mutator lock.
+  virtual void Run(Thread* self ATTRIBUTE_UNUSED) NO_THREAD_SAFETY_ANALYSIS {
+    const bool active_transaction = Runtime::Current()->IsActiveTransaction();
+    for (size_t i = 0; i < num_references_; ++i) {
+      mirror::Reference* const ref = references_[i];
+      mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
+      if (referent_addr->AsMirrorPtr() != nullptr && !is_marked_callback_(referent_addr, arg_)) {
+        // Referent is white, clear it.
+        if (active_transaction) {
+          ref->ClearReferent<true>();
+        } else {
+          ref->ClearReferent<false>();
+        }
+        if (ref->IsEnqueuable()) {
+          cleared_references_.EnqueuePendingReference(ref);
+        }
+      }
+    }
+  }
+
+ private:
+  IsHeapReferenceMarkedCallback* const is_marked_callback_;
+  void* const arg_;
+  // Partial queue of this task's cleared references, merged into the processor's queue once all
+  // the tasks finished.
+  ReferenceQueue cleared_references_;
+  size_t num_references_;
+  mirror::Reference* references_[kClearWhiteReferencesChunkSize];
+
+  DISALLOW_COPY_AND_ASSIGN(ClearWhiteReferencesTask);
+};
+
+size_t ReferenceProcessor::ClearWhiteReferences(std::initializer_list<ReferenceQueue*> queues,
+                                                IsHeapReferenceMarkedCallback* is_marked_callback,
+                                                void* arg, size_t thread_count) {
+  ThreadPool* const thread_pool = Runtime::Current()->GetHeap()->GetThreadPool();
+  size_t count = 0;
+  if (thread_count <= 1 || thread_pool == nullptr) {
+    for (ReferenceQueue* queue : queues) {
+      count += queue->ClearWhiteReferences(&cleared_references_, is_marked_callback, arg);
+    }
+    return count;
+  }
+  // Unlinking is inherently serial, so this thread cuts the queues into chunks and hands full
+  // chunks to the workers while it keeps unlinking. Workers are only started once there is more
+  // than one chunk, small queues are processed without waking up the thread pool.
+  Thread* const self = Thread::Current();
+  std::vector<std::unique_ptr<ClearWhiteReferencesTask>> tasks;
+  bool workers_started = false;
+  for (ReferenceQueue* queue : queues) {
+    while (!queue->IsEmpty()) {
+      if (tasks.empty() || tasks.back()->IsFull()) {
+        if (!tasks.empty()) {
+          if (!workers_started) {
+            thread_pool->SetMaxActiveWorkers(thread_count - 1);
+            thread_pool->StartWorkers(self);
+            workers_started = true;
+          }
+          thread_pool->AddTask(self, tasks.back().get());
+        }
+        tasks.emplace_back(new ClearWhiteReferencesTask(is_marked_callback, arg));
+      }
+      tasks.back()->Add(queue->DequeuePendingReference());
+      ++count;
+    }
+  }
+  if (tasks.empty()) {
+    return 0;
+  }
+  // The last, possibly partial, chunk is processed by this thread.
+  tasks.back()->Run(self);
+  if (workers_started) {
+    thread_pool->Wait(self, true, true);
+    thread_pool->StopWorkers(self);
+  }
+  for (auto& task : tasks) {
+    cleared_references_.EnqueueQueue(task->GetClearedReferences());
+  }
+  return count;
+}
+
+void ReferenceProcessor::DumpPerformanceInfo(std::ostream& os) {
+  MutexLock mu(Thread::Current(), stats_lock_);
+  if (process_time_histogram_.SampleSize() == 0) {
+    return;
+  }
+  Histogram<uint64_t>::CumulativeData cumulative_data;
+  process_time_histogram_.CreateHistogram(&cumulative_data);
+  process_time_histogram_.PrintConfidenceIntervals(os, 0.99, cumulative_data);
+  os << "Reference processing count: " << process_time_histogram_.SampleSize()
+     << " soft, weak and phantom references processed: " << total_references_processed_ << "\n";
+}
+
+void ReferenceProcessor::ResetMeasurements() {
+  MutexLock mu(Thread::Current(), stats_lock_);
+  process_time_histogram_.Reset();
+  total_references_processed_ = 0;
 }
 
 // Process the "referent" field in a java.lang.ref.Reference.  If the referent has not yet been
@@ -17,6 +17,10 @@
 #ifndef ART_RUNTIME_GC_REFERENCE_PROCESSOR_H_
 #define ART_RUNTIME_GC_REFERENCE_PROCESSOR_H_
 
+#include <initializer_list>
+#include <ostream>
+
+#include "base/histogram.h"
 #include "base/mutex.h"
 #include "globals.h"
 #include "jni.h"
@@ -43,10 +47,13 @@ class ReferenceProcessor {
   explicit ReferenceProcessor();
   static bool PreserveSoftReferenceCallback(mirror::HeapReference<mirror::Object>* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // If thread_count is greater than one, white references are cleared in parallel on the heap
+  // thread pool. This requires is_marked_callback to be safe to call from multiple threads.
   void ProcessReferences(bool concurrent, TimingLogger* timings, bool clear_soft_references,
                          IsHeapReferenceMarkedCallback* is_marked_callback,
                          MarkObjectCallback* mark_object_callback,
-                         ProcessMarkStackCallback* process_mark_stack_callback, void* arg)
+                         ProcessMarkStackCallback* process_mark_stack_callback, void* arg,
+                         size_t thread_count)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_)
       LOCKS_EXCLUDED(Locks::reference_processor_lock_);
@@ -68,8 +75,16 @@ class ReferenceProcessor {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       LOCKS_EXCLUDED(Locks::reference_processor_lock_,
                      Locks::reference_queue_finalizer_references_lock_);
+  // Dump the cumulative reference processing statistics, used by Heap::DumpGcPerformanceInfo.
+  void DumpPerformanceInfo(std::ostream& os) LOCKS_EXCLUDED(stats_lock_);
+  void ResetMeasurements() LOCKS_EXCLUDED(stats_lock_);
 
  private:
+  class ClearWhiteReferencesTask;
+
+  static constexpr size_t kProcessTimeBucketSize = 500;
+  static constexpr size_t kProcessTimeBucketCount = 32;
+
   class ProcessReferencesArgs {
    public:
     ProcessReferencesArgs(IsHeapReferenceMarkedCallback* is_marked_callback,
@@ -86,6 +101,14 @@ class ReferenceProcessor {
     DISALLOW_IMPLICIT_CONSTRUCTORS(ProcessReferencesArgs);
   };
   bool SlowPathEnabled() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Clear the references with white referents in all of the queues and move the enqueuable ones
+  // to cleared_references_. Uses the heap thread pool if thread_count is greater than one, each
+  // task collects its cleared references into a partial queue which is merged at the end.
+  // Returns how many references were dequeued.
+  size_t ClearWhiteReferences(std::initializer_list<ReferenceQueue*> queues,
+                              IsHeapReferenceMarkedCallback* is_marked_callback, void* arg,
+                              size_t thread_count)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   // Called by ProcessReferences.
   void DisableSlowPath(Thread* self) EXCLUSIVE_LOCKS_REQUIRED(Locks::reference_processor_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -108,6 +131,10 @@ class ReferenceProcessor {
   ReferenceQueue finalizer_reference_queue_;
   ReferenceQueue phantom_reference_queue_;
   ReferenceQueue cleared_references_;
+  // Cumulative statistics, may be read by the SIGQUIT dump while the GC is processing references.
+  Mutex stats_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  Histogram<uint64_t> process_time_histogram_ GUARDED_BY(stats_lock_);
+  uint64_t total_references_processed_ GUARDED_BY(stats_lock_);
 
   DISALLOW_COPY_AND_ASSIGN(ReferenceProcessor);
 };
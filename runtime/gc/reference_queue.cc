@@ -62,6 +62,30 @@ void ReferenceQueue::EnqueuePendingReference(mirror::Reference* ref) {
   }
 }
 
+void ReferenceQueue::EnqueueQueue(ReferenceQueue* other) {
+  DCHECK(other != nullptr);
+  DCHECK_NE(other, this);
+  if (other->IsEmpty()) {
+    return;
+  }
+  if (IsEmpty()) {
+    list_ = other->list_;
+  } else {
+    // Splice the two cyclic lists: list_ -> other's head ... other->list_ -> our head.
+    mirror::Reference* head = list_->GetPendingNext();
+    mirror::Reference* other_head = other->list_->GetPendingNext();
+    if (Runtime::Current()->IsActiveTransaction()) {
+      list_->SetPendingNext<true>(other_head);
+      other->list_->SetPendingNext<true>(head);
+    } else {
+      list_->SetPendingNext<false>(other_head);
+      other->list_->SetPendingNext<false>(head);
+    }
+    list_ = other->list_;
+  }
+  other->Clear();
+}
+
 mirror::Reference* ReferenceQueue::DequeuePendingReference() {
   DCHECK(!IsEmpty());
   mirror::Reference* head = list_->GetPendingNext();
@@ -136,10 +160,12 @@ size_t ReferenceQueue::GetLength() const {
   return count;
 }
 
-void ReferenceQueue::ClearWhiteReferences(ReferenceQueue* cleared_references,
-                                          IsHeapReferenceMarkedCallback* preserve_callback,
-                                          void* arg) {
+size_t ReferenceQueue::ClearWhiteReferences(ReferenceQueue* cleared_references,
+                                            IsHeapReferenceMarkedCallback* preserve_callback,
+                                            void* arg) {
+  size_t count = 0;
   while (!IsEmpty()) {
+    ++count;
     mirror::Reference* ref = DequeuePendingReference();
     mirror::HeapReference<mirror::Object>* referent_addr = ref->GetReferentReferenceAddr();
     if (referent_addr->AsMirrorPtr() != nullptr && !preserve_callback(referent_addr, arg)) {
@@ -154,6 +180,7 @@ void ReferenceQueue::ClearWhiteReferences(ReferenceQueue* cleared_references,
       }
     }
   }
+  return count;
 }
 
 void ReferenceQueue::EnqueueFinalizerReferences(ReferenceQueue* cleared_references,
@@ -59,6 +59,10 @@ class ReferenceQueue {
   // Enqueue a reference without checking that it is enqueable.
   void EnqueuePendingReference(mirror::Reference* ref) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Move all of the references of other to this queue, other is empty afterwards. Not thread safe,
+  // used to merge the partial queues of parallel reference processing.
+  void EnqueueQueue(ReferenceQueue* other) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Dequeue the first reference (returns list_).
   mirror::Reference* DequeuePendingReference() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
@@ -76,8 +80,9 @@ class ReferenceQueue {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   // Unlink the reference list clearing references objects with white referents. Cleared references
-  // registered to a reference queue are scheduled for appending by the heap worker thread.
-  void ClearWhiteReferences(ReferenceQueue* cleared_references,
+  // registered to a reference queue are scheduled for appending by the heap worker thread. Returns
+  // the number of references unlinked.
+  size_t ClearWhiteReferences(ReferenceQueue* cleared_references,
                             IsHeapReferenceMarkedCallback* is_marked_callback, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
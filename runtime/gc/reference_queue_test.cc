@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <set>
+
 #include "common_runtime_test.h"
 #include "reference_queue.h"
 #include "handle_scope-inl.h"
@@ -56,6 +58,47 @@ TEST_F(ReferenceQueueTest, EnqueueDequeue) {
   ASSERT_TRUE(queue.IsEmpty());
 }
 
+TEST_F(ReferenceQueueTest, EnqueueQueue) {
+  Thread* self = Thread::Current();
+  StackHandleScope<20> hs(self);
+  Mutex lock("Reference queue lock");
+  ReferenceQueue queue(&lock);
+  ReferenceQueue other(&lock);
+  ScopedObjectAccess soa(self);
+  auto ref_class = hs.NewHandle(
+      Runtime::Current()->GetClassLinker()->FindClass(self, "Ljava/lang/ref/WeakReference;",
+                                                      NullHandle<mirror::ClassLoader>()));
+  ASSERT_TRUE(ref_class.Get() != nullptr);
+  auto ref1(hs.NewHandle(ref_class->AllocObject(self)->AsReference()));
+  ASSERT_TRUE(ref1.Get() != nullptr);
+  auto ref2(hs.NewHandle(ref_class->AllocObject(self)->AsReference()));
+  ASSERT_TRUE(ref2.Get() != nullptr);
+  auto ref3(hs.NewHandle(ref_class->AllocObject(self)->AsReference()));
+  ASSERT_TRUE(ref3.Get() != nullptr);
+  // Merging an empty queue is a no-op.
+  queue.EnqueueQueue(&other);
+  ASSERT_TRUE(queue.IsEmpty());
+  // Merging into an empty queue takes over the list.
+  other.EnqueuePendingReference(ref1.Get());
+  queue.EnqueueQueue(&other);
+  ASSERT_TRUE(other.IsEmpty());
+  ASSERT_EQ(queue.GetLength(), 1U);
+  // Merging two non empty queues keeps all of the references.
+  other.EnqueuePendingReference(ref2.Get());
+  other.EnqueuePendingReference(ref3.Get());
+  queue.EnqueueQueue(&other);
+  ASSERT_TRUE(other.IsEmpty());
+  ASSERT_EQ(queue.GetLength(), 3U);
+  std::set<mirror::Reference*> dequeued;
+  while (!queue.IsEmpty()) {
+    dequeued.insert(queue.DequeuePendingReference());
+  }
+  ASSERT_EQ(dequeued.size(), 3U);
+  ASSERT_EQ(dequeued.count(ref1.Get()), 1U);
+  ASSERT_EQ(dequeued.count(ref2.Get()), 1U);
+  ASSERT_EQ(dequeued.count(ref3.Get()), 1U);
+}
+
 TEST_F(ReferenceQueueTest, Dump) {
   Thread* self = Thread::Current();
   StackHandleScope<20> hs(self);
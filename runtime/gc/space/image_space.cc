@@ -17,21 +17,32 @@
 #include "image_space.h"
 
 #include <dirent.h>
+#include <pthread.h>
 #include <sys/statvfs.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #include <random>
+#include <unordered_map>
+#include <unordered_set>
 
-#include "art_method.h"
+#include "art_field-inl.h"
+#include "art_method-inl.h"
 #include "base/macros.h"
 #include "base/stl_util.h"
 #include "base/scoped_flock.h"
 #include "base/time_utils.h"
 #include "base/unix_file/fd_file.h"
+#include "class_linker.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "intern_table.h"
+#include "mirror/abstract_method.h"
 #include "mirror/class-inl.h"
+#include "mirror/dex_cache-inl.h"
+#include "mirror/iftable-inl.h"
 #include "mirror/object-inl.h"
+#include "mirror/object_array-inl.h"
+#include "mirror/reference.h"
 #include "oat_file.h"
 #include "os.h"
 #include "space-inl.h"
@@ -330,6 +341,46 @@ static bool RelocateImage(const char* image_location, const char* dest_filename,
   return Exec(argv, error_msg);
 }
 
+// Chooses the delta for images relocated in process from the boot id. All processes of a boot,
+// the zygote and its children as well as dex2oat, thus map the image at the same address, as
+// they did with the single relocated copy patchoat wrote to the dalvik-cache. Non-PIC oat files
+// record the address of the boot oat file and are only up to date while it stays the same.
+static bool ChooseBootRelocationOffsetDelta(int32_t min_delta, int32_t max_delta,
+                                            int32_t* delta) {
+  CHECK_ALIGNED(min_delta, kPageSize);
+  CHECK_ALIGNED(max_delta, kPageSize);
+  CHECK_LT(min_delta, max_delta);
+
+  std::string boot_id;
+  if (!ReadFileToString("/proc/sys/kernel/random/boot_id", &boot_id) || boot_id.empty()) {
+    return false;
+  }
+  // FNV-1a, which is stable across processes and builds.
+  uint32_t hash = 2166136261u;
+  for (char c : boot_id) {
+    hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+  }
+  uint32_t num_deltas = static_cast<uint32_t>(max_delta - min_delta) / kPageSize + 1u;
+  *delta = min_delta + static_cast<int32_t>((hash % num_deltas) * kPageSize);
+  CHECK_LE(min_delta, *delta);
+  CHECK_GE(max_delta, *delta);
+  return true;
+}
+
+// Whether the image can be relocated while it is loaded instead of by patchoat, and by which
+// delta. This needs position independent code, which does not have to be patched, the runtime's
+// pointer size and a boot id. Like patchoat, this is disabled by -Xnoimage-dex2oat.
+static bool CanRelocateInProcess(const char* image_filename, InstructionSet image_isa,
+                                 int32_t* delta) {
+  ImageHeader image_header;
+  return image_isa == kRuntimeISA &&
+      Runtime::Current()->IsImageDex2OatEnabled() &&
+      ReadSpecificImageHeader(image_filename, &image_header) &&
+      image_header.CompilePic() &&
+      ChooseBootRelocationOffsetDelta(ART_BASE_ADDRESS_MIN_DELTA, ART_BASE_ADDRESS_MAX_DELTA,
+                                      delta);
+}
+
 static ImageHeader* ReadSpecificImageHeader(const char* filename, std::string* error_msg) {
   std::unique_ptr<ImageHeader> hdr(new ImageHeader);
   if (!ReadSpecificImageHeader(filename, hdr.get())) {
@@ -375,12 +426,27 @@ ImageHeader* ImageSpace::ReadImageHeader(const char* image_location,
           return nullptr;
         }
         if (sys_hdr->GetOatChecksum() != cache_hdr->GetOatChecksum()) {
+          int32_t delta;
+          if (CanRelocateInProcess(system_filename.c_str(), image_isa, &delta)) {
+            // The system image is relocated when it is loaded, report where it ends up.
+            sys_hdr->RelocateImage(delta);
+            return sys_hdr.release();
+          }
           *error_msg = StringPrintf("Unable to find a relocated version of image file %s",
                                     image_location);
           return nullptr;
         }
         return cache_hdr.release();
       } else if (!has_cache) {
+        int32_t delta;
+        if (has_system && CanRelocateInProcess(system_filename.c_str(), image_isa, &delta)) {
+          // The system image is relocated when it is loaded, report where it ends up.
+          ImageHeader* sys_hdr = ReadSpecificImageHeader(system_filename.c_str(), error_msg);
+          if (sys_hdr != nullptr) {
+            sys_hdr->RelocateImage(delta);
+          }
+          return sys_hdr;
+        }
         *error_msg = StringPrintf("Unable to find a relocated version of image file %s",
                                   image_location);
         return nullptr;
@@ -495,7 +561,15 @@ ImageSpace* ImageSpace::Create(const char* image_location,
     const std::string* image_filename;
     bool is_system = false;
     bool relocated_version_used = false;
-    if (relocate) {
+    int32_t relocation_delta = 0;
+    if (relocate && has_system &&
+        !(has_cache && ChecksumsMatch(system_filename.c_str(), cache_filename.c_str())) &&
+        CanRelocateInProcess(system_filename.c_str(), image_isa, &relocation_delta)) {
+      // Relocate the system image while loading it rather than running patchoat. This needs
+      // neither the dalvik-cache nor the permission to write to it.
+      image_filename = &system_filename;
+      is_system = true;
+    } else if (relocate) {
       if (!dalvik_cache_exists) {
         *error_msg = StringPrintf("Requiring relocation for image '%s' at '%s' but we do not have "
                                   "any dalvik_cache to find/place it in.",
@@ -577,7 +651,8 @@ ImageSpace* ImageSpace::Create(const char* image_location,
       // matches) since this is only different by the offset. We need this to
       // make sure that host tests continue to work.
       space = ImageSpace::Init(image_filename->c_str(), image_location,
-                               !(is_system || relocated_version_used), error_msg);
+                               !(is_system || relocated_version_used), relocation_delta,
+                               error_msg);
     }
     if (space != nullptr) {
       return space;
@@ -635,7 +710,7 @@ ImageSpace* ImageSpace::Create(const char* image_location,
     // we leave Create.
     ScopedFlock image_lock;
     image_lock.Init(cache_filename.c_str(), error_msg);
-    space = ImageSpace::Init(cache_filename.c_str(), image_location, true, error_msg);
+    space = ImageSpace::Init(cache_filename.c_str(), image_location, true, 0, error_msg);
     if (space == nullptr) {
       *error_msg = StringPrintf("Failed to load generated image '%s': %s",
                                 cache_filename.c_str(), error_msg->c_str());
@@ -658,17 +733,418 @@ void ImageSpace::VerifyImageAllocations() {
   }
 }
 
-ImageSpace* ImageSpace::Init(const char* image_filename, const char* image_location,
-                             bool validate_oat_file, std::string* error_msg) {
-  CHECK(image_filename != nullptr);
-  CHECK(image_location != nullptr);
+// The number of threads patching the objects of an image relocated in process.
+static constexpr size_t kMaxRelocationThreads = 4;
+
+// Relocates a position independent boot image in place, as patchoat would, so that it can be
+// mapped at a randomized address without writing a relocated copy to the dalvik-cache. The
+// image has been mapped at its original address plus the delta but none of its pointers have
+// been updated yet, so a pointer read from the image must be forwarded before it is followed.
+// There is no Thread and no class linker at this point, so accessors that check the pointer
+// size against the class linker or read through other objects are avoided.
+class ImageRelocator {
+ public:
+  ImageRelocator(ImageHeader* image_header, accounting::ContinuousSpaceBitmap* live_bitmap,
+                 int32_t delta)
+      : image_header_(image_header),
+        image_begin_(reinterpret_cast<uint8_t*>(image_header)),
+        live_bitmap_(live_bitmap),
+        delta_(delta),
+        pointer_size_(image_header->GetPointerSize()),
+        java_lang_Class_(nullptr),
+        java_lang_reflect_Method_(nullptr),
+        java_lang_reflect_Constructor_(nullptr) {
+    CHECK_EQ(pointer_size_, sizeof(void*));
+  }
 
-  uint64_t start_time = 0;
-  if (VLOG_IS_ON(heap) || VLOG_IS_ON(startup)) {
-    start_time = NanoTime();
-    LOG(INFO) << "ImageSpace::Init entering image_filename=" << image_filename;
+  void Relocate() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    image_header_->RelocateImage(delta_);
+    FindClassLayouts();
+
+    // The objects are patched by a few threads in address stripes. Each object is only read
+    // and written by the thread patching it, while the class layouts and the set of pointer
+    // arrays found above are read-only. Pool threads cannot be attached to the runtime yet,
+    // so plain pthreads are used.
+    const auto& objects_section = image_header_->GetImageSection(ImageHeader::kSectionObjects);
+    uintptr_t objects_begin = reinterpret_cast<uintptr_t>(image_begin_) +
+        RoundUp(sizeof(ImageHeader), kObjectAlignment);
+    uintptr_t objects_end = reinterpret_cast<uintptr_t>(image_begin_) + objects_section.End();
+    size_t num_processors = static_cast<size_t>(sysconf(_SC_NPROCESSORS_CONF));
+    size_t num_stripes = std::max<size_t>(1u, std::min(num_processors, kMaxRelocationThreads));
+    size_t stripe_size = RoundUp((objects_end - objects_begin) / num_stripes, kObjectAlignment);
+    std::vector<Stripe> stripes(num_stripes);
+    for (size_t i = 0; i < num_stripes; ++i) {
+      stripes[i].relocator = this;
+      stripes[i].begin = std::min(objects_begin + i * stripe_size, objects_end);
+      stripes[i].end = (i + 1 == num_stripes)
+          ? objects_end
+          : std::min(objects_begin + (i + 1) * stripe_size, objects_end);
+    }
+    for (size_t i = 1; i < num_stripes; ++i) {
+      CHECK_PTHREAD_CALL(pthread_create, (&stripes[i].pthread, nullptr, &PatchStripeCallback,
+                                          &stripes[i]), "image relocation thread");
+    }
+    // The native sections do not overlap the objects, patch them while the threads run.
+    PatchArtFields();
+    PatchArtMethods();
+    PatchInternedStrings();
+    PatchStripeCallback(&stripes[0]);
+    for (size_t i = 1; i < num_stripes; ++i) {
+      CHECK_PTHREAD_CALL(pthread_join, (stripes[i].pthread, nullptr), "image relocation thread");
+    }
+  }
+
+  template <typename T>
+  T* Forward(T* ptr) const {
+    return ptr == nullptr
+        ? nullptr
+        : reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(ptr) + delta_);
+  }
+
+ private:
+  // What needs patching in the instances of a class, besides their class pointer.
+  struct ClassLayout {
+    enum Kind {
+      kInstance,
+      kClass,
+      kObjectArray,
+      kPrimitiveArray,
+    };
+
+    Kind kind;
+    // Whether this is java.lang.reflect.Method or java.lang.reflect.Constructor.
+    bool is_reflective_method;
+    // Offsets of the instance fields holding references.
+    std::vector<uint32_t> reference_offsets;
+  };
+
+  struct Stripe {
+    ImageRelocator* relocator;
+    uintptr_t begin;
+    uintptr_t end;
+    pthread_t pthread;
+  };
+
+  static void* PatchStripeCallback(void* arg) NO_THREAD_SAFETY_ANALYSIS {
+    Stripe* stripe = reinterpret_cast<Stripe*>(arg);
+    ImageRelocator* relocator = stripe->relocator;
+    PatchObjectVisitor visitor(stripe->relocator);
+    stripe->relocator->live_bitmap_->VisitMarkedRange(stripe->begin, stripe->end, visitor);
+    return nullptr;
+  }
+
+  class FindClassesVisitor {
+   public:
+    explicit FindClassesVisitor(ImageRelocator* relocator) : relocator_(relocator) {
+    }
+
+    void operator()(mirror::Object* obj) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+      mirror::Class* klass = obj->GetClass<kVerifyNone, kWithoutReadBarrier>();
+      if (relocator_->Forward(klass) == relocator_->java_lang_Class_) {
+        relocator_->AddClass(down_cast<mirror::Class*>(obj));
+      }
+    }
+
+   private:
+    ImageRelocator* const relocator_;
+  };
+
+  class PatchObjectVisitor {
+   public:
+    explicit PatchObjectVisitor(ImageRelocator* relocator) : relocator_(relocator) {
+    }
+
+    void operator()(mirror::Object* obj) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+      relocator_->PatchObject(obj);
+    }
+
+   private:
+    ImageRelocator* const relocator_;
+  };
+
+  // Reads a reference without following or forwarding it.
+  template <typename T>
+  static T* GetReference(mirror::Object* obj, MemberOffset offset)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    return obj->GetFieldObject<T, kVerifyNone, kWithoutReadBarrier>(offset);
+  }
+
+  void ForwardReference(mirror::Object* obj, MemberOffset offset) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    mirror::Object* ref = GetReference<mirror::Object>(obj, offset);
+    if (ref != nullptr) {
+      obj->SetFieldObjectWithoutWriteBarrier<false, false, kVerifyNone>(offset, Forward(ref));
+    }
+  }
+
+  void ForwardNativePointers(void* begin, size_t count) const {
+    uintptr_t* pointers = reinterpret_cast<uintptr_t*>(begin);
+    for (size_t i = 0; i < count; ++i) {
+      if (pointers[i] != 0u) {
+        pointers[i] += delta_;
+      }
+    }
+  }
+
+  // Nothing has been patched while the layouts are collected, so every reference read is
+  // forwarded before it is followed.
+  void FindClassLayouts() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    mirror::ObjectArray<mirror::Object>* image_roots = image_header_->GetImageRoots();
+    // The image roots are an Object[], whose class is an instance of java.lang.Class.
+    mirror::Class* object_array_class = Forward(image_roots->GetClass<kVerifyNone,
+                                                                     kWithoutReadBarrier>());
+    java_lang_Class_ = Forward(object_array_class->GetClass<kVerifyNone, kWithoutReadBarrier>());
+    auto* class_roots = Forward(GetReference<mirror::ObjectArray<mirror::Class>>(
+        image_roots, mirror::ObjectArray<mirror::Object>::OffsetOfElement(
+            ImageHeader::kClassRoots)));
+    java_lang_reflect_Method_ = Forward(GetReference<mirror::Class>(
+        class_roots, mirror::ObjectArray<mirror::Class>::OffsetOfElement(
+            ClassLinker::kJavaLangReflectMethod)));
+    java_lang_reflect_Constructor_ = Forward(GetReference<mirror::Class>(
+        class_roots, mirror::ObjectArray<mirror::Class>::OffsetOfElement(
+            ClassLinker::kJavaLangReflectConstructor)));
+
+    const auto& objects_section = image_header_->GetImageSection(ImageHeader::kSectionObjects);
+    FindClassesVisitor visitor(this);
+    live_bitmap_->VisitMarkedRange(
+        reinterpret_cast<uintptr_t>(image_begin_) + RoundUp(sizeof(ImageHeader), kObjectAlignment),
+        reinterpret_cast<uintptr_t>(image_begin_) + objects_section.End(),
+        visitor);
+
+    // The dex cache arrays of resolved fields and methods hold native pointers.
+    auto* dex_caches = Forward(GetReference<mirror::ObjectArray<mirror::DexCache>>(
+        image_roots, mirror::ObjectArray<mirror::Object>::OffsetOfElement(
+            ImageHeader::kDexCaches)));
+    for (int32_t i = 0, count = dex_caches->GetLength<kVerifyNone>(); i < count; ++i) {
+      mirror::DexCache* dex_cache = Forward(GetReference<mirror::DexCache>(
+          dex_caches, mirror::ObjectArray<mirror::DexCache>::OffsetOfElement(i)));
+      AddPointerArray(dex_cache->GetResolvedFields());
+      AddPointerArray(dex_cache->GetResolvedMethods());
+    }
+  }
+
+  void AddPointerArray(mirror::PointerArray* array) {
+    if (array != nullptr) {
+      pointer_arrays_.insert(Forward(array));
+    }
+  }
+
+  void AddClass(mirror::Class* klass) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    ClassLayout& layout = class_layouts_[klass];
+    mirror::Class* component_type = Forward(GetReference<mirror::Class>(
+        klass, mirror::Class::ComponentTypeOffset()));
+    if (klass == java_lang_Class_) {
+      layout.kind = ClassLayout::kClass;
+    } else if (component_type == nullptr) {
+      layout.kind = ClassLayout::kInstance;
+    } else if (component_type->GetPrimitiveType<kVerifyNone>() == Primitive::kPrimNot) {
+      layout.kind = ClassLayout::kObjectArray;
+    } else {
+      layout.kind = ClassLayout::kPrimitiveArray;
+    }
+    layout.is_reflective_method =
+        klass == java_lang_reflect_Method_ || klass == java_lang_reflect_Constructor_;
+    if (component_type == nullptr) {
+      AddReferenceOffsets(klass, &layout.reference_offsets);
+    }
+
+    // Vtables and interface method arrays hold native pointers. Iftables may be shared
+    // between classes, the set takes care of duplicates.
+    AddPointerArray(GetReference<mirror::PointerArray>(klass, mirror::Class::VTableOffset()));
+    mirror::IfTable* iftable = Forward(klass->GetIfTable());
+    if (iftable != nullptr) {
+      for (size_t i = 0, count = iftable->Count(); i < count; ++i) {
+        AddPointerArray(GetReference<mirror::PointerArray>(
+            iftable, mirror::IfTable::OffsetOfElement(i * mirror::IfTable::kMax +
+                                                      mirror::IfTable::kMethodArray)));
+      }
+    }
+  }
+
+  // Mirrors Object::VisitFieldsReferences() for instance fields, except for the class pointer
+  // which is always patched.
+  void AddReferenceOffsets(mirror::Class* klass, std::vector<uint32_t>* offsets)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    uint32_t ref_offsets = klass->GetReferenceInstanceOffsets<kVerifyNone>();
+    if (ref_offsets != mirror::Class::kClassWalkSuper) {
+      uint32_t field_offset = mirror::kObjectHeaderSize;
+      while (ref_offsets != 0) {
+        if ((ref_offsets & 1) != 0) {
+          offsets->push_back(field_offset);
+        }
+        ref_offsets >>= 1;
+        field_offset += sizeof(mirror::HeapReference<mirror::Object>);
+      }
+    } else {
+      for (mirror::Class* k = klass; k != nullptr;
+           k = Forward(GetReference<mirror::Class>(k, mirror::Class::SuperClassOffset()))) {
+        uint32_t num_reference_fields = k->NumReferenceInstanceFields();
+        mirror::Class* super_class =
+            Forward(GetReference<mirror::Class>(k, mirror::Class::SuperClassOffset()));
+        uint32_t field_offset = (super_class != nullptr)
+            ? RoundUp(super_class->GetField32<kVerifyNone>(mirror::Class::ObjectSizeOffset()),
+                      sizeof(mirror::HeapReference<mirror::Object>))
+            : mirror::Object::ClassOffset().Uint32Value();
+        for (size_t i = 0; i < num_reference_fields; ++i) {
+          if (field_offset != mirror::Object::ClassOffset().Uint32Value()) {
+            offsets->push_back(field_offset);
+          }
+          field_offset += sizeof(mirror::HeapReference<mirror::Object>);
+        }
+      }
+    }
+    // The referent is not counted as a reference field, see ClassLinker::LinkFields().
+    if ((klass->GetField32<kVerifyNone>(mirror::Class::AccessFlagsOffset()) &
+         kAccClassIsReference) != 0) {
+      offsets->push_back(mirror::Reference::ReferentOffset().Uint32Value());
+    }
+  }
+
+  void PatchObject(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    mirror::Class* klass = Forward(obj->GetClass<kVerifyNone, kWithoutReadBarrier>());
+    obj->SetFieldObjectWithoutWriteBarrier<false, false, kVerifyNone>(
+        mirror::Object::ClassOffset(), klass);
+    if (kUseBrooksReadBarrier) {
+      obj->SetReadBarrierPointer(obj);
+    }
+    auto it = class_layouts_.find(klass);
+    CHECK(it != class_layouts_.end()) << "Image object " << obj << " has unknown class " << klass;
+    const ClassLayout& layout = it->second;
+    for (uint32_t offset : layout.reference_offsets) {
+      ForwardReference(obj, MemberOffset(offset));
+    }
+    switch (layout.kind) {
+      case ClassLayout::kInstance:
+        if (layout.is_reflective_method) {
+          auto* method = down_cast<mirror::AbstractMethod*>(obj);
+          method->SetArtMethod(Forward(method->GetArtMethod()));
+        }
+        break;
+      case ClassLayout::kClass:
+        PatchClass(down_cast<mirror::Class*>(obj));
+        break;
+      case ClassLayout::kObjectArray: {
+        auto* array = down_cast<mirror::ObjectArray<mirror::Object>*>(obj);
+        for (int32_t i = 0, length = array->GetLength<kVerifyNone>(); i < length; ++i) {
+          ForwardReference(array, mirror::ObjectArray<mirror::Object>::OffsetOfElement(i));
+        }
+        break;
+      }
+      case ClassLayout::kPrimitiveArray:
+        if (pointer_arrays_.find(obj) != pointer_arrays_.end()) {
+          auto* array = down_cast<mirror::PointerArray*>(obj);
+          ForwardNativePointers(array->GetRawData(pointer_size_, 0),
+                                array->GetLength<kVerifyNone>());
+        }
+        break;
+    }
+  }
+
+  void PatchClass(mirror::Class* klass) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    klass->SetSFieldsUnchecked(Forward(klass->GetSFields()));
+    klass->SetIFieldsUnchecked(Forward(klass->GetIFields()));
+    klass->SetDirectMethodsPtrUnchecked(Forward(klass->GetDirectMethodsPtr()));
+    klass->SetVirtualMethodsPtr(Forward(klass->GetVirtualMethodsPtrUnchecked()));
+    uint32_t static_fields_offset = sizeof(mirror::Class);
+    if (klass->ShouldHaveEmbeddedImtAndVTable()) {
+      // The embedded IMT and vtable follow the vtable length, rounded up to the pointer size.
+      int32_t vtable_length = klass->GetEmbeddedVTableLength();
+      uint32_t tables_offset = RoundUp(
+          mirror::Class::EmbeddedVTableLengthOffset().Uint32Value() + sizeof(uint32_t),
+          pointer_size_);
+      ForwardNativePointers(reinterpret_cast<uint8_t*>(klass) + tables_offset,
+                            mirror::Class::kImtSize + vtable_length);
+      static_fields_offset = mirror::Class::ComputeClassSize(
+          true, vtable_length, 0, 0, 0, 0, 0, pointer_size_);
+    }
+    for (size_t i = 0, count = klass->NumReferenceStaticFields(); i < count; ++i) {
+      ForwardReference(klass, MemberOffset(
+          static_fields_offset + i * sizeof(mirror::HeapReference<mirror::Object>)));
+    }
+  }
+
+  void PatchArtFields() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    const auto& section = image_header_->GetImageSection(ImageHeader::kSectionArtFields);
+    for (size_t pos = 0; pos < section.Size(); pos += sizeof(ArtField)) {
+      auto* field = reinterpret_cast<ArtField*>(image_begin_ + section.Offset() + pos);
+      field->SetDeclaringClass(Forward(field->DeclaringClassRoot().Read<kWithoutReadBarrier>()));
+    }
+  }
+
+  void PatchArtMethods() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    const auto& section = image_header_->GetMethodsSection();
+    const size_t method_size = ArtMethod::ObjectSize(pointer_size_);
+    for (size_t pos = 0; pos < section.Size(); pos += method_size) {
+      auto* method = reinterpret_cast<ArtMethod*>(image_begin_ + section.Offset() + pos);
+      method->SetDeclaringClass(Forward(method->GetDeclaringClassNoBarrier()));
+      method->SetDexCacheResolvedMethods(Forward(method->GetDexCacheResolvedMethods()));
+      method->SetDexCacheResolvedTypes(Forward(method->GetDexCacheResolvedTypes()));
+      // The code is in the oat file, which moves with the image.
+      method->SetEntryPointFromQuickCompiledCodePtrSize(Forward(
+          method->GetEntryPointFromQuickCompiledCodePtrSize(pointer_size_)), pointer_size_);
+      method->SetEntryPointFromInterpreterPtrSize(Forward(
+          method->GetEntryPointFromInterpreterPtrSize(pointer_size_)), pointer_size_);
+      method->SetEntryPointFromJniPtrSize(Forward(
+          method->GetEntryPointFromJniPtrSize(pointer_size_)), pointer_size_);
+    }
+  }
+
+  class ForwardingRootVisitor : public RootVisitor {
+   public:
+    explicit ForwardingRootVisitor(const ImageRelocator* relocator) : relocator_(relocator) {
+    }
+
+    void VisitRoots(mirror::Object*** roots, size_t count, const RootInfo& info ATTRIBUTE_UNUSED)
+        OVERRIDE SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+      for (size_t i = 0; i < count; ++i) {
+        *roots[i] = relocator_->Forward(*roots[i]);
+      }
+    }
+
+    void VisitRoots(mirror::CompressedReference<mirror::Object>** roots, size_t count,
+                    const RootInfo& info ATTRIBUTE_UNUSED)
+        OVERRIDE SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+      for (size_t i = 0; i < count; ++i) {
+        roots[i]->Assign(relocator_->Forward(roots[i]->AsMirrorPtr()));
+      }
+    }
+
+   private:
+    const ImageRelocator* const relocator_;
+  };
+
+  void PatchInternedStrings() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    const auto& section = image_header_->GetImageSection(ImageHeader::kSectionInternedStrings);
+    // As in patchoat, this relies on ReadFromMemory() not copying the table so that the roots
+    // are updated in the image.
+    InternTable temp_table;
+    temp_table.ReadFromMemory(image_begin_ + section.Offset());
+    ForwardingRootVisitor visitor(this);
+    temp_table.VisitRoots(&visitor, kVisitRootFlagAllRoots);
   }
 
+  ImageHeader* const image_header_;
+  uint8_t* const image_begin_;
+  accounting::ContinuousSpaceBitmap* const live_bitmap_;
+  const int32_t delta_;
+  const size_t pointer_size_;
+
+  // Relocated addresses of the classes needing special treatment.
+  mirror::Class* java_lang_Class_;
+  mirror::Class* java_lang_reflect_Method_;
+  mirror::Class* java_lang_reflect_Constructor_;
+
+  // Keyed by the relocated address of the class.
+  std::unordered_map<mirror::Class*, ClassLayout> class_layouts_;
+  // Relocated addresses of the int[] or long[] arrays that hold native pointers.
+  std::unordered_set<mirror::Object*> pointer_arrays_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImageRelocator);
+};
+
+MemMap* ImageSpace::MapImageFile(const char* image_filename, int32_t relocation_delta,
+                                 std::unique_ptr<accounting::ContinuousSpaceBitmap>* out_bitmap,
+                                 std::string* error_msg) {
   std::unique_ptr<File> file(OS::OpenFileForReading(image_filename));
   if (file.get() == nullptr) {
     *error_msg = StringPrintf("Failed to open '%s'", image_filename);
@@ -710,13 +1186,13 @@ ImageSpace* ImageSpace::Init(const char* image_filename, const char* image_locat
 
   // Note: The image header is part of the image due to mmap page alignment required of offset.
   std::unique_ptr<MemMap> map(MemMap::MapFileAtAddress(
-      image_header.GetImageBegin(), image_header.GetImageSize(),
+      image_header.GetImageBegin() + relocation_delta, image_header.GetImageSize(),
       PROT_READ | PROT_WRITE, MAP_PRIVATE, file->Fd(), 0, false, image_filename, error_msg));
   if (map.get() == nullptr) {
     DCHECK(!error_msg->empty());
     return nullptr;
   }
-  CHECK_EQ(image_header.GetImageBegin(), map->Begin());
+  CHECK_EQ(image_header.GetImageBegin() + relocation_delta, map->Begin());
   DCHECK_EQ(0, memcmp(&image_header, map->Begin(), sizeof(ImageHeader)));
 
   std::unique_ptr<MemMap> image_map(MemMap::MapFileAtAddress(
@@ -738,6 +1214,42 @@ ImageSpace* ImageSpace::Init(const char* image_filename, const char* image_locat
     return nullptr;
   }
 
+  if (relocation_delta != 0) {
+    uint64_t relocation_start_time = NanoTime();
+    ImageRelocator relocator(reinterpret_cast<ImageHeader*>(map->Begin()), bitmap.get(),
+                             relocation_delta);
+    relocator.Relocate();
+    image_header.RelocateImage(relocation_delta);
+    DCHECK_EQ(0, memcmp(&image_header, map->Begin(), sizeof(ImageHeader)));
+    LOG(INFO) << "Relocated image " << image_filename << " by 0x" << std::hex << relocation_delta
+              << std::dec << " in " << PrettyDuration(NanoTime() - relocation_start_time);
+  }
+
+  *out_bitmap = std::move(bitmap);
+  return map.release();
+}
+
+ImageSpace* ImageSpace::Init(const char* image_filename, const char* image_location,
+                             bool validate_oat_file, int32_t relocation_delta,
+                             std::string* error_msg) {
+  CHECK(image_filename != nullptr);
+  CHECK(image_location != nullptr);
+
+  uint64_t start_time = 0;
+  if (VLOG_IS_ON(heap) || VLOG_IS_ON(startup)) {
+    start_time = NanoTime();
+    LOG(INFO) << "ImageSpace::Init entering image_filename=" << image_filename;
+  }
+
+  std::unique_ptr<accounting::ContinuousSpaceBitmap> bitmap;
+  std::unique_ptr<MemMap> map(MapImageFile(image_filename, relocation_delta, &bitmap,
+                                           error_msg));
+  if (map.get() == nullptr) {
+    DCHECK(!error_msg->empty());
+    return nullptr;
+  }
+  const ImageHeader& image_header = *reinterpret_cast<const ImageHeader*>(map->Begin());
+
   // We only want the mirror object, not the ArtFields and ArtMethods.
   uint8_t* const image_end =
       map->Begin() + image_header.GetImageSection(ImageHeader::kSectionObjects).End();
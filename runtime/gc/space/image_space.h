@@ -128,8 +128,21 @@ class ImageSpace : public MemMapSpace {
   // image's OatFile is up-to-date relative to its DexFile
   // inputs. Otherwise (for /data), validate the inputs and generate
   // the OatFile in /data/dalvik-cache if necessary.
+  //
+  // If relocation_delta is not zero, the image is mapped that many
+  // bytes from its base address and relocated in place. This is only
+  // supported for position independent images.
   static ImageSpace* Init(const char* image_filename, const char* image_location,
-                          bool validate_oat_file, std::string* error_msg)
+                          bool validate_oat_file, int32_t relocation_delta,
+                          std::string* error_msg)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Maps the image file and its live bitmap, `relocation_delta` bytes from its base address,
+  // and relocates the image in place if the delta is not zero. The image header is at the
+  // beginning of the returned map. Returns null on error.
+  static MemMap* MapImageFile(const char* image_filename, int32_t relocation_delta,
+                              std::unique_ptr<accounting::ContinuousSpaceBitmap>* out_bitmap,
+                              std::string* error_msg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   OatFile* OpenOatFile(const char* image, std::string* error_msg) const
@@ -139,6 +152,7 @@ class ImageSpace : public MemMapSpace {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   friend class Space;
+  ART_FRIEND_TEST(ImageSpaceTest, RelocationMatchesPatchoat);  // For MapImageFile.
 
   static Atomic<uint32_t> bitmap_index_;
 
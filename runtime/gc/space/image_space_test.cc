@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "image_space.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/stringprintf.h"
+#include "base/unix_file/fd_file.h"
+#include "common_runtime_test.h"
+#include "image.h"
+#include "mem_map.h"
+#include "os.h"
+#include "scoped_thread_state_change.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+namespace space {
+
+class ImageSpaceTest : public CommonRuntimeTest {
+ protected:
+  // The position independent core image, which is relocated in process.
+  static std::string GetPicImageLocation() {
+    std::string location = GetCoreArtLocation();
+    location.replace(location.rfind(".art"), strlen(".art"), "-pic.art");
+    return location;
+  }
+};
+
+// The test runtime has no boot image, so the image can be mapped at its relocated address.
+TEST_F(ImageSpaceTest, RelocationMatchesPatchoat) {
+  const std::string image_location = GetPicImageLocation();
+  const std::string image_filename = GetSystemImageFilename(image_location.c_str(), kRuntimeISA);
+  ASSERT_TRUE(OS::FileExists(image_filename.c_str()))
+      << "Expected pre-compiled PIC boot image to be at: " << image_filename;
+  const int32_t delta = 16 * kPageSize;
+
+  // Relocate the image with patchoat.
+  const std::string patched_image = dalvik_cache_ + "/patched.art";
+  const std::string patched_oat = dalvik_cache_ + "/patched.oat";
+  std::vector<std::string> argv;
+  argv.push_back(Runtime::Current()->GetPatchoatExecutable());
+  argv.push_back("--input-image-location=" + image_location);
+  argv.push_back("--output-image-file=" + patched_image);
+  argv.push_back("--input-oat-location=" +
+                 ImageHeader::GetOatLocationFromImageLocation(image_location));
+  argv.push_back("--output-oat-file=" + patched_oat);
+  argv.push_back(StringPrintf("--instruction-set=%s", GetInstructionSetString(kRuntimeISA)));
+  argv.push_back(StringPrintf("--base-offset-delta=%d", delta));
+  std::string error_msg;
+  ASSERT_TRUE(Exec(argv, &error_msg)) << error_msg;
+  std::string expected;
+  ASSERT_TRUE(ReadFileToString(patched_image, &expected));
+
+  // Relocate the image in process.
+  std::unique_ptr<accounting::ContinuousSpaceBitmap> bitmap;
+  std::unique_ptr<MemMap> map;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    map.reset(ImageSpace::MapImageFile(image_filename.c_str(), delta, &bitmap, &error_msg));
+  }
+  ASSERT_TRUE(map.get() != nullptr) << error_msg;
+  const ImageHeader& image_header = *reinterpret_cast<const ImageHeader*>(map->Begin());
+  EXPECT_EQ(delta, image_header.GetPatchDelta());
+
+  // Both must agree on every byte of the image, including the header.
+  size_t image_size = image_header.GetImageSize();
+  ASSERT_LE(image_size, expected.size());
+  size_t mismatches = 0u;
+  size_t first_mismatch = image_size;
+  for (size_t i = 0; i != image_size; ++i) {
+    if (map->Begin()[i] != static_cast<uint8_t>(expected[i])) {
+      first_mismatch = std::min(first_mismatch, i);
+      ++mismatches;
+    }
+  }
+  EXPECT_EQ(0u, mismatches) << "First mismatch at offset " << first_mismatch;
+
+  ASSERT_EQ(0, unlink(patched_image.c_str()));
+  ASSERT_EQ(0, unlink(patched_oat.c_str()));
+}
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
@@ -186,20 +186,26 @@ void LargeObjectMapSpace::SetAllLargeObjectsAsZygoteObjects(Thread* self) {
 }
 
 size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
-  MutexLock mu(self, lock_);
-  auto it = large_objects_.find(ptr);
-  if (UNLIKELY(it == large_objects_.end())) {
-    Runtime::Current()->GetHeap()->DumpSpaces(LOG(INTERNAL_FATAL));
-    LOG(FATAL) << "Attempted to free large object " << ptr << " which was not live";
-  }
-  MemMap* mem_map = it->second.mem_map;
-  const size_t map_size = mem_map->BaseSize();
-  DCHECK_GE(num_bytes_allocated_, map_size);
-  size_t allocation_size = map_size;
-  num_bytes_allocated_ -= allocation_size;
-  --num_objects_allocated_;
+  MemMap* mem_map;
+  size_t allocation_size;
+  {
+    MutexLock mu(self, lock_);
+    auto it = large_objects_.find(ptr);
+    if (UNLIKELY(it == large_objects_.end())) {
+      Runtime::Current()->GetHeap()->DumpSpaces(LOG(INTERNAL_FATAL));
+      LOG(FATAL) << "Attempted to free large object " << ptr << " which was not live";
+    }
+    mem_map = it->second.mem_map;
+    const size_t map_size = mem_map->BaseSize();
+    DCHECK_GE(num_bytes_allocated_, map_size);
+    allocation_size = map_size;
+    num_bytes_allocated_ -= allocation_size;
+    --num_objects_allocated_;
+    large_objects_.erase(it);
+  }
+  // Unmap outside of lock_ so that allocations and frees by other threads are not held up by the
+  // munmap.
   delete mem_map;
-  large_objects_.erase(it);
   return allocation_size;
 }
 
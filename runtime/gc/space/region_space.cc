@@ -164,7 +164,8 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         DCHECK((state == RegionState::kRegionStateAllocated ||
                 state == RegionState::kRegionStateLarge) &&
                type == RegionType::kRegionTypeToSpace);
-        bool should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+        // Pinned regions must stay in place even if we were asked to evacuate everything.
+        bool should_evacuate = !r->IsPinned() && (force_evacuate_all || r->ShouldBeEvacuated());
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
@@ -407,13 +408,27 @@ void RegionSpace::AssertAllThreadLocalBuffersAreRevoked() {
   }
 }
 
+void RegionSpace::PinObject(mirror::Object* obj) {
+  MutexLock mu(Thread::Current(), region_lock_);
+  Region* r = RefToRegionLocked(obj);
+  // Large objects live in their head region, the tails follow the head in SetFromSpace().
+  DCHECK(!r->IsLargeTail());
+  r->Pin();
+}
+
+void RegionSpace::UnpinObject(mirror::Object* obj) {
+  MutexLock mu(Thread::Current(), region_lock_);
+  RefToRegionLocked(obj)->Unpin();
+}
+
 void RegionSpace::Region::Dump(std::ostream& os) const {
   os << "Region[" << idx_ << "]=" << reinterpret_cast<void*>(begin_) << "-" << reinterpret_cast<void*>(top_)
      << "-" << reinterpret_cast<void*>(end_)
      << " state=" << static_cast<uint>(state_) << " type=" << static_cast<uint>(type_)
      << " objects_allocated=" << objects_allocated_
      << " alloc_time=" << alloc_time_ << " live_bytes=" << live_bytes_
-     << " is_newly_allocated=" << is_newly_allocated_ << " is_a_tlab=" << is_a_tlab_ << " thread=" << thread_ << "\n";
+     << " is_newly_allocated=" << is_newly_allocated_ << " is_a_tlab=" << is_a_tlab_ << " thread=" << thread_
+     << " pin_count=" << pin_count_ << "\n";
 }
 
 }  // namespace space
@@ -222,6 +222,11 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return time_;
   }
 
+  // Prevent obj from moving until the matching UnpinObject call by keeping the region that holds
+  // it out of the evacuated set. Cheaper than disabling moving GC for the whole heap.
+  void PinObject(mirror::Object* obj) LOCKS_EXCLUDED(region_lock_);
+  void UnpinObject(mirror::Object* obj) LOCKS_EXCLUDED(region_lock_);
+
  private:
   RegionSpace(const std::string& name, MemMap* mem_map);
 
@@ -235,13 +240,13 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
           begin_(nullptr), top_(nullptr), end_(nullptr),
           state_(RegionState::kRegionStateAllocated), type_(RegionType::kRegionTypeToSpace),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {}
+          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr), pin_count_(0) {}
 
     Region(size_t idx, uint8_t* begin, uint8_t* end)
         : idx_(idx), begin_(begin), top_(begin), end_(end),
           state_(RegionState::kRegionStateFree), type_(RegionType::kRegionTypeNone),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {
+          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr), pin_count_(0) {
       DCHECK_LT(begin, end);
       DCHECK_EQ(static_cast<size_t>(end - begin), kRegionSize);
     }
@@ -255,6 +260,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     }
 
     void Clear() {
+      DCHECK_EQ(pin_count_, 0U);
       top_ = begin_;
       state_ = RegionState::kRegionStateFree;
       type_ = RegionType::kRegionTypeNone;
@@ -372,6 +378,22 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
 
     ALWAYS_INLINE bool ShouldBeEvacuated();
 
+    // A pinned region is never evacuated so that raw pointers into it handed out to native code
+    // (e.g. by GetPrimitiveArrayCritical) stay valid across collections.
+    void Pin() {
+      DCHECK(!IsFree());
+      ++pin_count_;
+    }
+
+    void Unpin() {
+      DCHECK_GT(pin_count_, 0U);
+      --pin_count_;
+    }
+
+    bool IsPinned() const {
+      return pin_count_ != 0U;
+    }
+
     void AddLiveBytes(size_t live_bytes) {
       DCHECK(IsInUnevacFromSpace());
       DCHECK(!IsLargeTail());
@@ -472,6 +494,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     bool is_newly_allocated_;      // True if it's allocated after the last collection.
     bool is_a_tlab_;               // True if it's a tlab.
     Thread* thread_;               // The owning thread if it's a tlab.
+    size_t pin_count_;             // The number of outstanding pins on objects in the region.
 
     friend class RegionSpace;
   };
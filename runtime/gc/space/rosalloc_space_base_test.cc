@@ -16,6 +16,8 @@
 
 #include "space_test.h"
 
+#include "gc/allocator/rosalloc-inl.h"
+
 namespace art {
 namespace gc {
 namespace space {
@@ -28,6 +30,44 @@ MallocSpace* CreateRosAllocSpace(const std::string& name, size_t initial_size, s
 
 TEST_SPACE_CREATE_FN_BASE(RosAllocSpace, CreateRosAllocSpace)
 
+TEST_F(RosAllocSpaceBaseTest, CountFreeBytes) {
+  MallocSpace* space(CreateRosAllocSpace("test", 4 * MB, 16 * MB, 16 * MB, nullptr));
+  ASSERT_TRUE(space != nullptr);
+
+  // Make space findable to the heap, will also delete space when runtime is cleaned up
+  AddSpace(space);
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  allocator::RosAlloc* rosalloc = space->AsRosAllocSpace()->GetRosAlloc();
+  size_t free_slot_bytes_before, free_page_bytes_before;
+  rosalloc->CountFreeBytes(&free_slot_bytes_before, &free_page_bytes_before);
+
+  // Use a bracket that is not thread-local so that the runs end up in the non-full run sets.
+  static constexpr size_t kAllocSize = 4 * allocator::RosAlloc::kMaxThreadLocalBracketSize;
+  static constexpr size_t kNumAllocs = 1024;
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < kNumAllocs; ++i) {
+    size_t bytes_allocated, usable_size, bytes_tl_bulk_allocated;
+    void* ptr = rosalloc->Alloc(self, kAllocSize, &bytes_allocated, &usable_size,
+                                &bytes_tl_bulk_allocated);
+    ASSERT_TRUE(ptr != nullptr);
+    ptrs.push_back(ptr);
+  }
+  // Free every other slot, which leaves runs that only compaction can release.
+  for (size_t i = 0; i < kNumAllocs; i += 2) {
+    rosalloc->Free(self, ptrs[i]);
+  }
+  size_t free_slot_bytes, free_page_bytes;
+  rosalloc->CountFreeBytes(&free_slot_bytes, &free_page_bytes);
+  // The slots freed from the current run are not counted.
+  EXPECT_LT(free_slot_bytes_before + kNumAllocs / 4 * kAllocSize, free_slot_bytes);
+  EXPECT_GE(free_slot_bytes_before + kNumAllocs / 2 * kAllocSize, free_slot_bytes);
+
+  for (size_t i = 1; i < kNumAllocs; i += 2) {
+    rosalloc->Free(self, ptrs[i]);
+  }
+}
+
 
 }  // namespace space
 }  // namespace gc
@@ -439,6 +439,11 @@ class ContinuousMemMapAllocSpace : public MemMapSpace, public AllocSpace {
   }
 
   collector::ObjectBytePair Sweep(bool swap_bitmaps);
+  // Sweeps the objects in [sweep_begin, sweep_end). The range must start on a bitmap word boundary
+  // so that disjoint ranges may be swept by different threads at the same time. The caller must
+  // hold the heap bitmap lock exclusively, possibly on behalf of the calling thread.
+  collector::ObjectBytePair SweepRange(bool swap_bitmaps, uintptr_t sweep_begin,
+                                       uintptr_t sweep_end);
   virtual accounting::ContinuousSpaceBitmap::SweepCallback* GetSweepCallback() = 0;
 
  protected:
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <sys/time.h>
 #include <sys/uio.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <time.h>
 #include <unistd.h>
@@ -67,6 +68,13 @@ namespace hprof {
 
 static constexpr bool kDirectStream = true;
 
+// Whether heap dumps may be written by a forked child process.
+#if defined(__linux__)
+static constexpr bool kCanForkHeapDump = true;
+#else
+static constexpr bool kCanForkHeapDump = false;
+#endif
+
 static constexpr uint32_t kHprofTime = 0;
 static constexpr uint32_t kHprofNullStackTrace = 0;
 static constexpr uint32_t kHprofNullThread = 0;
@@ -419,7 +427,7 @@ class Hprof : public SingleRootVisitor {
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
   }
 
-  void Dump()
+  bool Dump()
       EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
       LOCKS_EXCLUDED(Locks::heap_bitmap_lock_) {
     // First pass to measure the size of the dump.
@@ -451,6 +459,7 @@ class Hprof : public SingleRootVisitor {
           << PrettySize(RoundUp(overall_size, 1024))
           << ") in " << PrettyDuration(duration);
     }
+    return okay;
   }
 
  private:
@@ -1208,12 +1217,42 @@ void Hprof::VisitRoot(mirror::Object* obj, const RootInfo& info) {
   MarkRootObject(obj, 0, xlate[info.GetType()], info.GetThreadId());
 }
 
+// Forks a child process for the heap dump. Only the calling thread exists in the child, so the
+// locks that threads outside of the mutator lock may hold, and that the dump needs, are held
+// across the fork. They are released again in both processes.
+static pid_t ForkForHeapDump(Thread* self) EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  MutexLock mu2(self, *Locks::logging_lock_);
+  return fork();
+}
+
+// Waits for the child process writing the heap dump and throws if it failed.
+static void WaitForHeapDump(Thread* self, pid_t pid, const char* filename)
+    LOCKS_EXCLUDED(Locks::mutator_lock_) {
+  int status;
+  if (TEMP_FAILURE_RETRY(waitpid(pid, &status, 0)) != pid) {
+    // The process may reap its children itself, in which case the status is lost.
+    PLOG(WARNING) << "hprof: waitpid(" << pid << ") failed, status of \"" << filename
+        << "\" unknown";
+    return;
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    ScopedObjectAccess soa(self);
+    ThrowRuntimeException("Couldn't dump heap; writing \"%s\" in process %d failed (status %d)",
+                          filename, pid, status);
+  }
+}
+
 // If "direct_to_ddms" is true, the other arguments are ignored, and data is
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
 // Otherwise, "filename" is used to create an output file.
-void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
+// If "fork_snapshot" is true and supported, threads are only suspended while
+// forking, and the heap is written by the child from its copy-on-write snapshot.
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms, bool fork_snapshot) {
   CHECK(filename != nullptr);
+  // DDMS output goes through the JDWP connection, which only the parent can use.
+  fork_snapshot = fork_snapshot && kCanForkHeapDump && !direct_to_ddms;
 
   Thread* self = Thread::Current();
   gc::Heap* heap = Runtime::Current()->GetHeap();
@@ -1222,13 +1261,29 @@ void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
     // comment in Heap::VisitObjects().
     heap->IncrementDisableMovingGC(self);
   }
-  Runtime::Current()->GetThreadList()->SuspendAll(__FUNCTION__, true /* long suspend */);
+  Runtime::Current()->GetThreadList()->SuspendAll(__FUNCTION__, !fork_snapshot /* long suspend */);
   Hprof hprof(filename, fd, direct_to_ddms);
-  hprof.Dump();
+  pid_t pid = -1;
+  if (fork_snapshot) {
+    pid = ForkForHeapDump(self);
+    if (pid == 0) {
+      // In the child. No other thread can change the heap, and the parent continues as soon
+      // as it has resumed its threads.
+      _exit(hprof.Dump() ? 0 : 1);
+    } else if (pid < 0) {
+      PLOG(WARNING) << "hprof: fork failed, dumping the heap in process";
+    }
+  }
+  if (pid < 0) {
+    hprof.Dump();
+  }
   Runtime::Current()->GetThreadList()->ResumeAll();
   if (heap->IsGcConcurrentAndMoving()) {
     heap->DecrementDisableMovingGC(self);
   }
+  if (pid > 0) {
+    WaitForHeapDump(self, pid, filename);
+  }
 }
 
 }  // namespace hprof
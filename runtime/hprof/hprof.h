@@ -21,7 +21,7 @@ namespace art {
 
 namespace hprof {
 
-void DumpHeap(const char* filename, int fd, bool direct_to_ddms);
+void DumpHeap(const char* filename, int fd, bool direct_to_ddms, bool fork_snapshot = false);
 
 }  // namespace hprof
 
@@ -32,17 +32,22 @@ namespace art {
 InternTable::InternTable()
     : image_added_to_intern_table_(false), log_new_roots_(false),
       allow_new_interns_(true),
-      new_intern_condition_("New intern condition", *Locks::intern_table_lock_) {
+      new_intern_condition_("New intern condition", *Locks::intern_table_lock_),
+      image_strong_interns_loaded_(false) {
 }
 
 size_t InternTable::Size() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size() + weak_interns_.Size();
+  return StrongSize() + WeakSize();
 }
 
 size_t InternTable::StrongSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size();
+  Thread* self = Thread::Current();
+  size_t size = image_strong_interns_loaded_.LoadAcquire() ? image_strong_interns_.Size() : 0u;
+  for (const StrongStripe& stripe : strong_stripes_) {
+    MutexLock mu(self, stripe.lock);
+    size += stripe.table.Size();
+  }
+  return size;
 }
 
 size_t InternTable::WeakSize() const {
@@ -55,9 +60,20 @@ void InternTable::DumpForSigQuit(std::ostream& os) const {
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
   if ((flags & kVisitRootFlagAllRoots) != 0) {
-    strong_interns_.VisitRoots(visitor);
+    if (image_strong_interns_loaded_.LoadRelaxed()) {
+      BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(
+          visitor, RootInfo(kRootInternedString));
+      for (auto& intern : image_strong_interns_) {
+        buffered_visitor.VisitRoot(intern.GetRoot());
+      }
+    }
+    for (StrongStripe& stripe : strong_stripes_) {
+      MutexLock mu2(self, stripe.lock);
+      stripe.table.VisitRoots(visitor);
+    }
   } else if ((flags & kVisitRootFlagNewRoots) != 0) {
     for (auto& root : new_strong_intern_roots_) {
       mirror::String* old_ref = root.Read<kWithoutReadBarrier>();
@@ -67,8 +83,10 @@ void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
         // The GC moved a root in the log. Need to search the strong interns and update the
         // corresponding object. This is slow, but luckily for us, this may only happen with a
         // concurrent moving GC.
-        strong_interns_.Remove(old_ref);
-        strong_interns_.Insert(new_ref);
+        RemoveStrong(old_ref);
+        StrongStripe& stripe = GetStrongStripe(new_ref->GetHashCode());
+        MutexLock mu2(self, stripe.lock);
+        stripe.table.Insert(new_ref);
       }
     }
   }
@@ -83,8 +101,22 @@ void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
   // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
 }
 
+template <typename Key>
+mirror::String* InternTable::FindStrong(Thread* self, const Key& key, int32_t hash) {
+  if (image_strong_interns_loaded_.LoadAcquire()) {
+    auto it = image_strong_interns_.Find(key);
+    if (it != image_strong_interns_.end()) {
+      return it->Read();
+    }
+  }
+  StrongStripe& stripe = GetStrongStripe(hash);
+  MutexLock mu(self, stripe.lock);
+  return stripe.table.Find(key);
+}
+
 mirror::String* InternTable::LookupStrong(mirror::String* s) {
-  return strong_interns_.Find(s);
+  const int32_t hash = s->GetHashCode();
+  return FindStrong(Thread::Current(), StringRoot(s, hash), hash);
 }
 
 mirror::String* InternTable::LookupWeak(mirror::String* s) {
@@ -92,9 +124,13 @@ mirror::String* InternTable::LookupWeak(mirror::String* s) {
 }
 
 void InternTable::SwapPostZygoteWithPreZygote() {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
   weak_interns_.SwapPostZygoteWithPreZygote();
-  strong_interns_.SwapPostZygoteWithPreZygote();
+  for (StrongStripe& stripe : strong_stripes_) {
+    MutexLock mu2(self, stripe.lock);
+    stripe.table.SwapPostZygoteWithPreZygote();
+  }
 }
 
 mirror::String* InternTable::InsertStrong(mirror::String* s) {
@@ -105,7 +141,9 @@ mirror::String* InternTable::InsertStrong(mirror::String* s) {
   if (log_new_roots_) {
     new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
   }
-  strong_interns_.Insert(s);
+  StrongStripe& stripe = GetStrongStripe(s->GetHashCode());
+  MutexLock mu(Thread::Current(), stripe.lock);
+  stripe.table.Insert(s);
   return s;
 }
 
@@ -119,7 +157,10 @@ mirror::String* InternTable::InsertWeak(mirror::String* s) {
 }
 
 void InternTable::RemoveStrong(mirror::String* s) {
-  strong_interns_.Remove(s);
+  // The image table is never changed, only strings interned at runtime are removed.
+  StrongStripe& stripe = GetStrongStripe(s->GetHashCode());
+  MutexLock mu(Thread::Current(), stripe.lock);
+  stripe.table.Remove(s);
 }
 
 void InternTable::RemoveWeak(mirror::String* s) {
@@ -235,13 +276,22 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong) {
   if (s == nullptr) {
     return nullptr;
   }
+  // Compute and cache the hash code before taking any lock, lookups under the locks then only
+  // compare cached hashes until a candidate is found.
+  const int32_t hash = s->GetHashCode();
   Thread* self = Thread::Current();
+  // Check the strong table for a match. Strong interns are never swept, so they can be
+  // returned without intern_table_lock_, even while new interns are disallowed.
+  mirror::String* strong = FindStrong(self, StringRoot(s, hash), hash);
+  if (strong != nullptr) {
+    return strong;
+  }
   MutexLock mu(self, *Locks::intern_table_lock_);
   while (UNLIKELY(!allow_new_interns_)) {
     new_intern_condition_.WaitHoldingLocks(self);
   }
-  // Check the strong table for a match.
-  mirror::String* strong = LookupStrong(s);
+  // Check the strong table again, another thread may have inserted the string meanwhile.
+  strong = LookupStrong(s);
   if (strong != nullptr) {
     return strong;
   }
@@ -264,10 +314,24 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong) {
   return is_strong ? InsertStrong(s) : InsertWeak(s);
 }
 
+mirror::String* InternTable::LookupStrong(Thread* self, uint32_t utf16_length,
+                                          const char* utf8_data) {
+  DCHECK_EQ(utf16_length, CountModifiedUtf8Chars(utf8_data));
+  // Hash outside of the lock to keep the critical section short.
+  const int32_t hash = ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length);
+  return FindStrong(self, Utf8String(utf16_length, utf8_data, hash), hash);
+}
+
 mirror::String* InternTable::InternStrong(int32_t utf16_length, const char* utf8_data) {
   DCHECK(utf8_data != nullptr);
-  return InternStrong(mirror::String::AllocFromModifiedUtf8(
-      Thread::Current(), utf16_length, utf8_data));
+  Thread* self = Thread::Current();
+  // Most strings interned this way are already in the strong table (e.g. const-string of a
+  // literal resolved by another dex cache), so avoid allocating a string just to look it up.
+  mirror::String* strong = LookupStrong(self, utf16_length, utf8_data);
+  if (strong != nullptr) {
+    return strong;
+  }
+  return InternStrong(mirror::String::AllocFromModifiedUtf8(self, utf16_length, utf8_data));
 }
 
 mirror::String* InternTable::InternStrong(const char* utf8_data) {
@@ -308,58 +372,90 @@ size_t InternTable::ReadFromMemory(const uint8_t* ptr) {
 }
 
 size_t InternTable::ReadFromMemoryLocked(const uint8_t* ptr) {
-  return strong_interns_.ReadIntoPreZygoteTable(ptr);
+  CHECK(!image_strong_interns_loaded_.LoadRelaxed());
+  size_t read_count = 0;
+  image_strong_interns_ = UnorderedSet(ptr, false /* make copy */, &read_count);
+  // Publish the table to the lookups that do not take intern_table_lock_.
+  image_strong_interns_loaded_.StoreRelease(true);
+  return read_count;
 }
 
 size_t InternTable::WriteToMemory(uint8_t* ptr) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.WriteFromPostZygoteTable(ptr);
+  Thread* self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  // Serialize the strong interns of all the stripes as a single table, as ReadFromMemory
+  // expects. The stripes are visited in order so that sizing and writing give the same table.
+  UnorderedSet set;
+  for (StrongStripe& stripe : strong_stripes_) {
+    MutexLock mu2(self, stripe.lock);
+    stripe.table.CopyPostZygoteTableTo(&set);
+  }
+  return set.WriteToMemory(ptr);
 }
 
-std::size_t InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& root) const {
+bool InternTable::StringHashEquals::operator()(const StringRoot& a, const StringRoot& b) const {
   if (kIsDebugBuild) {
     Locks::mutator_lock_->AssertSharedHeld(Thread::Current());
   }
-  return static_cast<size_t>(root.Read()->GetHashCode());
+  // Only dereference the strings if the cached hashes match.
+  return a.GetHash() == b.GetHash() && a.Read()->Equals(b.Read());
 }
 
-bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
-                                               const GcRoot<mirror::String>& b) const {
+bool InternTable::StringHashEquals::operator()(const StringRoot& a, const Utf8String& b) const {
   if (kIsDebugBuild) {
     Locks::mutator_lock_->AssertSharedHeld(Thread::Current());
   }
-  return a.Read()->Equals(b.Read());
-}
-
-size_t InternTable::Table::ReadIntoPreZygoteTable(const uint8_t* ptr) {
-  CHECK_EQ(pre_zygote_table_.Size(), 0u);
-  size_t read_count = 0;
-  pre_zygote_table_ = UnorderedSet(ptr, false /* make copy */, &read_count);
-  return read_count;
+  if (a.GetHash() != b.GetHash()) {
+    return false;
+  }
+  mirror::String* a_string = a.Read();
+  if (static_cast<uint32_t>(a_string->GetLength()) != b.GetUtf16Length()) {
+    return false;
+  }
+  return CompareModifiedUtf8ToUtf16AsCodePointValues(
+      b.GetUtf8Data(), a_string->GetValue(), a_string->GetLength()) == 0;
 }
 
-size_t InternTable::Table::WriteFromPostZygoteTable(uint8_t* ptr) {
-  return post_zygote_table_.WriteToMemory(ptr);
+void InternTable::Table::CopyPostZygoteTableTo(UnorderedSet* set) {
+  for (const StringRoot& intern : post_zygote_table_) {
+    set->Insert(intern);
+  }
 }
 
 void InternTable::Table::Remove(mirror::String* s) {
-  auto it = post_zygote_table_.Find(GcRoot<mirror::String>(s));
+  const StringRoot root(s, s->GetHashCode());
+  auto it = post_zygote_table_.Find(root);
   if (it != post_zygote_table_.end()) {
     post_zygote_table_.Erase(it);
   } else {
-    it = pre_zygote_table_.Find(GcRoot<mirror::String>(s));
+    it = pre_zygote_table_.Find(root);
     DCHECK(it != pre_zygote_table_.end());
     pre_zygote_table_.Erase(it);
   }
 }
 
 mirror::String* InternTable::Table::Find(mirror::String* s) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
-  auto it = pre_zygote_table_.Find(GcRoot<mirror::String>(s));
+  return Find(StringRoot(s, s->GetHashCode()));
+}
+
+mirror::String* InternTable::Table::Find(const StringRoot& root) {
+  auto it = pre_zygote_table_.Find(root);
+  if (it != pre_zygote_table_.end()) {
+    return it->Read();
+  }
+  it = post_zygote_table_.Find(root);
+  if (it != post_zygote_table_.end()) {
+    return it->Read();
+  }
+  return nullptr;
+}
+
+mirror::String* InternTable::Table::Find(const Utf8String& string) {
+  auto it = pre_zygote_table_.Find(string);
   if (it != pre_zygote_table_.end()) {
     return it->Read();
   }
-  it = post_zygote_table_.Find(GcRoot<mirror::String>(s));
+  it = post_zygote_table_.Find(string);
   if (it != post_zygote_table_.end()) {
     return it->Read();
   }
@@ -379,17 +475,17 @@ void InternTable::Table::SwapPostZygoteWithPreZygote() {
 void InternTable::Table::Insert(mirror::String* s) {
   // Always insert the post zygote table, this gets swapped when we create the zygote to be the
   // pre zygote table.
-  post_zygote_table_.Insert(GcRoot<mirror::String>(s));
+  post_zygote_table_.Insert(StringRoot(s, s->GetHashCode()));
 }
 
 void InternTable::Table::VisitRoots(RootVisitor* visitor) {
   BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(
       visitor, RootInfo(kRootInternedString));
   for (auto& intern : pre_zygote_table_) {
-    buffered_visitor.VisitRoot(intern);
+    buffered_visitor.VisitRoot(intern.GetRoot());
   }
   for (auto& intern : post_zygote_table_) {
-    buffered_visitor.VisitRoot(intern);
+    buffered_visitor.VisitRoot(intern.GetRoot());
   }
 }
 
@@ -406,7 +502,8 @@ void InternTable::Table::SweepWeaks(UnorderedSet* set, IsMarkedCallback* callbac
     if (new_object == nullptr) {
       it = set->Erase(it);
     } else {
-      *it = GcRoot<mirror::String>(new_object->AsString());
+      // The string contents are unchanged if it moved, so the cached hash is still valid.
+      *it = StringRoot(new_object->AsString(), it->GetHash());
       ++it;
     }
   }
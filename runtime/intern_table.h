@@ -19,6 +19,7 @@
 
 #include <unordered_set>
 
+#include "atomic.h"
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/mutex.h"
@@ -38,6 +39,7 @@ enum VisitRootFlags : uint8_t;
 namespace mirror {
 class String;
 }  // namespace mirror
+class Thread;
 class Transaction;
 
 /**
@@ -58,6 +60,11 @@ class InternTable {
   mirror::String* InternStrong(int32_t utf16_length, const char* utf8_data)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Look up a strong intern by its modified UTF-8 data without allocating a java.lang.String.
+  // Returns null if there is no such strong intern. Does not take intern_table_lock_.
+  mirror::String* LookupStrong(Thread* self, uint32_t utf16_length, const char* utf8_data)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Interns a potentially new string in the 'strong' table. (See above.)
   mirror::String* InternStrong(const char* utf8_data)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -112,59 +119,98 @@ class InternTable {
       LOCKS_EXCLUDED(Locks::intern_table_lock_);
 
  private:
+  // An interned string root together with its java.lang.String hash code. Caching the hash inline
+  // lets probing, rehashing and erasing compare hashes without dereferencing every string.
+  class StringRoot {
+   public:
+    StringRoot() : hash_(0) {}
+    StringRoot(mirror::String* s, int32_t hash) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+        : root_(s), hash_(hash) {}
+
+    template<ReadBarrierOption kReadBarrierOption = kWithReadBarrier>
+    mirror::String* Read() const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+      return root_.Read<kReadBarrierOption>();
+    }
+    GcRoot<mirror::String>& GetRoot() {
+      return root_;
+    }
+    int32_t GetHash() const {
+      return hash_;
+    }
+    bool IsNull() const {
+      return root_.IsNull();
+    }
+
+   private:
+    GcRoot<mirror::String> root_;
+    int32_t hash_;
+  };
+
+  // Lookup key for a modified UTF-8 string, used to find interned strings without allocating a
+  // java.lang.String first.
+  class Utf8String {
+   public:
+    Utf8String(uint32_t utf16_length, const char* utf8_data, int32_t hash)
+        : hash_(hash), utf16_length_(utf16_length), utf8_data_(utf8_data) {}
+
+    int32_t GetHash() const { return hash_; }
+    uint32_t GetUtf16Length() const { return utf16_length_; }
+    const char* GetUtf8Data() const { return utf8_data_; }
+
+   private:
+    int32_t hash_;
+    uint32_t utf16_length_;
+    const char* utf8_data_;
+  };
+
   class StringHashEquals {
    public:
-    std::size_t operator()(const GcRoot<mirror::String>& root) const NO_THREAD_SAFETY_ANALYSIS;
-    bool operator()(const GcRoot<mirror::String>& a, const GcRoot<mirror::String>& b) const
+    std::size_t operator()(const StringRoot& root) const {
+      return static_cast<size_t>(root.GetHash());
+    }
+    std::size_t operator()(const Utf8String& key) const {
+      return static_cast<size_t>(key.GetHash());
+    }
+    bool operator()(const StringRoot& a, const StringRoot& b) const
+        NO_THREAD_SAFETY_ANALYSIS;
+    bool operator()(const StringRoot& a, const Utf8String& b) const
         NO_THREAD_SAFETY_ANALYSIS;
   };
-  class GcRootEmptyFn {
+  class StringRootEmptyFn {
    public:
-    void MakeEmpty(GcRoot<mirror::String>& item) const {
-      item = GcRoot<mirror::String>();
+    void MakeEmpty(StringRoot& item) const {
+      item = StringRoot();
     }
-    bool IsEmpty(const GcRoot<mirror::String>& item) const {
+    bool IsEmpty(const StringRoot& item) const {
       return item.IsNull();
     }
   };
 
+  typedef HashSet<StringRoot, StringRootEmptyFn, StringHashEquals, StringHashEquals,
+      TrackingAllocator<StringRoot, kAllocatorTagInternTable>> UnorderedSet;
+
   // Table which holds pre zygote and post zygote interned strings. There is one instance for
-  // weak interns and strong interns.
+  // weak interns and one per stripe of strong interns. The caller holds the lock guarding the
+  // table.
   class Table {
    public:
-    mirror::String* Find(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
-        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
-    void Insert(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
-        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
-    void Remove(mirror::String* s)
-        SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
-        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
-    void VisitRoots(RootVisitor* visitor)
-        SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
-        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
+    mirror::String* Find(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+    mirror::String* Find(const StringRoot& root) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+    mirror::String* Find(const Utf8String& string) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+    void Insert(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+    void Remove(mirror::String* s) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+    void VisitRoots(RootVisitor* visitor) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
     void SweepWeaks(IsMarkedCallback* callback, void* arg)
-        SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
-        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
-    void SwapPostZygoteWithPreZygote() EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
-    size_t Size() const EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
-    // Read pre zygote table is called from ReadFromMemory which happens during runtime creation
-    // when we load the image intern table. Returns how many bytes were read.
-    size_t ReadIntoPreZygoteTable(const uint8_t* ptr)
-        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_)
-        SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-    // The image writer calls WritePostZygoteTable through WriteToMemory, it writes the interns in
-    // the post zygote table. Returns how many bytes were written.
-    size_t WriteFromPostZygoteTable(uint8_t* ptr)
-        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_)
         SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+    void SwapPostZygoteWithPreZygote();
+    size_t Size() const;
+    // Adds the post zygote interns to `set`. The image writer serializes them through
+    // WriteToMemory.
+    void CopyPostZygoteTableTo(UnorderedSet* set);
 
    private:
-    typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
-        TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
-
     void SweepWeaks(UnorderedSet* set, IsMarkedCallback* callback, void* arg)
-        SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
-        EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
+        SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
     // We call SwapPostZygoteWithPreZygote when we create the zygote to reduce private dirty pages
     // caused by modifying the zygote intern table hash table. The pre zygote table are the
@@ -174,14 +220,34 @@ class InternTable {
     UnorderedSet post_zygote_table_;
   };
 
+  // A part of the strong interns, selected by hash, with its own lock.
+  struct StrongStripe {
+    StrongStripe() : lock("InternTable strong stripe lock", kInternTableStripeLock) {}
+
+    mutable Mutex lock;
+    Table table GUARDED_BY(lock);
+  };
+
+  static constexpr size_t kStrongStripes = 16;
+
+  StrongStripe& GetStrongStripe(int32_t hash) {
+    uint32_t bits = static_cast<uint32_t>(hash);
+    return strong_stripes_[(bits ^ (bits >> 16)) % kStrongStripes];
+  }
+
+  // Looks up a strong intern in the image table and in the stripe selected by `hash`. Only
+  // takes the lock of that stripe.
+  template <typename Key>
+  mirror::String* FindStrong(Thread* self, const Key& key, int32_t hash)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Insert if non null, otherwise return null.
   mirror::String* Insert(mirror::String* s, bool is_strong)
       LOCKS_EXCLUDED(Locks::intern_table_lock_)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   mirror::String* LookupStrong(mirror::String* s)
-      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
-      EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   mirror::String* LookupWeak(mirror::String* s)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       EXCLUSIVE_LOCKS_REQUIRED(Locks::intern_table_lock_);
@@ -228,7 +294,16 @@ class InternTable {
   // enable concurrent intern table (strong) root scan. Do not
   // directly access the strings in it. Use functions that contain
   // read barriers.
-  Table strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
+  // The strong interns are split into stripes so that lookups, by far the most common use of
+  // the table (e.g. resolving a const-string), only take the lock of one stripe and do not
+  // contend with each other nor with the insertions of other stripes. Insertions and removals
+  // also hold intern_table_lock_, which orders them with the weak table, the root log and
+  // transactions.
+  StrongStripe strong_stripes_[kStrongStripes];
+  // The strong interns serialized in the boot image. Set once by ReadFromMemory and never
+  // changed afterwards, so lookups read it without a lock once it is published.
+  UnorderedSet image_strong_interns_;
+  Atomic<bool> image_strong_interns_loaded_;
   std::vector<GcRoot<mirror::String>> new_strong_intern_roots_
       GUARDED_BY(Locks::intern_table_lock_);
   // Since this contains (weak) roots, they need a read barrier. Do
@@ -16,11 +16,14 @@
 
 #include "intern_table.h"
 
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
 #include "common_runtime_test.h"
 #include "mirror/object.h"
 #include "handle_scope-inl.h"
 #include "mirror/string.h"
 #include "scoped_thread_state_change.h"
+#include "thread_pool.h"
 
 namespace art {
 
@@ -182,4 +185,94 @@ TEST_F(InternTableTest, ContainsWeak) {
   }
 }
 
+TEST_F(InternTableTest, LookupStrong) {
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable intern_table;
+  StackHandleScope<3> hs(soa.Self());
+  Handle<mirror::String> foo(hs.NewHandle(intern_table.InternStrong(3, "foo")));
+  Handle<mirror::String> bar(hs.NewHandle(intern_table.InternStrong(3, "bar")));
+  Handle<mirror::String> foobar(hs.NewHandle(intern_table.InternStrong(6, "foobar")));
+  ASSERT_TRUE(foo.Get() != nullptr);
+  ASSERT_TRUE(bar.Get() != nullptr);
+  ASSERT_TRUE(foobar.Get() != nullptr);
+  ASSERT_TRUE(foo->Equals("foo"));
+  ASSERT_TRUE(bar->Equals("bar"));
+  ASSERT_TRUE(foobar->Equals("foobar"));
+  ASSERT_FALSE(foo->Equals("foobar"));
+  ASSERT_FALSE(bar->Equals("foobar"));
+  // Lookups by modified UTF-8 data must not allocate and must find the existing strong interns.
+  EXPECT_EQ(foo.Get(), intern_table.LookupStrong(soa.Self(), 3, "foo"));
+  EXPECT_EQ(bar.Get(), intern_table.LookupStrong(soa.Self(), 3, "bar"));
+  EXPECT_EQ(foobar.Get(), intern_table.LookupStrong(soa.Self(), 6, "foobar"));
+  EXPECT_TRUE(intern_table.LookupStrong(soa.Self(), 6, "foobaz") == nullptr);
+  EXPECT_EQ(3U, intern_table.Size());
+  // Interning by UTF-8 data again returns the existing string.
+  EXPECT_EQ(foobar.Get(), intern_table.InternStrong(6, "foobar"));
+  EXPECT_EQ(3U, intern_table.Size());
+}
+
+class LookupStrongTask : public Task {
+ public:
+  LookupStrongTask(InternTable* intern_table, const std::vector<std::string>* strings,
+                   size_t iterations, Atomic<size_t>* misses)
+      : intern_table_(intern_table), strings_(strings), iterations_(iterations),
+        misses_(misses) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    size_t misses = 0;
+    for (size_t i = 0; i != iterations_; ++i) {
+      for (const std::string& string : *strings_) {
+        if (intern_table_->LookupStrong(self, string.length(), string.c_str()) == nullptr) {
+          ++misses;
+        }
+      }
+    }
+    misses_->FetchAndAddSequentiallyConsistent(misses);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  InternTable* const intern_table_;
+  const std::vector<std::string>* const strings_;
+  const size_t iterations_;
+  Atomic<size_t>* const misses_;
+};
+
+// Looks up strong interns from several threads at once, and logs the time taken. The lookups
+// only lock a stripe of the table, so they should scale with the number of threads.
+TEST_F(InternTableTest, ConcurrentLookupStrong) {
+  static constexpr size_t kNumStrings = 1000;
+  static constexpr size_t kIterations = 200;
+  Thread* self = Thread::Current();
+  // Use the runtime's table, whose strong interns are roots.
+  InternTable* intern_table = Runtime::Current()->GetInternTable();
+  std::vector<std::string> strings;
+  {
+    ScopedObjectAccess soa(self);
+    for (size_t i = 0; i != kNumStrings; ++i) {
+      strings.push_back(StringPrintf("ConcurrentLookupStrong%zu", i));
+      ASSERT_TRUE(intern_table->InternStrong(strings.back().c_str()) != nullptr);
+    }
+  }
+
+  for (size_t num_threads : { 1u, 2u, 4u, 8u }) {
+    ThreadPool thread_pool("Intern table lookup thread pool", num_threads);
+    Atomic<size_t> misses(0);
+    for (size_t i = 0; i != num_threads; ++i) {
+      thread_pool.AddTask(self, new LookupStrongTask(intern_table, &strings, kIterations,
+                                                     &misses));
+    }
+    uint64_t start_ns = NanoTime();
+    thread_pool.StartWorkers(self);
+    thread_pool.Wait(self, false, false);
+    LOG(INFO) << num_threads << " thread(s) looked up " << kNumStrings * kIterations
+              << " strong interns each in " << PrettyDuration(NanoTime() - start_ns);
+    EXPECT_EQ(0u, misses.LoadSequentiallyConsistent());
+  }
+}
+
 }  // namespace art
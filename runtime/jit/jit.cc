@@ -23,6 +23,7 @@
 #include "interpreter/interpreter.h"
 #include "jit_code_cache.h"
 #include "jit_instrumentation.h"
+#include "metrics.h"
 #include "runtime.h"
 #include "runtime_options.h"
 #include "thread_list.h"
@@ -38,6 +39,8 @@ JitOptions* JitOptions::CreateFromRuntimeArguments(const RuntimeArgumentMap& opt
       options.GetOrDefault(RuntimeArgumentMap::JITCodeCacheCapacity);
   jit_options->compile_threshold_ =
       options.GetOrDefault(RuntimeArgumentMap::JITCompileThreshold);
+  jit_options->optimize_threshold_ = std::min<size_t>(
+      options.GetOrDefault(RuntimeArgumentMap::JITOptimizeThreshold), Jit::kMaxOptimizeThreshold);
   jit_options->dump_info_on_shutdown_ =
       options.Exists(RuntimeArgumentMap::DumpJITInfoOnShutdown);
   return jit_options;
@@ -51,19 +54,27 @@ void Jit::DumpInfo(std::ostream& os) {
   cumulative_timings_.Dump(os);
 }
 
+void Jit::DumpMetrics(std::ostream& os) {
+  os << "jit.code_cache.code_bytes " << code_cache_->CodeCacheSize() << "\n"
+     << "jit.code_cache.data_bytes " << code_cache_->DataCacheSize() << "\n"
+     << "jit.code_cache.methods " << code_cache_->NumMethods() << "\n"
+     << "jit.code_cache.tier_up_reserve_bytes " << code_cache_->TierUpReserve() << "\n";
+}
+
 void Jit::AddTimingLogger(const TimingLogger& logger) {
   cumulative_timings_.AddLogger(logger);
 }
 
 Jit::Jit()
     : jit_library_handle_(nullptr), jit_compiler_handle_(nullptr), jit_load_(nullptr),
-      jit_compile_method_(nullptr), dump_info_on_shutdown_(false),
+      jit_compile_method_(nullptr), optimize_threshold_(0), dump_info_on_shutdown_(false),
       cumulative_timings_("JIT timings") {
 }
 
 Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   std::unique_ptr<Jit> jit(new Jit);
   jit->dump_info_on_shutdown_ = options->DumpJitInfoOnShutdown();
+  jit->optimize_threshold_ = options->GetOptimizeThreshold();
   if (!jit->LoadCompiler(error_msg)) {
     return nullptr;
   }
@@ -73,7 +84,8 @@ Jit* Jit::Create(JitOptions* options, std::string* error_msg) {
   }
   LOG(INFO) << "JIT created with code_cache_capacity="
       << PrettySize(options->GetCodeCacheCapacity())
-      << " compile_threshold=" << options->GetCompileThreshold();
+      << " compile_threshold=" << options->GetCompileThreshold()
+      << " optimize_threshold=" << options->GetOptimizeThreshold();
   return jit.release();
 }
 
@@ -100,7 +112,7 @@ bool Jit::LoadCompiler(std::string* error_msg) {
     *error_msg = "JIT couldn't find jit_unload entry point";
     return false;
   }
-  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*)>(
+  jit_compile_method_ = reinterpret_cast<bool (*)(void*, ArtMethod*, Thread*, bool)>(
       dlsym(jit_library_handle_, "jit_compile_method"));
   if (jit_compile_method_ == nullptr) {
     dlclose(jit_library_handle_);
@@ -132,9 +144,37 @@ bool Jit::CompileMethod(ArtMethod* method, Thread* self) {
     VLOG(jit) << "JIT not compiling " << PrettyMethod(method) << " due to breakpoint";
     return false;
   }
-  const bool result = jit_compile_method_(jit_compiler_handle_, method, self);
+  bool baseline = optimize_threshold_ != 0 && !code_cache_->ContainsMethod(method);
+  if (baseline) {
+    // The baseline code counts the hotness down to zero, see JitInstrumentationCache.
+    method->SetHotnessCount(optimize_threshold_);
+  }
+  bool result;
+  {
+    ScopedMetricsTimer timer(MetricsHistogram::kJitCompileTime);
+    result = jit_compile_method_(jit_compiler_handle_, method, self, baseline);
+    if (!result && baseline) {
+      // The baseline tier fails for the methods the optimizing compiler cannot compile, which
+      // the optimized tier compiles with Quick, and when the code cache has no room left for
+      // both the baseline code and its tier-up.
+      baseline = false;
+      result = jit_compile_method_(jit_compiler_handle_, method, self, baseline);
+    }
+  }
   if (result) {
     method->SetEntryPointFromInterpreter(artInterpreterToCompiledCodeBridge);
+    self->AddMetric(MetricsCounter::kJitMethodsCompiled, 1u);
+    if (!baseline) {
+      self->AddMetric(MetricsCounter::kJitOptimizedMethodsCompiled, 1u);
+    } else if (code_cache_->ContainsMethod(method)) {
+      // Methods with AOT code keep it and are not counted as baseline.
+      self->AddMetric(MetricsCounter::kJitBaselineMethodsCompiled, 1u);
+      if (instrumentation_cache_.get() != nullptr) {
+        instrumentation_cache_->AddBaselineMethod(self, method);
+      }
+    }
+  } else {
+    self->AddMetric(MetricsCounter::kJitCompilationFailures, 1u);
   }
   return result;
 }
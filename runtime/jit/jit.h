@@ -44,9 +44,16 @@ class Jit {
  public:
   static constexpr bool kStressMode = kIsDebugBuild;
   static constexpr size_t kDefaultCompileThreshold = kStressMode ? 1 : 1000;
+  // The hotness of baseline code, counted like the samples of the interpreter, at which the
+  // method is compiled again fully optimized. At most the range of ArtMethod::hotness_count_.
+  // Tiering is off by default: every tier-up leaves the baseline code behind in the code cache.
+  static constexpr size_t kDefaultOptimizeThreshold = 0;
+  static constexpr size_t kMaxOptimizeThreshold = 0xFFFF;
 
   virtual ~Jit();
   static Jit* Create(JitOptions* options, std::string* error_msg);
+  // Compiles the method with the baseline tier, or fully optimized if it is already in the
+  // code cache or tiering is disabled.
   bool CompileMethod(ArtMethod* method, Thread* self)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void CreateInstrumentationCache(size_t compile_threshold);
@@ -64,6 +71,8 @@ class Jit {
   // Dump interesting info: #methods compiled, code vs data size, compile / verify cumulative
   // loggers.
   void DumpInfo(std::ostream& os);
+  // Writes the code cache statistics in the format of MetricsRegistry::Dump.
+  void DumpMetrics(std::ostream& os);
   // Add a timing logger to cumulative_timings_.
   void AddTimingLogger(const TimingLogger& logger);
 
@@ -76,7 +85,10 @@ class Jit {
   void* jit_compiler_handle_;
   void* (*jit_load_)(CompilerCallbacks**);
   void (*jit_unload_)(void*);
-  bool (*jit_compile_method_)(void*, ArtMethod*, Thread*);
+  bool (*jit_compile_method_)(void*, ArtMethod*, Thread*, bool);
+
+  // Hotness of the baseline code at which it is optimized, 0 if there is no baseline tier.
+  size_t optimize_threshold_;
 
   // Performance monitoring.
   bool dump_info_on_shutdown_;
@@ -95,6 +107,9 @@ class JitOptions {
   size_t GetCompileThreshold() const {
     return compile_threshold_;
   }
+  size_t GetOptimizeThreshold() const {
+    return optimize_threshold_;
+  }
   size_t GetCodeCacheCapacity() const {
     return code_cache_capacity_;
   }
@@ -112,10 +127,11 @@ class JitOptions {
   bool use_jit_;
   size_t code_cache_capacity_;
   size_t compile_threshold_;
+  size_t optimize_threshold_;
   bool dump_info_on_shutdown_;
 
   JitOptions() : use_jit_(false), code_cache_capacity_(0), compile_threshold_(0),
-      dump_info_on_shutdown_(false) { }
+      optimize_threshold_(0), dump_info_on_shutdown_(false) { }
 
   DISALLOW_COPY_AND_ASSIGN(JitOptions);
 };
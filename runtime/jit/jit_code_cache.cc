@@ -42,7 +42,7 @@ JitCodeCache* JitCodeCache::Create(size_t capacity, std::string* error_msg) {
 }
 
 JitCodeCache::JitCodeCache(MemMap* mem_map)
-    : lock_("Jit code cache", kJitCodeCacheLock), num_methods_(0) {
+    : lock_("Jit code cache", kJitCodeCacheLock), num_methods_(0), tier_up_reserve_(0) {
   VLOG(jit) << "Created jit code cache size=" << PrettySize(mem_map->Size());
   mem_map_.reset(mem_map);
   uint8_t* divider = mem_map->Begin() + RoundUp(mem_map->Size() / 4, kPageSize);
@@ -72,16 +72,49 @@ void JitCodeCache::FlushInstructionCache() {
   // __clear_cache(reinterpret_cast<char*>(code_cache_begin_), static_cast<int>(CodeCacheSize()));
 }
 
-uint8_t* JitCodeCache::ReserveCode(Thread* self, size_t size) {
+uint8_t* JitCodeCache::ReserveCode(Thread* self, size_t size, ArtMethod* method,
+                                   bool baseline) {
   MutexLock mu(self, lock_);
-  if (size > CodeCacheRemain()) {
+  // The new code of a baseline method uses the room set aside for it.
+  DCHECK(method != nullptr || !baseline);
+  size_t tier_up_reserve = tier_up_reserve_;
+  auto it = (method != nullptr) ? baseline_code_sizes_.find(method) : baseline_code_sizes_.end();
+  if (it != baseline_code_sizes_.end()) {
+    tier_up_reserve -= it->second;
+  }
+  // Baseline code needs room for itself and for its optimized code.
+  const size_t needed = baseline ? 2 * size : size;
+  DCHECK_LE(tier_up_reserve, CodeCacheRemain());
+  if (needed > CodeCacheRemain() - tier_up_reserve) {
     return nullptr;
   }
+  if (it != baseline_code_sizes_.end()) {
+    baseline_code_sizes_.erase(it);
+  }
+  if (baseline) {
+    baseline_code_sizes_.Put(method, size);
+    tier_up_reserve += size;
+  }
+  tier_up_reserve_ = tier_up_reserve;
   ++num_methods_;  // TODO: This is hacky but works since each method has exactly one code region.
   code_cache_ptr_ += size;
   return code_cache_ptr_ - size;
 }
 
+size_t JitCodeCache::TierUpReserve() {
+  MutexLock mu(Thread::Current(), lock_);
+  return tier_up_reserve_;
+}
+
+void JitCodeCache::ReleaseTierUpReserve(Thread* self, ArtMethod* method) {
+  MutexLock mu(self, lock_);
+  auto it = baseline_code_sizes_.find(method);
+  if (it != baseline_code_sizes_.end()) {
+    tier_up_reserve_ -= it->second;
+    baseline_code_sizes_.erase(it);
+  }
+}
+
 uint8_t* JitCodeCache::AddDataArray(Thread* self, const uint8_t* begin, const uint8_t* end) {
   MutexLock mu(self, lock_);
   const size_t size = end - begin;
@@ -83,8 +83,19 @@ class JitCodeCache {
   // Return true if the code cache contains a code ptr.
   bool ContainsCodePtr(const void* ptr) const;
 
-  // Reserve a region of code of size at least "size". Returns null if there is no more room.
-  uint8_t* ReserveCode(Thread* self, size_t size) LOCKS_EXCLUDED(lock_);
+  // Reserve a region of code of size at least "size" for the code of "method". Returns null if
+  // there is no more room. The cache cannot free the baseline code of a method that tiers up,
+  // so adding baseline code also sets aside room for the optimized code, which is assumed to
+  // be about as large. Other code does not use the room set aside.
+  uint8_t* ReserveCode(Thread* self, size_t size, ArtMethod* method = nullptr,
+                       bool baseline = false) LOCKS_EXCLUDED(lock_);
+
+  // Returns the number of code bytes set aside for the optimized code of baseline methods.
+  size_t TierUpReserve() LOCKS_EXCLUDED(lock_);
+
+  // Gives back the room set aside for the tier-up of a baseline method that no longer runs its
+  // baseline code, e.g. since it is deoptimized.
+  void ReleaseTierUpReserve(Thread* self, ArtMethod* method) LOCKS_EXCLUDED(lock_);
 
   // Add a data array of size (end - begin) with the associated contents, returns null if there
   // is no more room.
@@ -122,6 +133,10 @@ class JitCodeCache {
   const uint8_t* data_cache_begin_;
   const uint8_t* data_cache_end_;
   size_t num_methods_;
+  // Code bytes set aside for the optimized code of the methods in baseline_code_sizes_.
+  size_t tier_up_reserve_ GUARDED_BY(lock_);
+  // The code size of the methods compiled with the baseline tier and not yet tiered up.
+  SafeMap<ArtMethod*, size_t> baseline_code_sizes_ GUARDED_BY(lock_);
   // This map holds code for methods if they were deoptimized by the instrumentation stubs. This is
   // required since we have to implement ClassLinker::GetQuickOatCodeFor for walking stacks.
   SafeMap<ArtMethod*, const void*> method_code_map_ GUARDED_BY(lock_);
@@ -99,5 +99,49 @@ TEST_F(JitCodeCacheTest, TestOverflow) {
   CHECK_GE(code_bytes + data_bytes, kSize * 4 / 5);
 }
 
+TEST_F(JitCodeCacheTest, TestTierUpReserve) {
+  std::string error_msg;
+  constexpr size_t kSize = 1 * MB;
+  std::unique_ptr<JitCodeCache> code_cache(
+      JitCodeCache::Create(kSize, &error_msg));
+  ASSERT_TRUE(code_cache.get() != nullptr) << error_msg;
+  ScopedObjectAccess soa(Thread::Current());
+  ClassLinker* const cl = Runtime::Current()->GetClassLinker();
+  ArtMethod* const method = cl->AllocArtMethodArray(soa.Self(), 1);
+  ArtMethod* const other_method = cl->AllocArtMethodArray(soa.Self(), 1);
+  constexpr size_t kCodeSize = 4 * KB;
+  // Baseline code sets aside room for its optimized code, which other code cannot use.
+  ASSERT_TRUE(code_cache->ReserveCode(soa.Self(), kCodeSize, method, true) != nullptr);
+  ASSERT_EQ(kCodeSize, code_cache->TierUpReserve());
+  const size_t remain = code_cache->CodeCacheRemain();
+  ASSERT_TRUE(code_cache->ReserveCode(soa.Self(), remain, other_method) == nullptr);
+  ASSERT_TRUE(code_cache->ReserveCode(soa.Self(), remain - kCodeSize, other_method) != nullptr);
+  // Baseline code is only added if its tier-up still fits.
+  ASSERT_TRUE(code_cache->ReserveCode(soa.Self(), 1u, other_method, true) == nullptr);
+  // The tier-up uses the room set aside for it.
+  ASSERT_TRUE(code_cache->ReserveCode(soa.Self(), kCodeSize, method) != nullptr);
+  ASSERT_EQ(0u, code_cache->TierUpReserve());
+  ASSERT_EQ(0u, code_cache->CodeCacheRemain());
+}
+
+TEST_F(JitCodeCacheTest, TestReleaseTierUpReserve) {
+  std::string error_msg;
+  constexpr size_t kSize = 1 * MB;
+  std::unique_ptr<JitCodeCache> code_cache(
+      JitCodeCache::Create(kSize, &error_msg));
+  ASSERT_TRUE(code_cache.get() != nullptr) << error_msg;
+  ScopedObjectAccess soa(Thread::Current());
+  ClassLinker* const cl = Runtime::Current()->GetClassLinker();
+  auto* method = cl->AllocArtMethodArray(soa.Self(), 1);
+  constexpr size_t kCodeSize = 4 * KB;
+  ASSERT_TRUE(code_cache->ReserveCode(soa.Self(), kCodeSize, method, true) != nullptr);
+  ASSERT_EQ(kCodeSize, code_cache->TierUpReserve());
+  code_cache->ReleaseTierUpReserve(soa.Self(), method);
+  ASSERT_EQ(0u, code_cache->TierUpReserve());
+  // Other code can use all the remaining room again.
+  const size_t remain = code_cache->CodeCacheRemain();
+  ASSERT_TRUE(code_cache->ReserveCode(soa.Self(), remain) != nullptr);
+}
+
 }  // namespace jit
 }  // namespace art
@@ -17,8 +17,12 @@
 #include "jit_instrumentation.h"
 
 #include "art_method-inl.h"
+#include "base/time_utils.h"
+#include "gc/heap.h"
+#include "gc/task_processor.h"
 #include "jit.h"
 #include "jit_code_cache.h"
+#include "metrics.h"
 #include "scoped_thread_state_change.h"
 
 namespace art {
@@ -32,6 +36,7 @@ class JitCompileTask : public Task {
 
   virtual void Run(Thread* self) OVERRIDE {
     ScopedObjectAccess soa(self);
+    self->AddMetric(MetricsCounter::kJitTasksRun, 1u);
     VLOG(jit) << "JitCompileTask compiling method " << PrettyMethod(method_);
     if (Runtime::Current()->GetJit()->CompileMethod(method_, self)) {
       cache_->SignalCompiled(self, method_);
@@ -51,8 +56,25 @@ class JitCompileTask : public Task {
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitCompileTask);
 };
 
+class JitTierUpTask : public gc::HeapTask {
+ public:
+  explicit JitTierUpTask(JitInstrumentationCache* cache)
+      : HeapTask(NanoTime() + JitInstrumentationCache::kTierUpPollPeriodNs), cache_(cache) {
+  }
+
+  virtual void Run(Thread* self) OVERRIDE {
+    cache_->CheckBaselineMethods(self);
+  }
+
+ private:
+  JitInstrumentationCache* const cache_;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(JitTierUpTask);
+};
+
 JitInstrumentationCache::JitInstrumentationCache(size_t hot_method_threshold)
-    : lock_("jit instrumentation lock"), hot_method_threshold_(hot_method_threshold) {
+    : lock_("jit instrumentation lock"), hot_method_threshold_(hot_method_threshold),
+      tier_up_task_scheduled_(false) {
 }
 
 void JitInstrumentationCache::CreateThreadPool() {
@@ -100,16 +122,74 @@ void JitInstrumentationCache::AddSamples(Thread* self, ArtMethod* method, size_t
     }
   }
   if (is_hot) {
-    if (thread_pool_.get() != nullptr) {
-      thread_pool_->AddTask(self, new JitCompileTask(
-          method->GetInterfaceMethodIfProxy(sizeof(void*)), this));
-      thread_pool_->StartWorkers(self);
-    } else {
-      VLOG(jit) << "Compiling hot method " << PrettyMethod(method);
-      Runtime::Current()->GetJit()->CompileMethod(
-          method->GetInterfaceMethodIfProxy(sizeof(void*)), self);
+    CompileHotMethod(self, method->GetInterfaceMethodIfProxy(sizeof(void*)));
+  }
+}
+
+void JitInstrumentationCache::CompileHotMethod(Thread* self, ArtMethod* method) {
+  if (thread_pool_.get() != nullptr) {
+    thread_pool_->AddTask(self, new JitCompileTask(method, this));
+    self->AddMetric(MetricsCounter::kJitTasksAdded, 1u);
+    thread_pool_->StartWorkers(self);
+  } else {
+    VLOG(jit) << "Compiling hot method " << PrettyMethod(method);
+    Runtime::Current()->GetJit()->CompileMethod(method, self);
+  }
+}
+
+void JitInstrumentationCache::AddBaselineMethod(Thread* self, ArtMethod* method) {
+  bool schedule_task;
+  {
+    MutexLock mu(self, lock_);
+    baseline_methods_.push_back(BaselineMethod { method, NanoTime() });
+    schedule_task = !tier_up_task_scheduled_;
+    tier_up_task_scheduled_ = true;
+  }
+  if (schedule_task) {
+    Runtime::Current()->GetHeap()->GetTaskProcessor()->AddTask(self, new JitTierUpTask(this));
+  }
+}
+
+void JitInstrumentationCache::CheckBaselineMethods(Thread* self) {
+  Runtime* const runtime = Runtime::Current();
+  std::vector<BaselineMethod> hot_methods;
+  bool schedule_task;
+  {
+    ScopedObjectAccess soa(self);
+    JitCodeCache* const code_cache = runtime->GetJit()->GetCodeCache();
+    {
+      MutexLock mu(self, lock_);
+      for (size_t i = 0; i < baseline_methods_.size(); ) {
+        BaselineMethod* entry = &baseline_methods_[i];
+        // Stop polling methods that no longer run the JIT code, e.g. since they are deoptimized.
+        const bool in_code_cache = code_cache->ContainsMethod(entry->method);
+        if (in_code_cache && entry->method->GetHotnessCount() != 0) {
+          ++i;
+          continue;
+        }
+        if (in_code_cache) {
+          hot_methods.push_back(*entry);
+        } else {
+          code_cache->ReleaseTierUpReserve(self, entry->method);
+        }
+        *entry = baseline_methods_.back();
+        baseline_methods_.pop_back();
+      }
+      schedule_task = !baseline_methods_.empty();
+      tier_up_task_scheduled_ = schedule_task;
+    }
+    const uint64_t now = NanoTime();
+    for (const BaselineMethod& entry : hot_methods) {
+      VLOG(jit) << "Optimizing hot baseline method " << PrettyMethod(entry.method);
+      // The time to become hot, with the polling delay, shows how long methods stay baseline.
+      runtime->GetMetrics()->AddTime(MetricsHistogram::kJitBaselineTime,
+                                     now - entry.compile_time_ns);
+      CompileHotMethod(self, entry.method);
     }
   }
+  if (schedule_task && !runtime->IsShuttingDown(self)) {
+    runtime->GetHeap()->GetTaskProcessor()->AddTask(self, new JitTierUpTask(this));
+  }
 }
 
 JitInstrumentationListener::JitInstrumentationListener(JitInstrumentationCache* cache)
@@ -18,6 +18,7 @@
 #define ART_RUNTIME_JIT_JIT_INSTRUMENTATION_H_
 
 #include <unordered_map>
+#include <vector>
 
 #include "instrumentation.h"
 
@@ -43,21 +44,43 @@ class Thread;
 namespace jit {
 
 // Keeps track of which methods are hot.
+//
+// Interpreted methods are sampled by the instrumentation listener. Baseline compiled methods
+// count down their ArtMethod::hotness_count_ instead, which a heap task polls while there are
+// baseline methods, to compile them again fully optimized once it reaches zero.
 class JitInstrumentationCache {
  public:
+  // How often the hotness of the baseline methods is polled.
+  static constexpr uint64_t kTierUpPollPeriodNs = 100 * 1000 * 1000;  // 100ms
+
   explicit JitInstrumentationCache(size_t hot_method_threshold);
   void AddSamples(Thread* self, ArtMethod* method, size_t samples)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void SignalCompiled(Thread* self, ArtMethod* method)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Polls the hotness of method, which was just compiled by the baseline tier.
+  void AddBaselineMethod(Thread* self, ArtMethod* method) LOCKS_EXCLUDED(lock_);
+  // Requests the optimized compilation of the baseline methods that became hot, and schedules
+  // the next poll if baseline methods are left.
+  void CheckBaselineMethods(Thread* self) LOCKS_EXCLUDED(lock_);
   void CreateThreadPool();
   void DeleteThreadPool();
 
  private:
+  struct BaselineMethod {
+    ArtMethod* method;
+    uint64_t compile_time_ns;
+  };
+
+  void CompileHotMethod(Thread* self, ArtMethod* method)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   Mutex lock_;
   std::unordered_map<jmethodID, size_t> samples_;
   size_t hot_method_threshold_;
   std::unique_ptr<ThreadPool> thread_pool_;
+  std::vector<BaselineMethod> baseline_methods_ GUARDED_BY(lock_);
+  bool tier_up_task_scheduled_ GUARDED_BY(lock_);
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(JitInstrumentationCache);
 };
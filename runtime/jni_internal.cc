@@ -1726,7 +1726,7 @@ class JNI {
     ScopedObjectAccess soa(env);
     mirror::String* s = soa.Decode<mirror::String*>(java_string);
     gc::Heap* heap = Runtime::Current()->GetHeap();
-    if (heap->IsMovableObject(s)) {
+    if (heap->IsMovableObject(s) && !heap->TryPinObject(s)) {
       StackHandleScope<1> hs(soa.Self());
       HandleWrapper<mirror::String> h(hs.NewHandleWrapper(&s));
       heap->IncrementDisableMovingGC(soa.Self());
@@ -1743,7 +1743,7 @@ class JNI {
     ScopedObjectAccess soa(env);
     gc::Heap* heap = Runtime::Current()->GetHeap();
     mirror::String* s = soa.Decode<mirror::String*>(java_string);
-    if (heap->IsMovableObject(s)) {
+    if (heap->IsMovableObject(s) && !heap->TryUnpinObject(s)) {
       heap->DecrementDisableMovingGC(soa.Self());
     }
   }
@@ -1761,7 +1761,7 @@ class JNI {
     char* bytes = new char[byte_count + 1];
     CHECK(bytes != nullptr);  // bionic aborts anyway.
     const uint16_t* chars = s->GetValue();
-    ConvertUtf16ToModifiedUtf8(bytes, chars, s->GetLength());
+    ConvertUtf16ToModifiedUtf8(bytes, byte_count, chars, s->GetLength());
     bytes[byte_count] = '\0';
     return bytes;
   }
@@ -1890,7 +1890,9 @@ class JNI {
       return nullptr;
     }
     gc::Heap* heap = Runtime::Current()->GetHeap();
-    if (heap->IsMovableObject(array)) {
+    // Only region space objects can be pinned, bump pointer and semi space objects still disable
+    // moving GC until the critical section ends.
+    if (heap->IsMovableObject(array) && !heap->TryPinObject(array)) {
       heap->IncrementDisableMovingGC(soa.Self());
       // Re-decode in case the object moved since IncrementDisableGC waits for GC to complete.
       array = soa.Decode<mirror::Array*>(java_array);
@@ -2435,8 +2437,8 @@ class JNI {
     if (mode != JNI_COMMIT) {
       if (is_copy) {
         delete[] reinterpret_cast<uint64_t*>(elements);
-      } else if (heap->IsMovableObject(array)) {
-        // Non copy to a movable object must means that we had disabled the moving GC.
+      } else if (heap->IsMovableObject(array) && !heap->TryUnpinObject(array)) {
+        // Non copy to a movable object must means that we had pinned it or disabled the moving GC.
         heap->DecrementDisableMovingGC(soa.Self());
       }
     }
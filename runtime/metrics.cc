@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include "base/histogram-inl.h"
+#include "base/mutex-inl.h"
+#include "base/stringprintf.h"
+#include "base/time_utils.h"
+#include "base/unix_file/fd_file.h"
+#include "gc/heap.h"
+#include "gc/task_processor.h"
+#include "jit/jit.h"
+#include "os.h"
+#include "runtime.h"
+#include "thread-inl.h"
+#include "thread_list.h"
+
+namespace art {
+
+static_assert(MetricsRegistry::AllocatedBytesCounter(gc::kAllocatorTypeBumpPointer) ==
+                  MetricsCounter::kAllocatedBytesBumpPointer, "Allocator counter mismatch");
+static_assert(MetricsRegistry::AllocatedBytesCounter(gc::kAllocatorTypeRegionTLAB) ==
+                  MetricsCounter::kAllocatedBytesRegionTLAB, "Allocator counter mismatch");
+
+static constexpr const char* kCounterNames[] = {
+#define ART_METRICS_NAME(name, dump_name) dump_name,
+  ART_METRICS_COUNTERS(ART_METRICS_NAME)
+#undef ART_METRICS_NAME
+};
+static_assert(arraysize(kCounterNames) == kNumMetricsCounters, "Missing counter names");
+
+static constexpr const char* kHistogramNames[] = {
+#define ART_METRICS_NAME(name, dump_name) dump_name,
+  ART_METRICS_HISTOGRAMS(ART_METRICS_NAME)
+#undef ART_METRICS_NAME
+};
+static_assert(arraysize(kHistogramNames) == kNumMetricsHistograms, "Missing histogram names");
+
+// Histogram buckets in microseconds.
+static constexpr uint64_t kHistogramBucketWidth = 50;
+static constexpr size_t kHistogramMaxBuckets = 100;
+
+MetricsRegistry::MetricsRegistry() : histogram_lock_("metrics histogram lock") {
+  for (size_t i = 0; i != kNumMetricsHistograms; ++i) {
+    histograms_[i].reset(
+        new Histogram<uint64_t>(kHistogramNames[i], kHistogramBucketWidth, kHistogramMaxBuckets));
+  }
+}
+
+MetricsRegistry::~MetricsRegistry() {
+}
+
+uint64_t MetricsRegistry::GetCounter(MetricsCounter counter) {
+  const size_t index = static_cast<size_t>(counter);
+  MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
+  uint64_t value = exited_thread_counters_[index].LoadRelaxed();
+  for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+    value += thread->GetMetric(counter);
+  }
+  return value;
+}
+
+void MetricsRegistry::FoldThreadCounters(Thread* thread) {
+  for (size_t i = 0; i != kNumMetricsCounters; ++i) {
+    exited_thread_counters_[i].FetchAndAddSequentiallyConsistent(
+        thread->GetMetric(static_cast<MetricsCounter>(i)));
+  }
+}
+
+void MetricsRegistry::AddTime(MetricsHistogram histogram, uint64_t duration_ns) {
+  MutexLock mu(Thread::Current(), histogram_lock_);
+  histograms_[static_cast<size_t>(histogram)]->AdjustAndAddValue(NsToUs(duration_ns));
+}
+
+void MetricsRegistry::DumpHistogram(std::ostream& os, const std::string& name,
+                                    const Histogram<uint64_t>& histogram, uint64_t divisor) {
+  DCHECK_NE(divisor, 0u);
+  const uint64_t count = histogram.SampleSize();
+  uint64_t p50 = 0;
+  uint64_t p90 = 0;
+  uint64_t p99 = 0;
+  if (count != 0) {
+    Histogram<uint64_t>::CumulativeData data;
+    histogram.CreateHistogram(&data);
+    p50 = static_cast<uint64_t>(histogram.Percentile(0.50, data)) / divisor;
+    p90 = static_cast<uint64_t>(histogram.Percentile(0.90, data)) / divisor;
+    p99 = static_cast<uint64_t>(histogram.Percentile(0.99, data)) / divisor;
+  }
+  os << name << ".count " << count << "\n"
+     << name << ".sum " << histogram.Sum() / divisor << "\n"
+     << name << ".min " << (count != 0 ? histogram.Min() / divisor : 0u) << "\n"
+     << name << ".max " << (count != 0 ? histogram.Max() / divisor : 0u) << "\n"
+     << name << ".p50 " << p50 << "\n"
+     << name << ".p90 " << p90 << "\n"
+     << name << ".p99 " << p99 << "\n";
+}
+
+std::string MetricsRegistry::SanitizeName(const std::string& name) {
+  std::string result;
+  for (char c : name) {
+    if (isalnum(static_cast<unsigned char>(c))) {
+      result += tolower(static_cast<unsigned char>(c));
+    } else if (!result.empty() && result.back() != '_') {
+      result += '_';
+    }
+  }
+  if (!result.empty() && result.back() == '_') {
+    result.pop_back();
+  }
+  return result;
+}
+
+void MetricsRegistry::Dump(std::ostream& os) {
+  Runtime* const runtime = Runtime::Current();
+  os << "metrics.version " << kDumpFormatVersion << "\n";
+  uint64_t counters[kNumMetricsCounters];
+  {
+    MutexLock mu(Thread::Current(), *Locks::thread_list_lock_);
+    for (size_t i = 0; i != kNumMetricsCounters; ++i) {
+      counters[i] = exited_thread_counters_[i].LoadRelaxed();
+    }
+    for (Thread* thread : runtime->GetThreadList()->GetList()) {
+      for (size_t i = 0; i != kNumMetricsCounters; ++i) {
+        counters[i] += thread->GetMetric(static_cast<MetricsCounter>(i));
+      }
+    }
+  }
+  for (size_t i = 0; i != kNumMetricsCounters; ++i) {
+    os << kCounterNames[i] << " " << counters[i] << "\n";
+  }
+  // Tasks are counted when added and when they start running, so the difference is the number
+  // of queued compilations.
+  const uint64_t jit_tasks_added = counters[static_cast<size_t>(MetricsCounter::kJitTasksAdded)];
+  const uint64_t jit_tasks_run = counters[static_cast<size_t>(MetricsCounter::kJitTasksRun)];
+  os << "jit.queue.length "
+     << (jit_tasks_added > jit_tasks_run ? jit_tasks_added - jit_tasks_run : 0u) << "\n";
+  {
+    MutexLock mu(Thread::Current(), histogram_lock_);
+    for (size_t i = 0; i != kNumMetricsHistograms; ++i) {
+      DumpHistogram(os, kHistogramNames[i], *histograms_[i]);
+    }
+  }
+  runtime->GetHeap()->DumpMetrics(os);
+  if (runtime->GetJit() != nullptr) {
+    runtime->GetJit()->DumpMetrics(os);
+  }
+}
+
+bool MetricsRegistry::DumpToFile(const std::string& filename, std::string* error_msg) {
+  std::ostringstream os;
+  Dump(os);
+  const std::string contents = os.str();
+  const std::string temp_filename = filename + ".tmp";
+  std::unique_ptr<File> file(OS::CreateEmptyFile(temp_filename.c_str()));
+  if (file.get() == nullptr) {
+    *error_msg = StringPrintf("Failed to create '%s'", temp_filename.c_str());
+    return false;
+  }
+  if (!file->WriteFully(contents.data(), contents.size())) {
+    *error_msg = StringPrintf("Failed to write '%s'", temp_filename.c_str());
+    file->Erase();
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    *error_msg = StringPrintf("Failed to flush '%s'", temp_filename.c_str());
+    return false;
+  }
+  if (rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    *error_msg = StringPrintf("Failed to rename '%s' to '%s': %s", temp_filename.c_str(),
+                              filename.c_str(), strerror(errno));
+    unlink(temp_filename.c_str());
+    return false;
+  }
+  return true;
+}
+
+class MetricsRegistry::PeriodicDumpTask : public gc::HeapTask {
+ public:
+  PeriodicDumpTask(const std::string& filename, uint64_t period_ns)
+      : HeapTask(NanoTime() + period_ns), filename_(filename), period_ns_(period_ns) {
+  }
+
+  virtual void Run(Thread* self) OVERRIDE {
+    Runtime* const runtime = Runtime::Current();
+    std::string error_msg;
+    if (!runtime->GetMetrics()->DumpToFile(filename_, &error_msg)) {
+      // Give up rather than logging the failure every period.
+      LOG(WARNING) << "Failed to dump metrics: " << error_msg;
+      return;
+    }
+    if (!runtime->IsShuttingDown(self)) {
+      runtime->GetHeap()->GetTaskProcessor()->AddTask(
+          self, new PeriodicDumpTask(filename_, period_ns_));
+    }
+  }
+
+ private:
+  const std::string filename_;
+  const uint64_t period_ns_;
+};
+
+void MetricsRegistry::StartPeriodicDump(Thread* self, const std::string& filename,
+                                        uint64_t period_ns) {
+  Runtime::Current()->GetHeap()->GetTaskProcessor()->AddTask(
+      self, new PeriodicDumpTask(filename, period_ns));
+}
+
+ScopedMetricsTimer::ScopedMetricsTimer(MetricsHistogram histogram)
+    : histogram_(histogram), start_ns_(NanoTime()) {
+}
+
+ScopedMetricsTimer::~ScopedMetricsTimer() {
+  Runtime::Current()->GetMetrics()->AddTime(histogram_, NanoTime() - start_ns_);
+}
+
+}  // namespace art
@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_METRICS_H_
+#define ART_RUNTIME_METRICS_H_
+
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "atomic.h"
+#include "base/histogram.h"
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "gc/allocator_type.h"
+
+namespace art {
+
+class Thread;
+
+// The counters of the metrics registry, with their names in the dump. The allocated bytes
+// counters follow the order of gc::AllocatorType.
+#define ART_METRICS_COUNTERS(V) \
+  V(AllocatedBytesBumpPointer, "alloc.BumpPointer.bytes") \
+  V(AllocatedBytesTLAB, "alloc.TLAB.bytes") \
+  V(AllocatedBytesRosAlloc, "alloc.RosAlloc.bytes") \
+  V(AllocatedBytesDlMalloc, "alloc.DlMalloc.bytes") \
+  V(AllocatedBytesNonMoving, "alloc.NonMoving.bytes") \
+  V(AllocatedBytesLOS, "alloc.LOS.bytes") \
+  V(AllocatedBytesRegion, "alloc.Region.bytes") \
+  V(AllocatedBytesRegionTLAB, "alloc.RegionTLAB.bytes") \
+  V(ClassesDefined, "class_linker.defined") \
+  V(ClassesVerified, "class_linker.verified") \
+  V(JitTasksAdded, "jit.queue.added") \
+  V(JitTasksRun, "jit.queue.run") \
+  V(JitMethodsCompiled, "jit.compiled") \
+  V(JitCompilationFailures, "jit.failed") \
+  V(JitBaselineMethodsCompiled, "jit.compiled.baseline") \
+  V(JitOptimizedMethodsCompiled, "jit.compiled.optimized") \
+  V(MonitorsInflated, "monitor.inflated")
+
+// The timing distributions of the metrics registry, with their names in the dump.
+#define ART_METRICS_HISTOGRAMS(V) \
+  V(ClassDefineTime, "class_linker.define_time_us") \
+  V(ClassVerifyTime, "class_linker.verify_time_us") \
+  V(JitCompileTime, "jit.compile_time_us") \
+  V(JitBaselineTime, "jit.baseline_time_us")
+
+enum class MetricsCounter : size_t {
+#define ART_METRICS_ENUM(name, dump_name) k##name,
+  ART_METRICS_COUNTERS(ART_METRICS_ENUM)
+#undef ART_METRICS_ENUM
+  kLast = kMonitorsInflated,
+};
+
+enum class MetricsHistogram : size_t {
+#define ART_METRICS_ENUM(name, dump_name) k##name,
+  ART_METRICS_HISTOGRAMS(ART_METRICS_ENUM)
+#undef ART_METRICS_ENUM
+  kLast = kJitBaselineTime,
+};
+
+static constexpr size_t kNumMetricsCounters = static_cast<size_t>(MetricsCounter::kLast) + 1;
+static constexpr size_t kNumMetricsHistograms = static_cast<size_t>(MetricsHistogram::kLast) + 1;
+
+// Machine readable runtime statistics, exported through VMDebug and an optional periodic dump
+// file. Counters are updated in the Thread that counts them, without synchronization, and are
+// only aggregated when read. The counters of exited threads are folded into the registry.
+// Histograms record durations in microseconds and share one lock. Other values, such as heap
+// sizes and collector statistics, are sampled from their owners when the registry is dumped.
+class MetricsRegistry {
+ public:
+  MetricsRegistry();
+  ~MetricsRegistry();
+
+  static constexpr MetricsCounter AllocatedBytesCounter(gc::AllocatorType allocator) {
+    return static_cast<MetricsCounter>(
+        static_cast<size_t>(MetricsCounter::kAllocatedBytesBumpPointer) +
+        static_cast<size_t>(allocator));
+  }
+
+  // Returns the sum of the counter over all threads, live or exited.
+  uint64_t GetCounter(MetricsCounter counter) LOCKS_EXCLUDED(Locks::thread_list_lock_);
+
+  // Adds the counters of a thread that is being removed from the thread list.
+  void FoldThreadCounters(Thread* thread) EXCLUSIVE_LOCKS_REQUIRED(Locks::thread_list_lock_);
+
+  // Records a duration, which is converted to the microseconds the histograms hold.
+  void AddTime(MetricsHistogram histogram, uint64_t duration_ns) LOCKS_EXCLUDED(histogram_lock_);
+
+  // Writes one "name value" line per metric. Names are stable across releases; the first line
+  // gives the version of the format.
+  void Dump(std::ostream& os) LOCKS_EXCLUDED(Locks::thread_list_lock_, histogram_lock_);
+
+  // Writes the dump to a temporary file that is then renamed to filename, so that readers
+  // never see a partial dump.
+  bool DumpToFile(const std::string& filename, std::string* error_msg)
+      LOCKS_EXCLUDED(Locks::thread_list_lock_, histogram_lock_);
+
+  // Dumps to filename every period_ns from the heap task daemon.
+  void StartPeriodicDump(Thread* self, const std::string& filename, uint64_t period_ns);
+
+  // Writes the statistics of a histogram under the given name, with every value divided by
+  // divisor, e.g. 1000 for a histogram of nanoseconds dumped under a "_us" name. The histogram
+  // must be guarded against concurrent updates by the caller.
+  static void DumpHistogram(std::ostream& os, const std::string& name,
+                            const Histogram<uint64_t>& histogram, uint64_t divisor = 1u);
+
+  // Turns a free form name, such as a collector name, into a metric name component.
+  static std::string SanitizeName(const std::string& name);
+
+  static constexpr uint32_t kDumpFormatVersion = 1;
+
+ private:
+  class PeriodicDumpTask;
+
+  Atomic<uint64_t> exited_thread_counters_[kNumMetricsCounters];
+  Mutex histogram_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::unique_ptr<Histogram<uint64_t>> histograms_[kNumMetricsHistograms]
+      GUARDED_BY(histogram_lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(MetricsRegistry);
+};
+
+// Records the lifetime of the scope into a histogram of the runtime's metrics registry.
+class ScopedMetricsTimer {
+ public:
+  explicit ScopedMetricsTimer(MetricsHistogram histogram);
+  ~ScopedMetricsTimer();
+
+ private:
+  const MetricsHistogram histogram_;
+  const uint64_t start_ns_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScopedMetricsTimer);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_METRICS_H_
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics.h"
+
+#include <pthread.h>
+
+#include <sstream>
+
+#include "base/histogram-inl.h"
+#include "base/unix_file/fd_file.h"
+#include "common_runtime_test.h"
+#include "os.h"
+#include "thread-inl.h"
+#include "utils.h"
+
+namespace art {
+
+class MetricsTest : public CommonRuntimeTest {};
+
+static constexpr uint64_t kExitedThreadCount = 7u;
+
+static void* CountAndExit(void*) {
+  Runtime* runtime = Runtime::Current();
+  CHECK(runtime->AttachCurrentThread("metrics test thread", false, nullptr, false));
+  Thread::Current()->AddMetric(MetricsCounter::kMonitorsInflated, kExitedThreadCount);
+  runtime->DetachCurrentThread();
+  return nullptr;
+}
+
+TEST_F(MetricsTest, Counters) {
+  MetricsRegistry* metrics = Runtime::Current()->GetMetrics();
+  Thread* self = Thread::Current();
+  const uint64_t before = metrics->GetCounter(MetricsCounter::kMonitorsInflated);
+
+  self->AddMetric(MetricsCounter::kMonitorsInflated, 3u);
+  EXPECT_EQ(before + 3u, metrics->GetCounter(MetricsCounter::kMonitorsInflated));
+
+  // The counts of a thread are kept after it exits.
+  pthread_t pthread;
+  CHECK_PTHREAD_CALL(pthread_create, (&pthread, nullptr, CountAndExit, nullptr), "create");
+  CHECK_PTHREAD_CALL(pthread_join, (pthread, nullptr), "join");
+  EXPECT_EQ(before + 3u + kExitedThreadCount,
+            metrics->GetCounter(MetricsCounter::kMonitorsInflated));
+}
+
+TEST_F(MetricsTest, AllocatedBytesCounter) {
+  EXPECT_EQ(MetricsCounter::kAllocatedBytesRosAlloc,
+            MetricsRegistry::AllocatedBytesCounter(gc::kAllocatorTypeRosAlloc));
+  EXPECT_EQ(MetricsCounter::kAllocatedBytesLOS,
+            MetricsRegistry::AllocatedBytesCounter(gc::kAllocatorTypeLOS));
+}
+
+TEST_F(MetricsTest, SanitizeName) {
+  EXPECT_EQ("concurrent_mark_sweep", MetricsRegistry::SanitizeName("concurrent mark sweep"));
+  EXPECT_EQ("marksweep_semispace", MetricsRegistry::SanitizeName("marksweep + semispace"));
+  EXPECT_EQ("gss", MetricsRegistry::SanitizeName(" (GSS) "));
+}
+
+TEST_F(MetricsTest, DumpHistogram) {
+  Histogram<uint64_t> histogram("test", 10, 10);
+  {
+    std::ostringstream os;
+    MetricsRegistry::DumpHistogram(os, "h", histogram);
+    EXPECT_EQ("h.count 0\nh.sum 0\nh.min 0\nh.max 0\nh.p50 0\nh.p90 0\nh.p99 0\n", os.str());
+  }
+  for (uint64_t i = 1; i <= 100; ++i) {
+    histogram.AddValue(i);
+  }
+  std::ostringstream os;
+  MetricsRegistry::DumpHistogram(os, "h", histogram);
+  const std::string dump = os.str();
+  EXPECT_NE(std::string::npos, dump.find("h.count 100\n"));
+  EXPECT_NE(std::string::npos, dump.find("h.sum 5050\n"));
+  EXPECT_NE(std::string::npos, dump.find("h.min 1\n"));
+  EXPECT_NE(std::string::npos, dump.find("h.max 100\n"));
+
+  // Values are scaled by the divisor.
+  std::ostringstream scaled_os;
+  MetricsRegistry::DumpHistogram(scaled_os, "h", histogram, 10u);
+  const std::string scaled_dump = scaled_os.str();
+  EXPECT_NE(std::string::npos, scaled_dump.find("h.sum 505\n"));
+  EXPECT_NE(std::string::npos, scaled_dump.find("h.max 10\n"));
+}
+
+TEST_F(MetricsTest, Dump) {
+  MetricsRegistry* metrics = Runtime::Current()->GetMetrics();
+  Runtime::Current()->GetHeap()->CollectGarbage(false);
+  metrics->AddTime(MetricsHistogram::kJitCompileTime, MsToNs(1));
+
+  std::ostringstream os;
+  metrics->Dump(os);
+  const std::string dump = os.str();
+  EXPECT_EQ(0u, dump.find("metrics.version 1\n"));
+  EXPECT_NE(std::string::npos, dump.find("\nmonitor.inflated "));
+  EXPECT_NE(std::string::npos, dump.find("\njit.compile_time_us.count "));
+  // AddTime() takes nanoseconds and records microseconds.
+  EXPECT_NE(std::string::npos, dump.find("\njit.compile_time_us.max 1000\n"));
+  EXPECT_NE(std::string::npos, dump.find("\ngc.count "));
+  EXPECT_NE(std::string::npos, dump.find(".pause_us.p99 "));
+
+  // Every line is a name and an integer.
+  std::vector<std::string> lines;
+  Split(dump, '\n', &lines);
+  for (const std::string& line : lines) {
+    std::vector<std::string> fields;
+    Split(line, ' ', &fields);
+    ASSERT_EQ(2u, fields.size()) << line;
+    EXPECT_EQ(std::string::npos, fields[1].find_first_not_of("-0123456789")) << line;
+  }
+}
+
+TEST_F(MetricsTest, DumpToFile) {
+  ScratchFile tmp;
+  std::string error_msg;
+  ASSERT_TRUE(Runtime::Current()->GetMetrics()->DumpToFile(tmp.GetFilename(), &error_msg))
+      << error_msg;
+  std::unique_ptr<File> file(OS::OpenFileForReading(tmp.GetFilename().c_str()));
+  ASSERT_TRUE(file.get() != nullptr);
+  std::string contents(file->GetLength(), '\0');
+  ASSERT_TRUE(file->ReadFully(&contents[0], contents.size()));
+  EXPECT_EQ(0u, contents.find("metrics.version 1\n"));
+}
+
+}  // namespace art
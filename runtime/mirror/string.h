@@ -118,6 +118,10 @@ class MANAGED String FINAL : public Object {
   static String* AllocFromModifiedUtf8(Thread* self, int32_t utf16_length, const char* utf8_data_in)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  static String* AllocFromModifiedUtf8(Thread* self, int32_t utf16_length, const char* utf8_data_in,
+                                       int32_t utf8_length)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // TODO: This is only used in the interpreter to compare against
   // entries from a dex files constant pool (ArtField names). Should
   // we unify this with Equals(const StringPiece&); ?
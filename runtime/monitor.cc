@@ -649,6 +649,7 @@ void Monitor::Inflate(Thread* self, Thread* owner, mirror::Object* obj, int32_t
           << " created monitor " << m << " for object " << obj;
     }
     Runtime::Current()->GetMonitorList()->Add(m);
+    self->AddMetric(MetricsCounter::kMonitorsInflated, 1u);
     CHECK_EQ(obj->GetLockWord(true).GetState(), LockWord::kFatLocked);
   } else {
     MonitorPool::ReleaseMonitor(self, m);
@@ -26,6 +26,7 @@
 #include "class_linker.h"
 #include "common_throws.h"
 #include "debugger.h"
+#include "gc/allocation_profiler.h"
 #include "gc/space/bump_pointer_space.h"
 #include "gc/space/dlmalloc_space.h"
 #include "gc/space/large_object_space.h"
@@ -33,6 +34,7 @@
 #include "gc/space/zygote_space.h"
 #include "hprof/hprof.h"
 #include "jni_internal.h"
+#include "metrics.h"
 #include "mirror/class.h"
 #include "ScopedLocalRef.h"
 #include "ScopedUtfChars.h"
@@ -229,7 +231,7 @@ static void VMDebug_dumpHprofData(JNIEnv* env, jclass, jstring javaFilename, job
     }
   }
 
-  hprof::DumpHeap(filename.c_str(), fd, false);
+  hprof::DumpHeap(filename.c_str(), fd, false, Runtime::Current()->ShouldForkHeapDump());
 }
 
 static void VMDebug_dumpHprofDataDdms(JNIEnv*, jclass) {
@@ -343,6 +345,10 @@ enum class VMDebugRuntimeStatId {
   kArtGcBlockingGcTime,
   kArtGcGcCountRateHistogram,
   kArtGcBlockingGcCountRateHistogram,
+  // "art.metrics", the MetricsRegistry dump, only returned on its own. libcore's VMDebug
+  // needs the matching entry in its runtime stat names for getRuntimeStat() to reach it.
+  kArtMetrics,
+  kArtAllocationProfile,  // The allocation profiler's pprof profile, only returned on its own.
   kNumRuntimeStats,
 };
 
@@ -383,6 +389,19 @@ static jobject VMDebug_getRuntimeStatInternal(JNIEnv* env, jclass, jint statId)
       heap->DumpBlockingGcCountRateHistogram(output);
       return env->NewStringUTF(output.str().c_str());
     }
+    case VMDebugRuntimeStatId::kArtMetrics: {
+      std::ostringstream output;
+      Runtime::Current()->GetMetrics()->Dump(output);
+      return env->NewStringUTF(output.str().c_str());
+    }
+    case VMDebugRuntimeStatId::kArtAllocationProfile: {
+      std::ostringstream output;
+      {
+        ScopedObjectAccess soa(env);
+        heap->GetAllocationProfiler()->DumpProfile(output);
+      }
+      return env->NewStringUTF(output.str().c_str());
+    }
     default:
       return nullptr;
   }
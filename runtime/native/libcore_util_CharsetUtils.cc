@@ -188,6 +188,15 @@ static jbyteArray CharsetUtils_toIsoLatin1Bytes(JNIEnv* env, jclass, jstring jav
     return charsToBytes(env, java_string, offset, length, 0xff);
 }
 
+static bool IsAscii(const jchar* chars, jint length) {
+  // Branch-free so that the compiler can vectorize the scan.
+  jchar bits = 0;
+  for (jint i = 0; i < length; ++i) {
+    bits |= chars[i];
+  }
+  return bits <= 0x7f;
+}
+
 static jbyteArray CharsetUtils_toUtf8Bytes(JNIEnv* env, jclass, jstring java_string, jint offset,
                                            jint length) {
   ScopedObjectAccess soa(env);
@@ -197,6 +206,11 @@ static jbyteArray CharsetUtils_toUtf8Bytes(JNIEnv* env, jclass, jstring java_str
     return nullptr;
   }
 
+  // Fast path: ASCII is its own UTF-8 encoding, so we know the exact size up front.
+  if (IsAscii(&(string->GetValue()[offset]), length)) {
+    return charsToBytes(env, java_string, offset, length, 0x7f);
+  }
+
   NativeUnsafeByteSequence out(env);
   if (!out.resize(length)) {
     return nullptr;
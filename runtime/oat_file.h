@@ -399,6 +399,11 @@ class OatDexFile FINAL {
   // Returns the offset to the OatClass information. Most callers should use GetOatClass.
   uint32_t GetOatClassOffset(uint16_t class_def_index) const;
 
+  // Returns the raw TypeLookupTable data for the DexFile, or null if there is none.
+  const uint8_t* GetLookupTableData() const {
+    return lookup_table_data_;
+  }
+
   ~OatDexFile();
 
  private:
@@ -407,6 +412,7 @@ class OatDexFile FINAL {
              const std::string& canonical_dex_file_location,
              uint32_t dex_file_checksum,
              const uint8_t* dex_file_pointer,
+             const uint8_t* lookup_table_data,
              const uint32_t* oat_class_offsets_pointer);
 
   const OatFile* const oat_file_;
@@ -414,6 +420,7 @@ class OatDexFile FINAL {
   const std::string canonical_dex_file_location_;
   const uint32_t dex_file_location_checksum_;
   const uint8_t* const dex_file_pointer_;
+  const uint8_t* const lookup_table_data_;
   const uint32_t* const oat_class_offsets_pointer_;
 
   friend class OatFile;
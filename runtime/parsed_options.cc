@@ -138,6 +138,17 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
           .IntoKey(M::DumpGCPerformanceOnShutdown)
       .Define("-XX:DumpJITInfoOnShutdown")
           .IntoKey(M::DumpJITInfoOnShutdown)
+      .Define("-XX:ForkHeapDump")
+          .IntoKey(M::ForkHeapDump)
+      .Define("-XX:MetricsDumpFile=_")
+          .WithType<std::string>()
+          .IntoKey(M::MetricsDumpFile)
+      .Define("-XX:MetricsDumpPeriod=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::MetricsDumpPeriod)
+      .Define("-XX:AllocationProfileInterval=_")
+          .WithType<Memory<1>>()
+          .IntoKey(M::AllocationProfileInterval)
       .Define("-XX:IgnoreMaxFootprint")
           .IntoKey(M::IgnoreMaxFootprint)
       .Define("-XX:LowMemoryMode")
@@ -158,6 +169,9 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xjitthreshold:_")
           .WithType<unsigned int>()
           .IntoKey(M::JITCompileThreshold)
+      .Define("-Xjitoptimizethreshold:_")
+          .WithType<unsigned int>()
+          .IntoKey(M::JITOptimizeThreshold)
       .Define("-XX:HspaceCompactForOOMMinIntervalMs=_")  // in ms
           .WithType<MillisecondsToNanoseconds>()  // store as ns
           .IntoKey(M::HSpaceCompactForOOMMinIntervalsMs)
@@ -612,6 +626,7 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xprofile:{threadcpuclock,wallclock,dualclock}\n");
   UsageMessage(stream, "  -Xjitcodecachesize:N\n");
   UsageMessage(stream, "  -Xjitthreshold:integervalue\n");
+  UsageMessage(stream, "  -Xjitoptimizethreshold:integervalue\n");
   UsageMessage(stream, "\n");
 
   UsageMessage(stream, "The following unique to ART options are supported:\n");
@@ -630,6 +645,12 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:LongGCLogThreshold=integervalue\n");
   UsageMessage(stream, "  -XX:DumpGCPerformanceOnShutdown\n");
   UsageMessage(stream, "  -XX:DumpJITInfoOnShutdown\n");
+  UsageMessage(stream, "  -XX:ForkHeapDump\n");
+  UsageMessage(stream, "  -XX:MetricsDumpFile=filename\n");
+  UsageMessage(stream, "  -XX:MetricsDumpPeriod=integervalue\n");
+  UsageMessage(stream, "     (the dump is also VMDebug.getRuntimeStat(\"art.metrics\") if libcore\n"
+                       "     knows that stat name)\n");
+  UsageMessage(stream, "  -XX:AllocationProfileInterval=N\n");
   UsageMessage(stream, "  -XX:IgnoreMaxFootprint\n");
   UsageMessage(stream, "  -XX:UseTLAB\n");
   UsageMessage(stream, "  -XX:BackgroundGC=none\n");
@@ -869,8 +869,9 @@ bool ProfileFile::LoadFile(const std::string& fileName) {
   return true;
 }
 
-bool ProfileFile::GetProfileData(ProfileFile::ProfileData* data, const std::string& method_name) {
-  ProfileMap::iterator i = profile_map_.find(method_name);
+bool ProfileFile::GetProfileData(ProfileFile::ProfileData* data,
+                                 const std::string& method_name) const {
+  ProfileMap::const_iterator i = profile_map_.find(method_name);
   if (i == profile_map_.end()) {
     return false;
   }
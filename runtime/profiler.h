@@ -271,7 +271,7 @@ class ProfileFile {
 
   // If the given method has an entry in the profile table it updates the data
   // and returns true. Otherwise returns false and leaves the data unchanged.
-  bool GetProfileData(ProfileData* data, const std::string& method_name);
+  bool GetProfileData(ProfileData* data, const std::string& method_name) const;
 
  private:
   // Profile data is stored in a map, indexed by the full method name.
@@ -64,6 +64,7 @@
 #include "entrypoints/runtime_asm_entrypoints.h"
 #include "fault_handler.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/allocation_profiler.h"
 #include "gc/heap.h"
 #include "gc/space/image_space.h"
 #include "gc/space/space-inl.h"
@@ -75,6 +76,7 @@
 #include "jit/jit.h"
 #include "jni_internal.h"
 #include "linear_alloc.h"
+#include "metrics.h"
 #include "mirror/array.h"
 #include "mirror/class-inl.h"
 #include "mirror/class_loader.h"
@@ -184,6 +186,9 @@ Runtime::Runtime()
       system_thread_group_(nullptr),
       system_class_loader_(nullptr),
       dump_gc_performance_on_shutdown_(false),
+      fork_heap_dump_(false),
+      metrics_dump_period_ns_(0),
+      allocation_profile_interval_(0),
       preinitialization_transaction_(nullptr),
       verify_(false),
       allow_dex_file_fallback_(true),
@@ -408,6 +413,7 @@ void Runtime::SweepSystemWeaks(IsMarkedCallback* visitor, void* arg) {
   GetInternTable()->SweepInternTableWeaks(visitor, arg);
   GetMonitorList()->SweepMonitorList(visitor, arg);
   GetJavaVM()->SweepJniWeakGlobals(visitor, arg);
+  GetHeap()->GetAllocationProfiler()->SweepSampledObjects(visitor, arg);
 }
 
 bool Runtime::Create(const RuntimeOptions& options, bool ignore_unrecognized) {
@@ -559,6 +565,14 @@ bool Runtime::Start() {
   VLOG(startup) << "Runtime::Start exiting";
   finished_starting_ = true;
 
+  if (!metrics_dump_file_.empty()) {
+    metrics_->StartPeriodicDump(self, metrics_dump_file_, metrics_dump_period_ns_);
+  }
+
+  if (allocation_profile_interval_ != 0) {
+    heap_->GetAllocationProfiler()->Start(allocation_profile_interval_);
+  }
+
   if (profiler_options_.IsEnabled() && !profile_output_filename_.empty()) {
     // User has asked for a profile using -Xenable-profiler.
     // Create the profile file if it doesn't exist.
@@ -831,6 +845,7 @@ bool Runtime::Init(const RuntimeOptions& raw_options, bool ignore_unrecognized)
   max_spins_before_thin_lock_inflation_ =
       runtime_options.GetOrDefault(Opt::MaxSpinsBeforeThinLockInflation);
 
+  metrics_.reset(new MetricsRegistry);
   monitor_list_ = new MonitorList;
   monitor_pool_ = MonitorPool::Create();
   thread_list_ = new ThreadList;
@@ -890,6 +905,10 @@ bool Runtime::Init(const RuntimeOptions& raw_options, bool ignore_unrecognized)
   }
 
   dump_gc_performance_on_shutdown_ = runtime_options.Exists(Opt::DumpGCPerformanceOnShutdown);
+  fork_heap_dump_ = runtime_options.Exists(Opt::ForkHeapDump);
+  metrics_dump_file_ = runtime_options.ReleaseOrDefault(Opt::MetricsDumpFile);
+  metrics_dump_period_ns_ = runtime_options.GetOrDefault(Opt::MetricsDumpPeriod);
+  allocation_profile_interval_ = runtime_options.GetOrDefault(Opt::AllocationProfileInterval);
 
   if (runtime_options.Exists(Opt::JdwpOptions)) {
     Dbg::ConfigureJdwp(runtime_options.GetOrDefault(Opt::JdwpOptions));
@@ -1486,12 +1505,14 @@ void Runtime::DisallowNewSystemWeaks() {
   monitor_list_->DisallowNewMonitors();
   intern_table_->DisallowNewInterns();
   java_vm_->DisallowNewWeakGlobals();
+  heap_->GetAllocationProfiler()->DisallowNewSamples();
 }
 
 void Runtime::AllowNewSystemWeaks() {
   monitor_list_->AllowNewMonitors();
   intern_table_->AllowNewInterns();
   java_vm_->AllowNewWeakGlobals();
+  heap_->GetAllocationProfiler()->AllowNewSamples();
 }
 
 void Runtime::EnsureNewSystemWeaksDisallowed() {
@@ -1500,6 +1521,7 @@ void Runtime::EnsureNewSystemWeaksDisallowed() {
   monitor_list_->EnsureNewMonitorsDisallowed();
   intern_table_->EnsureNewInternsDisallowed();
   java_vm_->EnsureNewWeakGlobalsDisallowed();
+  heap_->GetAllocationProfiler()->EnsureNewSamplesDisallowed();
 }
 
 void Runtime::SetInstructionSet(InstructionSet instruction_set) {
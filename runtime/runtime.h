@@ -74,6 +74,7 @@ class DexFile;
 class InternTable;
 class JavaVMExt;
 class LinearAlloc;
+class MetricsRegistry;
 class MonitorList;
 class MonitorPool;
 class NullPointerHandler;
@@ -152,6 +153,10 @@ class Runtime {
     return is_explicit_gc_disabled_;
   }
 
+  bool ShouldForkHeapDump() const {
+    return fork_heap_dump_;
+  }
+
   std::string GetCompilerExecutable() const;
   std::string GetPatchoatExecutable() const;
 
@@ -269,6 +274,10 @@ class Runtime {
     return monitor_list_;
   }
 
+  MetricsRegistry* GetMetrics() const {
+    return metrics_.get();
+  }
+
   MonitorPool* GetMonitorPool() const {
     return monitor_pool_;
   }
@@ -695,6 +704,19 @@ class Runtime {
   // If true, then we dump the GC cumulative timings on shutdown.
   bool dump_gc_performance_on_shutdown_;
 
+  // If true, hprof heap dumps are written by a forked child process, so that threads are only
+  // suspended for the fork rather than for the whole dump.
+  bool fork_heap_dump_;
+
+  std::unique_ptr<MetricsRegistry> metrics_;
+
+  // If not empty, the metrics are written to this file every metrics_dump_period_ns_.
+  std::string metrics_dump_file_;
+  uint64_t metrics_dump_period_ns_;
+
+  // If not 0, the allocation profiler samples about every this many bytes allocated per thread.
+  size_t allocation_profile_interval_;
+
   // Transaction used for pre-initializing classes at compilation time.
   Transaction* preinitialization_transaction_;
 
@@ -145,6 +145,12 @@ void Thread::InitStringEntryPoints() {
 
 void Thread::ResetQuickAllocEntryPointsForThread() {
   ResetQuickAllocEntryPoints(&tlsPtr_.quick_entrypoints);
+  UpdateThreadLocalInlineEnd();
+}
+
+void Thread::UpdateThreadLocalInlineEnd() {
+  tlsPtr_.thread_local_inline_end =
+      IsQuickAllocEntryPointsInstrumented() ? nullptr : tlsPtr_.thread_local_end;
 }
 
 class DeoptimizationReturnValueRecord {
@@ -2046,6 +2052,10 @@ void Thread::DumpThreadOffset(std::ostream& os, uint32_t offset) {
   DO_THREAD_OFFSET(TopShadowFrameOffset<ptr_size>(), "top_shadow_frame")
   DO_THREAD_OFFSET(TopHandleScopeOffset<ptr_size>(), "top_handle_scope")
   DO_THREAD_OFFSET(ThreadSuspendTriggerOffset<ptr_size>(), "suspend_trigger")
+  DO_THREAD_OFFSET(ThreadLocalPosOffset<ptr_size>(), "thread_local_pos")
+  DO_THREAD_OFFSET(ThreadLocalEndOffset<ptr_size>(), "thread_local_end")
+  DO_THREAD_OFFSET(ThreadLocalObjectsOffset<ptr_size>(), "thread_local_objects")
+  DO_THREAD_OFFSET(ThreadLocalInlineEndOffset<ptr_size>(), "thread_local_inline_end")
 #undef DO_THREAD_OFFSET
 
 #define INTERPRETER_ENTRY_POINT_INFO(x) \
@@ -2534,6 +2544,7 @@ void Thread::SetTlab(uint8_t* start, uint8_t* end) {
   tlsPtr_.thread_local_pos  = tlsPtr_.thread_local_start;
   tlsPtr_.thread_local_end = end;
   tlsPtr_.thread_local_objects = 0;
+  UpdateThreadLocalInlineEnd();
 }
 
 bool Thread::HasTlab() const {
@@ -37,6 +37,7 @@
 #include "handle_scope.h"
 #include "instrumentation.h"
 #include "jvalue.h"
+#include "metrics.h"
 #include "object_callbacks.h"
 #include "offsets.h"
 #include "runtime_stats.h"
@@ -333,6 +334,33 @@ class Thread {
     return &tls64_.stats;
   }
 
+  // Only the thread itself updates its metrics counters, so the update needs no atomic
+  // read-modify-write. Other threads only read them when aggregating.
+  void AddMetric(MetricsCounter counter, uint64_t delta) {
+    Atomic<uint64_t>& value = metrics_counters_[static_cast<size_t>(counter)];
+    value.StoreRelaxed(value.LoadRelaxed() + delta);
+  }
+
+  uint64_t GetMetric(MetricsCounter counter) const {
+    return metrics_counters_[static_cast<size_t>(counter)].LoadRelaxed();
+  }
+
+  // Counts the bytes that the allocation slow path hands to the thread, and returns true when
+  // the current allocation should be sampled by the allocation profiler.
+  bool CountAllocationSampleBytes(size_t byte_count) {
+    const size_t remaining = alloc_sample_bytes_remaining_.LoadRelaxed();
+    if (LIKELY(byte_count < remaining)) {
+      alloc_sample_bytes_remaining_.StoreRelaxed(remaining - byte_count);
+      return false;
+    }
+    return true;
+  }
+
+  // Set by the allocation profiler, which may run on another thread.
+  void SetAllocationSampleBytesRemaining(size_t byte_count) {
+    alloc_sample_bytes_remaining_.StoreRelaxed(byte_count);
+  }
+
   bool IsStillStarting() const;
 
   bool IsExceptionPending() const {
@@ -619,6 +647,30 @@ class Thread {
     return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values, thread_local_objects));
   }
 
+  template<size_t pointer_size>
+  static ThreadOffset<pointer_size> ThreadLocalInlineEndOffset() {
+    return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values,
+                                                                thread_local_inline_end));
+  }
+
+  template<size_t pointer_size>
+  static ThreadOffset<pointer_size> RosAllocRunsOffset() {
+    return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values,
+                                                                rosalloc_runs));
+  }
+
+  template<size_t pointer_size>
+  static ThreadOffset<pointer_size> ThreadLocalAllocStackTopOffset() {
+    return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values,
+                                                                thread_local_alloc_stack_top));
+  }
+
+  template<size_t pointer_size>
+  static ThreadOffset<pointer_size> ThreadLocalAllocStackEndOffset() {
+    return ThreadOffsetFromTlsPtr<pointer_size>(OFFSETOF_MEMBER(tls_ptr_sized_values,
+                                                                thread_local_alloc_stack_end));
+  }
+
   // Size of stack less any space reserved for stack overflow
   size_t GetStackSize() const {
     return tlsPtr_.stack_size - (tlsPtr_.stack_end - tlsPtr_.stack_begin);
@@ -969,6 +1021,9 @@ class Thread {
 
   void VerifyStackImpl() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Recomputes thread_local_inline_end after a TLAB or entrypoint change.
+  void UpdateThreadLocalInlineEnd();
+
   void DumpState(std::ostream& os) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void DumpStack(std::ostream& os) const
       LOCKS_EXCLUDED(Locks::thread_suspend_count_lock_)
@@ -1144,7 +1199,8 @@ class Thread {
       last_no_thread_suspension_cause(nullptr), thread_local_start(nullptr),
       thread_local_pos(nullptr), thread_local_end(nullptr), thread_local_objects(0),
       thread_local_alloc_stack_top(nullptr), thread_local_alloc_stack_end(nullptr),
-      nested_signal_state(nullptr), flip_function(nullptr), method_verifier(nullptr) {
+      nested_signal_state(nullptr), flip_function(nullptr), method_verifier(nullptr),
+      thread_local_inline_end(nullptr) {
       std::fill(held_mutexes, held_mutexes + kLockLevelCount, nullptr);
     }
 
@@ -1268,6 +1324,11 @@ class Thread {
 
     // Current method verifier, used for root marking.
     verifier::MethodVerifier* method_verifier;
+
+    // The limit for TLAB allocations inlined into compiled code. Equal to thread_local_end,
+    // except while the allocation entrypoints are instrumented, when it is null so that compiled
+    // code calls the entrypoints for every allocation.
+    uint8_t* thread_local_inline_end;
   } tlsPtr_;
 
   // Guards the 'interrupted_' and 'wait_monitor_' members.
@@ -1281,6 +1342,13 @@ class Thread {
   // Thread "interrupted" status; stays raised until queried or thrown.
   bool interrupted_ GUARDED_BY(wait_mutex_);
 
+  // Counters of the runtime's MetricsRegistry, see AddMetric.
+  Atomic<uint64_t> metrics_counters_[kNumMetricsCounters];
+
+  // Bytes to allocate until the next allocation profiler sample. Starts at 0, so that the first
+  // counted allocation asks the profiler whether it is enabled.
+  Atomic<size_t> alloc_sample_bytes_remaining_;
+
   friend class Dbg;  // For SetStateUnsafe.
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
@@ -1141,6 +1141,7 @@ void ThreadList::Unregister(Thread* self) {
     } else {
       MutexLock mu2(self, *Locks::thread_suspend_count_lock_);
       if (!self->IsSuspended()) {
+        Runtime::Current()->GetMetrics()->FoldThreadCounters(self);
         list_.remove(self);
         break;
       }
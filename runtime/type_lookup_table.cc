@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "type_lookup_table.h"
+
+#include <string.h>
+#include <vector>
+
+#include "base/bit_utils.h"
+#include "dex_file-inl.h"
+#include "leb128.h"
+#include "utf.h"
+
+namespace art {
+
+TypeLookupTable::TypeLookupTable(const DexFile& dex_file,
+                                 const Entry* entries,
+                                 Entry* owned_entries)
+    : dex_file_(dex_file),
+      mask_(CalculateMask(dex_file.NumClassDefs())),
+      entries_(entries),
+      owned_entries_(owned_entries) {
+}
+
+TypeLookupTable::~TypeLookupTable() {
+}
+
+uint32_t TypeLookupTable::CalculateMask(uint32_t num_class_defs) {
+  return RoundUpToPowerOfTwo(num_class_defs) - 1u;
+}
+
+bool TypeLookupTable::SupportedSize(uint32_t num_class_defs) {
+  // Class def indexes and chain deltas are stored in 16 bits.
+  return num_class_defs != 0u && num_class_defs <= UINT16_MAX;
+}
+
+uint32_t TypeLookupTable::RawDataLength(const DexFile& dex_file) {
+  return RawDataLength(dex_file.NumClassDefs());
+}
+
+uint32_t TypeLookupTable::RawDataLength(uint32_t num_class_defs) {
+  return SupportedSize(num_class_defs) ? (CalculateMask(num_class_defs) + 1u) * sizeof(Entry) : 0u;
+}
+
+TypeLookupTable* TypeLookupTable::Create(const DexFile& dex_file) {
+  uint32_t num_class_defs = dex_file.NumClassDefs();
+  if (!SupportedSize(num_class_defs)) {
+    return nullptr;
+  }
+  uint32_t mask = CalculateMask(num_class_defs);
+  Entry* entries = new Entry[mask + 1u];
+  memset(entries, 0, (mask + 1u) * sizeof(Entry));
+
+  // First place every class def whose home bucket is still free, so that each bucket either
+  // starts its own chain or stays empty. Collisions are chained into the remaining buckets.
+  std::vector<uint16_t> conflicts;
+  for (uint32_t i = 0; i != num_class_defs; ++i) {
+    const DexFile::ClassDef& class_def = dex_file.GetClassDef(i);
+    const DexFile::TypeId& type_id = dex_file.GetTypeId(class_def.class_idx_);
+    const DexFile::StringId& string_id = dex_file.GetStringId(type_id.descriptor_idx_);
+    uint32_t hash = ComputeModifiedUtf8Hash(dex_file.GetStringData(string_id));
+    Entry* entry = &entries[hash & mask];
+    if (entry->IsEmpty()) {
+      entry->str_offset = string_id.string_data_off_;
+      entry->hash = hash;
+      entry->class_def_idx = static_cast<uint16_t>(i);
+    } else {
+      conflicts.push_back(static_cast<uint16_t>(i));
+    }
+  }
+  uint32_t free_pos = 0u;
+  for (uint16_t class_def_idx : conflicts) {
+    const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_idx);
+    const DexFile::TypeId& type_id = dex_file.GetTypeId(class_def.class_idx_);
+    const DexFile::StringId& string_id = dex_file.GetStringId(type_id.descriptor_idx_);
+    uint32_t hash = ComputeModifiedUtf8Hash(dex_file.GetStringData(string_id));
+    uint32_t tail_pos = hash & mask;
+    while (entries[tail_pos].next_pos_delta != 0u) {
+      tail_pos = (tail_pos + entries[tail_pos].next_pos_delta) & mask;
+    }
+    // There are at least as many buckets as class defs, so a free one always exists.
+    while (!entries[free_pos].IsEmpty()) {
+      ++free_pos;
+      DCHECK_LE(free_pos, mask);
+    }
+    Entry* entry = &entries[free_pos];
+    entry->str_offset = string_id.string_data_off_;
+    entry->hash = hash;
+    entry->class_def_idx = class_def_idx;
+    entries[tail_pos].next_pos_delta = static_cast<uint16_t>((free_pos - tail_pos) & mask);
+  }
+  return new TypeLookupTable(dex_file, entries, entries);
+}
+
+TypeLookupTable* TypeLookupTable::Open(const uint8_t* raw_data, const DexFile& dex_file) {
+  DCHECK_ALIGNED(raw_data, alignof(Entry));
+  if (!SupportedSize(dex_file.NumClassDefs())) {
+    return nullptr;
+  }
+  return new TypeLookupTable(dex_file, reinterpret_cast<const Entry*>(raw_data), nullptr);
+}
+
+uint32_t TypeLookupTable::Lookup(const char* descriptor, uint32_t hash) const {
+  uint32_t pos = hash & mask_;
+  const Entry* entry = &entries_[pos];
+  // A bucket holding another bucket's collision means there is no chain for this hash.
+  if (entry->IsEmpty() || (entry->hash & mask_) != pos) {
+    return DexFile::kDexNoIndex;
+  }
+  while (true) {
+    if (entry->hash == hash) {
+      const uint8_t* ptr = dex_file_.Begin() + entry->str_offset;
+      // Skip the utf16 length of the string data.
+      DecodeUnsignedLeb128(&ptr);
+      if (strcmp(descriptor, reinterpret_cast<const char*>(ptr)) == 0) {
+        return entry->class_def_idx;
+      }
+    }
+    if (entry->next_pos_delta == 0u) {
+      return DexFile::kDexNoIndex;
+    }
+    pos = (pos + entry->next_pos_delta) & mask_;
+    entry = &entries_[pos];
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_TYPE_LOOKUP_TABLE_H_
+#define ART_RUNTIME_TYPE_LOOKUP_TABLE_H_
+
+#include <stdint.h>
+#include <memory>
+
+#include "base/macros.h"
+
+namespace art {
+
+class DexFile;
+
+// A hash table mapping class descriptors to the class def index in a dex file.
+//
+// The table is built by dex2oat and stored in the oat file next to the dex file, so that
+// class lookups by descriptor on a freshly started runtime neither search the dex file's
+// string and type ids nor build an index on the native heap. The raw layout is an array of
+// Entry with a power of two size. Each class def lives in the bucket selected by its hash
+// or, on a collision, in a free bucket chained from there.
+class TypeLookupTable {
+ public:
+  ~TypeLookupTable();
+
+  // Returns the size in bytes of the raw table for the dex file.
+  static uint32_t RawDataLength(const DexFile& dex_file);
+
+  // Returns the size in bytes of the raw table for a dex file with the given number of class defs.
+  static uint32_t RawDataLength(uint32_t num_class_defs);
+
+  // Returns whether a table can be created for the dex file.
+  static bool SupportedSize(uint32_t num_class_defs);
+
+  // Builds a table for the dex file. Returns null if the dex file has no class defs.
+  static TypeLookupTable* Create(const DexFile& dex_file);
+
+  // Wraps a raw table stored in an oat file. The data is not copied.
+  static TypeLookupTable* Open(const uint8_t* raw_data, const DexFile& dex_file);
+
+  // Returns the class def index of the class with the given descriptor and hash, or
+  // DexFile::kDexNoIndex if the dex file does not define it.
+  uint32_t Lookup(const char* descriptor, uint32_t hash) const;
+
+  const uint8_t* RawData() const {
+    return reinterpret_cast<const uint8_t*>(entries_);
+  }
+
+  uint32_t RawDataLength() const {
+    return (mask_ + 1u) * sizeof(Entry);
+  }
+
+ private:
+  struct Entry {
+    // Offset of the descriptor's string data in the dex file. Zero for an empty bucket.
+    uint32_t str_offset;
+    // Modified UTF-8 hash of the descriptor, truncated to 32 bits.
+    uint32_t hash;
+    uint16_t class_def_idx;
+    // Distance to the next bucket in the chain, modulo the table size. Zero ends the chain.
+    uint16_t next_pos_delta;
+
+    bool IsEmpty() const {
+      return str_offset == 0u;
+    }
+  };
+
+  TypeLookupTable(const DexFile& dex_file, const Entry* entries, Entry* owned_entries);
+
+  static uint32_t CalculateMask(uint32_t num_class_defs);
+
+  const DexFile& dex_file_;
+  const uint32_t mask_;
+  const Entry* const entries_;
+  std::unique_ptr<Entry[]> owned_entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(TypeLookupTable);
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_TYPE_LOOKUP_TABLE_H_
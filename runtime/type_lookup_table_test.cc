@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "type_lookup_table.h"
+
+#include <memory>
+
+#include "common_runtime_test.h"
+#include "dex_file-inl.h"
+#include "scoped_thread_state_change.h"
+#include "utf.h"
+
+namespace art {
+
+class TypeLookupTableTest : public CommonRuntimeTest {};
+
+TEST_F(TypeLookupTableTest, CreateAndLookup) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Nested"));
+  ASSERT_TRUE(dex_file.get() != nullptr);
+  std::unique_ptr<TypeLookupTable> table(TypeLookupTable::Create(*dex_file));
+  ASSERT_TRUE(table.get() != nullptr);
+  EXPECT_EQ(TypeLookupTable::RawDataLength(*dex_file), table->RawDataLength());
+
+  for (uint32_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+    const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+    EXPECT_EQ(i, table->Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor))) << descriptor;
+  }
+  const char* missing = "LNested$Missing;";
+  EXPECT_EQ(DexFile::kDexNoIndex, table->Lookup(missing, ComputeModifiedUtf8Hash(missing)));
+  // A type that is only referenced, not defined, is not in the table.
+  const char* object = "Ljava/lang/Object;";
+  EXPECT_EQ(DexFile::kDexNoIndex, table->Lookup(object, ComputeModifiedUtf8Hash(object)));
+}
+
+TEST_F(TypeLookupTableTest, OpenRawData) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Nested"));
+  ASSERT_TRUE(dex_file.get() != nullptr);
+  std::unique_ptr<TypeLookupTable> created(TypeLookupTable::Create(*dex_file));
+  ASSERT_TRUE(created.get() != nullptr);
+  // Tables are read straight out of the oat file, check that the raw data is self-contained.
+  std::unique_ptr<uint32_t[]> copy(new uint32_t[created->RawDataLength() / sizeof(uint32_t)]);
+  memcpy(copy.get(), created->RawData(), created->RawDataLength());
+  std::unique_ptr<TypeLookupTable> opened(
+      TypeLookupTable::Open(reinterpret_cast<const uint8_t*>(copy.get()), *dex_file));
+  ASSERT_TRUE(opened.get() != nullptr);
+  for (uint32_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+    const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+    EXPECT_EQ(i, opened->Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor))) << descriptor;
+    EXPECT_EQ(i, dex_file->GetIndexForClassDef(*dex_file->FindClassDef(
+        descriptor, ComputeModifiedUtf8Hash(descriptor))));
+  }
+}
+
+}  // namespace art
@@ -16,6 +16,21 @@
 
 #include "utf.h"
 
+#include <string.h>
+#include <algorithm>
+#include <memory>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#endif
+
+#if defined(__arm__) && defined(__ARM_NEON__)
+#include "arch/arm/instruction_set_features_arm.h"
+#include "arch/instruction_set_features.h"
+#endif
+#include "base/bit_utils.h"
 #include "base/logging.h"
 #include "mirror/array.h"
 #include "mirror/object-inl.h"
@@ -23,6 +38,128 @@
 
 namespace art {
 
+// Number of bytes checked at once by the ASCII fast paths below.
+static constexpr size_t kAsciiWordSize = sizeof(uint64_t);
+static constexpr uint64_t kNonAsciiMask = UINT64_C(0x8080808080808080);
+
+// Number of bytes handled at once by the SIMD versions of the ASCII fast paths.
+static constexpr size_t kAsciiVectorSize = 16u;
+
+// Returns the number of ASCII bytes at the start of utf8, at most byte_count.
+static size_t CountAsciiPrefixGeneric(const char* utf8, size_t byte_count) {
+  size_t i = 0;
+  for (; i + kAsciiWordSize <= byte_count; i += kAsciiWordSize) {
+    uint64_t word;
+    memcpy(&word, utf8 + i, sizeof(word));
+    if ((word & kNonAsciiMask) != 0) {
+      break;
+    }
+  }
+  while (i < byte_count && (utf8[i] & 0x80) == 0) {
+    ++i;
+  }
+  return i;
+}
+
+// Widens count ASCII bytes to UTF-16.
+static void WidenAsciiGeneric(uint16_t* utf16_out, const char* ascii_in, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    utf16_out[i] = static_cast<uint8_t>(ascii_in[i]);
+  }
+}
+
+#if defined(__SSE2__)
+
+static size_t CountAsciiPrefixSse2(const char* utf8, size_t byte_count) {
+  size_t i = 0;
+  for (; i + kAsciiVectorSize <= byte_count; i += kAsciiVectorSize) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(utf8 + i));
+    // The sign bits of the bytes are set exactly for the non-ASCII ones.
+    const uint32_t non_ascii = static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+    if (non_ascii != 0u) {
+      return i + CTZ(non_ascii);
+    }
+  }
+  return i + CountAsciiPrefixGeneric(utf8 + i, byte_count - i);
+}
+
+static void WidenAsciiSse2(uint16_t* utf16_out, const char* ascii_in, size_t count) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + kAsciiVectorSize <= count; i += kAsciiVectorSize) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ascii_in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + i), _mm_unpacklo_epi8(bytes, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(utf16_out + i + kAsciiVectorSize / 2u),
+                     _mm_unpackhi_epi8(bytes, zero));
+  }
+  WidenAsciiGeneric(utf16_out + i, ascii_in + i, count - i);
+}
+
+#elif defined(__aarch64__) || (defined(__arm__) && defined(__ARM_NEON__))
+
+static size_t CountAsciiPrefixNeon(const char* utf8, size_t byte_count) {
+  size_t i = 0;
+  for (; i + kAsciiVectorSize <= byte_count; i += kAsciiVectorSize) {
+    const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(utf8 + i));
+    // Fold the two halves, the generic loop below finds the first non-ASCII byte if any.
+    const uint8x8_t folded = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+    if ((vget_lane_u64(vreinterpret_u64_u8(folded), 0) & kNonAsciiMask) != 0u) {
+      break;
+    }
+  }
+  return i + CountAsciiPrefixGeneric(utf8 + i, byte_count - i);
+}
+
+static void WidenAsciiNeon(uint16_t* utf16_out, const char* ascii_in, size_t count) {
+  size_t i = 0;
+  for (; i + kAsciiVectorSize <= count; i += kAsciiVectorSize) {
+    const uint8x16_t bytes = vld1q_u8(reinterpret_cast<const uint8_t*>(ascii_in + i));
+    vst1q_u16(utf16_out + i, vmovl_u8(vget_low_u8(bytes)));
+    vst1q_u16(utf16_out + i + kAsciiVectorSize / 2u, vmovl_u8(vget_high_u8(bytes)));
+  }
+  WidenAsciiGeneric(utf16_out + i, ascii_in + i, count - i);
+}
+
+#endif
+
+// The ASCII fast paths, selected for the CPU the runtime runs on.
+struct AsciiFunctions {
+  size_t (*count_ascii_prefix)(const char* utf8, size_t byte_count);
+  void (*widen_ascii)(uint16_t* utf16_out, const char* ascii_in, size_t count);
+};
+
+#if defined(__SSE2__)
+// SSE2 is part of x86-64 and required of x86 builds that define __SSE2__.
+static constexpr AsciiFunctions kAsciiFunctions = { CountAsciiPrefixSse2, WidenAsciiSse2 };
+#elif defined(__aarch64__)
+// NEON is mandatory on arm64.
+static constexpr AsciiFunctions kAsciiFunctions = { CountAsciiPrefixNeon, WidenAsciiNeon };
+#elif defined(__arm__) && defined(__ARM_NEON__)
+// NEON is optional on ARMv7, check the CPU once and keep the choice in static function pointers.
+static const AsciiFunctions* SelectAsciiFunctions() {
+  static constexpr AsciiFunctions kNeonFunctions = { CountAsciiPrefixNeon, WidenAsciiNeon };
+  static constexpr AsciiFunctions kGenericFunctions =
+      { CountAsciiPrefixGeneric, WidenAsciiGeneric };
+  std::unique_ptr<const InstructionSetFeatures> features(InstructionSetFeatures::FromHwcap());
+  if (!features->AsArmInstructionSetFeatures()->HasNeon()) {
+    features.reset(InstructionSetFeatures::FromCpuInfo());
+  }
+  return features->AsArmInstructionSetFeatures()->HasNeon() ? &kNeonFunctions
+                                                            : &kGenericFunctions;
+}
+#else
+static constexpr AsciiFunctions kAsciiFunctions = { CountAsciiPrefixGeneric, WidenAsciiGeneric };
+#endif
+
+static ALWAYS_INLINE const AsciiFunctions& GetAsciiFunctions() {
+#if defined(__arm__) && defined(__ARM_NEON__)
+  static const AsciiFunctions* const functions = SelectAsciiFunctions();
+  return *functions;
+#else
+  return kAsciiFunctions;
+#endif
+}
+
 size_t CountModifiedUtf8Chars(const char* utf8) {
   size_t len = 0;
   int ic;
@@ -52,6 +189,106 @@ size_t CountModifiedUtf8Chars(const char* utf8) {
   return len;
 }
 
+size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count) {
+  const char* end = utf8 + byte_count;
+  size_t len = 0;
+  const AsciiFunctions& ascii_functions = GetAsciiFunctions();
+  while (utf8 < end) {
+    // Skip runs of ASCII, they are one char per byte.
+    const size_t ascii_count = ascii_functions.count_ascii_prefix(utf8, end - utf8);
+    utf8 += ascii_count;
+    len += ascii_count;
+    if (utf8 == end) {
+      break;
+    }
+    int ic = *utf8++;
+    len++;
+    if ((ic & 0x80) == 0) {
+      // one-byte encoding
+      continue;
+    }
+    // A sequence truncated by the end of the input counts as a single char. The input may come
+    // straight from JNI NewStringUTF, so never step past the end.
+    // two- or three-byte encoding
+    if (utf8 == end) {
+      break;
+    }
+    utf8++;
+    if ((ic & 0x20) == 0) {
+      // two-byte encoding
+      continue;
+    }
+    if (utf8 == end) {
+      break;
+    }
+    utf8++;
+    if ((ic & 0x10) == 0) {
+      // three-byte encoding
+      continue;
+    }
+
+    // four-byte encoding: needs to be converted into a surrogate
+    // pair.
+    if (utf8 == end) {
+      break;
+    }
+    utf8++;
+    len++;
+  }
+  return len;
+}
+
+void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
+                                const char* utf8_data_in, size_t in_bytes) {
+  if (LIKELY(out_chars == in_bytes)) {
+    // Every multi-byte sequence decodes to fewer chars than bytes, so this is plain ASCII.
+    GetAsciiFunctions().widen_ascii(utf16_data_out, utf8_data_in, in_bytes);
+    return;
+  }
+  const char* const in_end = utf8_data_in + in_bytes;
+  uint16_t* const out_end = utf16_data_out + out_chars;
+  while (utf8_data_in < in_end && utf16_data_out < out_end) {
+    uint32_t ch;
+    const size_t remaining = in_end - utf8_data_in;
+    if (LIKELY(remaining >= 4u)) {
+      ch = GetUtf16FromUtf8(&utf8_data_in);
+    } else {
+      // Decode the last bytes from a zero padded copy, so that a sequence truncated by the end of
+      // the input does not read past it. It decodes to one char, as CountModifiedUtf8Chars counts.
+      char tail[4] = {};
+      memcpy(tail, utf8_data_in, remaining);
+      const char* tail_ptr = tail;
+      ch = GetUtf16FromUtf8(&tail_ptr);
+      utf8_data_in += std::min(static_cast<size_t>(tail_ptr - tail), remaining);
+    }
+    *utf16_data_out++ = GetLeadingUtf16Char(ch);
+    const uint16_t trailing = GetTrailingUtf16Char(ch);
+    if (trailing != 0 && utf16_data_out < out_end) {
+      *utf16_data_out++ = trailing;
+    }
+  }
+}
+
+void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, size_t out_chars,
+                                const char* utf8_data_in) {
+  // Every char takes at least one byte, so the input has at least out_chars bytes. If they are
+  // all ASCII they are the whole string.
+  const AsciiFunctions& ascii_functions = GetAsciiFunctions();
+  if (LIKELY(ascii_functions.count_ascii_prefix(utf8_data_in, out_chars) == out_chars)) {
+    ascii_functions.widen_ascii(utf16_data_out, utf8_data_in, out_chars);
+    return;
+  }
+  uint16_t* const out_end = utf16_data_out + out_chars;
+  while (utf16_data_out < out_end && *utf8_data_in != '\0') {
+    const uint32_t ch = GetUtf16FromUtf8(&utf8_data_in);
+    *utf16_data_out++ = GetLeadingUtf16Char(ch);
+    const uint16_t trailing = GetTrailingUtf16Char(ch);
+    if (trailing != 0 && utf16_data_out < out_end) {
+      *utf16_data_out++ = trailing;
+    }
+  }
+}
+
 void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_data_out, const char* utf8_data_in) {
   while (*utf8_data_in != '\0') {
     const uint32_t ch = GetUtf16FromUtf8(&utf8_data_in);
@@ -107,14 +344,51 @@ void ConvertUtf16ToModifiedUtf8(char* utf8_out, const uint16_t* utf16_in, size_t
   }
 }
 
+void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
+                                const uint16_t* utf16_in, size_t char_count) {
+  if (LIKELY(byte_count == char_count)) {
+    // Every char needs at least one byte and NUL needs two, so this is plain non-NUL ASCII.
+    for (size_t i = 0; i < char_count; ++i) {
+      utf8_out[i] = static_cast<char>(utf16_in[i]);
+    }
+    return;
+  }
+  ConvertUtf16ToModifiedUtf8(utf8_out, utf16_in, char_count);
+}
+
 int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count) {
+  // Hash four chars per iteration to break the serial multiply-add dependency:
+  // h * 31^4 + c0 * 31^3 + c1 * 31^2 + c2 * 31 + c3 equals four steps of h * 31 + c modulo 2^32.
   uint32_t hash = 0;
+  while (char_count >= 4u) {
+    hash = hash * (31u * 31u * 31u * 31u) +
+        chars[0] * (31u * 31u * 31u) + chars[1] * (31u * 31u) + chars[2] * 31u + chars[3];
+    chars += 4;
+    char_count -= 4u;
+  }
   while (char_count--) {
     hash = hash * 31 + *chars++;
   }
   return static_cast<int32_t>(hash);
 }
 
+int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length) {
+  uint32_t hash = 0;
+  while (utf16_length != 0u) {
+    const uint32_t pair = GetUtf16FromUtf8(&utf8);
+    const uint16_t first = GetLeadingUtf16Char(pair);
+    hash = hash * 31 + first;
+    --utf16_length;
+    const uint16_t second = GetTrailingUtf16Char(pair);
+    if (second != 0) {
+      hash = hash * 31 + second;
+      DCHECK_NE(utf16_length, 0u);
+      --utf16_length;
+    }
+  }
+  return static_cast<int32_t>(hash);
+}
+
 size_t ComputeModifiedUtf8Hash(const char* chars) {
   size_t hash = 0;
   while (*chars != '\0') {
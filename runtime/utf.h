@@ -40,6 +40,8 @@ namespace mirror {
  * Returns the number of UTF-16 characters in the given modified UTF-8 string.
  */
 size_t CountModifiedUtf8Chars(const char* utf8);
+// As above, but stops after byte_count bytes. A sequence truncated by the end counts as one char.
+size_t CountModifiedUtf8Chars(const char* utf8, size_t byte_count);
 
 /*
  * Returns the number of modified UTF-8 bytes needed to represent the given
@@ -51,6 +53,12 @@ size_t CountUtf8Bytes(const uint16_t* chars, size_t char_count);
  * Convert from Modified UTF-8 to UTF-16.
  */
 void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_out, const char* utf8_in);
+// As above, but stops after out_chars chars, the length of the string in UTF-16 chars.
+void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_out, size_t out_chars, const char* utf8_in);
+// As above, but with the lengths of both strings known. When they match the input is pure ASCII
+// and is widened without decoding. Never reads past in_bytes or writes more than out_chars.
+void ConvertModifiedUtf8ToUtf16(uint16_t* utf16_out, size_t out_chars,
+                                const char* utf8_in, size_t in_bytes);
 
 /*
  * Compare two modified UTF-8 strings as UTF-16 code point values in a non-locale sensitive manner
@@ -72,6 +80,10 @@ int CompareModifiedUtf8ToUtf16AsCodePointValues(const char* utf8, const uint16_t
  * put the NUL byte.
  */
 void ConvertUtf16ToModifiedUtf8(char* utf8_out, const uint16_t* utf16_in, size_t char_count);
+// As above, but with byte_count (from CountUtf8Bytes) known. When it matches char_count the
+// input is pure ASCII and is narrowed without encoding.
+void ConvertUtf16ToModifiedUtf8(char* utf8_out, size_t byte_count,
+                                const uint16_t* utf16_in, size_t char_count);
 
 /*
  * The java.lang.String hashCode() algorithm.
@@ -80,6 +92,10 @@ int32_t ComputeUtf16Hash(mirror::CharArray* chars, int32_t offset, size_t char_c
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 int32_t ComputeUtf16Hash(const uint16_t* chars, size_t char_count);
 
+// Compute the java.lang.String hashCode() of a modified UTF-8 string without first converting it
+// to UTF-16. utf16_length must be the number of UTF-16 chars the string decodes to.
+int32_t ComputeUtf16HashFromModifiedUtf8(const char* utf8, size_t utf16_length);
+
 // Compute a hash code of a modified UTF-8 string. Not the standard java hash since it returns a
 // size_t and hashes individual chars instead of codepoint words.
 size_t ComputeModifiedUtf8Hash(const char* chars);
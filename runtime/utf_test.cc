@@ -160,4 +160,87 @@ TEST_F(UtfTest, CountAndConvertUtf8Bytes_UnpairedSurrogate) {
   AssertConversion({ 'h', 0xdc00, 0xdc00, 'e' }, { 'h', 0xed, 0xb0, 0x80, 0xed, 0xb0, 0x80, 'e' });
 }
 
+static void AssertHashFromModifiedUtf8(const std::vector<uint16_t> input) {
+  std::vector<char> utf8(CountUtf8Bytes(&input[0], input.size()) + 1u, '\0');
+  ConvertUtf16ToModifiedUtf8(&utf8[0], &input[0], input.size());
+  EXPECT_EQ(input.size(), CountModifiedUtf8Chars(&utf8[0]));
+  EXPECT_EQ(ComputeUtf16Hash(&input[0], input.size()),
+            ComputeUtf16HashFromModifiedUtf8(&utf8[0], input.size()));
+}
+
+TEST_F(UtfTest, ComputeUtf16HashFromModifiedUtf8) {
+  AssertHashFromModifiedUtf8({ 'h', 'e', 'l', 'l', 'o' });
+  AssertHashFromModifiedUtf8({ 0x0101, 0x0000 });
+  AssertHashFromModifiedUtf8({ 0xdef0, 0xdcff });
+  // Surrogate pairs are encoded as a single 4 byte sequence but hash as two chars.
+  AssertHashFromModifiedUtf8({ 'a', 0xd802, 0xdc02, 'b' });
+  AssertHashFromModifiedUtf8({ 'h', 0xd801, 'e' });
+}
+
+static void AssertRoundTripWithLengths(const std::vector<uint16_t> input) {
+  size_t byte_count = CountUtf8Bytes(&input[0], input.size());
+  std::vector<char> utf8(byte_count + 1u, '\0');
+  ConvertUtf16ToModifiedUtf8(&utf8[0], byte_count, &input[0], input.size());
+  EXPECT_EQ(byte_count, strlen(&utf8[0]));
+  EXPECT_EQ(input.size(), CountModifiedUtf8Chars(&utf8[0], byte_count));
+  EXPECT_EQ(CountModifiedUtf8Chars(&utf8[0]), CountModifiedUtf8Chars(&utf8[0], byte_count));
+
+  std::vector<uint16_t> output(input.size());
+  ConvertModifiedUtf8ToUtf16(&output[0], output.size(), &utf8[0], byte_count);
+  EXPECT_EQ(input, output);
+
+  std::vector<uint16_t> output_from_utf16_length(input.size());
+  ConvertModifiedUtf8ToUtf16(&output_from_utf16_length[0], input.size(), &utf8[0]);
+  EXPECT_EQ(input, output_from_utf16_length);
+
+  uint32_t hash = 0;
+  for (uint16_t c : input) {
+    hash = hash * 31 + c;
+  }
+  EXPECT_EQ(static_cast<int32_t>(hash), ComputeUtf16Hash(&input[0], input.size()));
+}
+
+TEST_F(UtfTest, CountAndConvertTruncatedSequences) {
+  // The bytes after the counted ones are continuation bytes that would be decoded if the end of
+  // the input were stepped over.
+  const char truncated_two_bytes[] = { 'h', 'i', '\xc3', '\x80', '\x80', '\x80', '\0' };
+  EXPECT_EQ(3u, CountModifiedUtf8Chars(truncated_two_bytes, 3u));
+
+  const char truncated_three_bytes[] = { 'h', 'i', '\xe2', '\x82', '\x80', '\x80', '\0' };
+  EXPECT_EQ(3u, CountModifiedUtf8Chars(truncated_three_bytes, 3u));
+  EXPECT_EQ(3u, CountModifiedUtf8Chars(truncated_three_bytes, 4u));
+  std::vector<uint16_t> output(3u);
+  ConvertModifiedUtf8ToUtf16(&output[0], output.size(), truncated_three_bytes, 4u);
+  EXPECT_EQ(std::vector<uint16_t>({ 'h', 'i', 0x2080 }), output);
+}
+
+TEST_F(UtfTest, ConvertWithLengths) {
+  // Pure ASCII of various lengths around the fast path word size.
+  AssertRoundTripWithLengths({ 'a' });
+  AssertRoundTripWithLengths({ 'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o' });
+  AssertRoundTripWithLengths({ 'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd' });
+  // Non-ASCII before, inside and after ASCII runs.
+  AssertRoundTripWithLengths({ 0x0101, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i' });
+  AssertRoundTripWithLengths({ 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 0xdef0 });
+  AssertRoundTripWithLengths({ 'a', 'b', 'c', 'd', 0xd802, 0xdc02, 'e', 'f', 'g', 'h', 'i' });
+  // NUL needs two bytes so it must not take the ASCII path.
+  AssertRoundTripWithLengths({ 'a', 'b', 'c', 'd', 0x0000, 'e', 'f', 'g', 'h' });
+}
+
+TEST_F(UtfTest, ConvertWithLengths_LongStrings) {
+  // Lengths around the SIMD vector size, with a non-ASCII char at every position.
+  for (size_t length = 1u; length <= 40u; ++length) {
+    std::vector<uint16_t> input(length);
+    for (size_t i = 0; i < length; ++i) {
+      input[i] = 'a' + (i % 26u);
+    }
+    AssertRoundTripWithLengths(input);
+    for (size_t position = 0; position < length; ++position) {
+      std::vector<uint16_t> with_non_ascii = input;
+      with_non_ascii[position] = (position % 2u == 0u) ? 0x00e9 : 0x20ac;
+      AssertRoundTripWithLengths(with_non_ascii);
+    }
+  }
+}
+
 }  // namespace art
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// More methods than IMT slots, so that some of them are guaranteed to conflict.
+public interface Itf {
+  int m00();
+  int m01();
+  int m02();
+  int m03();
+  int m04();
+  int m05();
+  int m06();
+  int m07();
+  int m08();
+  int m09();
+  int m10();
+  int m11();
+  int m12();
+  int m13();
+  int m14();
+  int m15();
+  int m16();
+  int m17();
+  int m18();
+  int m19();
+  int m20();
+  int m21();
+  int m22();
+  int m23();
+  int m24();
+  int m25();
+  int m26();
+  int m27();
+  int m28();
+  int m29();
+  int m30();
+  int m31();
+  int m32();
+  int m33();
+  int m34();
+  int m35();
+  int m36();
+  int m37();
+  int m38();
+  int m39();
+  int m40();
+  int m41();
+  int m42();
+  int m43();
+  int m44();
+  int m45();
+  int m46();
+  int m47();
+  int m48();
+  int m49();
+  int m50();
+  int m51();
+  int m52();
+  int m53();
+  int m54();
+  int m55();
+  int m56();
+  int m57();
+  int m58();
+  int m59();
+  int m60();
+  int m61();
+  int m62();
+  int m63();
+  int m64();
+  int m65();
+  int m66();
+  int m67();
+  int m68();
+  int m69();
+}
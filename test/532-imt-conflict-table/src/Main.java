@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static int sumAll(Itf itf) {
+    int sum = 0;
+    sum += itf.m00();
+    sum += itf.m01();
+    sum += itf.m02();
+    sum += itf.m03();
+    sum += itf.m04();
+    sum += itf.m05();
+    sum += itf.m06();
+    sum += itf.m07();
+    sum += itf.m08();
+    sum += itf.m09();
+    sum += itf.m10();
+    sum += itf.m11();
+    sum += itf.m12();
+    sum += itf.m13();
+    sum += itf.m14();
+    sum += itf.m15();
+    sum += itf.m16();
+    sum += itf.m17();
+    sum += itf.m18();
+    sum += itf.m19();
+    sum += itf.m20();
+    sum += itf.m21();
+    sum += itf.m22();
+    sum += itf.m23();
+    sum += itf.m24();
+    sum += itf.m25();
+    sum += itf.m26();
+    sum += itf.m27();
+    sum += itf.m28();
+    sum += itf.m29();
+    sum += itf.m30();
+    sum += itf.m31();
+    sum += itf.m32();
+    sum += itf.m33();
+    sum += itf.m34();
+    sum += itf.m35();
+    sum += itf.m36();
+    sum += itf.m37();
+    sum += itf.m38();
+    sum += itf.m39();
+    sum += itf.m40();
+    sum += itf.m41();
+    sum += itf.m42();
+    sum += itf.m43();
+    sum += itf.m44();
+    sum += itf.m45();
+    sum += itf.m46();
+    sum += itf.m47();
+    sum += itf.m48();
+    sum += itf.m49();
+    sum += itf.m50();
+    sum += itf.m51();
+    sum += itf.m52();
+    sum += itf.m53();
+    sum += itf.m54();
+    sum += itf.m55();
+    sum += itf.m56();
+    sum += itf.m57();
+    sum += itf.m58();
+    sum += itf.m59();
+    sum += itf.m60();
+    sum += itf.m61();
+    sum += itf.m62();
+    sum += itf.m63();
+    sum += itf.m64();
+    sum += itf.m65();
+    sum += itf.m66();
+    sum += itf.m67();
+    sum += itf.m68();
+    sum += itf.m69();
+    return sum;
+  }
+
+  public static void main(String[] args) {
+    Itf impl = new Impl();
+    Itf sub = new Sub();
+    // Call several times so that the later calls go through the conflict tables.
+    for (int i = 0; i < 3; ++i) {
+      System.out.println(sumAll(impl));
+      System.out.println(sumAll(sub));
+    }
+  }
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// Overrides every other method, the conflict tables of Impl must not be reused.
+public class Sub extends Impl {
+  public int m00() { return 100; }
+  public int m02() { return 102; }
+  public int m04() { return 104; }
+  public int m06() { return 106; }
+  public int m08() { return 108; }
+  public int m10() { return 110; }
+  public int m12() { return 112; }
+  public int m14() { return 114; }
+  public int m16() { return 116; }
+  public int m18() { return 118; }
+  public int m20() { return 120; }
+  public int m22() { return 122; }
+  public int m24() { return 124; }
+  public int m26() { return 126; }
+  public int m28() { return 128; }
+  public int m30() { return 130; }
+  public int m32() { return 132; }
+  public int m34() { return 134; }
+  public int m36() { return 136; }
+  public int m38() { return 138; }
+  public int m40() { return 140; }
+  public int m42() { return 142; }
+  public int m44() { return 144; }
+  public int m46() { return 146; }
+  public int m48() { return 148; }
+  public int m50() { return 150; }
+  public int m52() { return 152; }
+  public int m54() { return 154; }
+  public int m56() { return 156; }
+  public int m58() { return 158; }
+  public int m60() { return 160; }
+  public int m62() { return 162; }
+  public int m64() { return 164; }
+  public int m66() { return 166; }
+  public int m68() { return 168; }
+}
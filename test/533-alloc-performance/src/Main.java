@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+    static final int ITERATIONS = 200000;
+    static final int RETAINED = 40000;
+
+    // Objects of increasing size, covering the smallest, a middle and the largest thread-local
+    // RosAlloc size brackets.
+    static class Small {
+        int a;
+    }
+
+    static class Medium {
+        long a, b, c, d, e, f;
+    }
+
+    static class Large {
+        long a, b, c, d, e, f, g, h, i, j, k, l, m, n;
+    }
+
+    static int checksum;
+
+    public static void main(String[] args) {
+        boolean timing = (args.length >= 1) && args[0].equals("--timing");
+
+        long time0 = System.nanoTime();
+        int small = allocSmall(ITERATIONS);
+        long time1 = System.nanoTime();
+        int medium = allocMedium(ITERATIONS);
+        long time2 = System.nanoTime();
+        int large = allocLarge(ITERATIONS);
+        long time3 = System.nanoTime();
+        int retained = allocRetained(RETAINED);
+        long time4 = System.nanoTime();
+
+        System.out.println("Small: allocated " + small + " objects");
+        System.out.println("Medium: allocated " + medium + " objects");
+        System.out.println("Large: allocated " + large + " objects");
+        System.out.println("Retained: " + retained + " objects");
+        if (checksum != 0) {
+            throw new Error("Freshly allocated objects are not zeroed: " + checksum);
+        }
+        System.out.println("Checksum ok");
+
+        if (timing) {
+            printRate("Small", small, time1 - time0);
+            printRate("Medium", medium, time2 - time1);
+            printRate("Large", large, time3 - time2);
+            printRate("Retained", retained, time4 - time3);
+        }
+    }
+
+    static void printRate(String name, int count, long nanos) {
+        System.out.println(name + ": " + (nanos / count) + " ns per allocation, " +
+                           (count * 1000000000L / Math.max(nanos, 1L)) + " allocations/s");
+    }
+
+    static int allocSmall(int count) {
+        for (int i = 0; i < count; ++i) {
+            Small o = new Small();
+            checksum += o.a;
+            o.a = i;
+        }
+        return count;
+    }
+
+    static int allocMedium(int count) {
+        for (int i = 0; i < count; ++i) {
+            Medium o = new Medium();
+            checksum += (int) (o.a | o.f);
+            o.f = i;
+        }
+        return count;
+    }
+
+    static int allocLarge(int count) {
+        for (int i = 0; i < count; ++i) {
+            Large o = new Large();
+            checksum += (int) (o.a | o.n);
+            o.n = i;
+        }
+        return count;
+    }
+
+    // Keeps the objects alive so that the thread-local runs fill up and get refilled, and so that
+    // the collector has to find the objects allocated by the fast paths.
+    static int allocRetained(int count) {
+        Object[] objects = new Object[count];
+        for (int i = 0; i < count; ++i) {
+            switch (i % 3) {
+                case 0: objects[i] = new Small(); break;
+                case 1: objects[i] = new Medium(); break;
+                default: objects[i] = new Large(); break;
+            }
+        }
+        Runtime.getRuntime().gc();
+        int live = 0;
+        for (int i = 0; i < count; ++i) {
+            Object o = objects[i];
+            if (o instanceof Small) {
+                checksum += ((Small) o).a;
+                ++live;
+            } else if (o instanceof Medium) {
+                checksum += (int) ((Medium) o).f;
+                ++live;
+            } else if (o instanceof Large) {
+                checksum += (int) ((Large) o).n;
+                ++live;
+            }
+        }
+        return live;
+    }
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+    static final int ITERATIONS = 200000;
+    static final int RETAINED = 20000;
+
+    static class Point {
+        int x, y;
+    }
+
+    static class Finalizable {
+        static int finalized;
+        int a;
+
+        protected void finalize() {
+            ++finalized;
+        }
+    }
+
+    static class Lazy {
+        static int initialized;
+        static {
+            ++initialized;
+        }
+        long a;
+    }
+
+    static int checksum;
+
+    public static void main(String[] args) {
+        boolean timing = (args.length >= 1) && args[0].equals("--timing");
+
+        long time0 = System.nanoTime();
+        int points = allocPoints(ITERATIONS);
+        long time1 = System.nanoTime();
+        int arrays = allocArrays(ITERATIONS);
+        long time2 = System.nanoTime();
+
+        System.out.println("Points: allocated " + points + " objects");
+        System.out.println("Arrays: allocated " + arrays + " arrays");
+
+        // Classes that need a finalizer or are not yet initialized take the slow path.
+        allocFinalizable();
+        System.out.println("Lazy initialized " + allocLazy() + " time(s)");
+
+        checkArrayLengths();
+        checkNegativeLength();
+        System.out.println("Retained: " + allocRetained(RETAINED) + " objects");
+
+        if (checksum != 0) {
+            throw new Error("Freshly allocated objects are not zeroed: " + checksum);
+        }
+        System.out.println("Checksum ok");
+
+        if (timing) {
+            printRate("Points", points, time1 - time0);
+            printRate("Arrays", arrays, time2 - time1);
+        }
+    }
+
+    static void printRate(String name, int count, long nanos) {
+        System.out.println(name + ": " + (nanos / count) + " ns per allocation, " +
+                           (count * 1000000000L / Math.max(nanos, 1L)) + " allocations/s");
+    }
+
+    static int allocPoints(int count) {
+        for (int i = 0; i < count; ++i) {
+            Point p = new Point();
+            checksum += p.x | p.y;
+            p.x = i;
+        }
+        return count;
+    }
+
+    static int allocArrays(int count) {
+        for (int i = 0; i < count; ++i) {
+            int[] a = new int[i & 15];
+            for (int j = 0; j < a.length; ++j) {
+                checksum += a[j];
+            }
+        }
+        return count;
+    }
+
+    static void allocFinalizable() {
+        Finalizable f = new Finalizable();
+        checksum += f.a;
+    }
+
+    static int allocLazy() {
+        Lazy l = new Lazy();
+        checksum += (int) l.a;
+        l = new Lazy();
+        checksum += (int) l.a;
+        return Lazy.initialized;
+    }
+
+    // Covers every component size and lengths below and above the inline allocation limit.
+    static void checkArrayLengths() {
+        int[] lengths = { 0, 1, 7, 8, 9, 100, 255, 256, 1000, 100000 };
+        for (int length : lengths) {
+            expectLength(length, new boolean[length].length);
+            expectLength(length, new byte[length].length);
+            expectLength(length, new char[length].length);
+            expectLength(length, new short[length].length);
+            expectLength(length, new int[length].length);
+            expectLength(length, new float[length].length);
+            expectLength(length, new long[length].length);
+            expectLength(length, new double[length].length);
+            expectLength(length, new Object[length].length);
+            long[] longs = new long[length];
+            Object[] objects = new Object[length];
+            for (int i = 0; i < length; ++i) {
+                checksum += (int) longs[i];
+                if (objects[i] != null) {
+                    ++checksum;
+                }
+            }
+        }
+        System.out.println("Array lengths ok");
+    }
+
+    static void expectLength(int expected, int actual) {
+        if (expected != actual) {
+            throw new Error("Expected length " + expected + ", got " + actual);
+        }
+    }
+
+    static void checkNegativeLength() {
+        try {
+            int[] a = new int[-1];
+            throw new Error("Allocated an array of length " + a.length);
+        } catch (NegativeArraySizeException expected) {
+            System.out.println("Caught NegativeArraySizeException");
+        }
+    }
+
+    // Keeps the objects alive across a collection, so that the collector has to find and move
+    // the objects allocated by the inline fast paths.
+    static int allocRetained(int count) {
+        Object[] objects = new Object[count];
+        for (int i = 0; i < count; ++i) {
+            if ((i & 1) == 0) {
+                Point p = new Point();
+                p.x = i;
+                objects[i] = p;
+            } else {
+                int[] a = new int[i & 7];
+                if (a.length != 0) {
+                    a[0] = i;
+                }
+                objects[i] = a;
+            }
+        }
+        Runtime.getRuntime().gc();
+        int live = 0;
+        for (int i = 0; i < count; ++i) {
+            Object o = objects[i];
+            if ((i & 1) == 0) {
+                if (((Point) o).x != i) {
+                    throw new Error("Point " + i + " lost its value");
+                }
+            } else {
+                int[] a = (int[]) o;
+                if (a.length != (i & 7) || (a.length != 0 && a[0] != i)) {
+                    throw new Error("Array " + i + " lost its value");
+                }
+            }
+            ++live;
+        }
+        return live;
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.io.File;
+import java.lang.reflect.Method;
+
+public class Main {
+    private static final int TEST_LENGTH = 100;
+
+    private static volatile boolean dumpDone;
+
+    public static void main(String[] args) throws Exception {
+        // Create some data.
+        Object data[] = new Object[TEST_LENGTH];
+        for (int i = 0; i < data.length; i++) {
+            if (i % 10 == 0) {
+                Object[] local = new Object[TEST_LENGTH];
+                local[0] = data;
+                data[i] = local;
+            } else {
+                data[i] = String.valueOf(i);
+            }
+        }
+        System.out.println("Generated data.");
+
+        // A thread that keeps allocating and mutating the heap while it is dumped.
+        Thread mutator = new Thread() {
+            public void run() {
+                Object[] objects = new Object[TEST_LENGTH];
+                int i = 0;
+                while (!dumpDone) {
+                    objects[i % TEST_LENGTH] = new Object[i % 10];
+                    ++i;
+                }
+            }
+        };
+        mutator.start();
+
+        File dumpFile = getTempFile("dump");
+        File convFile = getTempFile("conv");
+        try {
+            Method dumpHprofData = Class.forName("dalvik.system.VMDebug")
+                    .getMethod("dumpHprofData", String.class);
+            dumpHprofData.invoke(null, dumpFile.getAbsoluteFile().toString());
+            if (dumpFile.length() == 0) {
+                throw new RuntimeException("Empty heap dump");
+            }
+            System.out.println("Dumped heap.");
+
+            dumpDone = true;
+            mutator.join();
+            System.out.println("Mutator done.");
+
+            // The child process must have written a complete dump.
+            ProcessBuilder pb = new ProcessBuilder(
+                    getHprofConv().getAbsoluteFile().toString(),
+                    dumpFile.getAbsoluteFile().toString(),
+                    convFile.getAbsoluteFile().toString());
+            pb.redirectErrorStream(true);
+            Process process = pb.start();
+            int ret = process.waitFor();
+            if (ret != 0) {
+                throw new RuntimeException("Exited abnormally with " + ret);
+            }
+            System.out.println("Converted dump.");
+        } finally {
+            dumpDone = true;
+            dumpFile.delete();
+            convFile.delete();
+        }
+        if (data[10] == null) {
+            throw new Error("Lost data");
+        }
+    }
+
+    private static File getHprofConv() {
+        // Use the java.library.path. It points to the lib directory.
+        File libDir = new File(System.getProperty("java.library.path"));
+        return new File(new File(libDir.getParentFile(), "bin"), "hprof-conv");
+    }
+
+    private static File getTempFile(String suffix) throws Exception {
+        return File.createTempFile("test-535-hprof-fork", suffix);
+    }
+}
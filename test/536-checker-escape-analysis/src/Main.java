@@ -0,0 +1,151 @@
+/*
+* Copyright (C) 2015 The Android Open Source Project
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*      http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+class Point {
+  int x;
+  int y;
+
+  Point(int x, int y) {
+    this.x = x;
+    this.y = y;
+  }
+}
+
+class Holder {
+  Point point;
+}
+
+public class Main {
+
+  // CHECK-START: int Main.sum(int, int) escape_analysis (before)
+  // CHECK:         NewInstance
+  // CHECK:         InstanceFieldGet
+
+  // CHECK-START: int Main.sum(int, int) escape_analysis (after)
+  // CHECK-NOT:     NewInstance
+  // CHECK-NOT:     InstanceFieldSet
+  // CHECK-NOT:     InstanceFieldGet
+
+  // CHECK-START: int Main.sum(int, int) escape_analysis (after)
+  // CHECK-DAG:     [[X:i\d+]]      ParameterValue
+  // CHECK-DAG:     [[Y:i\d+]]      ParameterValue
+  // CHECK-DAG:     [[Add:i\d+]]    Add [ [[X]] [[Y]] ]
+  // CHECK-DAG:                     Return [ [[Add]] ]
+
+  public static int sum(int x, int y) {
+    Point p = new Point(x, y);
+    return p.x + p.y;
+  }
+
+  // CHECK-START: int Main.select(boolean, int, int) escape_analysis (after)
+  // CHECK-NOT:     NewInstance
+  // CHECK-NOT:     InstanceFieldGet
+
+  // CHECK-START: int Main.select(boolean, int, int) escape_analysis (after)
+  // CHECK-DAG:     [[Phi:i\d+]]    Phi
+  // CHECK-DAG:                     Return [ [[Phi]] ]
+
+  public static int select(boolean cond, int x, int y) {
+    Point p = new Point(0, 0);
+    if (cond) {
+      p.x = x;
+    } else {
+      p.x = y;
+    }
+    return p.x;
+  }
+
+  // The object is live in the environment of the loop's suspend check, and a frame
+  // rebuilt from it would need the object.
+
+  // CHECK-START: int Main.loop(int) escape_analysis (after)
+  // CHECK:         NewInstance
+
+  public static int loop(int n) {
+    Point p = new Point(0, 1);
+    for (int i = 0; i < n; ++i) {
+      p.x += p.y;
+      p.y++;
+    }
+    return p.x;
+  }
+
+  // CHECK-START: int Main.nested(int) escape_analysis (after)
+  // CHECK-NOT:     NewInstance
+  // CHECK-NOT:     InstanceFieldGet
+
+  public static int nested(int x) {
+    Holder holder = new Holder();
+    holder.point = new Point(x, x);
+    return holder.point.x + holder.point.y;
+  }
+
+  // CHECK-START: int Main.liveAcrossCall(int) escape_analysis (after)
+  // CHECK:         NewInstance
+  // CHECK:         InvokeStaticOrDirect
+
+  public static int liveAcrossCall(int x) {
+    Point p = new Point(x, x);
+    doNothing();
+    return p.x;
+  }
+
+  public static void doNothing() {
+    if (doThrow) {
+      // Try defeating inlining.
+      throw new Error();
+    }
+  }
+
+  public static boolean doThrow = false;
+
+  // CHECK-START: Point Main.escapes(int) escape_analysis (after)
+  // CHECK:         NewInstance
+
+  public static Point escapes(int x) {
+    Point p = new Point(x, x);
+    return p;
+  }
+
+  // CHECK-START: int Main.escapesToField(int) escape_analysis (after)
+  // CHECK:         NewInstance
+
+  public static int escapesToField(int x) {
+    Point p = new Point(x, x);
+    staticPoint = p;
+    return p.x;
+  }
+
+  public static Point staticPoint;
+
+  public static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  public static void main(String[] args) {
+    assertEquals(7, sum(3, 4));
+    assertEquals(3, select(true, 3, 4));
+    assertEquals(4, select(false, 3, 4));
+    assertEquals(10, loop(4));
+    assertEquals(10, nested(5));
+    assertEquals(8, liveAcrossCall(8));
+    assertEquals(6, escapes(6).y);
+    assertEquals(7, escapesToField(7));
+    assertEquals(7, staticPoint.y);
+  }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/logging.h"
+#include "gc/heap.h"
+#include "jni.h"
+#include "mirror/array-inl.h"
+#include "mirror/string-inl.h"
+#include "runtime.h"
+#include "scoped_thread_state_change.h"
+#include "thread.h"
+
+namespace art {
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_keepsArrayAddressAcrossGc(
+    JNIEnv* env, jclass, jbyteArray java_array) {
+  jboolean is_copy;
+  void* elements = env->GetPrimitiveArrayCritical(java_array, &is_copy);
+  CHECK(elements != nullptr);
+  Runtime::Current()->GetHeap()->CollectGarbage(false);
+  bool kept_address;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    mirror::ByteArray* array = soa.Decode<mirror::ByteArray*>(java_array);
+    // A copy (-Xjniopts:forcecopy) never aliases the array, so there is nothing to check.
+    kept_address = is_copy == JNI_TRUE || array->GetData() == elements;
+  }
+  static_cast<jbyte*>(elements)[0] = 42;
+  env->ReleasePrimitiveArrayCritical(java_array, elements, 0);
+  return kept_address ? JNI_TRUE : JNI_FALSE;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_keepsStringAddressAcrossGc(
+    JNIEnv* env, jclass, jstring java_string) {
+  jboolean is_copy;
+  const jchar* chars = env->GetStringCritical(java_string, &is_copy);
+  CHECK(chars != nullptr);
+  Runtime::Current()->GetHeap()->CollectGarbage(false);
+  bool kept_address;
+  {
+    ScopedObjectAccess soa(Thread::Current());
+    mirror::String* string = soa.Decode<mirror::String*>(java_string);
+    kept_address = is_copy == JNI_TRUE || string->GetValue() == chars;
+  }
+  env->ReleaseStringCritical(java_string, chars);
+  return kept_address ? JNI_TRUE : JNI_FALSE;
+}
+
+}  // namespace art
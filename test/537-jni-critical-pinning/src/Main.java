@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void main(String[] args) {
+    System.loadLibrary("arttest");
+
+    byte[] array = new byte[1024];
+    System.out.println("Array kept its address: " + keepsArrayAddressAcrossGc(array));
+    System.out.println("Array written through the critical pointer: " + array[0]);
+
+    String string = new String(new char[] { 'p', 'i', 'n', 'n', 'e', 'd' });
+    System.out.println("String kept its address: " + keepsStringAddressAcrossGc(string));
+  }
+
+  // Both collect garbage between the Get*Critical and Release*Critical calls.
+  private static native boolean keepsArrayAddressAcrossGc(byte[] array);
+  private static native boolean keepsStringAddressAcrossGc(String string);
+}
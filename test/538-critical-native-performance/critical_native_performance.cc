@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "jni.h"
+
+namespace art {
+
+extern "C" JNIEXPORT jint JNICALL Java_Main_addNormal(JNIEnv*, jclass, jint a, jint b) {
+  return a + b;
+}
+
+static jint AddFast(JNIEnv*, jclass, jint a, jint b) {
+  return a + b;
+}
+
+extern "C" JNIEXPORT void JNICALL Java_Main_registerFastNative(JNIEnv* env, jclass klass) {
+  static const JNINativeMethod kMethods[] = {
+    { "addFast", "!(II)I", reinterpret_cast<void*>(AddFast) },
+  };
+  CHECK_EQ(env->RegisterNatives(klass, kMethods, arraysize(kMethods)), JNI_OK);
+}
+
+// @CriticalNative methods are called without the JNIEnv* and the jclass.
+extern "C" JNIEXPORT jint JNICALL Java_Main_addCritical(jint a, jint b) {
+  return a + b;
+}
+
+}  // namespace art
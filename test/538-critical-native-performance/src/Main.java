@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import dalvik.annotation.optimization.CriticalNative;
+
+public class Main {
+    static final int ITERATIONS = 1000000;
+
+    public static void main(String[] args) {
+        boolean timing = (args.length >= 1) && args[0].equals("--timing");
+        System.loadLibrary("arttest");
+        registerFastNative();
+
+        System.out.println("Normal: " + addNormal(40, 2));
+        System.out.println("Fast: " + addFast(40, 2));
+        System.out.println("Critical: " + addCritical(40, 2));
+
+        long time0 = System.nanoTime();
+        int normal = callNormal(ITERATIONS);
+        long time1 = System.nanoTime();
+        int fast = callFast(ITERATIONS);
+        long time2 = System.nanoTime();
+        int critical = callCritical(ITERATIONS);
+        long time3 = System.nanoTime();
+
+        if (normal != fast || fast != critical) {
+            throw new Error("Sums differ: " + normal + " " + fast + " " + critical);
+        }
+        System.out.println("Sums match");
+
+        if (timing) {
+            printRate("Normal", time1 - time0);
+            printRate("Fast", time2 - time1);
+            printRate("Critical", time3 - time2);
+        }
+    }
+
+    static void printRate(String name, long nanos) {
+        System.out.println(name + ": " + (nanos * 1000 / ITERATIONS) + " ps per call");
+    }
+
+    static int callNormal(int count) {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum = addNormal(sum, i);
+        }
+        return sum;
+    }
+
+    static int callFast(int count) {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum = addFast(sum, i);
+        }
+        return sum;
+    }
+
+    static int callCritical(int count) {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum = addCritical(sum, i);
+        }
+        return sum;
+    }
+
+    // The same function behind the three native calling conventions: a regular JNI method, a
+    // fast native registered with a '!' signature, and a @CriticalNative method.
+    private static native void registerFastNative();
+    private static native int addNormal(int a, int b);
+    private static native int addFast(int a, int b);
+    @CriticalNative
+    private static native int addCritical(int a, int b);
+}
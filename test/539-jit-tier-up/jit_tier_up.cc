@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "art_method-inl.h"
+#include "base/logging.h"
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
+#include "jni.h"
+#include "runtime.h"
+#include "scoped_thread_state_change.h"
+#include "thread.h"
+
+namespace art {
+
+static ArtMethod* GetHotMethod(const ScopedObjectAccess& soa, jclass klass)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  jmethodID method_id = soa.Env()->GetStaticMethodID(klass, "hot", "(I)I");
+  CHECK(method_id != nullptr);
+  return soa.DecodeMethod(method_id);
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_Main_getJitCode(JNIEnv*, jclass klass) {
+  ScopedObjectAccess soa(Thread::Current());
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  CHECK(jit != nullptr);
+  const void* code = GetHotMethod(soa, klass)->GetEntryPointFromQuickCompiledCode();
+  if (!jit->GetCodeCache()->ContainsCodePtr(code)) {
+    return 0;
+  }
+  return static_cast<jlong>(reinterpret_cast<uintptr_t>(code));
+}
+
+extern "C" JNIEXPORT jint JNICALL Java_Main_getHotnessCount(JNIEnv*, jclass klass) {
+  ScopedObjectAccess soa(Thread::Current());
+  return GetHotMethod(soa, klass)->GetHotnessCount();
+}
+
+}  // namespace art
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary("arttest");
+
+    // Get the interpreter to request the compilation of hot(), see -Xjitthreshold in run.
+    for (int i = 0; i != 20; ++i) {
+      hot(1);
+    }
+    long baselineCode = waitForNewJitCode(0);
+    System.out.println("Compiled by the baseline tier: " + (baselineCode != 0));
+
+    // The baseline code counts once on entry and once per loop back edge.
+    int before = getHotnessCount();
+    hot(10);
+    int after = getHotnessCount();
+    System.out.println("Baseline code counts the hotness: " + (before - after >= 10));
+
+    // Run the baseline code until its count reaches zero, then wait for the optimized code,
+    // which the runtime requests when it next polls the baseline methods.
+    while (getHotnessCount() != 0) {
+      hot(100);
+    }
+    long optimizedCode = waitForNewJitCode(baselineCode);
+    System.out.println("Recompiled once hot: " + (optimizedCode != baselineCode));
+    System.out.println("Result: " + hot(100));
+  }
+
+  static int hot(int n) {
+    int result = 0;
+    for (int i = 0; i < n; ++i) {
+      result += i;
+    }
+    return result;
+  }
+
+  // Waits until hot() has JIT code other than previousCode, and returns it.
+  private static long waitForNewJitCode(long previousCode) throws Exception {
+    for (int i = 0; i != 1000; ++i) {
+      long code = getJitCode();
+      if (code != 0 && code != previousCode) {
+        return code;
+      }
+      Thread.sleep(10);
+    }
+    throw new Error("Timed out waiting for the JIT");
+  }
+
+  // Returns the address of hot()'s code if it is in the JIT code cache, 0 otherwise.
+  private static native long getJitCode();
+
+  private static native int getHotnessCount();
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Point {
+  int x;
+  int y;
+}
+
+public class Main {
+
+  // The fast path loads the position in the thread-local allocation buffer, compares the
+  // new position against the inline end, branches to the slow path when the object does
+  // not fit, then stores the new position and counts the object. The slow path is emitted
+  // after the blocks of the method and calls the allocation entrypoint. The ARM
+  // disassembler only names the thread fields of loads, so the stores are not checked there.
+
+  // CHECK-START-X86: Point Main.allocPoint() disassembly (after)
+  // CHECK:         NewInstance
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_inline_end
+  // CHECK:         jnbe/a
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_objects
+  // CHECK-NOT:     pAllocObject
+  // CHECK:         SlowPath for NewInstance
+  // CHECK:         pAllocObject
+
+  // CHECK-START-X86_64: Point Main.allocPoint() disassembly (after)
+  // CHECK:         NewInstance
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_inline_end
+  // CHECK:         jnbe/a
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_objects
+  // CHECK-NOT:     pAllocObject
+  // CHECK:         SlowPath for NewInstance
+  // CHECK:         pAllocObject
+
+  // CHECK-START-ARM: Point Main.allocPoint() disassembly (after)
+  // CHECK:         NewInstance
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_inline_end
+  // CHECK:         bhi
+  // CHECK:         thread_local_objects
+  // CHECK-NOT:     pAllocObject
+  // CHECK:         SlowPath for NewInstance
+  // CHECK:         pAllocObject
+
+  // CHECK-START-ARM64: Point Main.allocPoint() disassembly (after)
+  // CHECK:         NewInstance
+  // CHECK:         (thread_local_pos)
+  // CHECK:         (thread_local_inline_end)
+  // CHECK:         b.hi
+  // CHECK:         (thread_local_pos)
+  // CHECK:         (thread_local_objects)
+  // CHECK-NOT:     (pAllocObject)
+  // CHECK:         SlowPath for NewInstance
+  // CHECK:         (pAllocObject)
+
+  // MIPS64 does not inline allocations and always calls the entrypoint.
+
+  // CHECK-START-MIPS64: Point Main.allocPoint() disassembly (after)
+  // CHECK-NOT:     thread_local_pos
+  // CHECK:         NewInstance
+  // CHECK-NOT:     thread_local_pos
+  // CHECK:         pAllocObject
+  // CHECK-NOT:     SlowPath for NewInstance
+
+  public static Point allocPoint() {
+    return new Point();
+  }
+
+  // CHECK-START-X86: int[] Main.allocArray(int) disassembly (after)
+  // CHECK:         NewArray
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_inline_end
+  // CHECK:         jnbe/a
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_objects
+  // CHECK-NOT:     pAllocArray
+  // CHECK:         SlowPath for NewArray
+  // CHECK:         pAllocArray
+
+  // CHECK-START-X86_64: int[] Main.allocArray(int) disassembly (after)
+  // CHECK:         NewArray
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_inline_end
+  // CHECK:         jnbe/a
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_objects
+  // CHECK-NOT:     pAllocArray
+  // CHECK:         SlowPath for NewArray
+  // CHECK:         pAllocArray
+
+  // CHECK-START-ARM: int[] Main.allocArray(int) disassembly (after)
+  // CHECK:         NewArray
+  // CHECK:         thread_local_pos
+  // CHECK:         thread_local_inline_end
+  // CHECK:         bhi
+  // CHECK:         thread_local_objects
+  // CHECK-NOT:     pAllocArray
+  // CHECK:         SlowPath for NewArray
+  // CHECK:         pAllocArray
+
+  // CHECK-START-ARM64: int[] Main.allocArray(int) disassembly (after)
+  // CHECK:         NewArray
+  // CHECK:         (thread_local_pos)
+  // CHECK:         (thread_local_inline_end)
+  // CHECK:         b.hi
+  // CHECK:         (thread_local_pos)
+  // CHECK:         (thread_local_objects)
+  // CHECK-NOT:     (pAllocArray)
+  // CHECK:         SlowPath for NewArray
+  // CHECK:         (pAllocArray)
+
+  // CHECK-START-MIPS64: int[] Main.allocArray(int) disassembly (after)
+  // CHECK-NOT:     thread_local_pos
+  // CHECK:         NewArray
+  // CHECK-NOT:     thread_local_pos
+  // CHECK:         pAllocArray
+  // CHECK-NOT:     SlowPath for NewArray
+
+  public static int[] allocArray(int length) {
+    return new int[length];
+  }
+
+  public static void main(String[] args) {
+    Point p = allocPoint();
+    System.out.println("Point: " + p.x + " " + p.y);
+    System.out.println("Array: " + allocArray(8).length);
+  }
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.io.BufferedReader;
+import java.io.FileReader;
+import java.io.IOException;
+import java.io.StringReader;
+import java.lang.reflect.Method;
+import java.util.ArrayList;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.Random;
+
+public class Main {
+    // The sizes of the objects, spread over several RosAlloc brackets.
+    private static final int[] SIZES = { 16, 48, 120, 250, 500, 1000, 2000 };
+    // Bytes allocated per round, and the share of them kept alive.
+    private static final int BYTES_PER_ROUND = 512 * 1024;
+    private static final int RETAINED_PER_MILLE = 200;
+    // Bound on the retained bytes, to stay well below the heap size of the gcstress runs.
+    private static final int MAX_RETAINED_BYTES = 768 * 1024;
+
+    private static final String METRICS_FILE = "metrics.txt";
+    private static final long METRICS_WAIT_MS = 10 * 1000;
+
+    public static void main(String[] args) throws Exception {
+        long seconds = Long.getLong("stress.seconds", 2);
+        boolean report = Boolean.getBoolean("stress.report");
+
+        Random random = new Random(42);
+        ArrayList<byte[]> retained = new ArrayList<byte[]>();
+        long retainedBytes = 0;
+        long rounds = 0;
+        long end = System.currentTimeMillis() + seconds * 1000;
+        do {
+            for (int allocated = 0; allocated < BYTES_PER_ROUND; ) {
+                int size = SIZES[random.nextInt(SIZES.length)];
+                byte[] array = new byte[size];
+                allocated += size;
+                if (random.nextInt(1000) < RETAINED_PER_MILLE) {
+                    retained.add(array);
+                    retainedBytes += size;
+                }
+            }
+            // Drop a random half of the survivors, which leaves holes in the runs they were
+            // allocated from.
+            while (retainedBytes > MAX_RETAINED_BYTES / 2) {
+                int index = random.nextInt(retained.size());
+                int last = retained.size() - 1;
+                retainedBytes -= retained.get(index).length;
+                retained.set(index, retained.get(last));
+                retained.remove(last);
+            }
+            Runtime.getRuntime().gc();
+            ++rounds;
+            if (report && rounds % 100 == 0) {
+                printReport(rounds, getMetrics());
+            }
+        } while (System.currentTimeMillis() < end);
+
+        // The fragmentation is measured by a heap task after the collections.
+        Map<String, Long> metrics = getMetrics();
+        long waitEnd = System.currentTimeMillis() + METRICS_WAIT_MS;
+        while (get(metrics, "heap.main_space.used_page_bytes") == 0 &&
+               System.currentTimeMillis() < waitEnd) {
+            Runtime.getRuntime().gc();
+            Thread.sleep(100);
+            metrics = getMetrics();
+        }
+        if (report) {
+            printReport(rounds, metrics);
+        }
+
+        long usedPageBytes = get(metrics, "heap.main_space.used_page_bytes");
+        long freeSlotBytes = get(metrics, "heap.main_space.free_slot_bytes");
+        System.out.println("Fragmentation measured: " +
+            (usedPageBytes > 0 && freeSlotBytes <= usedPageBytes));
+
+        boolean histogramsConsistent = true;
+        for (String key : metrics.keySet()) {
+            if (key.endsWith(".pause_us.count")) {
+                String name = key.substring(0, key.length() - ".count".length());
+                if (!checkHistogram(metrics, name)) {
+                    System.out.println("Inconsistent histogram " + name);
+                    histogramsConsistent = false;
+                }
+            }
+        }
+        System.out.println("Pause histograms consistent: " + histogramsConsistent);
+    }
+
+    private static boolean checkHistogram(Map<String, Long> metrics, String name) {
+        long count = get(metrics, name + ".count");
+        long sum = get(metrics, name + ".sum");
+        long min = get(metrics, name + ".min");
+        long max = get(metrics, name + ".max");
+        long p50 = get(metrics, name + ".p50");
+        long p99 = get(metrics, name + ".p99");
+        if (count == 0) {
+            return sum == 0 && min == 0 && max == 0;
+        }
+        // The collectors record pauses in nanoseconds, each statistic is rounded down to
+        // microseconds on its own.
+        return min <= max && min * count <= sum && sum <= (max + 1) * count && p50 <= p99;
+    }
+
+    private static void printReport(long rounds, Map<String, Long> metrics) {
+        long usedPageBytes = get(metrics, "heap.main_space.used_page_bytes");
+        long freeSlotBytes = get(metrics, "heap.main_space.free_slot_bytes");
+        System.out.println("Round " + rounds + ": " +
+            freeSlotBytes + " free slot bytes in " + usedPageBytes + " used page bytes (" +
+            (usedPageBytes != 0 ? freeSlotBytes * 100 / usedPageBytes : 0) + "%)");
+        for (String key : metrics.keySet()) {
+            if (key.endsWith(".pause_us.count") && metrics.get(key) != 0) {
+                String name = key.substring(0, key.length() - ".count".length());
+                System.out.println("  " + name + ": count " + metrics.get(key) +
+                    ", p50 " + get(metrics, name + ".p50") +
+                    ", p99 " + get(metrics, name + ".p99") +
+                    ", max " + get(metrics, name + ".max"));
+            }
+        }
+    }
+
+    private static long get(Map<String, Long> metrics, String key) {
+        Long value = metrics.get(key);
+        return (value != null) ? value : 0;
+    }
+
+    // Reads the metrics with VMDebug.getRuntimeStat("art.metrics"), or from the periodic dump
+    // set up by the run script if libcore does not know that stat.
+    private static Map<String, Long> getMetrics() throws Exception {
+        String dump = null;
+        try {
+            Class<?> c = Class.forName("dalvik.system.VMDebug");
+            Method getRuntimeStat = c.getDeclaredMethod("getRuntimeStat", String.class);
+            dump = (String) getRuntimeStat.invoke(null, "art.metrics");
+        } catch (Exception e) {
+            // Fall back to the dump file.
+        }
+        BufferedReader reader;
+        if (dump != null) {
+            reader = new BufferedReader(new StringReader(dump));
+        } else {
+            String dexLocation = System.getenv("DEX_LOCATION");
+            String path = (dexLocation != null) ? dexLocation + "/" + METRICS_FILE : METRICS_FILE;
+            // Wait for the next periodic dump to see the last collections.
+            Thread.sleep(1000);
+            try {
+                reader = new BufferedReader(new FileReader(path));
+            } catch (IOException e) {
+                return new HashMap<String, Long>();
+            }
+        }
+        Map<String, Long> metrics = new HashMap<String, Long>();
+        try {
+            String line;
+            while ((line = reader.readLine()) != null) {
+                int space = line.indexOf(' ');
+                if (space < 0) {
+                    continue;
+                }
+                try {
+                    long value = Long.parseLong(line.substring(space + 1));
+                    metrics.put(line.substring(0, space), value);
+                } catch (NumberFormatException e) {
+                    // Not a number.
+                }
+            }
+        } finally {
+            reader.close();
+        }
+        return metrics;
+    }
+}
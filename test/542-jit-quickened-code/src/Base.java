@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Base {
+  public boolean booleanField;
+  public byte byteField;
+  public char charField;
+  public short shortField;
+  public int intField;
+  public long longField;
+  public float floatField;
+  public double doubleField;
+  public Object objectField;
+
+  public int value() {
+    return intField;
+  }
+
+  public int sum(int a, int b, int c, int d, int e) {
+    return a + b + c + d + e + intField;
+  }
+
+  public void store(int value) {
+    intField = value;
+  }
+
+  public int run(int n) {
+    return n;
+  }
+}
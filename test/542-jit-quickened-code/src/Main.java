@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.reflect.Method;
+
+public class Main {
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary("arttest");
+
+    Base base = new Base();
+    Base derived = (Base) Class.forName("Derived").newInstance();
+
+    // Get the interpreter to request the compilation of the methods, see -Xjitthreshold in run.
+    for (int i = 0; i != 20; ++i) {
+      putFields(base, i);
+      getFields(base);
+      invokeVirtual(base);
+      invokeVirtualRange(base, i);
+      derived.run(i);
+    }
+    waitForJitCode(Main.class.getDeclaredMethod("putFields", Base.class, int.class));
+    waitForJitCode(Main.class.getDeclaredMethod("getFields", Base.class));
+    waitForJitCode(Main.class.getDeclaredMethod("invokeVirtual", Base.class));
+    waitForJitCode(Main.class.getDeclaredMethod("invokeVirtualRange", Base.class, int.class));
+    waitForJitCode(derived.getClass().getDeclaredMethod("run", int.class));
+
+    putFields(base, 42);
+    String fields = getFields(base);
+    System.out.print(fields);
+    int virtualResult = invokeVirtual(base);
+    int rangeResult = invokeVirtualRange(base, 42);
+    int derivedResult = derived.run(42);
+    System.out.println("INVOKE_VIRTUAL_QUICK: " + virtualResult);
+    System.out.println("INVOKE_VIRTUAL_RANGE_QUICK: " + rangeResult);
+    System.out.println("Other dex file: " + derivedResult);
+
+    // Keep running the methods, which tiers them up, and check that the results do not change.
+    boolean stable = true;
+    for (int i = 0; i != 2000; ++i) {
+      putFields(base, 42);
+      stable &= fields.equals(getFields(base)) &&
+          invokeVirtual(base) == virtualResult &&
+          invokeVirtualRange(base, 42) == rangeResult &&
+          derived.run(42) == derivedResult;
+    }
+    System.out.println("Results stable: " + stable);
+  }
+
+  // IPUT_*_QUICK, and RETURN_VOID_NO_BARRIER.
+  static void putFields(Base o, int n) {
+    o.booleanField = (n & 1) == 0;
+    o.byteField = (byte) (n * 5);
+    o.charField = (char) ('a' + n % 26);
+    o.shortField = (short) (n * 1000);
+    o.intField = n * 100000;
+    o.longField = n * 10000000000L;
+    o.floatField = n / 4.0f;
+    o.doubleField = n / 8.0;
+    o.objectField = o;
+  }
+
+  // IGET_*_QUICK.
+  static String getFields(Base o) {
+    return "IGET_BOOLEAN_QUICK: " + o.booleanField + "\n" +
+        "IGET_BYTE_QUICK: " + o.byteField + "\n" +
+        "IGET_CHAR_QUICK: " + o.charField + "\n" +
+        "IGET_SHORT_QUICK: " + o.shortField + "\n" +
+        "IGET_QUICK: " + o.intField + " " + o.floatField + "\n" +
+        "IGET_WIDE_QUICK: " + o.longField + " " + o.doubleField + "\n" +
+        "IGET_OBJECT_QUICK: " + (o.objectField == o) + "\n";
+  }
+
+  // INVOKE_VIRTUAL_QUICK.
+  static int invokeVirtual(Base o) {
+    return o.value();
+  }
+
+  // INVOKE_VIRTUAL_RANGE_QUICK, the receiver and the arguments take six registers.
+  static int invokeVirtualRange(Base o, int n) {
+    return o.sum(n, n + 1, n + 2, n + 3, n + 4);
+  }
+
+  // Waits until the method has JIT code.
+  private static void waitForJitCode(Method method) throws Exception {
+    for (int i = 0; i != 1000; ++i) {
+      if (isJitCompiled(method)) {
+        System.out.println("Compiled " + method.getName() + ": true");
+        return;
+      }
+      Thread.sleep(10);
+    }
+    throw new Error("Timed out waiting for the JIT to compile " + method.getName());
+  }
+
+  // Returns whether the method's code is in the JIT code cache.
+  private static native boolean isJitCompiled(Method method);
+}
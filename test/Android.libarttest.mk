@@ -35,7 +35,11 @@ LIBARTTEST_COMMON_SRC_FILES := \
   455-set-vreg/set_vreg_jni.cc \
   457-regs/regs_jni.cc \
   461-get-reference-vreg/get_reference_vreg_jni.cc \
-  466-get-live-vreg/get_live_vreg_jni.cc
+  466-get-live-vreg/get_live_vreg_jni.cc \
+  537-jni-critical-pinning/jni_critical_pinning.cc \
+  538-critical-native-performance/critical_native_performance.cc \
+  539-jit-tier-up/jit_tier_up.cc \
+  542-jit-quickened-code/jit_quickened_code.cc
 
 ART_TARGET_LIBARTTEST_$(ART_PHONY_TEST_TARGET_SUFFIX) += $(ART_TARGET_TEST_OUT)/$(TARGET_ARCH)/libarttest.so
 ifdef TARGET_2ND_ARCH
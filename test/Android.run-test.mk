@@ -272,13 +272,13 @@ ART_TEST_KNOWN_BROKEN += $(call all-run-test-names,target,$(RUN_TYPES),$(PREBUIL
     $(RELOCATE_TYPES),$(TRACE_TYPES),$(GC_TYPES),$(JNI_TYPES),$(IMAGE_TYPES),$(PICTEST_TYPES),$(DEBUGGABLE_TYPES), 115-native-bridge, \
     $(ALL_ADDRESS_SIZES))
 
-# 130-hprof dumps the heap and runs hprof-conv to check whether the file is somewhat readable. This
-# is only possible on the host.
+# 130-hprof and 535-hprof-fork dump the heap and run hprof-conv to check whether the file is
+# somewhat readable. This is only possible on the host.
 # TODO: Turn off all the other combinations, this is more about testing actual ART code. A gtest is
 #       very hard to write here, as (for a complete test) JDWP must be set up.
 ART_TEST_KNOWN_BROKEN += $(call all-run-test-names,target,$(RUN_TYPES),$(PREBUILD_TYPES), \
     $(COMPILER_TYPES),$(RELOCATE_TYPES),$(TRACE_TYPES),$(GC_TYPES),$(JNI_TYPES),$(IMAGE_TYPES), \
-    $(PICTEST_TYPES),$(DEBUGGABLE_TYPES),130-hprof,$(ALL_ADDRESS_SIZES))
+    $(PICTEST_TYPES),$(DEBUGGABLE_TYPES),130-hprof 535-hprof-fork,$(ALL_ADDRESS_SIZES))
 
 # 131 is an old test. The functionality has been implemented at an earlier stage and is checked
 # in tests 138.
@@ -338,6 +338,8 @@ TEST_ART_BROKEN_FALLBACK_RUN_TESTS :=
 # when already tracing, and writes an error message that we do not want to check for.
 TEST_ART_BROKEN_TRACING_RUN_TESTS := \
   137-cfi \
+  539-jit-tier-up \
+  542-jit-quickened-code \
   802-deoptimization
 
 ifneq (,$(filter trace stream,$(TRACE_TYPES)))
@@ -371,6 +373,10 @@ TEST_ART_BROKEN_NDEBUG_TESTS := \
   457-regs \
   461-get-reference-vreg \
   466-get-live-vreg \
+  537-jni-critical-pinning \
+  538-critical-native-performance \
+  539-jit-tier-up \
+  542-jit-quickened-code \
 
 ifneq (,$(filter ndebug,$(RUN_TYPES)))
   ART_TEST_KNOWN_BROKEN += $(call all-run-test-names,$(TARGET_TYPES),ndebug,$(PREBUILD_TYPES), \
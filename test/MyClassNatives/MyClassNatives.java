@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+import dalvik.annotation.optimization.CriticalNative;
+
 class MyClassNatives {
     native void throwException();
     native void foo();
@@ -102,4 +104,12 @@ class MyClassNatives {
     static native boolean returnTrue();
     static native boolean returnFalse();
     static native int returnInt();
+
+    @CriticalNative
+    static native int criticalSII(int x, int y);
+    @CriticalNative
+    static native double criticalSJIDF(long x, int y, double z, float w);
+    @CriticalNative
+    static native void criticalStackArgs(int i1, long l1, int i2, long l2, int i3, long l3,
+        double d1, float f1, double d2, float f2, int i4, long l4);
 }
@@ -54,6 +54,12 @@
 # enclosed in round brackets. For example, the pattern '{{foo{2}}}' will parse
 # the invalid regex 'foo{2', but '{{(fo{2})}}' will match 'foo'.
 #
+# Groups which only hold for the code generated for one instruction set start
+# with 'CHECK-START-<ARCH>' instead, where <ARCH> is one of ARM, ARM64, MIPS,
+# MIPS64, X86 and X86_64. They are only matched when Checker is run with the
+# same '--arch' and skipped otherwise. They are typically used against the
+# 'disassembly (after)' group which interleaves the graph with the native code.
+#
 # Regex patterns can be named and referenced later. A new variable is defined
 # with '[[name:regex]]' and can be referenced with '[[name]]'. Variables are
 # only valid within the scope of the defining group. Within a group they cannot
@@ -79,6 +85,9 @@ import shutil
 import sys
 import tempfile
 
+# Instruction sets which check groups can be specific to.
+archs_list = ["ARM", "ARM64", "MIPS", "MIPS64", "X86", "X86_64"]
+
 class Logger(object):
 
   class Level(object):
@@ -356,7 +365,7 @@ class CheckGroup(CommonEqualityMixin):
   """Represents a named collection of check lines which are to be matched
      against an output group of the same name."""
 
-  def __init__(self, name, lines, fileName=None, lineNo=-1):
+  def __init__(self, name, lines, fileName=None, lineNo=-1, arch=None):
     self.fileName = fileName
     self.lineNo = lineNo
 
@@ -367,11 +376,14 @@ class CheckGroup(CommonEqualityMixin):
 
     self.name = name
     self.lines = lines
+    # Instruction set the group is specific to, or None if it holds for all of them.
+    self.arch = arch
 
   def __eq__(self, other):
     return (isinstance(other, self.__class__) and
             self.name == other.name and
-            self.lines == other.lines)
+            self.lines == other.lines and
+            self.arch == other.arch)
 
   def __headAndTail(self, list):
     return list[0], list[1:]
@@ -566,13 +578,20 @@ class CheckFile(FileSplitMixin):
   # This function is invoked on each line of the check file and returns a pair
   # which instructs the parser how the line should be handled. If the line is to
   # be included in the current check group, it is returned in the first value.
-  # If the line starts a new check group, the name of the group is returned in
-  # the second value.
+  # If the line starts a new check group, the name of the group and the
+  # instruction set it is specific to are returned in the second value.
   def _processLine(self, line, lineNo):
     # Lines beginning with 'CHECK-START' start a new check group.
     startLine = self._extractLine(self.prefix + "-START", line)
     if startLine is not None:
-      return None, startLine
+      return None, (startLine, None)
+
+    # Lines beginning with 'CHECK-START-<ARCH>' start a new instruction set
+    # specific check group.
+    for arch in archs_list:
+      startLine = self._extractLine(self.prefix + "-START-" + arch, line)
+      if startLine is not None:
+        return None, (startLine, arch)
 
     # Lines starting only with 'CHECK' are matched in order.
     plainLine = self._extractLine(self.prefix, line)
@@ -596,12 +615,17 @@ class CheckFile(FileSplitMixin):
     Logger.fail("Check line not inside a group", self.fileName, lineNo)
 
   # Constructs a check group from the parser-collected check lines.
-  def _processGroup(self, name, lines, lineNo):
+  def _processGroup(self, nameAndArch, lines, lineNo):
+    name, arch = nameAndArch
     checkLines = list(map(lambda line: CheckLine(line[0], line[1], self.fileName, line[2]), lines))
-    return CheckGroup(name, checkLines, self.fileName, lineNo)
+    return CheckGroup(name, checkLines, self.fileName, lineNo, arch)
 
-  def match(self, outputFile):
+  def match(self, outputFile, targetArch=None):
     for checkGroup in self.groups:
+      # Groups specific to another instruction set than the one the output was
+      # generated for are skipped.
+      if checkGroup.arch is not None and checkGroup.arch != targetArch:
+        continue
       # TODO: Currently does not handle multiple occurrences of the same group
       # name, e.g. when a pass is run multiple times. It will always try to
       # match a check group against the first output group of the same name.
@@ -711,6 +735,9 @@ def ParseArguments():
                       help="print the contents of an output group")
   parser.add_argument("-q", "--quiet", action="store_true",
                       help="print only errors")
+  parser.add_argument("--arch", choices=archs_list,
+                      help="instruction set the output was generated for, which selects "
+                           "the CHECK-START-<ARCH> groups to run")
   return parser.parse_args()
 
 
@@ -753,14 +780,14 @@ def FindCheckFiles(path):
     Logger.fail("Source path \"" + path + "\" not found")
 
 
-def RunChecks(checkPrefix, checkPath, outputFilename):
+def RunChecks(checkPrefix, checkPath, outputFilename, targetArch):
   outputBaseName = os.path.basename(outputFilename)
   outputFile = OutputFile(open(outputFilename, "r"), outputBaseName)
 
   for checkFilename in FindCheckFiles(checkPath):
     checkBaseName = os.path.basename(checkFilename)
     checkFile = CheckFile(checkPrefix, open(checkFilename, "r"), checkBaseName)
-    checkFile.match(outputFile)
+    checkFile.match(outputFile, targetArch)
 
 
 if __name__ == "__main__":
@@ -774,4 +801,4 @@ if __name__ == "__main__":
   elif args.dump_group:
     DumpGroup(args.tested_file, args.dump_group)
   else:
-    RunChecks(args.check_prefix, args.source_path, args.tested_file)
+    RunChecks(args.check_prefix, args.source_path, args.tested_file, args.arch)
@@ -469,6 +469,38 @@ class TestCheckFile_Parse(unittest.TestCase):
                                                          ("abc", CheckVariant.DAG),
                                                          ("def", CheckVariant.DAG) ])) ])
 
+  def test_ArchSpecificGroups(self):
+    self.__parsesTo("""// CHECK-START: Example Group
+                       // CHECK: foo
+                       // CHECK-START-ARM64: Example Group
+                       // CHECK: bar
+                       // CHECK-START-X86_64: Example Group
+                       // CHECK: abc""",
+                    [ checker.CheckGroup("Example Group", prepareChecks([ "foo" ])),
+                      checker.CheckGroup("Example Group", prepareChecks([ "bar" ]),
+                                         arch="ARM64"),
+                      checker.CheckGroup("Example Group", prepareChecks([ "abc" ]),
+                                         arch="X86_64") ])
+
+  def test_ArchSpecificGroupsOnlyMatchTheirArch(self):
+    checkStream = io.StringIO(unicode("""// CHECK-START-ARM: MyMethod pass
+                                         // CHECK: foo
+                                         // CHECK-START-X86: MyMethod pass
+                                         // CHECK: bar"""))
+    outputStream = io.StringIO(unicode("""begin_compilation
+                                            method "MyMethod"
+                                          end_compilation
+                                          begin_cfg
+                                            name "pass"
+                                            bar
+                                          end_cfg"""))
+    checkFile = checker.CheckFile("CHECK", checkStream)
+    outputFile = checker.OutputFile(outputStream)
+    checkFile.match(outputFile, "X86")
+    checkFile.match(outputFile)
+    with self.assertRaises(CheckerException):
+      checkFile.match(outputFile, "ARM")
+
 if __name__ == '__main__':
   checker.Logger.Verbosity = checker.Logger.Level.NoOutput
   unittest.main()